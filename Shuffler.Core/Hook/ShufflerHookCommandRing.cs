@@ -0,0 +1,123 @@
+﻿using System.Diagnostics;
+using System.IO.MemoryMappedFiles;
+
+namespace Shuffler.Core.Hook;
+
+/// <summary>
+/// Producer side of the hook's shared memory command ring, see IpcRing.h in Shuffler.Hook for the layout.
+/// Writing a command is a copy into the mapping plus an event signal, with no round trip through a pipe.
+/// </summary>
+public sealed class ShufflerHookCommandRing : IDisposable
+{
+    private const uint Magic = 0x52434853;
+    private const ushort Version = 1;
+    private const int CapacityOffset = 8;
+    private const int TailOffset = 64;
+    private const int HeadOffset = 128;
+    private const int HeaderSize = 192;
+    private const int PrefixSize = 8;
+    private const int RecordAlignment = 8;
+    private const uint WrapMarker = 0xFFFFFFFF;
+
+    private readonly MemoryMappedFile _mapping;
+    private readonly MemoryMappedViewAccessor _accessor;
+    private readonly EventWaitHandle _dataEvent;
+    private readonly uint _capacity;
+    private readonly object _writeLock = new();
+
+    private ShufflerHookCommandRing(MemoryMappedFile mapping, MemoryMappedViewAccessor accessor,
+        EventWaitHandle dataEvent, uint capacity)
+    {
+        _mapping = mapping;
+        _accessor = accessor;
+        _dataEvent = dataEvent;
+        _capacity = capacity;
+    }
+
+    /// <summary>
+    /// Opens the ring of a hooked process, or returns null if the hook in it does not provide one.
+    /// </summary>
+    public static ShufflerHookCommandRing? TryOpen(Process process)
+    {
+        MemoryMappedFile? mapping = null;
+        MemoryMappedViewAccessor? accessor = null;
+
+        try
+        {
+            mapping = MemoryMappedFile.OpenExisting($@"Local\ShufflerHookCommands-{process.Id}",
+                MemoryMappedFileRights.ReadWrite);
+            accessor = mapping.CreateViewAccessor();
+
+            var capacity = accessor.ReadUInt32(CapacityOffset);
+            if (accessor.ReadUInt32(0) != Magic || accessor.ReadUInt16(4) != Version ||
+                capacity == 0 || (capacity & (capacity - 1)) != 0)
+                throw new IpcException("Unsupported command ring");
+
+            var dataEvent = EventWaitHandle.OpenExisting($@"Local\ShufflerHookCommandsEvent-{process.Id}");
+            return new ShufflerHookCommandRing(mapping, accessor, dataEvent, capacity);
+        }
+        catch (Exception)
+        {
+            accessor?.Dispose();
+            mapping?.Dispose();
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// Queues one command, returns false if the hook has not caught up and the ring is full.
+    /// </summary>
+    public bool TryWrite(ReadOnlySpan<byte> payload)
+    {
+        var recordSize = GetRecordSize(payload.Length);
+        if (recordSize > _capacity)
+            return false;
+
+        lock (_writeLock)
+        {
+            var tail = _accessor.ReadUInt64(TailOffset);
+            var head = _accessor.ReadUInt64(HeadOffset);
+            Interlocked.MemoryBarrier();
+
+            var offset = (uint)(tail & (_capacity - 1));
+            var padding = offset + recordSize > _capacity ? _capacity - offset : 0;
+            if (tail + padding + recordSize - head > _capacity)
+                return false;
+
+            if (padding != 0)
+            {
+                WritePrefix(offset, WrapMarker);
+                tail += padding;
+                offset = 0;
+            }
+
+            WritePrefix(offset, (uint)payload.Length);
+            _accessor.WriteArray(HeaderSize + offset + PrefixSize, payload.ToArray(), 0, payload.Length);
+
+            // The record has to be visible before the hook can see the new tail
+            Interlocked.MemoryBarrier();
+            _accessor.Write(TailOffset, tail + recordSize);
+        }
+
+        _dataEvent.Set();
+        return true;
+    }
+
+    private void WritePrefix(uint offset, uint length)
+    {
+        _accessor.Write(HeaderSize + offset, length);
+        _accessor.Write(HeaderSize + offset + 4, 0u);
+    }
+
+    private static uint GetRecordSize(int payloadLength)
+    {
+        return (uint)(PrefixSize + payloadLength + RecordAlignment - 1) & ~(uint)(RecordAlignment - 1);
+    }
+
+    public void Dispose()
+    {
+        _dataEvent.Dispose();
+        _accessor.Dispose();
+        _mapping.Dispose();
+    }
+}
\ No newline at end of file
@@ -1,6 +1,5 @@
 ﻿using System.Diagnostics;
 using System.IO.Pipes;
-using System.Runtime.InteropServices;
 
 namespace Shuffler.Core.Hook;
 
@@ -10,30 +9,26 @@ public class IpcException : Exception
     public IpcException(string message, Exception inner) : base(message, inner) { }
 }
 
-public enum ShufflerHookIpcMessageType
-{
-    Enable,
-    Disable,
-    SetActiveController
-}
-
-public struct ShufflerHookIpcMessage
-{
-    public ShufflerHookIpcMessageType Type;
-    public int ControllerId;
-}
-
 public class ShufflerHookIpc : IAsyncDisposable, IDisposable
 {
     public bool IsConnected => _pipeClient.IsConnected;
 
+    /// <summary>
+    /// Poll interval <see cref="SetInputSourceAsync"/> uses for <see cref="ShufflerHookInputSource.Polled"/>.
+    /// </summary>
+    public static readonly TimeSpan DefaultPollInterval = TimeSpan.FromMilliseconds(1);
+
+    private static readonly TimeSpan CommandRingTimeout = TimeSpan.FromSeconds(5);
+
     private readonly Process _process;
     private readonly NamedPipeClientStream _pipeClient;
+    private readonly ShufflerHookCommandRing? _commandRing;
 
-    private ShufflerHookIpc(Process process, NamedPipeClientStream pipeClient)
+    private ShufflerHookIpc(Process process, NamedPipeClientStream pipeClient, ShufflerHookCommandRing? commandRing)
     {
         _process = process;
         _pipeClient = pipeClient;
+        _commandRing = commandRing;
     }
 
     public static async Task<ShufflerHookIpc> ConnectAsync(Process process, CancellationToken cancellationToken = default)
@@ -50,36 +45,146 @@ public class ShufflerHookIpc : IAsyncDisposable, IDisposable
             throw new IpcException($"Failed to connect to IPC pipe: {ex}");
         }
 
-        return new ShufflerHookIpc(process, pipeClient);
+        // Hooks that predate the command ring only have the pipe
+        return new ShufflerHookIpc(process, pipeClient, ShufflerHookCommandRing.TryOpen(process));
     }
 
     public Task EnableAsync(CancellationToken cancellationToken = default)
     {
-        return SendIpcMessageAsync(new ShufflerHookIpcMessage
-        {
-            Type = ShufflerHookIpcMessageType.Enable
-        }, cancellationToken);
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeEnable(), cancellationToken);
     }
 
     public Task DisableAsync(CancellationToken cancellationToken = default)
     {
-        return SendIpcMessageAsync(new ShufflerHookIpcMessage
-        {
-            Type = ShufflerHookIpcMessageType.Disable
-        }, cancellationToken);
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeDisable(), cancellationToken);
     }
 
     public Task SetActiveControllerAsync(int controllerId, CancellationToken cancellationToken = default)
     {
-        return SendIpcMessageAsync(new ShufflerHookIpcMessage
-        {
-            Type = ShufflerHookIpcMessageType.SetActiveController,
-            ControllerId = controllerId
-        }, cancellationToken);
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeSetActiveController(controllerId), cancellationToken);
+    }
+
+    /// <summary>
+    /// Switches where the hook reads controllers from, see <see cref="ShufflerPadFeed"/>.
+    /// </summary>
+    public Task SetInputSourceAsync(ShufflerHookInputSource source, CancellationToken cancellationToken = default)
+    {
+        if (source == ShufflerHookInputSource.Polled)
+            return SetPolledInputSourceAsync(DefaultPollInterval, cancellationToken);
+        if (source == ShufflerHookInputSource.Replay)
+            throw new ArgumentException("Replay needs a file, use SetReplayInputSourceAsync", nameof(source));
+
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeSetInputSource(source), cancellationToken);
+    }
+
+    /// <summary>
+    /// Makes the hook read XInput on a background thread every <paramref name="interval"/>, between 1 µs and about
+    /// 65 ms, and hand games the latest state it read.
+    /// </summary>
+    public Task SetPolledInputSourceAsync(TimeSpan interval, CancellationToken cancellationToken = default)
+    {
+        var microseconds = (long)interval.TotalMicroseconds;
+        if (microseconds < 1 || microseconds > ushort.MaxValue)
+            throw new ArgumentOutOfRangeException(nameof(interval));
+
+        return SendIpcMessageAsync(
+            ShufflerHookIpcProtocol.EncodeSetInputSource(ShufflerHookInputSource.Polled, (ushort)microseconds),
+            cancellationToken);
+    }
+
+    /// <summary>
+    /// Makes the hook play back an input stream recorded with <see cref="StartInputRecordingAsync"/> in place of the
+    /// controllers. <paramref name="path"/> is opened by the hooked process.
+    /// </summary>
+    public Task SetReplayInputSourceAsync(string path, float speed = 1, bool loop = false,
+        CancellationToken cancellationToken = default)
+    {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeSetReplayInputSource(path, speed, loop),
+            cancellationToken);
+    }
+
+    /// <summary>
+    /// Records the controller states the hook reads, before any remapping, to <paramref name="path"/> in the hooked
+    /// process, replacing the file if it exists.
+    /// </summary>
+    public Task StartInputRecordingAsync(string path, CancellationToken cancellationToken = default)
+    {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeStartInputRecording(path), cancellationToken);
+    }
+
+    public Task StopInputRecordingAsync(CancellationToken cancellationToken = default)
+    {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeStopInputRecording(), cancellationToken);
     }
 
-    private async Task SendIpcMessageAsync(ShufflerHookIpcMessage msg, CancellationToken cancellationToken)
+    /// <summary>
+    /// Sets a player's stick and trigger deadzones and response curves.
+    /// </summary>
+    public Task SetAnalogSettingsAsync(byte playerIndex, ShufflerHookAnalogSettings settings,
+        CancellationToken cancellationToken = default)
     {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeSetAnalogSettings(playerIndex, settings),
+            cancellationToken);
+    }
+
+    /// <summary>
+    /// Sets how a player's sticks and triggers are mixed into each other, and the stick/D-pad conversions.
+    /// </summary>
+    public Task SetAxisRoutingAsync(byte playerIndex, ShufflerHookAxisRouting routing,
+        CancellationToken cancellationToken = default)
+    {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeSetAxisRouting(playerIndex, routing),
+            cancellationToken);
+    }
+
+    /// <summary>
+    /// Makes GetState calls within <paramref name="window"/> of a controller's last read, up to 100 ms, reuse that
+    /// read. <see cref="TimeSpan.Zero"/> reads the controller on every call.
+    /// </summary>
+    public Task SetStateFreshnessAsync(TimeSpan window, CancellationToken cancellationToken = default)
+    {
+        var microseconds = (long)window.TotalMicroseconds;
+        if (microseconds < 0 || microseconds > ShufflerHookIpcProtocol.MaxStateFreshnessMicroseconds)
+            throw new ArgumentOutOfRangeException(nameof(window));
+
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeSetStateFreshness((uint)microseconds),
+            cancellationToken);
+    }
+
+    /// <summary>
+    /// Shows the game another controller in slot, driven by controllerIndex with playerIndex's mappings.
+    /// </summary>
+    public Task BindVirtualSlotAsync(byte slot, byte playerIndex, byte controllerIndex,
+        CancellationToken cancellationToken = default)
+    {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeBindVirtualSlot(slot, playerIndex, controllerIndex),
+            cancellationToken);
+    }
+
+    public Task UnplugVirtualSlotAsync(byte slot, CancellationToken cancellationToken = default)
+    {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeUnplugVirtualSlot(slot), cancellationToken);
+    }
+
+    /// <summary>
+    /// Replaces the mappings of every player at once, players that are not listed are left without mappings.
+    /// </summary>
+    public Task SetMappingsAsync(IReadOnlyList<ShufflerHookPlayerMappings> players,
+        CancellationToken cancellationToken = default)
+    {
+        return SendIpcMessageAsync(ShufflerHookIpcProtocol.EncodeSetMappings(players), cancellationToken);
+    }
+
+    private async Task SendIpcMessageAsync(byte[] bytes, CancellationToken cancellationToken)
+    {
+        // Once the hook has a command ring every command goes through it. Sending one over the pipe while the ring is
+        // full would let it overtake the commands still queued in the ring
+        if (_commandRing != null)
+        {
+            await WriteCommandRingAsync(_commandRing, bytes, cancellationToken);
+            return;
+        }
+
         if (!_pipeClient.IsConnected)
         {
             try
@@ -94,21 +199,6 @@ public class ShufflerHookIpc : IAsyncDisposable, IDisposable
 
         try
         {
-            // Convert the message to bytes
-            var size = Marshal.SizeOf<ShufflerHookIpcMessage>();
-            var bytes = new byte[size];
-            var ptr = Marshal.AllocHGlobal(size);
-
-            try
-            {
-                Marshal.StructureToPtr(msg, ptr, false);
-                Marshal.Copy(ptr, bytes, 0, size);
-            }
-            finally
-            {
-                Marshal.FreeHGlobal(ptr);
-            }
-
             try
             {
                 await _pipeClient.WriteAsync(bytes, cancellationToken);
@@ -128,14 +218,30 @@ public class ShufflerHookIpc : IAsyncDisposable, IDisposable
         }
     }
 
+    private static async Task WriteCommandRingAsync(ShufflerHookCommandRing commandRing, byte[] bytes,
+        CancellationToken cancellationToken)
+    {
+        var waited = Stopwatch.StartNew();
+        while (!commandRing.TryWrite(bytes))
+        {
+            // The hook drains the ring as soon as it is signalled, one that stays full means the hook stopped reading
+            if (waited.Elapsed > CommandRingTimeout)
+                throw new IpcException("Timed out waiting for room in the command ring");
+
+            await Task.Delay(1, cancellationToken);
+        }
+    }
+
     public async ValueTask DisposeAsync()
     {
+        _commandRing?.Dispose();
         await _pipeClient.DisposeAsync();
         _process.Dispose();
     }
 
     public void Dispose()
     {
+        _commandRing?.Dispose();
         _pipeClient.Dispose();
         _process.Dispose();
     }
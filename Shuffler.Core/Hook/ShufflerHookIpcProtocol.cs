@@ -0,0 +1,344 @@
+﻿using System.Buffers.Binary;
+
+namespace Shuffler.Core.Hook;
+
+/// <summary>
+/// Message types of the hook's IPC protocol, see IpcProtocol.h in Shuffler.Hook for the wire format.
+/// </summary>
+public enum ShufflerHookIpcMessageType : ushort
+{
+    Enable = 1,
+    Disable = 2,
+    SetActiveController = 3,
+    SetMappings = 4,
+    SetInputSource = 5,
+    SetAnalogSettings = 6,
+    SetAxisRouting = 7,
+    SetVirtualSlot = 8,
+    SetInputRecording = 9,
+    SetStateFreshness = 10
+}
+
+public enum ShufflerHookInputSource : byte
+{
+    XInput = 0,
+    SharedPadFeed = 1,
+
+    /// <summary>
+    /// XInput read on a background thread in the hooked process, so game threads never wait on the driver.
+    /// </summary>
+    Polled = 2,
+
+    /// <summary>
+    /// A file recorded with <see cref="ShufflerHookIpcProtocol.EncodeStartInputRecording"/> played back in place of
+    /// the controllers.
+    /// </summary>
+    Replay = 3
+}
+
+public enum ShufflerHookInputType : byte
+{
+    Button,
+    Trigger
+}
+
+/// <summary>
+/// A button (one XInput button bit) or a trigger (0 for left, 1 for right).
+/// </summary>
+public readonly record struct ShufflerHookInputAction(ShufflerHookInputType Type, ushort Value);
+
+public readonly record struct ShufflerHookMapping(ShufflerHookInputAction From, ShufflerHookInputAction To);
+
+/// <summary>
+/// Radial stick deadzones in stick units (0 to 32767) and a response curve exponent, 1 is linear. Axis movements up
+/// to NoiseGate are held back, so jitter at rest does not read as new input.
+/// </summary>
+public record ShufflerHookStickResponse(
+    ushort Deadzone = 0,
+    ushort AntiDeadzone = 0,
+    ushort OuterDeadzone = 32767,
+    float Curve = 1.0f,
+    ushort NoiseGate = 0);
+
+/// <summary>
+/// Trigger deadzones in trigger units (0 to 255) and a response curve exponent, 1 is linear. Movements up to
+/// NoiseGate are held back.
+/// </summary>
+public record ShufflerHookTriggerResponse(
+    byte Deadzone = 0,
+    byte AntiDeadzone = 0,
+    float Curve = 1.0f,
+    byte NoiseGate = 0);
+
+public record ShufflerHookAnalogSettings(
+    ShufflerHookStickResponse LeftStick,
+    ShufflerHookStickResponse RightStick,
+    ShufflerHookTriggerResponse LeftTrigger,
+    ShufflerHookTriggerResponse RightTrigger);
+
+public enum ShufflerHookStickSelection : byte
+{
+    None,
+    Left,
+    Right
+}
+
+/// <summary>
+/// Axis routing for one player. Matrix is 6 by 6, row major, in the axis order left X, left Y, right X, right Y, left
+/// trigger, right trigger; each output axis is the weighted sum of the input axes in its row.
+/// </summary>
+public record ShufflerHookAxisRouting(
+    float[] Matrix,
+    ShufflerHookStickSelection DpadToStick = ShufflerHookStickSelection.None,
+    ShufflerHookStickSelection StickToDpad = ShufflerHookStickSelection.None,
+    ushort StickToDpadThreshold = 16384)
+{
+    public const int AxisCount = 6;
+
+    public static float[] CreateIdentityMatrix()
+    {
+        var matrix = new float[AxisCount * AxisCount];
+        for (var i = 0; i < AxisCount; i++)
+            matrix[i * AxisCount + i] = 1;
+        return matrix;
+    }
+}
+
+public record ShufflerHookPlayerMappings(byte PlayerIndex, IReadOnlyList<ShufflerHookMapping> Mappings);
+
+/// <summary>
+/// Builds the frames sent to the hook: a 16 byte header followed by the payload of the message type.
+/// </summary>
+public static class ShufflerHookIpcProtocol
+{
+    public const uint Magic = 0x50494853;
+    public const ushort Version = 1;
+    public const int MaxFrameSize = 16 * 1024;
+    public const float MaxReplaySpeed = 1000;
+    public const uint MaxStateFreshnessMicroseconds = 100_000;
+
+    private const int HeaderSize = 16;
+    private const int MappingSetHeaderSize = 4;
+    private const int PlayerMappingsHeaderSize = 4;
+    private const int MappingEntrySize = 8;
+    private const int AnalogSettingsSize = 44;
+    private const int ReplaySourceSize = 12;
+    private const int InputRecordingSize = 4;
+    private const int AxisRoutingSize = 8 + ShufflerHookAxisRouting.AxisCount * ShufflerHookAxisRouting.AxisCount * 4;
+
+    public static byte[] EncodeEnable()
+    {
+        return CreateFrame(ShufflerHookIpcMessageType.Enable, 0);
+    }
+
+    public static byte[] EncodeDisable()
+    {
+        return CreateFrame(ShufflerHookIpcMessageType.Disable, 0);
+    }
+
+    public static byte[] EncodeSetActiveController(int controllerId)
+    {
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetActiveController, sizeof(int));
+        BinaryPrimitives.WriteInt32LittleEndian(frame.AsSpan(HeaderSize), controllerId);
+        return frame;
+    }
+
+    public static byte[] EncodeSetInputSource(ShufflerHookInputSource source, ushort pollIntervalMicroseconds = 0)
+    {
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetInputSource, 4);
+        frame[HeaderSize] = (byte)source;
+        BinaryPrimitives.WriteUInt16LittleEndian(frame.AsSpan(HeaderSize + 2), pollIntervalMicroseconds);
+        return frame;
+    }
+
+    /// <summary>
+    /// Makes the hook play back the input stream at <paramref name="path"/>, a path in the hooked process, at
+    /// <paramref name="speed"/> times the recorded pace.
+    /// </summary>
+    public static byte[] EncodeSetReplayInputSource(string path, float speed = 1, bool loop = false)
+    {
+        if (!float.IsFinite(speed) || speed <= 0 || speed > MaxReplaySpeed)
+            throw new ArgumentOutOfRangeException(nameof(speed));
+        ValidatePath(path, ReplaySourceSize);
+
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetInputSource, ReplaySourceSize + path.Length * 2);
+        var span = frame.AsSpan(HeaderSize);
+        span[0] = (byte)ShufflerHookInputSource.Replay;
+        BinaryPrimitives.WriteSingleLittleEndian(span[4..], speed);
+        span[8] = loop ? (byte)1 : (byte)0;
+        BinaryPrimitives.WriteUInt16LittleEndian(span[10..], (ushort)path.Length);
+        WritePath(span[ReplaySourceSize..], path);
+        return frame;
+    }
+
+    /// <summary>
+    /// Makes the hook record the controller states it reads to <paramref name="path"/>, a path in the hooked process.
+    /// </summary>
+    public static byte[] EncodeStartInputRecording(string path)
+    {
+        ValidatePath(path, InputRecordingSize);
+
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetInputRecording, InputRecordingSize + path.Length * 2);
+        var span = frame.AsSpan(HeaderSize);
+        span[0] = 1;
+        BinaryPrimitives.WriteUInt16LittleEndian(span[2..], (ushort)path.Length);
+        WritePath(span[InputRecordingSize..], path);
+        return frame;
+    }
+
+    public static byte[] EncodeStopInputRecording()
+    {
+        return CreateFrame(ShufflerHookIpcMessageType.SetInputRecording, InputRecordingSize);
+    }
+
+    /// <summary>
+    /// Makes the hook reuse a controller's last read for calls within <paramref name="microseconds"/> of it, 0 reads
+    /// the controller on every call.
+    /// </summary>
+    public static byte[] EncodeSetStateFreshness(uint microseconds)
+    {
+        if (microseconds > MaxStateFreshnessMicroseconds)
+            throw new ArgumentOutOfRangeException(nameof(microseconds));
+
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetStateFreshness, sizeof(uint));
+        BinaryPrimitives.WriteUInt32LittleEndian(frame.AsSpan(HeaderSize), microseconds);
+        return frame;
+    }
+
+    public static byte[] EncodeSetAnalogSettings(byte playerIndex, ShufflerHookAnalogSettings settings)
+    {
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetAnalogSettings, AnalogSettingsSize);
+        var span = frame.AsSpan(HeaderSize);
+        span[0] = playerIndex;
+        WriteStick(span[4..], settings.LeftStick);
+        WriteStick(span[16..], settings.RightStick);
+        WriteTrigger(span[28..], settings.LeftTrigger);
+        WriteTrigger(span[36..], settings.RightTrigger);
+        return frame;
+    }
+
+    /// <summary>
+    /// Plugs a virtual controller into slot (0 to 3), reading physical controller controllerIndex through the profile
+    /// of playerIndex. The game sees slot n as XInput user index n and as the n-th emulated HID device.
+    /// </summary>
+    public static byte[] EncodeBindVirtualSlot(byte slot, byte playerIndex, byte controllerIndex)
+    {
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetVirtualSlot, 4);
+        frame[HeaderSize] = slot;
+        frame[HeaderSize + 1] = 1;
+        frame[HeaderSize + 2] = playerIndex;
+        frame[HeaderSize + 3] = controllerIndex;
+        return frame;
+    }
+
+    public static byte[] EncodeUnplugVirtualSlot(byte slot)
+    {
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetVirtualSlot, 4);
+        frame[HeaderSize] = slot;
+        return frame;
+    }
+
+    public static byte[] EncodeSetAxisRouting(byte playerIndex, ShufflerHookAxisRouting routing)
+    {
+        if (routing.Matrix.Length != ShufflerHookAxisRouting.AxisCount * ShufflerHookAxisRouting.AxisCount)
+            throw new ArgumentException("The routing matrix must have 36 weights", nameof(routing));
+
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetAxisRouting, AxisRoutingSize);
+        var span = frame.AsSpan(HeaderSize);
+        span[0] = playerIndex;
+        span[1] = (byte)routing.DpadToStick;
+        span[2] = (byte)routing.StickToDpad;
+        BinaryPrimitives.WriteUInt16LittleEndian(span[4..], routing.StickToDpadThreshold);
+        for (var i = 0; i < routing.Matrix.Length; i++)
+            BinaryPrimitives.WriteSingleLittleEndian(span[(8 + i * 4)..], routing.Matrix[i]);
+        return frame;
+    }
+
+    /// <summary>
+    /// Encodes every player's mappings into one message, which the hook applies as a whole.
+    /// </summary>
+    public static byte[] EncodeSetMappings(IReadOnlyList<ShufflerHookPlayerMappings> players)
+    {
+        if (players.Count > byte.MaxValue)
+            throw new ArgumentException($"At most {byte.MaxValue} players are supported", nameof(players));
+
+        var payloadSize = MappingSetHeaderSize;
+        foreach (var player in players)
+        {
+            if (player.Mappings.Count > ushort.MaxValue)
+                throw new ArgumentException($"Too many mappings for player {player.PlayerIndex}", nameof(players));
+            payloadSize += PlayerMappingsHeaderSize + player.Mappings.Count * MappingEntrySize;
+        }
+
+        if (HeaderSize + payloadSize > MaxFrameSize)
+            throw new ArgumentException("Mappings do not fit in a single message", nameof(players));
+
+        var frame = CreateFrame(ShufflerHookIpcMessageType.SetMappings, payloadSize);
+        var span = frame.AsSpan(HeaderSize);
+        span[0] = (byte)players.Count;
+        span = span[MappingSetHeaderSize..];
+
+        foreach (var player in players)
+        {
+            span[0] = player.PlayerIndex;
+            BinaryPrimitives.WriteUInt16LittleEndian(span[2..], (ushort)player.Mappings.Count);
+            span = span[PlayerMappingsHeaderSize..];
+
+            foreach (var mapping in player.Mappings)
+            {
+                WriteAction(span, mapping.From);
+                WriteAction(span[4..], mapping.To);
+                span = span[MappingEntrySize..];
+            }
+        }
+
+        return frame;
+    }
+
+    private static byte[] CreateFrame(ShufflerHookIpcMessageType type, int payloadSize)
+    {
+        var frame = new byte[HeaderSize + payloadSize];
+        BinaryPrimitives.WriteUInt32LittleEndian(frame, Magic);
+        BinaryPrimitives.WriteUInt16LittleEndian(frame.AsSpan(4), Version);
+        BinaryPrimitives.WriteUInt16LittleEndian(frame.AsSpan(6), (ushort)type);
+        BinaryPrimitives.WriteUInt32LittleEndian(frame.AsSpan(8), (uint)payloadSize);
+        return frame;
+    }
+
+    private static void ValidatePath(string path, int fixedPayloadSize)
+    {
+        if (path.Length == 0 || path.Contains('\0'))
+            throw new ArgumentException("The path must be non-empty and cannot contain NUL", nameof(path));
+        if (HeaderSize + fixedPayloadSize + path.Length * 2 > MaxFrameSize)
+            throw new ArgumentException("The path does not fit in a single message", nameof(path));
+    }
+
+    private static void WritePath(Span<byte> destination, string path)
+    {
+        for (var i = 0; i < path.Length; i++)
+            BinaryPrimitives.WriteUInt16LittleEndian(destination[(i * 2)..], path[i]);
+    }
+
+    private static void WriteStick(Span<byte> destination, ShufflerHookStickResponse stick)
+    {
+        BinaryPrimitives.WriteUInt16LittleEndian(destination, stick.Deadzone);
+        BinaryPrimitives.WriteUInt16LittleEndian(destination[2..], stick.AntiDeadzone);
+        BinaryPrimitives.WriteUInt16LittleEndian(destination[4..], stick.OuterDeadzone);
+        BinaryPrimitives.WriteUInt16LittleEndian(destination[6..], stick.NoiseGate);
+        BinaryPrimitives.WriteSingleLittleEndian(destination[8..], stick.Curve);
+    }
+
+    private static void WriteTrigger(Span<byte> destination, ShufflerHookTriggerResponse trigger)
+    {
+        destination[0] = trigger.Deadzone;
+        destination[1] = trigger.AntiDeadzone;
+        destination[2] = trigger.NoiseGate;
+        BinaryPrimitives.WriteSingleLittleEndian(destination[4..], trigger.Curve);
+    }
+
+    private static void WriteAction(Span<byte> destination, ShufflerHookInputAction action)
+    {
+        destination[0] = (byte)action.Type;
+        BinaryPrimitives.WriteUInt16LittleEndian(destination[2..], action.Value);
+    }
+}
\ No newline at end of file
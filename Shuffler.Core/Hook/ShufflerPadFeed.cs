@@ -0,0 +1,88 @@
+﻿using System.IO.MemoryMappedFiles;
+
+namespace Shuffler.Core.Hook;
+
+public struct ShufflerPadState
+{
+    public ushort Buttons;
+    public byte LeftTrigger;
+    public byte RightTrigger;
+    public short LeftThumbX;
+    public short LeftThumbY;
+    public short RightThumbX;
+    public short RightThumbY;
+    public bool Connected;
+}
+
+/// <summary>
+/// Publishes every player's controller state to all hooked games at once, see SharedPadTable.h in Shuffler.Hook for
+/// the layout. Hooked games read it after being switched to <see cref="ShufflerHookInputSource.SharedPadFeed"/>, so
+/// only this process has to poll the physical controllers.
+/// </summary>
+public sealed class ShufflerPadFeed : IDisposable
+{
+    public const int MaxPlayers = 16;
+
+    private const uint Magic = 0x44504853;
+    private const ushort Version = 1;
+    private const int SlotsOffset = 64;
+    private const int SlotSize = 64;
+    private const int StateOffset = 8;
+    private const int TableSize = SlotsOffset + MaxPlayers * SlotSize;
+
+    private readonly MemoryMappedFile _mapping;
+    private readonly MemoryMappedViewAccessor _accessor;
+    private readonly uint[] _sequences = new uint[MaxPlayers];
+    private readonly object _writeLock = new();
+
+    public ShufflerPadFeed()
+    {
+        _mapping = MemoryMappedFile.CreateOrOpen(@"Local\ShufflerPadFeed", TableSize);
+        _accessor = _mapping.CreateViewAccessor(0, TableSize);
+
+        for (var player = 0; player < MaxPlayers; player++)
+            _sequences[player] = _accessor.ReadUInt32(SlotsOffset + player * SlotSize);
+
+        _accessor.Write(4, Version);
+        _accessor.Write(6, (ushort)MaxPlayers);
+        Interlocked.MemoryBarrier();
+        _accessor.Write(0, Magic);
+    }
+
+    /// <summary>
+    /// Writes one player's slot. Readers that catch the slot mid-write retry instead of seeing a torn state.
+    /// </summary>
+    public void Publish(int playerIndex, in ShufflerPadState state)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(playerIndex);
+        ArgumentOutOfRangeException.ThrowIfGreaterThanOrEqual(playerIndex, MaxPlayers);
+
+        var slot = SlotsOffset + playerIndex * SlotSize;
+        lock (_writeLock)
+        {
+            // The sequence must be odd before the state changes and even again only after all of it is written
+            var sequence = _sequences[playerIndex] | 1;
+            _accessor.Write(slot, sequence);
+            Interlocked.MemoryBarrier();
+
+            _accessor.Write(slot + StateOffset, state.Buttons);
+            _accessor.Write(slot + StateOffset + 2, state.LeftTrigger);
+            _accessor.Write(slot + StateOffset + 3, state.RightTrigger);
+            _accessor.Write(slot + StateOffset + 4, state.LeftThumbX);
+            _accessor.Write(slot + StateOffset + 6, state.LeftThumbY);
+            _accessor.Write(slot + StateOffset + 8, state.RightThumbX);
+            _accessor.Write(slot + StateOffset + 10, state.RightThumbY);
+            _accessor.Write(slot + StateOffset + 12, (byte)(state.Connected ? 1 : 0));
+
+            Interlocked.MemoryBarrier();
+            _sequences[playerIndex] = sequence + 1;
+            _accessor.Write(slot, sequence + 1);
+        }
+    }
+
+    public void Dispose()
+    {
+        _accessor.Dispose();
+        _mapping.Dispose();
+    }
+}
\ No newline at end of file
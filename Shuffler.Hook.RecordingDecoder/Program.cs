@@ -0,0 +1,146 @@
+﻿namespace Shuffler.Hook.RecordingDecoder;
+
+/// <summary>
+/// Dumps an input recording written by the hook's InputRecorder and summarizes the time between polls.
+/// The layout mirrors InputRecordHeader and InputRecord in Shuffler.Hook/InputRecorder.h.
+/// </summary>
+internal static class Program
+{
+    private const uint Magic = 0x52464853;
+    private const ushort Version = 1;
+    private const int HeaderSize = 128;
+    private const int NextIndexOffset = 64;
+    private const int RecordSize = 32;
+    private const int SequenceOffset = 8;
+
+    private static int Main(string[] args)
+    {
+        if (args.Length is < 1 or > 2 || (args.Length == 2 && args[1] != "--summary"))
+        {
+            Console.WriteLine("Usage: Shuffler.Hook.RecordingDecoder.exe <recording> [--summary]");
+            return 1;
+        }
+
+        try
+        {
+            Decode(args[0], args.Length == 1);
+            return 0;
+        }
+        catch (Exception ex)
+        {
+            Console.Error.WriteLine(ex.Message);
+            return 1;
+        }
+    }
+
+    private static void Decode(string path, bool dumpRecords)
+    {
+        // The hook may still be writing, so only ask for read access and share everything. Unbuffered, so reading a
+        // sequence again reads the file again
+        using var stream = new FileStream(path, FileMode.Open, FileAccess.Read,
+            FileShare.ReadWrite | FileShare.Delete, bufferSize: 0);
+        using var reader = new BinaryReader(stream);
+
+        if (reader.ReadUInt32() != Magic)
+            throw new Exception($"{path} is not an input recording");
+
+        var version = reader.ReadUInt16();
+        var recordSize = reader.ReadUInt16();
+        if (version != Version || recordSize != RecordSize)
+            throw new Exception($"Unsupported recording version {version} with {recordSize} byte records");
+
+        var capacity = reader.ReadUInt32();
+        var processId = reader.ReadUInt32();
+        var frequency = reader.ReadInt64();
+        var startTimestamp = reader.ReadInt64();
+        stream.Position = NextIndexOffset;
+        var nextIndex = reader.ReadUInt64();
+
+        var count = Math.Min(nextIndex, capacity);
+        var firstIndex = nextIndex - count;
+        Console.WriteLine($"Process {processId}, {nextIndex} records written, {count} kept, capacity {capacity}");
+
+        if (dumpRecords)
+            Console.WriteLine("index,time_ms,api,player,controller,buttons,lt,rt,lx,ly,rx,ry,since_last_ms");
+
+        var intervals = new Dictionary<string, List<double>>();
+        var lastTimestamps = new Dictionary<string, long>();
+        var skipped = 0;
+
+        for (var index = firstIndex; index < nextIndex; index++)
+        {
+            // Read like a SeqLock: the record's sequence before and after it was read must both be its own
+            var position = HeaderSize + (long)(index % capacity) * RecordSize;
+            stream.Position = position + SequenceOffset;
+            var sequenceBefore = reader.ReadUInt32();
+            stream.Position = position;
+            var timestamp = reader.ReadInt64();
+            var sequence = reader.ReadUInt32();
+            var api = reader.ReadByte() switch
+            {
+                1 => "XInput",
+                2 => "RawInput",
+                3 => "Hid",
+                var other => $"Unknown({other})"
+            };
+            var player = reader.ReadByte();
+            var controller = reader.ReadByte();
+            reader.ReadByte();
+            var buttons = reader.ReadUInt16();
+            var leftTrigger = reader.ReadByte();
+            var rightTrigger = reader.ReadByte();
+            var leftX = reader.ReadInt16();
+            var leftY = reader.ReadInt16();
+            var rightX = reader.ReadInt16();
+            var rightY = reader.ReadInt16();
+            stream.Position = position + SequenceOffset;
+            var sequenceAfter = reader.ReadUInt32();
+
+            // A record whose sequence does not match was still being written, or was overwritten by a later lap
+            var expected = (uint)(index + 1);
+            if (sequenceBefore != expected || sequence != expected || sequenceAfter != expected)
+            {
+                skipped++;
+                continue;
+            }
+
+            var sinceLast = double.NaN;
+            if (lastTimestamps.TryGetValue(api, out var lastTimestamp))
+            {
+                sinceLast = (timestamp - lastTimestamp) * 1000.0 / frequency;
+                if (!intervals.TryGetValue(api, out var apiIntervals))
+                    intervals[api] = apiIntervals = [];
+                apiIntervals.Add(sinceLast);
+            }
+
+            lastTimestamps[api] = timestamp;
+
+            if (dumpRecords)
+            {
+                var time = (timestamp - startTimestamp) * 1000.0 / frequency;
+                Console.WriteLine(
+                    $"{index},{time:F3},{api},{player},{controller},0x{buttons:X4},{leftTrigger},{rightTrigger}," +
+                    $"{leftX},{leftY},{rightX},{rightY},{(double.IsNaN(sinceLast) ? "" : sinceLast.ToString("F3"))}");
+            }
+        }
+
+        if (skipped > 0)
+            Console.WriteLine($"Skipped {skipped} incomplete records");
+
+        foreach (var (api, apiIntervals) in intervals)
+        {
+            apiIntervals.Sort();
+            Console.WriteLine(
+                $"{api}: {apiIntervals.Count + 1} polls, interval ms " +
+                $"min {apiIntervals[0]:F3}, mean {apiIntervals.Average():F3}, " +
+                $"p50 {Percentile(apiIntervals, 0.50):F3}, p99 {Percentile(apiIntervals, 0.99):F3}, " +
+                $"max {apiIntervals[^1]:F3}");
+        }
+    }
+
+    private static double Percentile(List<double> sorted, double percentile)
+    {
+        var index = (int)Math.Ceiling(percentile * sorted.Count) - 1;
+        return sorted[Math.Clamp(index, 0, sorted.Count - 1)];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "AnalogResponse.h"
+#include "Fakes/FloatAnalogResponse.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace {
+// Past the first table interval and off the deadzone edge the table is within this of the float math
+constexpr int STICK_TOLERANCE = 64;
+
+AnalogSettings MakeSettings(const StickResponse& stick, const TriggerResponse& trigger = {}) {
+    AnalogSettings settings;
+    settings.LeftStick = stick;
+    settings.RightStick = stick;
+    settings.LeftTrigger = trigger;
+    settings.RightTrigger = trigger;
+    return settings;
+}
+
+ControllerState MakeState(const int16_t x, const int16_t y, const uint8_t trigger = 0) {
+    ControllerState state = {};
+    state.LeftThumbstickX = x;
+    state.LeftThumbstickY = y;
+    state.RightThumbstickX = static_cast<int16_t>(-x);
+    state.RightThumbstickY = y;
+    state.LeftTrigger = trigger;
+    state.RightTrigger = trigger;
+    return state;
+}
+
+double GetMagnitude(const int32_t x, const int32_t y) {
+    return std::sqrt(static_cast<double>(x) * x + static_cast<double>(y) * y);
+}
+
+const StickResponse STICK_CASES[] = {
+    {.Deadzone = 4000},
+    {.Deadzone = 4000, .AntiDeadzone = 2000, .OuterDeadzone = 31000, .Curve = 1.6f},
+    {.Deadzone = 2500, .Curve = 0.8f},
+    {.OuterDeadzone = 30000},
+    {.Deadzone = 8000, .AntiDeadzone = 6000, .OuterDeadzone = 28000, .Curve = 3.0f},
+    {.Curve = 2.0f},
+    {.Curve = 0.5f},
+    {.AntiDeadzone = 3000},
+};
+}
+
+TEST(AnalogResponseTests, DefaultSettingsPassEverythingThrough) {
+    const AnalogResponse response = AnalogResponse::Compile(AnalogSettings());
+    for (int32_t x = -32768; x <= 32767; x += 131) {
+        for (int32_t y = -32768; y <= 32767; y += 127) {
+            ControllerState state = MakeState(static_cast<int16_t>(x), static_cast<int16_t>(y),
+                                              static_cast<uint8_t>(x));
+            response.Apply(&state);
+            ASSERT_EQ(state.LeftThumbstickX, x);
+            ASSERT_EQ(state.LeftThumbstickY, y);
+            ASSERT_EQ(state.LeftTrigger, static_cast<uint8_t>(x));
+        }
+    }
+}
+
+TEST(AnalogResponseTests, SticksMatchTheFloatMath) {
+    for (const StickResponse& stick : STICK_CASES) {
+        const AnalogSettings settings = MakeSettings(stick);
+        const AnalogResponse response = AnalogResponse::Compile(settings);
+        const FloatAnalogResponse reference(settings);
+
+        int worst = 0;
+        for (int32_t x = -32768; x <= 32767; x += 97) {
+            for (int32_t y = -32768; y <= 32767; y += 89) {
+                const double magnitude = GetMagnitude(x, y);
+                if (magnitude < 2048 || (magnitude > stick.Deadzone && magnitude < stick.Deadzone + 256))
+                    continue;
+
+                ControllerState actual = MakeState(static_cast<int16_t>(x), static_cast<int16_t>(y));
+                ControllerState expected = actual;
+                response.Apply(&actual);
+                reference.Apply(&expected);
+                worst = std::max({worst, std::abs(actual.LeftThumbstickX - expected.LeftThumbstickX),
+                                  std::abs(actual.LeftThumbstickY - expected.LeftThumbstickY),
+                                  std::abs(actual.RightThumbstickX - expected.RightThumbstickX)});
+            }
+        }
+        EXPECT_LE(worst, STICK_TOLERANCE) << "deadzone " << stick.Deadzone << ", curve " << stick.Curve;
+    }
+}
+
+TEST(AnalogResponseTests, DeadzoneIsExact) {
+    const AnalogResponse response = AnalogResponse::Compile(MakeSettings({.Deadzone = 5000, .AntiDeadzone = 4000}));
+
+    // Every point on and inside the deadzone's edge is centered, every point past it gets at least the anti-deadzone
+    for (int32_t x = 0; x <= 5000; x++) {
+        const auto y = static_cast<int32_t>(std::sqrt(5000.0 * 5000 - x * x));
+        ControllerState inside = MakeState(static_cast<int16_t>(x), static_cast<int16_t>(y));
+        response.Apply(&inside);
+        ASSERT_EQ(inside.LeftThumbstickX, 0);
+        ASSERT_EQ(inside.LeftThumbstickY, 0);
+
+        ControllerState outside = MakeState(static_cast<int16_t>(x), static_cast<int16_t>(y + 2));
+        response.Apply(&outside);
+        ASSERT_GE(GetMagnitude(outside.LeftThumbstickX, outside.LeftThumbstickY), 4000 - 2);
+    }
+}
+
+TEST(AnalogResponseTests, OutputGrowsWithDeflectionAndKeepsDirection) {
+    for (const StickResponse& stick : STICK_CASES) {
+        const AnalogResponse response = AnalogResponse::Compile(MakeSettings(stick));
+
+        for (const double angle : {0.0, 0.3, 0.785, 1.2, 2.0, 3.0, 4.0, 5.5}) {
+            double last = 0;
+            for (int32_t length = 0; length <= 32767; length = length == 32752 ? 32767 : length + 16) {
+                const auto x = static_cast<int16_t>(std::lround(length * std::cos(angle)));
+                const auto y = static_cast<int16_t>(std::lround(length * std::sin(angle)));
+                ControllerState state = MakeState(x, y);
+                response.Apply(&state);
+
+                // Allowing for the rounding of both axes. Closer to the center the scale is steep enough with an
+                // anti-deadzone that interpolating it rather than the output can dip by a few units
+                const double magnitude = GetMagnitude(state.LeftThumbstickX, state.LeftThumbstickY);
+                if (length >= 2048) {
+                    ASSERT_GE(magnitude + 2, last) << "curve " << stick.Curve << ", length " << length;
+                }
+                ASSERT_GE(state.LeftThumbstickX * x, 0);
+                ASSERT_GE(state.LeftThumbstickY * y, 0);
+                last = magnitude;
+            }
+            EXPECT_GE(last, 32767 - 4) << "curve " << stick.Curve;
+        }
+    }
+}
+
+TEST(AnalogResponseTests, CornersStayInRange) {
+    for (const StickResponse& stick : STICK_CASES) {
+        const AnalogResponse response = AnalogResponse::Compile(MakeSettings(stick));
+        for (const auto& [x, y] : {std::pair{-32768, -32768}, {32767, 32767}, {-32768, 32767}, {32767, -32768}}) {
+            ControllerState state = MakeState(static_cast<int16_t>(x), static_cast<int16_t>(y));
+            response.Apply(&state);
+            EXPECT_GE(std::abs(state.LeftThumbstickX), 23000);
+            EXPECT_EQ(state.LeftThumbstickX < 0, x < 0);
+            EXPECT_EQ(state.LeftThumbstickY < 0, y < 0);
+        }
+    }
+}
+
+TEST(AnalogResponseTests, TriggersMatchTheFloatMath) {
+    const TriggerResponse cases[] = {
+        {.Deadzone = 30},
+        {.Deadzone = 10, .AntiDeadzone = 40, .Curve = 2.0f},
+        {.AntiDeadzone = 100, .Curve = 0.5f},
+        {.Deadzone = 255},
+        {.Curve = 3.0f},
+    };
+
+    for (const TriggerResponse& trigger : cases) {
+        const AnalogSettings settings = MakeSettings({}, trigger);
+        const AnalogResponse response = AnalogResponse::Compile(settings);
+        const FloatAnalogResponse reference(settings);
+
+        int last = 0;
+        for (int value = 0; value < 256; value++) {
+            ControllerState actual = MakeState(0, 0, static_cast<uint8_t>(value));
+            ControllerState expected = actual;
+            response.Apply(&actual);
+            reference.Apply(&expected);
+            ASSERT_NEAR(actual.LeftTrigger, expected.LeftTrigger, 1) << "value " << value;
+            ASSERT_GE(actual.LeftTrigger, last);
+            last = actual.LeftTrigger;
+        }
+        EXPECT_EQ(last, 255);  // Even a deadzone of 255 leaves full travel pressed
+    }
+}
\ No newline at end of file
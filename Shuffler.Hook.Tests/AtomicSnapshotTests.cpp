@@ -0,0 +1,134 @@
+#include "AtomicSnapshot.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace {
+std::atomic<int> LiveProfiles{0};
+
+// Every element holds the profile's generation, so a reader that sees a torn or freed profile notices
+struct Profile {
+    static constexpr uint32_t ALIVE = 0x5AFE5AFE;
+
+    uint32_t Alive = ALIVE;
+    uint64_t Generation = 0;
+    std::vector<uint64_t> Values = std::vector<uint64_t>(16, 0);
+
+    Profile() {
+        ++LiveProfiles;
+    }
+
+    Profile(const Profile& other) : Generation(other.Generation), Values(other.Values) {
+        ++LiveProfiles;
+    }
+
+    ~Profile() {
+        Alive = 0;
+        --LiveProfiles;
+    }
+
+    bool IsConsistent() const {
+        if (Alive != ALIVE)
+            return false;
+        for (const uint64_t value : Values) {
+            if (value != Generation)
+                return false;
+        }
+        return true;
+    }
+};
+
+Profile MakeProfile(const uint64_t generation) {
+    Profile profile;
+    profile.Generation = generation;
+    std::ranges::fill(profile.Values, generation);
+    return profile;
+}
+
+// Publishes the given number of generations while readerCount readers check every snapshot they get
+void RunStress(const int readerCount, const uint64_t generations) {
+    AtomicSnapshot<Profile> snapshot;
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+    std::atomic<int> wentBack{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < readerCount; i++) {
+        readers.emplace_back([&] {
+            uint64_t lastGeneration = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                const auto profile = snapshot.Read();
+                if (!profile->IsConsistent())
+                    ++inconsistent;
+                if (profile->Generation < lastGeneration)
+                    ++wentBack;
+                lastGeneration = profile->Generation;
+            }
+        });
+    }
+
+    for (uint64_t generation = 1; generation <= generations; generation++) {
+        if (generation % 2)
+            snapshot.Publish(MakeProfile(generation));
+        else
+            snapshot.Update([generation](Profile& profile) {
+                profile.Generation = generation;
+                std::ranges::fill(profile.Values, generation);
+            });
+    }
+
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(inconsistent.load(), 0);
+    EXPECT_EQ(wentBack.load(), 0);
+    EXPECT_EQ(snapshot.GetVersion(), generations);
+    EXPECT_EQ(snapshot.Read()->Generation, generations);
+}
+}
+
+TEST(AtomicSnapshotTests, PublishReplacesTheSnapshot) {
+    AtomicSnapshot<Profile> snapshot;
+    EXPECT_EQ(snapshot.GetVersion(), 0u);
+    EXPECT_EQ(snapshot.Read()->Generation, 0u);
+
+    snapshot.Publish(MakeProfile(7));
+    EXPECT_EQ(snapshot.GetVersion(), 1u);
+    EXPECT_EQ(snapshot.Read()->Generation, 7u);
+}
+
+TEST(AtomicSnapshotTests, ProtectedSnapshotOutlivesLaterPublishes) {
+    AtomicSnapshot<Profile> snapshot;
+    snapshot.Publish(MakeProfile(1));
+
+    const auto held = snapshot.Read();
+    for (uint64_t generation = 2; generation < 100; generation++)
+        snapshot.Publish(MakeProfile(generation));
+
+    EXPECT_TRUE(held->IsConsistent());
+    EXPECT_EQ(held->Generation, 1u);
+}
+
+TEST(AtomicSnapshotTests, FreesEverySnapshot) {
+    {
+        AtomicSnapshot<Profile> snapshot;
+        for (uint64_t generation = 1; generation <= 1000; generation++)
+            snapshot.Publish(MakeProfile(generation));
+
+        // Only the current snapshot is left once nobody is reading
+        EXPECT_EQ(LiveProfiles.load(), 1);
+    }
+    EXPECT_EQ(LiveProfiles.load(), 0);
+}
+
+TEST(AtomicSnapshotTests, ReadersSeeWholeSnapshotsUnderStress) {
+    RunStress(4, 20000);
+    EXPECT_EQ(LiveProfiles.load(), 0);
+}
+
+TEST(AtomicSnapshotTests, ReadersBeyondTheHazardSlotsStaySafe) {
+    // More readers than hazard slots, so some read without a slot and hold off reclamation instead
+    RunStress(80, 2000);
+    EXPECT_EQ(LiveProfiles.load(), 0);
+}
\ No newline at end of file
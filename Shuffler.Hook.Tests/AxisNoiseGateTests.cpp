@@ -0,0 +1,189 @@
+#include "AxisNoiseGate.h"
+#include "ControllerManager.h"
+#include "InputStream.h"
+#include "Fakes/FakeXInput.h"
+#include "Fakes/InputSession.h"
+
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+namespace {
+constexpr uint16_t STICK_GATE = 48;
+constexpr uint8_t TRIGGER_GATE = 4;
+
+AnalogSettings MakeSettings(const uint16_t stickGate, const uint8_t triggerGate) {
+    AnalogSettings settings;
+    settings.LeftStick.NoiseGate = settings.RightStick.NoiseGate = stickGate;
+    settings.LeftTrigger.NoiseGate = settings.RightTrigger.NoiseGate = triggerGate;
+    return settings;
+}
+
+int16_t Jitter(std::mt19937& random, const int16_t rest, const int amplitude) {
+    const int value = rest + static_cast<int>(random() % (2 * amplitude + 1)) - amplitude;
+    return static_cast<int16_t>(std::clamp(value, -32768, 32767));
+}
+
+// A pad left mostly at rest: its sticks jitter by up to 20 units and its triggers by 2 either side of where they were
+// let go, and every half second or so an axis is moved somewhere else. The gates above cover the jitter from peak to
+// peak, since a held value at one extreme has to keep the other extreme back too
+std::vector<InputStreamSample> MakeJitterySession(const uint32_t seed, const size_t count) {
+    std::mt19937 random(seed);
+    std::vector<InputStreamSample> samples(count);
+    int16_t rest[4] = {220, -180, -90, 60};
+    uint8_t triggerRest[2] = {6, 4};
+    int64_t timestamp = InputSession::START_TIMESTAMP;
+
+    for (size_t i = 0; i < count; i++) {
+        timestamp += 9'000 + random() % 2'000;
+        if (random() % 500 == 0) {
+            if (random() % 2)
+                rest[random() % 4] = static_cast<int16_t>(random());
+            else
+                triggerRest[random() % 2] = static_cast<uint8_t>(random() % 2 ? 200 + random() % 40 : 5);
+        }
+
+        ControllerState& state = samples[i].State;
+        state.LeftThumbstickX = Jitter(random, rest[0], 20);
+        state.LeftThumbstickY = Jitter(random, rest[1], 20);
+        state.RightThumbstickX = Jitter(random, rest[2], 20);
+        state.RightThumbstickY = Jitter(random, rest[3], 20);
+        state.LeftTrigger = static_cast<uint8_t>(Jitter(random, triggerRest[0], 2));
+        state.RightTrigger = static_cast<uint8_t>(Jitter(random, triggerRest[1], 2));
+        samples[i].Timestamp = timestamp;
+        samples[i].Connected = true;
+    }
+    return samples;
+}
+
+// Plays a session back the way replay reads a recording
+std::vector<ControllerState> Replay(const std::vector<uint8_t>& recording) {
+    InputStreamReader reader;
+    EXPECT_TRUE(reader.Open(recording));
+
+    std::vector<ControllerState> states;
+    InputStreamSample sample;
+    while (reader.Next(&sample))
+        states.push_back(sample.State);
+    return states;
+}
+
+size_t CountStateChanges(const std::vector<ControllerState>& states) {
+    size_t changes = 0;
+    for (size_t i = 1; i < states.size(); i++)
+        changes += memcmp(&states[i], &states[i - 1], sizeof(ControllerState)) != 0;
+    return changes;
+}
+
+std::vector<ControllerState> Gate(const std::vector<ControllerState>& states, const AnalogSettings& settings) {
+    AxisNoiseGate gate;
+    std::vector<ControllerState> gated = states;
+    for (auto& state : gated)
+        gate.Apply(settings, &state);
+    return gated;
+}
+}
+
+TEST(AxisNoiseGateTests, HoldsJitterBackOverARecordedSession) {
+    const std::vector<uint8_t> recording = InputSession::Encode(MakeJitterySession(22, 20'000), 256);
+    const std::vector<ControllerState> raw = Replay(recording);
+    ASSERT_EQ(raw.size(), 20'000u);
+
+    const size_t rawChanges = CountStateChanges(raw);
+    const size_t gatedChanges = CountStateChanges(Gate(raw, MakeSettings(STICK_GATE, TRIGGER_GATE)));
+    RecordProperty("RawStateChanges", std::to_string(rawChanges));
+    RecordProperty("GatedStateChanges", std::to_string(gatedChanges));
+
+    // Unfiltered, nearly every poll is a new state. Gated, only the deliberate moves are, a few polls each
+    EXPECT_GT(rawChanges, raw.size() * 99 / 100);
+    EXPECT_LT(gatedChanges, rawChanges / 50);
+}
+
+TEST(AxisNoiseGateTests, GatedAxesStayWithinTheGateOfTheRawValue) {
+    const std::vector<ControllerState> raw = Replay(InputSession::Encode(MakeJitterySession(23, 5'000), 256));
+    const std::vector<ControllerState> gated = Gate(raw, MakeSettings(STICK_GATE, TRIGGER_GATE));
+
+    for (size_t i = 0; i < raw.size(); i++) {
+        ASSERT_LE(std::abs(gated[i].LeftThumbstickX - raw[i].LeftThumbstickX), STICK_GATE) << i;
+        ASSERT_LE(std::abs(gated[i].LeftThumbstickY - raw[i].LeftThumbstickY), STICK_GATE) << i;
+        ASSERT_LE(std::abs(gated[i].RightThumbstickX - raw[i].RightThumbstickX), STICK_GATE) << i;
+        ASSERT_LE(std::abs(gated[i].RightThumbstickY - raw[i].RightThumbstickY), STICK_GATE) << i;
+        ASSERT_LE(std::abs(gated[i].LeftTrigger - raw[i].LeftTrigger), TRIGGER_GATE) << i;
+        ASSERT_LE(std::abs(gated[i].RightTrigger - raw[i].RightTrigger), TRIGGER_GATE) << i;
+    }
+}
+
+TEST(AxisNoiseGateTests, ZeroGateLetsEverythingThrough) {
+    const std::vector<ControllerState> raw = Replay(InputSession::Encode(MakeJitterySession(24, 1'000), 256));
+    const std::vector<ControllerState> gated = Gate(raw, MakeSettings(0, 0));
+    ASSERT_EQ(gated.size(), raw.size());
+    EXPECT_EQ(memcmp(gated.data(), raw.data(), raw.size() * sizeof(ControllerState)), 0);
+}
+
+TEST(AxisNoiseGateTests, CenterAndEndsAlwaysGetThrough) {
+    const AnalogSettings settings = MakeSettings(1000, 50);
+    AxisNoiseGate gate;
+
+    // Each step starts within the gate of where it ends, so only the exception for center and ends lets it through
+    const std::pair<int16_t, uint8_t> steps[][2] = {
+        {{32000, 230}, {INT16_MAX, 255}},
+        {{500, 30}, {0, 0}},
+        {{-32000, 230}, {INT16_MIN, 255}},
+    };
+
+    for (const auto& [start, end] : steps) {
+        ControllerState state = {};
+        state.LeftThumbstickX = start.first;
+        state.LeftTrigger = start.second;
+        gate.Apply(settings, &state);
+        ASSERT_EQ(state.LeftThumbstickX, start.first);
+
+        state.LeftThumbstickX = end.first;
+        state.LeftTrigger = end.second;
+        gate.Apply(settings, &state);
+        EXPECT_EQ(state.LeftThumbstickX, end.first);
+        EXPECT_EQ(state.LeftTrigger, end.second);
+    }
+
+    // Anywhere else the same step is held back
+    ControllerState state = {};
+    state.LeftThumbstickX = 10000;
+    gate.Apply(settings, &state);
+    state.LeftThumbstickX = 10900;
+    gate.Apply(settings, &state);
+    EXPECT_EQ(state.LeftThumbstickX, 10000);
+}
+
+TEST(AxisNoiseGateTests, ControllerManagerReportsFewerPacketsForJitteryInput) {
+    FakeXInput::Reset();
+    for (int slot = 1; slot < VirtualSlotTable::MAX_SLOTS; slot++)
+        ControllerManager::UnbindSlot(slot);
+    ControllerManager::BindSlot(0, 0, 0);
+    ControllerManager::SetStateFreshness(std::chrono::microseconds(0));
+
+    const std::vector<ControllerState> raw = Replay(InputSession::Encode(MakeJitterySession(25, 5'000), 256));
+    const auto countPackets = [&raw] {
+        uint32_t first = 0;
+        uint32_t last = 0;
+        for (size_t i = 0; i < raw.size(); i++) {
+            FakeXInput::SetState(0, raw[i]);
+            ControllerState state;
+            EXPECT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput, i == 0 ? &first : &last));
+        }
+        return last - first;
+    };
+
+    ControllerManager::SetAnalogSettings(0, MakeSettings(0, 0));
+    const uint32_t rawPackets = countPackets();
+    ControllerManager::SetAnalogSettings(0, MakeSettings(STICK_GATE, TRIGGER_GATE));
+    const uint32_t gatedPackets = countPackets();
+    RecordProperty("RawPackets", std::to_string(rawPackets));
+    RecordProperty("GatedPackets", std::to_string(gatedPackets));
+
+    EXPECT_GT(rawPackets, raw.size() * 99 / 100);
+    EXPECT_LT(gatedPackets, rawPackets / 50);
+
+    ControllerManager::SetAnalogSettings(0, AnalogSettings());
+    ControllerManager::SetStateFreshness(ControllerManager::DEFAULT_STATE_FRESHNESS);
+}
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "AxisRouter.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+constexpr int AXIS_COUNT = AxisRoutingSettings::AXIS_COUNT;
+
+AxisRoutingSettings MakeZeroMatrix() {
+    AxisRoutingSettings settings;
+    for (auto& row : settings.Matrix)
+        std::fill(std::begin(row), std::end(row), 0.0f);
+    return settings;
+}
+
+AxisRoutingSettings MakeRandomMatrix(std::mt19937& random, const float range) {
+    std::uniform_real_distribution<float> weight(-range, range);
+    AxisRoutingSettings settings = MakeZeroMatrix();
+    for (auto& row : settings.Matrix) {
+        for (float& value : row)
+            value = random() % 3 == 0 ? 0.0f : weight(random);
+    }
+    settings.DpadToStick = static_cast<StickSelection>(random() % 3);
+    settings.StickToDpad = static_cast<StickSelection>(random() % 3);
+    return settings;
+}
+
+// Matrices at the limits: every weight as large as allowed, rows the scaling brings to the limit and that rounding
+// then carries over it, and everything in between
+std::vector<AxisRoutingSettings> MakeMatrices() {
+    std::vector<AxisRoutingSettings> matrices;
+    matrices.emplace_back();
+
+    for (const float weight : {2.0f, -2.0f, 1.0f, 0.6667f, 0.66667f, 2.0f / 3, -2.0f / 3, 0.5f}) {
+        AxisRoutingSettings settings = MakeZeroMatrix();
+        for (auto& row : settings.Matrix)
+            std::fill(std::begin(row), std::end(row), weight);
+        matrices.push_back(settings);
+    }
+
+    AxisRoutingSettings alternating = MakeZeroMatrix();
+    for (int output = 0; output < AXIS_COUNT; output++) {
+        for (int input = 0; input < AXIS_COUNT; input++)
+            alternating.Matrix[output][input] = (output + input) % 2 ? 2.0f : -2.0f;
+    }
+    alternating.DpadToStick = StickSelection::Left;
+    matrices.push_back(alternating);
+
+    std::mt19937 random(15);
+    for (int i = 0; i < 12; i++)
+        matrices.push_back(MakeRandomMatrix(random, i % 2 ? 2.0f : 0.75f));
+    return matrices;
+}
+
+#ifdef SHUFFLER_AXIS_ROUTER_SSE2
+bool SameOnBothPaths(const AxisRouter& router, const int16_t* axes, const int16_t* dpadVector) {
+    alignas(16) int16_t scalar[8];
+    alignas(16) int16_t sse2[8];
+    std::copy(axes, axes + 8, scalar);
+    std::copy(axes, axes + 8, sse2);
+    router.ApplyScalar(scalar, dpadVector);
+    router.ApplySse2(sse2, dpadVector);
+    return memcmp(scalar, sse2, sizeof(scalar)) == 0;
+}
+#endif
+
+ControllerState MakeState(const int16_t lx, const int16_t ly, const int16_t rx, const int16_t ry, const uint8_t lt,
+                          const uint8_t rt, const uint16_t buttons = 0) {
+    ControllerState state = {};
+    state.ButtonStates = buttons;
+    state.LeftThumbstickX = lx;
+    state.LeftThumbstickY = ly;
+    state.RightThumbstickX = rx;
+    state.RightThumbstickY = ry;
+    state.LeftTrigger = lt;
+    state.RightTrigger = rt;
+    return state;
+}
+}
+
+TEST(AxisRouterTests, DefaultSettingsPassEverythingThrough) {
+    const AxisRouter router = AxisRouter::Compile(AxisRoutingSettings());
+    std::mt19937 random(1);
+    for (int i = 0; i < 10000; i++) {
+        const ControllerState source = MakeState(static_cast<int16_t>(random()), static_cast<int16_t>(random()),
+                                                 static_cast<int16_t>(random()), static_cast<int16_t>(random()),
+                                                 static_cast<uint8_t>(random()), static_cast<uint8_t>(random()),
+                                                 static_cast<uint16_t>(random()));
+        ControllerState state = source;
+        router.Apply(&state);
+        ASSERT_EQ(memcmp(&state, &source, sizeof(state)), 0);
+    }
+}
+
+TEST(AxisRouterTests, SwapsInvertsAndScalesAxes) {
+    AxisRoutingSettings settings = MakeZeroMatrix();
+    settings.Matrix[0][2] = 1;      // Left X from right X
+    settings.Matrix[1][3] = -1;     // Left Y from inverted right Y
+    settings.Matrix[2][0] = 0.5f;   // Right X from half of left X
+    settings.Matrix[3][1] = 1;
+    settings.Matrix[4][5] = 1;      // Triggers swapped
+    settings.Matrix[5][4] = 1;
+    const AxisRouter router = AxisRouter::Compile(settings);
+
+    ControllerState state = MakeState(-32768, 1000, 12345, -32768, 255, 7);
+    router.Apply(&state);
+    EXPECT_EQ(state.LeftThumbstickX, 12345);
+    EXPECT_EQ(state.LeftThumbstickY, 32767);  // -(-32768) saturates
+    EXPECT_EQ(state.RightThumbstickX, -16384);
+    EXPECT_EQ(state.RightThumbstickY, 1000);
+    EXPECT_EQ(state.LeftTrigger, 7);
+    EXPECT_EQ(state.RightTrigger, 255);
+
+    // Every trigger value survives the trip through a stick-sized lane
+    AxisRoutingSettings identityWithDpad;
+    identityWithDpad.StickToDpad = StickSelection::Left;
+    const AxisRouter identity = AxisRouter::Compile(identityWithDpad);
+    for (int value = 0; value < 256; value++) {
+        ControllerState trigger = MakeState(0, 0, 0, 0, static_cast<uint8_t>(value), static_cast<uint8_t>(255 - value));
+        identity.Apply(&trigger);
+        ASSERT_EQ(trigger.LeftTrigger, value);
+        ASSERT_EQ(trigger.RightTrigger, 255 - value);
+    }
+}
+
+TEST(AxisRouterTests, MatchesExactArithmeticWithinRounding) {
+    std::mt19937 random(2);
+    for (int matrix = 0; matrix < 200; matrix++) {
+        AxisRoutingSettings settings = MakeRandomMatrix(random, 0.66f);  // Small enough for no row to be scaled
+        settings.DpadToStick = settings.StickToDpad = StickSelection::None;
+        const AxisRouter router = AxisRouter::Compile(settings);
+
+        for (int i = 0; i < 200; i++) {
+            const int16_t sticks[4] = {static_cast<int16_t>(random()), static_cast<int16_t>(random()),
+                                       static_cast<int16_t>(random()), static_cast<int16_t>(random())};
+            ControllerState state = MakeState(sticks[0], sticks[1], sticks[2], sticks[3], 0, 0);
+            router.Apply(&state);
+            const int16_t routed[4] = {state.LeftThumbstickX, state.LeftThumbstickY, state.RightThumbstickX,
+                                       state.RightThumbstickY};
+
+            for (int output = 0; output < 4; output++) {
+                double expected = 0;
+                for (int input = 0; input < 4; input++)
+                    expected += static_cast<double>(settings.Matrix[output][input]) * sticks[input];
+                expected = std::clamp(expected, -32768.0, 32767.0);
+                // Each of the four weights is off by up to half a unit of 2^-14
+                ASSERT_NEAR(routed[output], expected, 4 * 0.5 * 32768 / (1 << 14) + 1);
+            }
+        }
+    }
+}
+
+TEST(AxisRouterTests, SaturatesRowsThatRoundingCarriesOverTheLimit) {
+    // Six weights of 2/3 scale down to exactly the limit of 65535 / 6 = 10922.5 each, which rounds up
+    for (const float weight : {2.0f / 3, 2.0f}) {
+        AxisRoutingSettings settings = MakeZeroMatrix();
+        for (int output = 0; output < 4; output++) {
+            for (int input = 0; input < AXIS_COUNT; input++)
+                settings.Matrix[output][input] = input < 4 ? weight : -weight;
+        }
+        const AxisRouter router = AxisRouter::Compile(settings);
+
+        ControllerState low = MakeState(-32768, -32768, -32768, -32768, 255, 255);
+        router.Apply(&low);
+        EXPECT_EQ(low.LeftThumbstickX, -32768) << weight;
+        EXPECT_EQ(low.RightThumbstickY, -32768) << weight;
+
+        ControllerState high = MakeState(32767, 32767, 32767, 32767, 0, 0);
+        router.Apply(&high);
+        EXPECT_EQ(high.LeftThumbstickX, 32767) << weight;
+    }
+}
+
+TEST(AxisRouterTests, MovesTheStickWithTheDpad) {
+    AxisRoutingSettings settings;
+    settings.DpadToStick = StickSelection::Right;
+    const AxisRouter router = AxisRouter::Compile(settings);
+
+    const uint16_t up = static_cast<uint16_t>(Button::DPadUp);
+    const uint16_t right = static_cast<uint16_t>(Button::DPadRight);
+    const uint16_t a = static_cast<uint16_t>(Button::A);
+
+    ControllerState state = MakeState(0, 0, 100, -100, 0, 0, up | right | a);
+    router.Apply(&state);
+    EXPECT_EQ(state.RightThumbstickX, 100 + 23170);
+    EXPECT_EQ(state.RightThumbstickY, -100 + 23170);
+    EXPECT_EQ(state.ButtonStates, a);  // The D-pad no longer presses buttons
+
+    state = MakeState(0, 0, 30000, 0, 0, 0, right);
+    router.Apply(&state);
+    EXPECT_EQ(state.RightThumbstickX, 32767);
+}
+
+TEST(AxisRouterTests, PressesTheDpadWithTheStick) {
+    AxisRoutingSettings settings;
+    settings.StickToDpad = StickSelection::Left;
+    settings.StickToDpadThreshold = 16000;
+    const AxisRouter router = AxisRouter::Compile(settings);
+
+    const auto buttons = [&](const int16_t x, const int16_t y, const uint16_t held = 0) {
+        ControllerState state = MakeState(x, y, 0, 0, 0, 0, held);
+        router.Apply(&state);
+        EXPECT_EQ(state.LeftThumbstickX, x);  // The stick itself keeps working
+        return state.ButtonStates;
+    };
+
+    EXPECT_EQ(buttons(0, 0), 0);
+    EXPECT_EQ(buttons(16000, -16000), 0);
+    EXPECT_EQ(buttons(16001, 0), static_cast<uint16_t>(Button::DPadRight));
+    EXPECT_EQ(buttons(-20000, 20000), static_cast<uint16_t>(Button::DPadLeft) | static_cast<uint16_t>(Button::DPadUp));
+    EXPECT_EQ(buttons(0, -32768), static_cast<uint16_t>(Button::DPadDown));
+    EXPECT_EQ(buttons(0, 0, static_cast<uint16_t>(Button::DPadUp)), static_cast<uint16_t>(Button::DPadUp));
+}
+
+// Every value of every input lane, against random values in the others, on matrices at and past the limits
+TEST(AxisRouterTests, Sse2MatchesScalarExhaustively) {
+#ifdef SHUFFLER_AXIS_ROUTER_SSE2
+    std::mt19937 random(3);
+    for (const AxisRoutingSettings& settings : MakeMatrices()) {
+        const AxisRouter router = AxisRouter::Compile(settings);
+        alignas(16) int16_t dpadVectors[16][8] = {};
+        for (uint16_t dpad = 0; dpad < 16; dpad++) {
+            ControllerState state = MakeState(0, 0, 0, 0, 0, 0, dpad);
+            router.Apply(&state);  // With no input, only the D-pad vector is left
+            dpadVectors[dpad][0] = state.LeftThumbstickX;
+            dpadVectors[dpad][1] = state.LeftThumbstickY;
+            dpadVectors[dpad][2] = state.RightThumbstickX;
+            dpadVectors[dpad][3] = state.RightThumbstickY;
+        }
+
+        for (int lane = 0; lane < AXIS_COUNT; lane++) {
+            for (int32_t value = -32768; value <= 32767; value++) {
+                alignas(16) int16_t scalar[8];
+                for (int input = 0; input < 8; input++)
+                    scalar[input] = input < AXIS_COUNT ? static_cast<int16_t>(random()) : 0;
+                scalar[lane] = static_cast<int16_t>(value);
+                ASSERT_TRUE(SameOnBothPaths(router, scalar, dpadVectors[value & 15])) << "lane " << lane << ", " << value;
+            }
+        }
+
+        // Every combination of the extremes and center, where the sums are largest
+        for (int combination = 0; combination < 729; combination++) {
+            alignas(16) int16_t scalar[8] = {};
+            for (int input = 0, digits = combination; input < AXIS_COUNT; input++, digits /= 3)
+                scalar[input] = static_cast<int16_t>(digits % 3 == 0 ? -32768 : digits % 3 == 1 ? 0 : 32767);
+            ASSERT_TRUE(SameOnBothPaths(router, scalar, dpadVectors[combination & 15])) << combination;
+        }
+    }
+#else
+    GTEST_SKIP() << "Built without SSE2";
+#endif
+}
\ No newline at end of file
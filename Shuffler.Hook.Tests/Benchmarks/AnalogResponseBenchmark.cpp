@@ -0,0 +1,65 @@
+#include "AnalogResponse.h"
+#include "Fakes/FloatAnalogResponse.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace {
+AnalogSettings MakeSettings() {
+    AnalogSettings settings;
+    settings.LeftStick = {.Deadzone = 4000, .AntiDeadzone = 2000, .OuterDeadzone = 31000, .Curve = 1.6f};
+    settings.RightStick = {.Deadzone = 2500, .Curve = 0.8f};
+    settings.LeftTrigger = {.Deadzone = 10, .Curve = 2.0f};
+    settings.RightTrigger = {.AntiDeadzone = 20};
+    return settings;
+}
+
+std::vector<ControllerState> MakeStates() {
+    std::mt19937 random(14);
+    std::vector<ControllerState> states(1024);
+    for (auto& state : states) {
+        state.LeftTrigger = static_cast<uint8_t>(random());
+        state.RightTrigger = static_cast<uint8_t>(random());
+        state.LeftThumbstickX = static_cast<int16_t>(random());
+        state.LeftThumbstickY = static_cast<int16_t>(random());
+        state.RightThumbstickX = static_cast<int16_t>(random());
+        state.RightThumbstickY = static_cast<int16_t>(random());
+    }
+    return states;
+}
+
+template <typename Response>
+void ApplyAll(benchmark::State& benchmarkState, const Response& response) {
+    const std::vector<ControllerState> states = MakeStates();
+    size_t index = 0;
+
+    for (auto _ : benchmarkState) {
+        ControllerState state = states[index++ % states.size()];
+        response.Apply(&state);
+        benchmark::DoNotOptimize(state);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+}
+}
+
+static void BM_AnalogResponseTables(benchmark::State& benchmarkState) {
+    const AnalogResponse response = AnalogResponse::Compile(MakeSettings());
+    ApplyAll(benchmarkState, response);
+}
+BENCHMARK(BM_AnalogResponseTables);
+
+// sqrt and pow per stick and pow per trigger on every poll, what the tables replace
+static void BM_AnalogResponseFloat(benchmark::State& benchmarkState) {
+    const FloatAnalogResponse response(MakeSettings());
+    ApplyAll(benchmarkState, response);
+}
+BENCHMARK(BM_AnalogResponseFloat);
+
+// Paid once per settings change, off the polling path
+static void BM_AnalogResponseCompile(benchmark::State& benchmarkState) {
+    const AnalogSettings settings = MakeSettings();
+    for (auto _ : benchmarkState)
+        benchmark::DoNotOptimize(AnalogResponse::Compile(settings));
+}
+BENCHMARK(BM_AnalogResponseCompile)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "AtomicSnapshot.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+struct Profile {
+    uint64_t Generation = 0;
+    uint64_t Values[16] = {};
+};
+
+AtomicSnapshot<Profile> Snapshot;
+std::atomic<bool> WriterRunning{false};
+std::thread Writer;
+}
+
+// Reads from 1 to 8 threads, with thread 0 also starting a writer that republishes the snapshot as fast as it can
+static void BM_AtomicSnapshotRead(benchmark::State& state) {
+    if (state.thread_index() == 0 && state.range(0)) {
+        WriterRunning = true;
+        Writer = std::thread([] {
+            uint64_t generation = 0;
+            while (WriterRunning.load(std::memory_order_relaxed))
+                Snapshot.Publish({++generation, {}});
+        });
+    }
+
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        const auto profile = Snapshot.Read();
+        sum += profile->Generation + profile->Values[15];
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0 && state.range(0)) {
+        WriterRunning = false;
+        Writer.join();
+    }
+}
+BENCHMARK(BM_AtomicSnapshotRead)->ArgName("writer")->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_AtomicSnapshotPublish(benchmark::State& state) {
+    AtomicSnapshot<Profile> snapshot;
+    uint64_t generation = 0;
+    for (auto _ : state)
+        snapshot.Publish({++generation, {}});
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AtomicSnapshotPublish);
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "AxisRouter.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace {
+AxisRoutingSettings MakeSettings() {
+    AxisRoutingSettings settings;
+    settings.Matrix[0][0] = 0.75f;
+    settings.Matrix[0][2] = 0.25f;
+    settings.Matrix[1][1] = -1;
+    settings.Matrix[2][3] = 1;
+    settings.Matrix[3][2] = 1;
+    settings.Matrix[4][5] = 0.5f;
+    settings.DpadToStick = StickSelection::Left;
+    settings.StickToDpad = StickSelection::Right;
+    return settings;
+}
+
+std::vector<ControllerState> MakeStates() {
+    std::mt19937 random(15);
+    std::vector<ControllerState> states(1024);
+    for (auto& state : states) {
+        state.ButtonStates = static_cast<uint16_t>(random() & 0xF3FF);
+        state.LeftTrigger = static_cast<uint8_t>(random());
+        state.RightTrigger = static_cast<uint8_t>(random());
+        state.LeftThumbstickX = static_cast<int16_t>(random());
+        state.LeftThumbstickY = static_cast<int16_t>(random());
+        state.RightThumbstickX = static_cast<int16_t>(random());
+        state.RightThumbstickY = static_cast<int16_t>(random());
+    }
+    return states;
+}
+}
+
+// The whole stage as ControllerManager runs it, with SSE2 where the build has it
+static void BM_AxisRouterApply(benchmark::State& benchmarkState) {
+    const AxisRouter router = AxisRouter::Compile(MakeSettings());
+    const std::vector<ControllerState> states = MakeStates();
+    size_t index = 0;
+
+    for (auto _ : benchmarkState) {
+        ControllerState state = states[index++ % states.size()];
+        router.Apply(&state);
+        benchmark::DoNotOptimize(state);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+}
+BENCHMARK(BM_AxisRouterApply);
+
+template <bool Sse2>
+static void BM_AxisRouterMatrix(benchmark::State& benchmarkState) {
+    const AxisRouter router = AxisRouter::Compile(MakeSettings());
+    const std::vector<ControllerState> states = MakeStates();
+    alignas(16) const int16_t dpadVector[8] = {};
+    size_t index = 0;
+
+    for (auto _ : benchmarkState) {
+        const ControllerState& state = states[index++ % states.size()];
+        alignas(16) int16_t axes[8] = {state.LeftThumbstickX, state.LeftThumbstickY, state.RightThumbstickX,
+                                       state.RightThumbstickY, state.LeftTrigger, state.RightTrigger};
+#ifdef SHUFFLER_AXIS_ROUTER_SSE2
+        if constexpr (Sse2)
+            router.ApplySse2(axes, dpadVector);
+        else
+#endif
+            router.ApplyScalar(axes, dpadVector);
+        benchmark::DoNotOptimize(axes);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+}
+BENCHMARK(BM_AxisRouterMatrix<false>)->Name("BM_AxisRouterMatrix/Scalar");
+#ifdef SHUFFLER_AXIS_ROUTER_SSE2
+BENCHMARK(BM_AxisRouterMatrix<true>)->Name("BM_AxisRouterMatrix/Sse2");
+#endif
+
+static void BM_AxisRouterCompile(benchmark::State& benchmarkState) {
+    const AxisRoutingSettings settings = MakeSettings();
+    for (auto _ : benchmarkState)
+        benchmark::DoNotOptimize(AxisRouter::Compile(settings));
+}
+BENCHMARK(BM_AxisRouterCompile);
\ No newline at end of file
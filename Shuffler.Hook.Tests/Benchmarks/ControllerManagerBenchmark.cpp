@@ -0,0 +1,74 @@
+#include "ControllerManager.h"
+#include "Fakes/FakeXInput.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+// About what XInputGetState costs on a wired pad
+constexpr std::chrono::nanoseconds XINPUT_READ_COST{2'000};
+
+constexpr InputApi APIS[] = {InputApi::XInput, InputApi::RawInput, InputApi::Hid};
+
+ControllerState MakeState(const int controllerIndex) {
+    ControllerState state = {};
+    state.LeftThumbstickX = static_cast<int16_t>(1000 * (controllerIndex + 1));
+    return state;
+}
+}
+
+// A game reading one pad through XInput, raw input and HID on a thread each, as engines that layer an input library
+// over their own polling do. range(0) is the state freshness in microseconds; reads/call is how many of the calls went
+// to the controller
+static void BM_ControllerManagerMixedApis(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        FakeXInput::Reset();
+        FakeXInput::SetReadCost(XINPUT_READ_COST);
+        FakeXInput::SetState(0, MakeState(0));
+        for (int slot = 1; slot < VirtualSlotTable::MAX_SLOTS; slot++)
+            ControllerManager::UnbindSlot(slot);
+        ControllerManager::BindSlot(0, 0, 0);
+        ControllerManager::SetStateFreshness(std::chrono::microseconds(state.range(0)));
+    }
+
+    const InputApi api = APIS[state.thread_index() % std::size(APIS)];
+    ControllerState controllerState;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ControllerManager::GetState(0, &controllerState, api));
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        state.counters["reads/call"] = benchmark::Counter(static_cast<double>(FakeXInput::GetReadCount(0)),
+                                                          benchmark::Counter::kAvgIterations);
+        ControllerManager::SetStateFreshness(ControllerManager::DEFAULT_STATE_FRESHNESS);
+    }
+}
+BENCHMARK(BM_ControllerManagerMixedApis)->ArgName("freshness_us")->Arg(0)->Arg(500)->ThreadRange(1, 4)->UseRealTime();
+
+// Each thread polling a pad of its own, which the memo of one slot cannot help with but must not slow down either
+static void BM_ControllerManagerSlotPerThread(benchmark::State& state) {
+    const int slot = state.thread_index() % FakeXInput::MAX_CONTROLLERS;
+    if (state.thread_index() == 0) {
+        FakeXInput::Reset();
+        FakeXInput::SetReadCost(XINPUT_READ_COST);
+        for (int i = 0; i < FakeXInput::MAX_CONTROLLERS; i++) {
+            FakeXInput::SetState(i, MakeState(i));
+            ControllerManager::BindSlot(i, 0, static_cast<uint8_t>(i));
+        }
+        ControllerManager::SetStateFreshness(std::chrono::microseconds(state.range(0)));
+    }
+
+    const InputApi api = APIS[state.thread_index() % std::size(APIS)];
+    ControllerState controllerState;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ControllerManager::GetState(slot, &controllerState, api));
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+        ControllerManager::SetStateFreshness(ControllerManager::DEFAULT_STATE_FRESHNESS);
+}
+BENCHMARK(BM_ControllerManagerSlotPerThread)
+    ->ArgName("freshness_us")
+    ->Arg(0)
+    ->Arg(500)
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
\ No newline at end of file
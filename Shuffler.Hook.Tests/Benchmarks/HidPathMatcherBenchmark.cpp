@@ -0,0 +1,91 @@
+#include "EmulatedDeviceDefinitions.h"
+
+#include <benchmark/benchmark.h>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+namespace {
+// What the file open hooks see from a game: mostly its own files, then the HID, USB and audio device paths that input
+// and audio libraries open while enumerating, and now and then one of the emulated controllers
+const wchar_t* const OTHER_PATHS[] = {
+    L"C:\\Program Files (x86)\\Steam\\steamapps\\common\\Game\\data\\textures_00.pak",
+    L"C:\\Program Files (x86)\\Steam\\steamapps\\common\\Game\\data\\audio_en.bank",
+    L"C:\\Users\\Player\\AppData\\Local\\Game\\Saved\\Config\\Input.ini",
+    L"C:\\Users\\Player\\Documents\\My Games\\Game\\save_01.sav",
+    L"C:\\Windows\\Fonts\\segoeui.ttf",
+    L"\\\\.\\pipe\\ShufflerHook",
+    L"CONOUT$",
+    L"\\\\?\\HID#VID_046D&PID_C52B&MI_00#8&1e34fb1&0&0000#{884b96c3-56ef-11d1-bc8c-00a0c91405dd}",
+    L"\\\\?\\HID#VID_046D&PID_C52B&MI_01&Col01#8&2a6b9f8&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+    L"\\\\?\\HID#VID_054C&PID_09CC&MI_03#7&2c3c4b5d&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+    L"\\\\?\\HID#VID_045E&PID_0B12&IG_00#a&36fff2e1&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+    L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e5&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+    L"\\\\?\\USB#VID_045E&PID_02FF#0000000000000001#{a5dcbf10-6530-11d2-901f-00c04fb951ed}",
+    L"\\\\?\\SWD#MMDEVAPI#{0.0.0.00000000}.{5f8c4a3e-2d7b-4b5a-9e0c-1a2b3c4d5e6f}"
+    L"#{e6327cad-dcec-4949-ae8a-991e976a79d2}",
+};
+
+std::vector<std::wstring> MakeCorpus() {
+    std::vector<std::wstring> corpus;
+    for (int round = 0; round < 4; round++) {
+        corpus.insert(corpus.end(), std::begin(OTHER_PATHS), std::end(OTHER_PATHS));
+        corpus.push_back(EmulatedDeviceDefinitions::GetDevicePath(round));
+    }
+    return corpus;
+}
+
+// Case-insensitive wcscmp against each controller's path in turn, what the matcher replaces
+int MatchByComparing(const wchar_t* path) {
+    for (int slot = 0; slot < EmulatedDeviceDefinitions::DEVICE_COUNT; slot++) {
+        const wchar_t* candidate = EmulatedDeviceDefinitions::GetDevicePath(slot);
+        size_t i = 0;
+        for (; candidate[i] && towlower(candidate[i]) == towlower(path[i]); i++) {}
+        if (!candidate[i] && !path[i])
+            return slot + 1;
+    }
+    return 0;
+}
+
+template <typename Match>
+void MatchCorpus(benchmark::State& state, Match match) {
+    const std::vector<std::wstring> corpus = MakeCorpus();
+    size_t index = 0;
+    int matches = 0;
+
+    for (auto _ : state) {
+        matches += match(corpus[index].c_str()) != 0;
+        index = index + 1 == corpus.size() ? 0 : index + 1;
+    }
+
+    benchmark::DoNotOptimize(matches);
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+static void BM_HidPathMatcherCorpus(benchmark::State& state) {
+    MatchCorpus(state, [](const wchar_t* path) { return EmulatedDeviceDefinitions::DEVICE_PATH_MATCHER.Match(path); });
+}
+BENCHMARK(BM_HidPathMatcherCorpus);
+
+static void BM_CompareEachPathCorpus(benchmark::State& state) {
+    MatchCorpus(state, MatchByComparing);
+}
+BENCHMARK(BM_CompareEachPathCorpus);
+
+// The worst case for the matcher, a path that only differs in its controller number
+static void BM_HidPathMatcherControllerPath(benchmark::State& state) {
+    const std::wstring path = EmulatedDeviceDefinitions::GetDevicePath(3);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(EmulatedDeviceDefinitions::DEVICE_PATH_MATCHER.Match(path.c_str()));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HidPathMatcherControllerPath);
+
+static void BM_CompareEachPathControllerPath(benchmark::State& state) {
+    const std::wstring path = EmulatedDeviceDefinitions::GetDevicePath(3);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(MatchByComparing(path.c_str()));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CompareEachPathControllerPath);
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "HidReportEncoder.h"
+#include "Data/XboxOnePreparsedData.h"
+#include "Fakes/PreparsedReportWriter.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<ControllerState> MakeStates() {
+    std::mt19937 random(4);
+    std::vector<ControllerState> states(1024);
+    for (auto& state : states) {
+        state.ButtonStates = static_cast<uint16_t>(random() & 0xF3FF);
+        state.LeftTrigger = static_cast<uint8_t>(random());
+        state.RightTrigger = static_cast<uint8_t>(random());
+        state.LeftThumbstickX = static_cast<int16_t>(random());
+        state.LeftThumbstickY = static_cast<int16_t>(random());
+        state.RightThumbstickX = static_cast<int16_t>(random());
+        state.RightThumbstickY = static_cast<int16_t>(random());
+    }
+    return states;
+}
+}
+
+static void BM_HidReportEncoder(benchmark::State& benchmarkState) {
+    const std::vector<ControllerState> states = MakeStates();
+    uint8_t report[HidReportEncoder::REPORT_LENGTH];
+    size_t index = 0;
+
+    for (auto _ : benchmarkState) {
+        HidReportEncoder::Encode(states[index++ % states.size()], report);
+        benchmark::DoNotOptimize(report);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+}
+BENCHMARK(BM_HidReportEncoder);
+
+// Seven lookups of the preparsed data per report, the way the HidP_* calls the encoder replaced found their fields
+static void BM_PreparsedDataLookups(benchmark::State& benchmarkState) {
+    const std::vector<ControllerState> states = MakeStates();
+    const PreparsedReportWriter writer(XBOX_ONE_PREPARSED_DATA);
+    uint8_t report[HidReportEncoder::REPORT_LENGTH];
+    size_t index = 0;
+
+    for (auto _ : benchmarkState) {
+        const ControllerState& state = states[index++ % states.size()];
+        memset(report, 0, sizeof(report));
+        for (uint16_t usage = 1; usage <= 10; usage++) {
+            if (state.ButtonStates & (1u << (usage + 5)))
+                writer.SetUsage(0x09, usage, report);
+        }
+        writer.SetUsageValue(0x01, HidDeviceGenerator::USAGE_HAT, state.ButtonStates & 0x7, report);
+        writer.SetUsageValue(0x01, HidDeviceGenerator::USAGE_X, static_cast<uint16_t>(state.LeftThumbstickX), report);
+        writer.SetUsageValue(0x01, HidDeviceGenerator::USAGE_Y, static_cast<uint16_t>(state.LeftThumbstickY), report);
+        writer.SetUsageValue(0x01, HidDeviceGenerator::USAGE_RX, static_cast<uint16_t>(state.RightThumbstickX), report);
+        writer.SetUsageValue(0x01, HidDeviceGenerator::USAGE_RY, static_cast<uint16_t>(state.RightThumbstickY), report);
+        writer.SetUsageValue(0x01, HidDeviceGenerator::USAGE_Z, state.LeftTrigger * 128u, report);
+        benchmark::DoNotOptimize(report);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+}
+BENCHMARK(BM_PreparsedDataLookups);
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "InputStream.h"
+#include "Fakes/InputSession.h"
+
+#include <benchmark/benchmark.h>
+
+// Encoding happens on the game's input thread while recording, so its per-state cost is what a recording adds
+static void BM_InputStreamEncode(benchmark::State& benchmarkState) {
+    const auto samples = InputSession::Make(1, 1 << 16);
+    const auto keyframeInterval = static_cast<uint16_t>(benchmarkState.range(0));
+    InputStreamEncoder encoder(keyframeInterval);
+    size_t bytes = 0;
+    size_t index = 0;
+
+    for (auto _ : benchmarkState) {
+        const InputStreamSample& sample = samples[index++ % samples.size()];
+        if (encoder.Add(sample.Timestamp, sample.State, sample.Connected) && encoder.IsBlockFull())
+            bytes += encoder.FinishBlock().size();
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+    benchmarkState.counters["BytesPerState"] =
+        benchmark::Counter(static_cast<double>(bytes) / static_cast<double>(benchmarkState.iterations()));
+}
+BENCHMARK(BM_InputStreamEncode)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_InputStreamDecode(benchmark::State& benchmarkState) {
+    const auto keyframeInterval = static_cast<uint16_t>(benchmarkState.range(0));
+    const auto data = InputSession::Encode(InputSession::Make(2, 1 << 16), keyframeInterval);
+    InputStreamReader reader;
+    reader.Open(data);
+    InputStreamSample sample;
+
+    for (auto _ : benchmarkState) {
+        if (!reader.Next(&sample)) {
+            reader.Seek(INT64_MIN);
+            reader.Next(&sample);
+        }
+        benchmark::DoNotOptimize(sample);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+    benchmarkState.SetBytesProcessed(static_cast<int64_t>(
+        static_cast<double>(benchmarkState.iterations()) * static_cast<double>(data.size()) / (1 << 16)));
+}
+BENCHMARK(BM_InputStreamDecode)->Arg(16)->Arg(256)->Arg(4096);
+
+// Seeking to a random point and decoding up to it, the way a replay tool scrubs through a session
+static void BM_InputStreamSeek(benchmark::State& benchmarkState) {
+    const auto samples = InputSession::Make(3, 1 << 16);
+    const auto data = InputSession::Encode(samples, static_cast<uint16_t>(benchmarkState.range(0)));
+    InputStreamReader reader;
+    reader.Open(data);
+    std::mt19937 random(3);
+    InputStreamSample sample;
+
+    for (auto _ : benchmarkState) {
+        const int64_t target = samples[random() % samples.size()].Timestamp;
+        reader.Seek(target);
+        while (reader.Next(&sample) && sample.Timestamp < target) {
+        }
+        benchmark::DoNotOptimize(sample);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+}
+BENCHMARK(BM_InputStreamSeek)->Arg(16)->Arg(256)->Arg(4096);
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "IpcProtocol.h"
+
+#include "Fakes/IpcFrames.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+std::vector<uint8_t> MakeMappingSet(const int players, const int mappingsPerPlayer) {
+    std::vector<PlayerMappings> set;
+    for (int player = 0; player < players; player++) {
+        PlayerMappings mappings = {static_cast<uint8_t>(player), {}};
+        for (int i = 0; i < mappingsPerPlayer; i++) {
+            const int bit = i % 14;
+            mappings.Entries.push_back(
+                ButtonToButton(static_cast<Button>(1 << (bit < 10 ? bit : bit + 2)), Button::A));
+        }
+        set.push_back(std::move(mappings));
+    }
+    return MakeMappingsFrame(set);
+}
+}
+
+// Parsing and walking a whole SetMappings message, as the IPC handler does before publishing a remap table
+static void BM_DecodeMappingSet(benchmark::State& state) {
+    const auto frame = MakeMappingSet(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    int64_t mappings = 0;
+
+    for (auto _ : state) {
+        IpcMessage message;
+        if (!IpcMessage::TryParse(frame, &message))
+            state.SkipWithError("Frame did not parse");
+
+        message.GetMappingSet().ForEachPlayer([&](uint8_t, const IpcPlayerMappings& playerMappings) {
+            for (size_t i = 0; i < playerMappings.GetCount(); i++) {
+                ActionMapping mapping = playerMappings[i];
+                benchmark::DoNotOptimize(mapping);
+            }
+            mappings += static_cast<int64_t>(playerMappings.GetCount());
+        });
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["mappings_per_second"] = benchmark::Counter(static_cast<double>(mappings), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+BENCHMARK(BM_DecodeMappingSet)->Args({1, 1})->Args({4, 16})->Args({4, 64})->Args({8, 200});  // Close to MAX_FRAME_SIZE
+
+static void BM_DecodeSmallMessages(benchmark::State& state) {
+    const std::vector<std::vector<uint8_t>> frames = {
+        MakeFrame(IpcMessageType::Enable, nullptr, 0),
+        MakeFrame(IpcMessageType::SetActiveController, int32_t{1}),
+        MakeFrame(IpcMessageType::SetInputSource, IpcSetInputSource{IpcInputSource::Polled, 0, 1000}),
+        MakeFrame(IpcMessageType::SetVirtualSlot, IpcSetVirtualSlot{1, 1, 0, 2}),
+    };
+    size_t index = 0;
+
+    for (auto _ : state) {
+        IpcMessage message;
+        benchmark::DoNotOptimize(IpcMessage::TryParse(frames[index++ % frames.size()], &message));
+        benchmark::DoNotOptimize(message);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DecodeSmallMessages);
+
+static void BM_DecodeAnalogSettings(benchmark::State& state) {
+    IpcSetAnalogSettings payload = {};
+    payload.LeftStick.Curve = payload.RightStick.Curve = payload.LeftTrigger.Curve = payload.RightTrigger.Curve = 1.5f;
+    const auto frame = MakeFrame(IpcMessageType::SetAnalogSettings, payload);
+
+    for (auto _ : state) {
+        IpcMessage message;
+        IpcMessage::TryParse(frame, &message);
+        uint8_t player;
+        AnalogSettings settings = message.GetAnalogSettings(&player);
+        benchmark::DoNotOptimize(settings);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DecodeAnalogSettings);
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "IpcRing.h"
+
+#include "Fakes/EventFdSignal.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr uint32_t CAPACITY = 64 * 1024;
+
+// The hook's read thread, woken by the producer's event, acknowledging every batch on a second one
+class Consumer {
+    IpcRing& _ring;
+    EventFdSignal& _dataEvent;
+    EventFdSignal& _doneEvent;
+    std::atomic<bool> _stop = false;
+    std::thread _thread;
+
+  public:
+    std::atomic<uint64_t> Records = 0;
+
+    Consumer(IpcRing& ring, EventFdSignal& dataEvent, EventFdSignal& doneEvent)
+        : _ring(ring), _dataEvent(dataEvent), _doneEvent(doneEvent), _thread([this] { Run(); }) {}
+
+    ~Consumer() {
+        _stop = true;
+        _dataEvent.Notify();
+        _thread.join();
+    }
+
+  private:
+    void Run() {
+        while (true) {
+            _dataEvent.Wait();
+            if (_stop)
+                return;
+
+            uint64_t records = 0;
+            _ring.Release(_ring.Peek([&](const std::span<const uint8_t> record) {
+                benchmark::DoNotOptimize(record.data());
+                records++;
+            }));
+            Records.fetch_add(records, std::memory_order_release);
+            _doneEvent.Notify();
+        }
+    }
+};
+}
+
+// One command written, signalled, read and acknowledged, the latency a single SetMapping pays end to end
+static void BM_IpcRingRoundTrip(benchmark::State& state) {
+    const auto memory = std::make_unique<uint8_t[]>(IpcRing::GetMappingSize(CAPACITY));
+    IpcRing ring = IpcRing::Create(memory.get(), CAPACITY);
+    EventFdSignal dataEvent;
+    EventFdSignal doneEvent;
+    Consumer consumer(ring, dataEvent, doneEvent);
+    const std::vector<uint8_t> payload(state.range(0));
+
+    for (auto _ : state) {
+        ring.TryWrite(payload);
+        dataEvent.Notify();
+        doneEvent.Wait();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IpcRingRoundTrip)->Arg(16)->Arg(256)->Arg(4096)->UseRealTime();
+
+// Bursts of commands sent back to back, as when a profile with many mappings is applied, signalled once each
+static void BM_IpcRingBurst(benchmark::State& state) {
+    const auto memory = std::make_unique<uint8_t[]>(IpcRing::GetMappingSize(CAPACITY));
+    IpcRing ring = IpcRing::Create(memory.get(), CAPACITY);
+    EventFdSignal dataEvent;
+    EventFdSignal doneEvent;
+    Consumer consumer(ring, dataEvent, doneEvent);
+    const std::vector<uint8_t> payload(16);
+    const auto burst = static_cast<uint64_t>(state.range(0));
+    uint64_t sent = 0;
+
+    for (auto _ : state) {
+        for (uint64_t i = 0; i < burst; i++) {
+            while (!ring.TryWrite(payload))
+                std::this_thread::yield();
+            dataEvent.Notify();
+        }
+        sent += burst;
+        while (consumer.Records.load(std::memory_order_acquire) < sent)
+            doneEvent.Wait();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(sent));
+}
+BENCHMARK(BM_IpcRingBurst)->Arg(16)->Arg(256)->UseRealTime();
+
+// The ring alone, without waking another thread
+static void BM_IpcRingWriteRead(benchmark::State& state) {
+    const auto memory = std::make_unique<uint8_t[]>(IpcRing::GetMappingSize(CAPACITY));
+    IpcRing ring = IpcRing::Create(memory.get(), CAPACITY);
+    const std::vector<uint8_t> payload(state.range(0));
+
+    for (auto _ : state) {
+        ring.TryWrite(payload);
+        ring.ReadAll([](const std::span<const uint8_t> record) { benchmark::DoNotOptimize(record.data()); });
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IpcRingWriteRead)->Arg(16)->Arg(256)->Arg(4096);
\ No newline at end of file
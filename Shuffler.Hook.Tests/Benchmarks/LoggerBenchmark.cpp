@@ -0,0 +1,79 @@
+#include "Logger.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int CALLS_PER_THREAD = 20000;
+
+// Times every call individually, so the percentiles show what a single game thread waits for a log line
+void RunProducers(benchmark::State& state, void (*log)(Logger&, int)) {
+    const int threadCount = static_cast<int>(state.range(0));
+    const auto path = std::filesystem::temp_directory_path() / "shuffler_logger_benchmark.log";
+    std::vector<int64_t> latencies;
+    uint64_t dropped = 0;
+
+    for (auto _ : state) {
+        std::filesystem::remove(path);
+        Logger::Init(path.string());
+        const uint64_t droppedBefore = Logger::GetDroppedCount();
+
+        std::vector<std::vector<int64_t>> perThread(threadCount, std::vector<int64_t>(CALLS_PER_THREAD));
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < threadCount; thread++) {
+            threads.emplace_back([&, thread] {
+                Logger logger("Benchmark");
+                for (int i = 0; i < CALLS_PER_THREAD; i++) {
+                    const auto before = std::chrono::steady_clock::now();
+                    log(logger, i);
+                    perThread[thread][i] = (std::chrono::steady_clock::now() - before).count();
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        dropped += Logger::GetDroppedCount() - droppedBefore;
+        Logger::Shutdown();
+        for (const auto& thread : perThread)
+            latencies.insert(latencies.end(), thread.begin(), thread.end());
+    }
+    std::filesystem::remove(path);
+
+    std::ranges::sort(latencies);
+    const auto percentile = [&](const double fraction) {
+        return static_cast<double>(latencies[static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1))]);
+    };
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p99.9_ns"] = percentile(0.999);
+    state.counters["max_ns"] = static_cast<double>(latencies.back());
+    state.counters["dropped"] = static_cast<double>(dropped);
+    state.SetItemsProcessed(static_cast<int64_t>(latencies.size()));
+}
+}
+
+static void BM_LoggerProducerMessage(benchmark::State& state) {
+    RunProducers(state, [](Logger& logger, int) { logger.Info("HookedGetProcAddress called"); });
+}
+BENCHMARK(BM_LoggerProducerMessage)->RangeMultiplier(2)->Range(1, 16)->UseManualTime()->Iterations(5);
+
+static void BM_LoggerProducerFormat(benchmark::State& state) {
+    RunProducers(state, [](Logger& logger, int i) { logger.InfoFormat("Handle {} closed after {} reads", i, 3.5); });
+}
+BENCHMARK(BM_LoggerProducerFormat)->RangeMultiplier(2)->Range(1, 16)->UseManualTime()->Iterations(5);
+
+// A call below the runtime level, which hot hook paths pay when their logger is turned down
+static void BM_LoggerFilteredFormat(benchmark::State& state) {
+    Logger logger("Filtered");
+    Logger::SetLevel("Filtered", LogLevel::Error);
+    int i = 0;
+    for (auto _ : state)
+        logger.InfoFormat("Handle {} closed", i++);
+}
+BENCHMARK(BM_LoggerFilteredFormat);
\ No newline at end of file
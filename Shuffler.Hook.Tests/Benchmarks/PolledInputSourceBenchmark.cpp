@@ -0,0 +1,53 @@
+#include "InputSource.h"
+#include "Fakes/SyntheticInputSource.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+// Roughly what XInputGetState costs for a connected pad and for an empty slot
+constexpr std::chrono::nanoseconds CONNECTED_READ_COST = 2us;
+constexpr std::chrono::nanoseconds DISCONNECTED_READ_COST = 50us;
+
+std::chrono::nanoseconds GetReadCost(const benchmark::State& state) {
+    return state.range(0) ? DISCONNECTED_READ_COST : CONNECTED_READ_COST;
+}
+}
+
+// What every hooked call paid before: a synchronous read of the physical controller
+static void BM_DirectRead(benchmark::State& state) {
+    SyntheticInputSource source(GetReadCost(state), 0b01);
+    const int controller = static_cast<int>(state.range(0));
+
+    for (auto _ : state) {
+        ControllerState controllerState;
+        benchmark::DoNotOptimize(source.GetState(controller, &controllerState));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DirectRead)->ArgName("disconnected")->Arg(0)->Arg(1);
+
+// The same reads from game threads once a poll thread reads the controller every millisecond
+static void BM_PolledRead(benchmark::State& state) {
+    static SyntheticInputSource* source;
+    static PolledInputSource* polled;
+    if (state.thread_index() == 0) {
+        source = new SyntheticInputSource(GetReadCost(state), 0b01);
+        polled = new PolledInputSource(source, 1ms);
+        polled->Start();
+    }
+
+    const int controller = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        ControllerState controllerState;
+        benchmark::DoNotOptimize(polled->GetState(controller, &controllerState));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        delete polled;
+        delete source;
+    }
+}
+BENCHMARK(BM_PolledRead)->ArgName("disconnected")->Arg(0)->Arg(1)->ThreadRange(1, 4)->UseRealTime();
\ No newline at end of file
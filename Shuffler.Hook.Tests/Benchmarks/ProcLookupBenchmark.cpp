@@ -0,0 +1,111 @@
+#include "ModuleCache.h"
+#include "ProcNameTable.h"
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+namespace {
+constexpr const char* EXPORT_NAMES[] = {"XInputGetState", "XInputGetCapabilities"};
+constexpr ProcNameTable<std::size(EXPORT_NAMES)> EXPORT_NAME_TABLE(EXPORT_NAMES);
+
+// What a game resolves through GetProcAddress at startup; only the first two are hooked
+constexpr const char* LOOKED_UP_NAMES[] = {
+    "XInputGetState",     "XInputGetCapabilities", "XInputSetState",          "XInputEnable",
+    "XInputGetKeystroke", "D3D11CreateDevice",     "CreateDXGIFactory1",      "GetProcAddress",
+    "LoadLibraryExW",     "QueryPerformanceCounter", "RtlCaptureStackBackTrace", "DirectInput8Create",
+};
+
+// Every named XInput export, for how both lookups scale past the two names hooked today
+constexpr const char* XINPUT_NAMES[] = {
+    "XInputEnable",          "XInputGetAudioDeviceIds",         "XInputGetBatteryInformation",
+    "XInputGetCapabilities", "XInputGetCapabilitiesEx",         "XInputGetKeystroke",
+    "XInputGetState",        "XInputGetStateEx",                "XInputSetState",
+    "XInputGetDSoundAudioDeviceGuids", "XInputPowerOffController", "XInputWaitForGuideButton",
+    "XInputCancelGuideButtonWait",
+};
+constexpr ProcNameTable<std::size(XINPUT_NAMES)> XINPUT_NAME_TABLE(XINPUT_NAMES);
+
+// The chain of strcmp calls the table replaces
+template <size_t N>
+int FindByStrcmp(const char* const (&names)[N], const char* name) {
+    for (size_t i = 0; i < N; i++) {
+        if (strcmp(names[i], name) == 0)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+template <typename Find>
+void FindNames(benchmark::State& state, const size_t first, const size_t count, Find find) {
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(find(LOOKED_UP_NAMES[first + index]));
+        index = index + 1 == count ? 0 : index + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+const void* Module(const uintptr_t index) {
+    return reinterpret_cast<const void*>(0x7FF800000000ull + (index << 16));
+}
+}
+
+static void BM_ProcNameTableHit(benchmark::State& state) {
+    FindNames(state, 0, 2, [](const char* name) { return EXPORT_NAME_TABLE.Find(name); });
+}
+BENCHMARK(BM_ProcNameTableHit);
+
+static void BM_ProcNameTableMiss(benchmark::State& state) {
+    FindNames(state, 2, std::size(LOOKED_UP_NAMES) - 2, [](const char* name) { return EXPORT_NAME_TABLE.Find(name); });
+}
+BENCHMARK(BM_ProcNameTableMiss);
+
+static void BM_StrcmpChainHit(benchmark::State& state) {
+    FindNames(state, 0, 2, [](const char* name) { return FindByStrcmp(EXPORT_NAMES, name); });
+}
+BENCHMARK(BM_StrcmpChainHit);
+
+static void BM_StrcmpChainMiss(benchmark::State& state) {
+    FindNames(state, 2, std::size(LOOKED_UP_NAMES) - 2,
+              [](const char* name) { return FindByStrcmp(EXPORT_NAMES, name); });
+}
+BENCHMARK(BM_StrcmpChainMiss);
+
+static void BM_ProcNameTableXInputSet(benchmark::State& state) {
+    FindNames(state, 0, std::size(LOOKED_UP_NAMES), [](const char* name) { return XINPUT_NAME_TABLE.Find(name); });
+}
+BENCHMARK(BM_ProcNameTableXInputSet);
+
+static void BM_StrcmpChainXInputSet(benchmark::State& state) {
+    FindNames(state, 0, std::size(LOOKED_UP_NAMES), [](const char* name) { return FindByStrcmp(XINPUT_NAMES, name); });
+}
+BENCHMARK(BM_StrcmpChainXInputSet);
+
+// A process with the usual handful of XInput versions loaded, looked up from the hooked exports
+static void BM_ModuleCacheHit(benchmark::State& state) {
+    ModuleCache<int> cache;
+    for (uintptr_t i = 0; i < 5; i++)
+        cache.Add(Module(i * 37), static_cast<int>(i));
+
+    uintptr_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.Find(Module(index * 37), -1));
+        index = index == 4 ? 0 : index + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ModuleCacheHit);
+
+static void BM_ModuleCacheMiss(benchmark::State& state) {
+    ModuleCache<int> cache;
+    for (uintptr_t i = 0; i < 5; i++)
+        cache.Add(Module(i * 37), static_cast<int>(i));
+
+    uintptr_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.Find(Module(index * 37 + 1), -1));
+        index = index == 4 ? 0 : index + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ModuleCacheMiss);
\ No newline at end of file
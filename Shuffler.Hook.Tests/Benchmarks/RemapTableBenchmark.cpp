@@ -0,0 +1,63 @@
+#include "RemapTable.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+constexpr Button MAPPED_BUTTONS[] = {
+    Button::A,        Button::B,         Button::X,              Button::Y,
+    Button::Start,    Button::Back,      Button::DPadUp,         Button::DPadDown,
+    Button::DPadLeft, Button::DPadRight, Button::LeftShoulder,   Button::RightShoulder,
+    Button::LeftThumbstick, Button::RightThumbstick,
+};
+
+std::vector<ActionMapping> MakeMappings(const size_t count) {
+    std::vector<ActionMapping> mappings(count);
+    for (size_t i = 0; i < count; i++) {
+        auto& [From, To] = mappings[i];
+        if (i < std::size(MAPPED_BUTTONS)) {
+            From.Type = InputType::Button;
+            From.Button = MAPPED_BUTTONS[i];
+        } else {
+            From.Type = InputType::Trigger;
+            From.Trigger = i % 2 ? TriggerInput::RightTrigger : TriggerInput::LeftTrigger;
+        }
+        To.Type = InputType::Button;
+        To.Button = MAPPED_BUTTONS[(i + 1) % std::size(MAPPED_BUTTONS)];
+    }
+    return mappings;
+}
+
+std::vector<ControllerState> MakeStates() {
+    std::mt19937 random(3);
+    std::vector<ControllerState> states(1024);
+    for (auto& state : states) {
+        state.ButtonStates = static_cast<uint16_t>(random() & 0xF3FF);
+        state.LeftTrigger = static_cast<uint8_t>(random());
+        state.RightTrigger = static_cast<uint8_t>(random());
+    }
+    return states;
+}
+}
+
+// Mapping counts a player is likely to have: none, a few swaps, and every button plus both triggers
+static void BM_RemapTableApply(benchmark::State& benchmarkState) {
+    const RemapTable table = RemapTable::Compile(MakeMappings(static_cast<size_t>(benchmarkState.range(0))));
+    const std::vector<ControllerState> states = MakeStates();
+    size_t index = 0;
+
+    for (auto _ : benchmarkState) {
+        ControllerState state;
+        table.Apply(states[index++ % states.size()], &state);
+        benchmark::DoNotOptimize(state);
+    }
+    benchmarkState.SetItemsProcessed(benchmarkState.iterations());
+}
+BENCHMARK(BM_RemapTableApply)->Arg(0)->Arg(3)->Arg(16);
+
+static void BM_RemapTableCompile(benchmark::State& benchmarkState) {
+    const std::vector<ActionMapping> mappings = MakeMappings(static_cast<size_t>(benchmarkState.range(0)));
+    for (auto _ : benchmarkState)
+        benchmark::DoNotOptimize(RemapTable::Compile(mappings));
+}
+BENCHMARK(BM_RemapTableCompile)->Arg(0)->Arg(3)->Arg(16);
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "HidReportEncoder.h"
+#include "ReportBatch.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+// RAWINPUTHEADER on 64-bit followed by RAWHID's two counts and the report
+constexpr size_t HID_RECORD_SIZE = 24 + 8 + HidReportEncoder::REPORT_LENGTH;
+constexpr size_t RAW_INPUT_ALIGNMENT = 8;
+
+ControllerState MakeState(const int slot) {
+    ControllerState state = {};
+    state.LeftThumbstickX = static_cast<int16_t>(1000 * (slot + 1));
+    state.LeftTrigger = static_cast<uint8_t>(40 * slot);
+    return state;
+}
+}
+
+// One GetRawInputBuffer answer: a HID record for each of range(0) slots whose state changed, encoded in place
+static void BM_RecordBatchHidRecords(benchmark::State& state) {
+    alignas(16) uint8_t buffer[4096];
+    const int slots = static_cast<int>(state.range(0));
+    ControllerState states[4];
+    for (int slot = 0; slot < 4; slot++)
+        states[slot] = MakeState(slot);
+
+    for (auto _ : state) {
+        RecordBatchWriter batch(buffer, sizeof(buffer), RAW_INPUT_ALIGNMENT);
+        for (int slot = 0; slot < slots && batch.CanFit(HID_RECORD_SIZE); slot++) {
+            auto* record = static_cast<uint8_t*>(batch.Append(HID_RECORD_SIZE));
+            HidReportEncoder::Encode(states[slot], record + 32);
+        }
+        benchmark::DoNotOptimize(batch.GetNextOffset());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * slots);
+}
+BENCHMARK(BM_RecordBatchHidRecords)->Arg(1)->Arg(4);
+
+// Laying out records alone, as many as fit in a typical 4 KB buffer
+static void BM_RecordBatchAppend(benchmark::State& state) {
+    alignas(16) uint8_t buffer[4096];
+    int64_t records = 0;
+    for (auto _ : state) {
+        RecordBatchWriter batch(buffer, sizeof(buffer), RAW_INPUT_ALIGNMENT);
+        while (void* record = batch.Append(HID_RECORD_SIZE))
+            benchmark::DoNotOptimize(record);
+        records += batch.GetCount();
+    }
+    state.SetItemsProcessed(records);
+}
+BENCHMARK(BM_RecordBatchAppend);
+
+// Polls that find the state unchanged, the common case when a game polls faster than the pad changes
+static void BM_ReportChangeFilterUnchanged(benchmark::State& state) {
+    static ReportChangeFilter<4> filter;
+    filter.Claim(0, 1);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(filter.Claim(0, 1));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReportChangeFilterUnchanged)->ThreadRange(1, 4)->UseRealTime();
+
+static void BM_ReportChangeFilterChanged(benchmark::State& state) {
+    ReportChangeFilter<4> filter;
+    uint32_t packet = 0;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(filter.Claim(0, ++packet));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReportChangeFilterChanged);
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "InputSource.h"
+#include "Fakes/PadFeedPublisher.h"
+
+#include <benchmark/benchmark.h>
+#include <thread>
+
+namespace {
+PadFeedPublisher& GetPublisher() {
+    static PadFeedPublisher publisher;
+    return publisher;
+}
+
+std::atomic<bool> StopWriter;
+std::thread Writer;
+}
+
+// Every hooked game reading its player's slot, with the controlling process publishing every state at 8 kHz or, at
+// range 0 of 0, not at all
+static void BM_SharedPadRead(benchmark::State& state) {
+    PadFeedPublisher& publisher = GetPublisher();
+    if (state.thread_index() == 0) {
+        for (int player = 0; player < static_cast<int>(SharedPadTable::MAX_PLAYERS); player++)
+            publisher.Publish(player, MakeCheckedState(player), true);
+
+        if (state.range(0)) {
+            StopWriter = false;
+            Writer = std::thread([&publisher] {
+                for (uint32_t value = 0; !StopWriter.load(std::memory_order_relaxed); value++) {
+                    for (int player = 0; player < static_cast<int>(SharedPadTable::MAX_PLAYERS); player++)
+                        publisher.Publish(player, MakeCheckedState(value), true);
+                    std::this_thread::sleep_for(std::chrono::microseconds(125));
+                }
+            });
+        }
+    }
+
+    SharedPadInputSource source;
+    if (!source.Open())
+        state.SkipWithError("Pad feed did not open");
+    const int player = state.thread_index() % static_cast<int>(SharedPadTable::MAX_PLAYERS);
+
+    for (auto _ : state) {
+        ControllerState padState;
+        benchmark::DoNotOptimize(source.GetState(player, &padState));
+        benchmark::DoNotOptimize(padState);
+    }
+
+    if (state.thread_index() == 0 && Writer.joinable()) {
+        StopWriter = true;
+        Writer.join();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SharedPadRead)->Arg(0)->Arg(1)->ThreadRange(1, 16)->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "VirtualHandleTable.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+VirtualHandleTable<uint32_t> Table;
+}
+
+// What CreateFile and CloseHandle on an emulated device cost the table
+static void BM_VirtualHandleOpenClose(benchmark::State& state) {
+    for (auto _ : state) {
+        void* handle = Table.Open(1);
+        benchmark::DoNotOptimize(handle);
+        Table.Close(handle);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VirtualHandleOpenClose)->ThreadRange(1, 4)->UseRealTime();
+
+// Every ReadFile and DeviceIoControl on an emulated device looks its handle up
+static void BM_VirtualHandleTryGet(benchmark::State& state) {
+    void* handle = Table.Open(1);
+    uint32_t value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Table.TryGet(handle, &value));
+        benchmark::DoNotOptimize(value);
+    }
+    Table.Close(handle);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VirtualHandleTryGet)->ThreadRange(1, 4)->UseRealTime();
+
+// Calls on every other handle only pay for the range check before going to the original function
+static void BM_VirtualHandleKernelHandle(benchmark::State& state) {
+    uintptr_t handle = 0x1F4;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handle);
+        benchmark::DoNotOptimize(VirtualHandleTable<uint32_t>::IsInRange(reinterpret_cast<void*>(handle)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VirtualHandleKernelHandle);
+
+// Handles opened and closed while other threads read their own, as when a game reopens a device during a poll
+static void BM_VirtualHandleMixed(benchmark::State& state) {
+    void* own = Table.Open(static_cast<uint32_t>(state.thread_index()));
+    uint32_t value = 0;
+    uint64_t iteration = 0;
+    for (auto _ : state) {
+        if (++iteration % 16 == 0) {
+            Table.Close(own);
+            own = Table.Open(static_cast<uint32_t>(state.thread_index()));
+        }
+        benchmark::DoNotOptimize(Table.TryGet(own, &value));
+    }
+    Table.Close(own);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VirtualHandleMixed)->ThreadRange(1, 4)->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include "Windows.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <cwchar>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace {
+thread_local DWORD LastError = ERROR_SUCCESS;
+
+struct Object {
+    virtual ~Object() = default;
+};
+
+struct File : Object {
+    int Descriptor;
+
+    explicit File(const int descriptor) : Descriptor(descriptor) {}
+
+    ~File() override {
+        close(Descriptor);
+    }
+};
+
+struct Mapping : Object {
+    int Descriptor;
+    size_t Size;
+    std::string UnlinkName;  // Set on the handle that created a named mapping, which removes the name when closed
+
+    Mapping(const int descriptor, const size_t size) : Descriptor(descriptor), Size(size) {}
+
+    ~Mapping() override {
+        close(Descriptor);
+        if (!UnlinkName.empty())
+            shm_unlink(UnlinkName.c_str());
+    }
+};
+
+std::mutex ViewsMutex;
+std::unordered_map<const void*, size_t> ViewSizes;
+
+BOOL Fail(const DWORD error) {
+    LastError = error;
+    return FALSE;
+}
+
+DWORD FromErrno(const int error) {
+    switch (error) {
+    case ENOENT:
+        return ERROR_FILE_NOT_FOUND;
+    case EACCES:
+    case EPERM:
+        return ERROR_ACCESS_DENIED;
+    case EBADF:
+        return ERROR_INVALID_HANDLE;
+    case ENOMEM:
+        return ERROR_NOT_ENOUGH_MEMORY;
+    default:
+        return ERROR_INVALID_PARAMETER;
+    }
+}
+
+std::string ToNarrow(const LPCWSTR wide) {
+    std::string narrow;
+    for (const wchar_t* c = wide; *c; c++)
+        narrow += *c < 0x80 ? static_cast<char>(*c) : '_';
+    return narrow;
+}
+
+// "Local\Name" becomes "/Local_Name", shared memory names cannot contain more than the leading slash
+std::string ToShmName(const LPCWSTR name) {
+    std::string shmName = ToNarrow(name);
+    shmName.insert(shmName.begin(), '/');
+    for (size_t i = 1; i < shmName.size(); i++) {
+        if (shmName[i] == '\\' || shmName[i] == '/')
+            shmName[i] = '_';
+    }
+    return shmName;
+}
+
+template <typename T>
+T* As(const HANDLE handle) {
+    if (!handle || handle == INVALID_HANDLE_VALUE)
+        return nullptr;
+    return dynamic_cast<T*>(static_cast<Object*>(handle));
+}
+}  // namespace
+
+DWORD GetLastError() {
+    return LastError;
+}
+
+DWORD GetCurrentProcessId() {
+    return static_cast<DWORD>(getpid());
+}
+
+DWORD GetModuleFileNameA(HMODULE, CHAR* fileName, const DWORD size) {
+    const ssize_t length = readlink("/proc/self/exe", fileName, size ? size - 1 : 0);
+    if (length <= 0)
+        return Fail(FromErrno(errno));
+    fileName[length] = '\0';
+    return static_cast<DWORD>(length);
+}
+
+BOOL CloseHandle(const HANDLE handle) {
+    if (!handle || handle == INVALID_HANDLE_VALUE)
+        return Fail(ERROR_INVALID_HANDLE);
+    delete static_cast<Object*>(handle);
+    return TRUE;
+}
+
+int WideCharToMultiByte(const UINT codePage, DWORD, const LPCWSTR wide, const int wideLength, CHAR* multiByte,
+                        const int multiByteSize, const CHAR*, BOOL*) {
+    if (codePage != CP_UTF8 || !wide)
+        return Fail(ERROR_INVALID_PARAMETER);
+
+    // A length of -1 includes the terminator
+    const size_t length = wideLength < 0 ? wcslen(wide) + 1 : static_cast<size_t>(wideLength);
+    std::string utf8;
+    for (size_t i = 0; i < length; i++) {
+        const auto c = static_cast<uint32_t>(wide[i]);
+        if (c < 0x80) {
+            utf8 += static_cast<char>(c);
+        } else if (c < 0x800) {
+            utf8 += static_cast<char>(0xC0 | c >> 6);
+            utf8 += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            utf8 += static_cast<char>(0xE0 | c >> 12);
+            utf8 += static_cast<char>(0x80 | (c >> 6 & 0x3F));
+            utf8 += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            utf8 += static_cast<char>(0xF0 | c >> 18);
+            utf8 += static_cast<char>(0x80 | (c >> 12 & 0x3F));
+            utf8 += static_cast<char>(0x80 | (c >> 6 & 0x3F));
+            utf8 += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    if (multiByteSize == 0)
+        return static_cast<int>(utf8.size());
+    if (utf8.size() > static_cast<size_t>(multiByteSize))
+        return Fail(ERROR_INVALID_PARAMETER);
+
+    memcpy(multiByte, utf8.data(), utf8.size());
+    return static_cast<int>(utf8.size());
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count) {
+    count->QuadPart = std::chrono::steady_clock::now().time_since_epoch().count();
+    return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency) {
+    frequency->QuadPart = std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num;
+    return TRUE;
+}
+
+HANDLE CreateFileW(const LPCWSTR fileName, const DWORD desiredAccess, DWORD, SECURITY_ATTRIBUTES*,
+                   const DWORD creationDisposition, DWORD, HANDLE) {
+    int flags = (desiredAccess & GENERIC_WRITE) ? ((desiredAccess & GENERIC_READ) ? O_RDWR : O_WRONLY) : O_RDONLY;
+    if (creationDisposition == CREATE_ALWAYS)
+        flags |= O_CREAT | O_TRUNC;
+    else if (creationDisposition == OPEN_ALWAYS)
+        flags |= O_CREAT;
+
+    const int descriptor = open(ToNarrow(fileName).c_str(), flags | O_CLOEXEC, 0644);
+    if (descriptor < 0) {
+        LastError = FromErrno(errno);
+        return INVALID_HANDLE_VALUE;
+    }
+    return static_cast<Object*>(new File(descriptor));
+}
+
+BOOL ReadFile(const HANDLE file, const LPVOID buffer, const DWORD size, DWORD* read, OVERLAPPED*) {
+    const File* object = As<File>(file);
+    if (!object)
+        return Fail(ERROR_INVALID_HANDLE);
+
+    DWORD total = 0;
+    while (total < size) {
+        const ssize_t result = ::read(object->Descriptor, static_cast<char*>(buffer) + total, size - total);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0)
+            return Fail(FromErrno(errno));
+        if (result == 0)
+            break;
+        total += static_cast<DWORD>(result);
+    }
+
+    if (read)
+        *read = total;
+    return TRUE;
+}
+
+BOOL WriteFile(const HANDLE file, const LPCVOID buffer, const DWORD size, DWORD* written, OVERLAPPED*) {
+    const File* object = As<File>(file);
+    if (!object)
+        return Fail(ERROR_INVALID_HANDLE);
+
+    DWORD total = 0;
+    while (total < size) {
+        const ssize_t result = ::write(object->Descriptor, static_cast<const char*>(buffer) + total, size - total);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0)
+            return Fail(FromErrno(errno));
+        total += static_cast<DWORD>(result);
+    }
+
+    if (written)
+        *written = total;
+    return TRUE;
+}
+
+BOOL FlushFileBuffers(const HANDLE file) {
+    const File* object = As<File>(file);
+    if (!object)
+        return Fail(ERROR_INVALID_HANDLE);
+    return fsync(object->Descriptor) == 0 ? TRUE : Fail(FromErrno(errno));
+}
+
+BOOL GetFileSizeEx(const HANDLE file, LARGE_INTEGER* size) {
+    const File* object = As<File>(file);
+    struct stat status;
+    if (!object)
+        return Fail(ERROR_INVALID_HANDLE);
+    if (fstat(object->Descriptor, &status) != 0)
+        return Fail(FromErrno(errno));
+    size->QuadPart = status.st_size;
+    return TRUE;
+}
+
+HANDLE CreateFileMappingW(const HANDLE file, SECURITY_ATTRIBUTES*, DWORD, const DWORD maximumSizeHigh,
+                          const DWORD maximumSizeLow, const LPCWSTR name) {
+    const size_t size = (static_cast<size_t>(maximumSizeHigh) << 32) | maximumSizeLow;
+
+    if (file != INVALID_HANDLE_VALUE) {
+        const File* object = As<File>(file);
+        if (!object) {
+            LastError = ERROR_INVALID_HANDLE;
+            return nullptr;
+        }
+        const int descriptor = dup(object->Descriptor);
+        struct stat status;
+        fstat(descriptor, &status);
+        if (size > static_cast<size_t>(status.st_size) && ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+            LastError = FromErrno(errno);
+            close(descriptor);
+            return nullptr;
+        }
+        LastError = ERROR_SUCCESS;
+        return static_cast<Object*>(new Mapping(descriptor, size ? size : static_cast<size_t>(status.st_size)));
+    }
+
+    if (!name) {
+        const int descriptor = memfd_create("mapping", MFD_CLOEXEC);
+        if (descriptor < 0 || ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+            LastError = FromErrno(errno);
+            if (descriptor >= 0)
+                close(descriptor);
+            return nullptr;
+        }
+        LastError = ERROR_SUCCESS;
+        return static_cast<Object*>(new Mapping(descriptor, size));
+    }
+
+    const std::string shmName = ToShmName(name);
+    bool created = true;
+    int descriptor = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (descriptor < 0 && errno == EEXIST) {
+        created = false;
+        descriptor = shm_open(shmName.c_str(), O_RDWR | O_CLOEXEC, 0600);
+    }
+    if (descriptor < 0 || (created && ftruncate(descriptor, static_cast<off_t>(size)) != 0)) {
+        LastError = FromErrno(errno);
+        if (descriptor >= 0)
+            close(descriptor);
+        return nullptr;
+    }
+
+    auto* mapping = new Mapping(descriptor, size);
+    if (created)
+        mapping->UnlinkName = shmName;
+    LastError = created ? ERROR_SUCCESS : ERROR_ALREADY_EXISTS;
+    return static_cast<Object*>(mapping);
+}
+
+HANDLE OpenFileMappingW(const DWORD desiredAccess, BOOL, const LPCWSTR name) {
+    const bool write = (desiredAccess & FILE_MAP_WRITE) != 0;
+    const int descriptor = shm_open(ToShmName(name).c_str(), (write ? O_RDWR : O_RDONLY) | O_CLOEXEC, 0);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+        LastError = FromErrno(errno);
+        if (descriptor >= 0)
+            close(descriptor);
+        return nullptr;
+    }
+    return static_cast<Object*>(new Mapping(descriptor, static_cast<size_t>(status.st_size)));
+}
+
+LPVOID MapViewOfFile(const HANDLE mapping, const DWORD desiredAccess, const DWORD offsetHigh, const DWORD offsetLow,
+                     SIZE_T size) {
+    const Mapping* object = As<Mapping>(mapping);
+    const size_t offset = (static_cast<size_t>(offsetHigh) << 32) | offsetLow;
+    if (!object || offset > object->Size) {
+        LastError = ERROR_INVALID_PARAMETER;
+        return nullptr;
+    }
+    if (size == 0)
+        size = object->Size - offset;
+
+    const int protection = (desiredAccess & FILE_MAP_WRITE) ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* view = mmap(nullptr, size, protection, MAP_SHARED, object->Descriptor, static_cast<off_t>(offset));
+    if (view == MAP_FAILED) {
+        LastError = FromErrno(errno);
+        return nullptr;
+    }
+
+    std::lock_guard lock(ViewsMutex);
+    ViewSizes[view] = size;
+    return view;
+}
+
+BOOL UnmapViewOfFile(const LPCVOID address) {
+    size_t size;
+    {
+        std::lock_guard lock(ViewsMutex);
+        const auto it = ViewSizes.find(address);
+        if (it == ViewSizes.end())
+            return Fail(ERROR_INVALID_PARAMETER);
+        size = it->second;
+        ViewSizes.erase(it);
+    }
+    munmap(const_cast<void*>(address), size);
+    return TRUE;
+}
+
+BOOL FlushViewOfFile(const LPCVOID address, const SIZE_T size) {
+    return msync(const_cast<void*>(address), size, MS_ASYNC) == 0 ? TRUE : Fail(FromErrno(errno));
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+ * The subset of the Win32 API the portable parts of Shuffler.Hook use, implemented on POSIX in Windows.cpp so they can
+ * be tested on Linux. Handles are heap objects behind HANDLE; named file mappings are POSIX shared memory objects.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#define WINAPI
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define MAXDWORD 0xFFFFFFFFu
+
+using BOOL = int;
+using UINT = uint32_t;
+using BYTE = uint8_t;
+using WORD = uint16_t;
+using DWORD = uint32_t;
+using LONG = int32_t;
+using ULONG = uint32_t;
+using LONGLONG = int64_t;
+using SIZE_T = size_t;
+using CHAR = char;
+using WCHAR = wchar_t;
+using LPVOID = void*;
+using LPCVOID = const void*;
+using LPCWSTR = const wchar_t*;
+using HANDLE = void*;
+using HMODULE = void*;
+using FARPROC = intptr_t (*)();
+
+union LARGE_INTEGER {
+    struct {
+        DWORD LowPart;
+        LONG HighPart;
+    };
+    LONGLONG QuadPart;
+};
+
+struct SECURITY_ATTRIBUTES;
+struct OVERLAPPED;
+
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(static_cast<intptr_t>(-1)))
+
+#define ERROR_SUCCESS 0L
+#define ERROR_FILE_NOT_FOUND 2L
+#define ERROR_ACCESS_DENIED 5L
+#define ERROR_INVALID_HANDLE 6L
+#define ERROR_NOT_ENOUGH_MEMORY 8L
+#define ERROR_INVALID_PARAMETER 87L
+#define ERROR_ALREADY_EXISTS 183L
+#define ERROR_DEVICE_NOT_CONNECTED 1167L
+
+#define GENERIC_READ 0x80000000u
+#define GENERIC_WRITE 0x40000000u
+#define FILE_SHARE_READ 0x1u
+#define FILE_SHARE_WRITE 0x2u
+#define CREATE_ALWAYS 2u
+#define OPEN_EXISTING 3u
+#define OPEN_ALWAYS 4u
+#define FILE_ATTRIBUTE_NORMAL 0x80u
+
+#define CP_UTF8 65001u
+
+#define PAGE_READONLY 0x02u
+#define PAGE_READWRITE 0x04u
+#define FILE_MAP_WRITE 0x2u
+#define FILE_MAP_READ 0x4u
+#define FILE_MAP_ALL_ACCESS 0xF001Fu
+
+#define INFINITE 0xFFFFFFFFu
+#define WAIT_OBJECT_0 0u
+#define WAIT_TIMEOUT 258u
+#define WAIT_FAILED 0xFFFFFFFFu
+
+DWORD GetLastError();
+DWORD GetCurrentProcessId();
+DWORD GetModuleFileNameA(HMODULE module, CHAR* fileName, DWORD size);
+BOOL CloseHandle(HANDLE handle);
+
+// Only CP_UTF8. wchar_t holds whole code points here rather than UTF-16 code units
+int WideCharToMultiByte(UINT codePage, DWORD flags, LPCWSTR wide, int wideLength, CHAR* multiByte, int multiByteSize,
+                        const CHAR* defaultChar, BOOL* usedDefaultChar);
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+
+HANDLE CreateFileW(LPCWSTR fileName, DWORD desiredAccess, DWORD shareMode, SECURITY_ATTRIBUTES* securityAttributes,
+                   DWORD creationDisposition, DWORD flagsAndAttributes, HANDLE templateFile);
+BOOL ReadFile(HANDLE file, LPVOID buffer, DWORD size, DWORD* read, OVERLAPPED* overlapped);
+BOOL WriteFile(HANDLE file, LPCVOID buffer, DWORD size, DWORD* written, OVERLAPPED* overlapped);
+BOOL FlushFileBuffers(HANDLE file);
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* size);
+
+// file INVALID_HANDLE_VALUE maps anonymous memory, shared with other processes only when it is named
+HANDLE CreateFileMappingW(HANDLE file, SECURITY_ATTRIBUTES* securityAttributes, DWORD protect, DWORD maximumSizeHigh,
+                          DWORD maximumSizeLow, LPCWSTR name);
+HANDLE OpenFileMappingW(DWORD desiredAccess, BOOL inheritHandle, LPCWSTR name);
+LPVOID MapViewOfFile(HANDLE mapping, DWORD desiredAccess, DWORD offsetHigh, DWORD offsetLow, SIZE_T size);
+BOOL UnmapViewOfFile(LPCVOID address);
+BOOL FlushViewOfFile(LPCVOID address, SIZE_T size);
+
+inline int localtime_s(tm* result, const time_t* time) {
+    return localtime_r(time, result) ? 0 : 1;
+}
\ No newline at end of file
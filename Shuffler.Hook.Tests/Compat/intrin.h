@@ -0,0 +1,6 @@
+#pragma once
+
+// MSVC's intrinsics header, GCC and Clang have theirs in <x86intrin.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
\ No newline at end of file
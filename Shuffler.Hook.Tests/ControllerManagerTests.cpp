@@ -0,0 +1,251 @@
+#include "ControllerManager.h"
+#include "Fakes/FakeXInput.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+ControllerState MakeState(const int controllerIndex) {
+    ControllerState state = {};
+    state.ButtonStates = static_cast<uint16_t>(Button::A);
+    state.LeftThumbstickX = static_cast<int16_t>(1000 * (controllerIndex + 1));
+    return state;
+}
+
+ActionMapping ButtonToButton(const Button from, const Button to) {
+    ActionMapping mapping{};
+    mapping.From.Type = InputType::Button;
+    mapping.From.Button = from;
+    mapping.To.Type = InputType::Button;
+    mapping.To.Button = to;
+    return mapping;
+}
+
+struct HeardPacket {
+    int SlotIndex;
+    uint32_t PacketNumber;
+    int16_t LeftThumbstickX;
+};
+
+std::vector<HeardPacket> HeardPackets;
+
+void ListenToStates(const int slotIndex, const ControllerState& state, const uint32_t packetNumber) {
+    HeardPackets.push_back({slotIndex, packetNumber, state.LeftThumbstickX});
+}
+
+std::atomic<uint32_t> HeardPacketCount = 0;
+
+void CountStates(int, const ControllerState&, uint32_t) {
+    HeardPacketCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ControllerManager is static, every test starts from slot 0 alone on player 0 and controller 0
+class ControllerManagerTests : public testing::Test {
+  protected:
+    void SetUp() override {
+        FakeXInput::Reset();
+        for (int controller = 0; controller < FakeXInput::MAX_CONTROLLERS; controller++)
+            FakeXInput::SetState(controller, MakeState(controller));
+
+        for (int slot = 1; slot < VirtualSlotTable::MAX_SLOTS; slot++)
+            ControllerManager::UnbindSlot(slot);
+        ControllerManager::BindSlot(0, 0, 0);
+        ControllerManager::ReplaceButtonMappings(std::vector<std::vector<ActionMapping>>());
+        ControllerManager::SetStateFreshness(std::chrono::microseconds(0));
+    }
+
+    void TearDown() override {
+        ControllerManager::SetStateListener(nullptr);
+        HeardPackets.clear();
+        ControllerManager::SetStateFreshness(ControllerManager::DEFAULT_STATE_FRESHNESS);
+    }
+};
+}
+
+TEST_F(ControllerManagerTests, PollingASlotReadsOnlyItsOwnController) {
+    for (int slot = 0; slot < VirtualSlotTable::MAX_SLOTS; slot++)
+        ASSERT_TRUE(ControllerManager::BindSlot(slot, static_cast<uint8_t>(slot), static_cast<uint8_t>(slot)));
+    EXPECT_EQ(ControllerManager::GetConnectedSlotMask(), 0xFu);
+
+    ControllerState state;
+    for (int i = 0; i < 100; i++)
+        ASSERT_TRUE(ControllerManager::GetState(3, &state, InputApi::XInput));
+
+    EXPECT_EQ(state.LeftThumbstickX, 4000);
+    EXPECT_EQ(FakeXInput::GetReadCount(3), 100u);
+    for (const int controller : {0, 1, 2})
+        EXPECT_EQ(FakeXInput::GetReadCount(controller), 0u) << controller;
+}
+
+TEST_F(ControllerManagerTests, UnboundSlotsReadNothing) {
+    ControllerState state;
+    EXPECT_FALSE(ControllerManager::GetState(2, &state, InputApi::XInput));
+    EXPECT_FALSE(ControllerManager::GetState(-1, &state, InputApi::XInput));
+    EXPECT_FALSE(ControllerManager::GetState(VirtualSlotTable::MAX_SLOTS, &state, InputApi::XInput));
+    EXPECT_FALSE(ControllerManager::BindSlot(VirtualSlotTable::MAX_SLOTS, 0, 0));
+    for (int controller = 0; controller < FakeXInput::MAX_CONTROLLERS; controller++)
+        EXPECT_EQ(FakeXInput::GetReadCount(controller), 0u);
+}
+
+TEST_F(ControllerManagerTests, SlotsFollowTheirControllersConnection) {
+    ASSERT_TRUE(ControllerManager::BindSlot(1, 1, 2));
+    FakeXInput::SetState(2, MakeState(2), false);
+
+    ControllerState state;
+    EXPECT_FALSE(ControllerManager::GetState(1, &state, InputApi::XInput));
+    EXPECT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput));
+
+    FakeXInput::SetState(2, MakeState(2));
+    ASSERT_TRUE(ControllerManager::GetState(1, &state, InputApi::XInput));
+    EXPECT_EQ(state.LeftThumbstickX, 3000);
+}
+
+TEST_F(ControllerManagerTests, EverySlotAppliesItsOwnPlayersProfile) {
+    // Two slots on the same controller, bound to different players
+    ControllerManager::AddButtonMapping(1, ButtonToButton(Button::A, Button::B));
+    ControllerManager::AddButtonMapping(2, ButtonToButton(Button::A, Button::Y));
+    ASSERT_TRUE(ControllerManager::BindSlot(1, 1, 0));
+    ASSERT_TRUE(ControllerManager::BindSlot(2, 2, 0));
+
+    ControllerState slot0, slot1, slot2;
+    ASSERT_TRUE(ControllerManager::GetState(0, &slot0, InputApi::XInput));
+    ASSERT_TRUE(ControllerManager::GetState(1, &slot1, InputApi::XInput));
+    ASSERT_TRUE(ControllerManager::GetState(2, &slot2, InputApi::XInput));
+    EXPECT_EQ(slot0.ButtonStates, static_cast<uint16_t>(Button::A));
+    EXPECT_EQ(slot1.ButtonStates, static_cast<uint16_t>(Button::B));
+    EXPECT_EQ(slot2.ButtonStates, static_cast<uint16_t>(Button::Y));
+
+    // Switching slot 0's player leaves the others alone
+    ControllerManager::SetActivePlayer(2);
+    ASSERT_TRUE(ControllerManager::GetState(0, &slot0, InputApi::XInput));
+    ASSERT_TRUE(ControllerManager::GetState(1, &slot1, InputApi::XInput));
+    EXPECT_EQ(slot0.ButtonStates, static_cast<uint16_t>(Button::Y));
+    EXPECT_EQ(slot1.ButtonStates, static_cast<uint16_t>(Button::B));
+}
+
+TEST_F(ControllerManagerTests, SlotsCacheTheirStatesSeparately) {
+    ControllerManager::SetStateFreshness(std::chrono::seconds(10));
+    ASSERT_TRUE(ControllerManager::BindSlot(1, 0, 1));
+
+    ControllerState state;
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput));
+        EXPECT_EQ(state.LeftThumbstickX, 1000);
+        ASSERT_TRUE(ControllerManager::GetState(1, &state, InputApi::RawInput));
+        EXPECT_EQ(state.LeftThumbstickX, 2000);
+    }
+    EXPECT_EQ(FakeXInput::GetReadCount(0), 1u);
+    EXPECT_EQ(FakeXInput::GetReadCount(1), 1u);
+
+    // Rebinding a slot drops its cached state, not the other slot's
+    ASSERT_TRUE(ControllerManager::BindSlot(1, 0, 2));
+    ASSERT_TRUE(ControllerManager::GetState(1, &state, InputApi::XInput));
+    EXPECT_EQ(state.LeftThumbstickX, 3000);
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput));
+    EXPECT_EQ(FakeXInput::GetReadCount(0), 1u);
+    EXPECT_EQ(FakeXInput::GetReadCount(2), 1u);
+}
+
+TEST_F(ControllerManagerTests, PacketNumbersAreCountedPerSlot) {
+    ASSERT_TRUE(ControllerManager::BindSlot(1, 0, 1));
+
+    ControllerState state;
+    uint32_t first0, first1, packet;
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput, &first0));
+    ASSERT_TRUE(ControllerManager::GetState(1, &state, InputApi::XInput, &first1));
+
+    // Controller 1 changes, slot 0's packet stays put
+    ControllerState changed = MakeState(1);
+    changed.RightTrigger = 200;
+    FakeXInput::SetState(1, changed);
+    ASSERT_TRUE(ControllerManager::GetState(1, &state, InputApi::XInput, &packet));
+    EXPECT_EQ(packet, first1 + 1);
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput, &packet));
+    EXPECT_EQ(packet, first0);
+}
+
+TEST_F(ControllerManagerTests, ListenerHearsEachPacketOnce) {
+    ControllerState state;
+    uint32_t first;
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput, &first));
+    ControllerManager::SetStateListener(&ListenToStates);
+
+    // Reads of an unchanged state through any api push nothing
+    for (const InputApi api : {InputApi::XInput, InputApi::RawInput, InputApi::Hid})
+        ASSERT_TRUE(ControllerManager::GetState(0, &state, api));
+    EXPECT_TRUE(HeardPackets.empty());
+
+    // The first read of a change pushes it, whichever api it came through, and later reads of it do not
+    ControllerState changed = MakeState(0);
+    changed.LeftThumbstickX = -5000;
+    FakeXInput::SetState(0, changed);
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::RawInput));
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput));
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::Hid));
+
+    ASSERT_EQ(HeardPackets.size(), 1u);
+    EXPECT_EQ(HeardPackets[0].SlotIndex, 0);
+    EXPECT_EQ(HeardPackets[0].PacketNumber, first + 1);
+    EXPECT_EQ(HeardPackets[0].LeftThumbstickX, -5000);
+}
+
+TEST_F(ControllerManagerTests, PolledChangesReachTheListenerToo) {
+    ASSERT_TRUE(ControllerManager::BindSlot(1, 0, 1));
+    ControllerState state;
+    uint32_t first;
+    ASSERT_TRUE(ControllerManager::PollState(1, &state, &first));
+    ControllerManager::SetStateListener(&ListenToStates);
+
+    ControllerState changed = MakeState(1);
+    changed.LeftThumbstickX = 1234;
+    FakeXInput::SetState(1, changed);
+    uint32_t packet;
+    ASSERT_TRUE(ControllerManager::PollState(1, &state, &packet));
+    EXPECT_EQ(packet, first + 1);
+    EXPECT_EQ(state.LeftThumbstickX, 1234);
+
+    ASSERT_EQ(HeardPackets.size(), 1u);
+    EXPECT_EQ(HeardPackets[0].SlotIndex, 1);
+    EXPECT_EQ(HeardPackets[0].PacketNumber, packet);
+
+    // A GetState of the same state afterwards shares the packet and pushes nothing more
+    ASSERT_TRUE(ControllerManager::GetState(1, &state, InputApi::Hid, &packet));
+    EXPECT_EQ(packet, first + 1);
+    EXPECT_EQ(HeardPackets.size(), 1u);
+}
+
+TEST_F(ControllerManagerTests, RacingReadersPushEachPacketOnce) {
+    ControllerState state;
+    uint32_t first;
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput, &first));
+    HeardPacketCount = 0;
+    ControllerManager::SetStateListener(&CountStates);
+
+    // Readers on every api race each other over a stream of changes
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> readers;
+    for (const InputApi api : {InputApi::XInput, InputApi::RawInput, InputApi::Hid}) {
+        readers.emplace_back([api, &stop] {
+            ControllerState read;
+            while (!stop.load(std::memory_order_relaxed))
+                ControllerManager::GetState(0, &read, api);
+        });
+    }
+
+    for (int16_t i = 1; i <= 2000; i++) {
+        ControllerState changed = MakeState(0);
+        changed.LeftThumbstickX = i;
+        FakeXInput::SetState(0, changed);
+        if (i % 16 == 0)
+            std::this_thread::yield();
+    }
+    stop = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    uint32_t last;
+    ASSERT_TRUE(ControllerManager::GetState(0, &state, InputApi::XInput, &last));
+    EXPECT_EQ(HeardPacketCount.load(), last - first);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/**
+ * Stands in for a Win32 auto-reset event. An eventfd counter is non-zero while signalled, and reading it both waits
+ * for and clears the signal, so a Notify with nobody waiting wakes the next Wait.
+ */
+class EventFdSignal {
+    int _descriptor = eventfd(0, EFD_CLOEXEC);
+
+  public:
+    EventFdSignal() = default;
+
+    ~EventFdSignal() {
+        close(_descriptor);
+    }
+
+    EventFdSignal(const EventFdSignal&) = delete;
+    EventFdSignal& operator=(const EventFdSignal&) = delete;
+
+    void Notify() {
+        const uint64_t one = 1;
+        while (write(_descriptor, &one, sizeof(one)) < 0 && errno == EINTR) {
+        }
+    }
+
+    void Wait() {
+        uint64_t count;
+        while (read(_descriptor, &count, sizeof(count)) < 0 && errno == EINTR) {
+        }
+    }
+
+    // Returns false if nothing was signalled within timeoutMilliseconds
+    bool WaitFor(const int timeoutMilliseconds) {
+        pollfd descriptor = {_descriptor, POLLIN, 0};
+        if (poll(&descriptor, 1, timeoutMilliseconds) <= 0)
+            return false;
+
+        uint64_t count;
+        return read(_descriptor, &count, sizeof(count)) == sizeof(count);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "FakeXInput.h"
+#include "XInputSource.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace {
+struct FakeController {
+    ControllerState State;
+    bool Connected;
+};
+
+std::mutex Mutex;
+FakeController Controllers[FakeXInput::MAX_CONTROLLERS] = {};
+std::atomic<uint32_t> ReadCounts[FakeXInput::MAX_CONTROLLERS] = {};
+std::atomic<int64_t> ReadCost{0};
+}  // namespace
+
+void FakeXInput::SetState(const int controllerIndex, const ControllerState& state, const bool connected) {
+    std::lock_guard lock(Mutex);
+    Controllers[controllerIndex] = {state, connected};
+}
+
+uint32_t FakeXInput::GetReadCount(const int controllerIndex) {
+    return ReadCounts[controllerIndex].load(std::memory_order_relaxed);
+}
+
+void FakeXInput::SetReadCost(const std::chrono::nanoseconds cost) {
+    ReadCost.store(cost.count(), std::memory_order_relaxed);
+}
+
+void FakeXInput::Reset() {
+    ReadCost.store(0, std::memory_order_relaxed);
+    std::lock_guard lock(Mutex);
+    for (int i = 0; i < MAX_CONTROLLERS; i++) {
+        Controllers[i] = {};
+        ReadCounts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool XInputSource::GetState(const int controllerIndex, ControllerState* state) {
+    if (controllerIndex < 0 || controllerIndex >= FakeXInput::MAX_CONTROLLERS)
+        return false;
+
+    ReadCounts[controllerIndex].fetch_add(1, std::memory_order_relaxed);
+    // Spins rather than sleeps, a driver call keeps the calling thread busy
+    if (const int64_t cost = ReadCost.load(std::memory_order_relaxed)) {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds(cost);
+        while (std::chrono::steady_clock::now() < end) {}
+    }
+
+    std::lock_guard lock(Mutex);
+    *state = Controllers[controllerIndex].State;
+    return Controllers[controllerIndex].Connected;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Stands in for the physical controllers behind XInputSource: FakeXInput.cpp defines XInputSource::GetState in place
+ * of XInputSource.cpp, so ControllerManager can be linked and driven without XInput. Reads are counted per controller
+ * and can be made to take as long as a call into the XInput driver does.
+ */
+namespace FakeXInput {
+constexpr int MAX_CONTROLLERS = 4;
+
+void SetState(int controllerIndex, const ControllerState& state, bool connected = true);
+uint32_t GetReadCount(int controllerIndex);
+void SetReadCost(std::chrono::nanoseconds cost);
+void Reset();
+}  // namespace FakeXInput
\ No newline at end of file
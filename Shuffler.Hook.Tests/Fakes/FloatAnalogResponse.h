@@ -0,0 +1,52 @@
+#pragma once
+
+#include "AnalogResponse.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * AnalogSettings applied with floating point math on every call, the way a per-poll implementation without lookup
+ * tables would. AnalogResponse is tested and benchmarked against it.
+ */
+class FloatAnalogResponse {
+    AnalogSettings _settings;
+
+  public:
+    explicit FloatAnalogResponse(const AnalogSettings& settings) : _settings(settings) {}
+
+    void Apply(ControllerState* state) const {
+        ApplyStick(_settings.LeftStick, &state->LeftThumbstickX, &state->LeftThumbstickY);
+        ApplyStick(_settings.RightStick, &state->RightThumbstickX, &state->RightThumbstickY);
+        state->LeftTrigger = ApplyTrigger(_settings.LeftTrigger, state->LeftTrigger);
+        state->RightTrigger = ApplyTrigger(_settings.RightTrigger, state->RightTrigger);
+    }
+
+  private:
+    static void ApplyStick(const StickResponse& response, int16_t* x, int16_t* y) {
+        const float magnitude = std::sqrt(static_cast<float>(*x) * *x + static_cast<float>(*y) * *y);
+        const float deadzone = response.Deadzone;
+        if (magnitude <= deadzone) {
+            *x = *y = 0;
+            return;
+        }
+
+        const float outer = std::max<float>(response.OuterDeadzone, deadzone + 1);
+        const float antiDeadzone = std::min<float>(response.AntiDeadzone, 32767);
+        const float curve = response.Curve > 0 ? response.Curve : 1.0f;
+        const float position = std::min((magnitude - deadzone) / (outer - deadzone), 1.0f);
+        const float scale = (antiDeadzone + (32767 - antiDeadzone) * std::pow(position, curve)) / magnitude;
+        *x = static_cast<int16_t>(std::clamp(*x * scale, -32768.0f, 32767.0f));
+        *y = static_cast<int16_t>(std::clamp(*y * scale, -32768.0f, 32767.0f));
+    }
+
+    static uint8_t ApplyTrigger(const TriggerResponse& response, const uint8_t value) {
+        const float deadzone = std::min<float>(response.Deadzone, 254);
+        if (value <= deadzone)
+            return 0;
+
+        const float curve = response.Curve > 0 ? response.Curve : 1.0f;
+        const float position = (value - deadzone) / (255 - deadzone);
+        return static_cast<uint8_t>(
+            std::lround(response.AntiDeadzone + (255.0f - response.AntiDeadzone) * std::pow(position, curve)));
+    }
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * Stands in for a Win32 auto-reset event with a futex, the way WaitOnAddress waits without a kernel object. A flag is
+ * set while signalled, and the one Wait that takes it clears it, so a Notify with nobody waiting wakes the next Wait.
+ */
+class FutexSignal {
+    std::atomic<uint32_t> _signalled{0};
+
+  public:
+    void Notify() {
+        _signalled.store(1, std::memory_order_release);
+        syscall(SYS_futex, &_signalled, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+
+    void Wait() {
+        // The kernel only puts the thread to sleep while the flag is still clear, a Notify in between is never lost
+        while (_signalled.exchange(0, std::memory_order_acquire) == 0)
+            syscall(SYS_futex, &_signalled, FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "InputStream.h"
+#include <random>
+#include <vector>
+
+/**
+ * Synthetic play sessions shaped like the ones InputStreamRecorder writes: sticks that wander and jitter by a few
+ * units, triggers that get squeezed, buttons pressed in short bursts and the odd disconnect, at roughly 1 kHz. The
+ * same seed always gives the same session.
+ */
+namespace InputSession {
+constexpr int64_t TIMESTAMP_FREQUENCY = 10'000'000;
+constexpr int64_t START_TIMESTAMP = 123'456'789;
+
+inline int16_t Wander(std::mt19937& random, const int16_t value) {
+    const int32_t step = static_cast<int32_t>(random() % 2001) - 1000;
+    return static_cast<int16_t>(std::clamp(value + step, -32768, 32767));
+}
+
+inline std::vector<InputStreamSample> Make(const uint32_t seed, const size_t count) {
+    std::mt19937 random(seed);
+    std::vector<InputStreamSample> samples(count);
+    InputStreamSample current = {START_TIMESTAMP, {}, true};
+
+    for (auto& sample : samples) {
+        current.Timestamp += 9'000 + random() % 2'000;
+
+        const uint32_t roll = random() % 100;
+        if (roll < 40) {
+            current.State.LeftThumbstickX = Wander(random, current.State.LeftThumbstickX);
+            current.State.LeftThumbstickY = Wander(random, current.State.LeftThumbstickY);
+        } else if (roll < 60) {
+            current.State.RightThumbstickX = Wander(random, current.State.RightThumbstickX);
+            current.State.RightThumbstickY = static_cast<int16_t>(current.State.RightThumbstickY + random() % 7 - 3);
+        } else if (roll < 75) {
+            current.State.LeftTrigger = static_cast<uint8_t>(random());
+        } else if (roll < 80) {
+            current.State.RightTrigger = random() % 2 ? 255 : 0;
+        } else if (roll < 99) {
+            current.State.ButtonStates ^= static_cast<uint16_t>(1u << (random() % 16)) & 0xF3FF;
+        } else {
+            current.Connected = !current.Connected;
+        }
+
+        sample = current;
+    }
+    return samples;
+}
+
+// Encodes samples as a complete stream file, header included
+inline std::vector<uint8_t> Encode(const std::vector<InputStreamSample>& samples, const uint16_t keyframeInterval) {
+    const InputStreamHeader header = {
+        .Magic = InputStreamHeader::MAGIC,
+        .Version = InputStreamHeader::VERSION,
+        .KeyframeInterval = keyframeInterval,
+        .TimestampFrequency = TIMESTAMP_FREQUENCY,
+        .StartTimestamp = samples.empty() ? START_TIMESTAMP : samples.front().Timestamp,
+    };
+
+    std::vector<uint8_t> data(sizeof(header));
+    memcpy(data.data(), &header, sizeof(header));
+
+    InputStreamEncoder encoder(keyframeInterval);
+    const auto append = [&] {
+        const auto block = encoder.FinishBlock();
+        data.insert(data.end(), block.begin(), block.end());
+    };
+
+    for (const auto& sample : samples) {
+        if (encoder.Add(sample.Timestamp, sample.State, sample.Connected) && encoder.IsBlockFull())
+            append();
+    }
+    append();
+    return data;
+}
+}  // namespace InputSession
\ No newline at end of file
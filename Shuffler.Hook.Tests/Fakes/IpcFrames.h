@@ -0,0 +1,46 @@
+#pragma once
+
+#include "IpcProtocol.h"
+#include <cstring>
+#include <vector>
+
+// Builds frames the way ShufflerHookIpcProtocol.cs in Shuffler.Core encodes them
+inline std::vector<uint8_t> MakeFrame(const IpcMessageType type, const void* payload, const size_t payloadSize) {
+    const IpcFrameHeader header = {IpcFrameHeader::MAGIC, IpcFrameHeader::VERSION, type,
+                                   static_cast<uint32_t>(payloadSize), 0};
+    std::vector<uint8_t> frame(sizeof(header) + payloadSize);
+    memcpy(frame.data(), &header, sizeof(header));
+    if (payloadSize)
+        memcpy(frame.data() + sizeof(header), payload, payloadSize);
+    return frame;
+}
+
+template <typename T>
+std::vector<uint8_t> MakeFrame(const IpcMessageType type, const T& payload) {
+    return MakeFrame(type, &payload, sizeof(payload));
+}
+
+struct PlayerMappings {
+    uint8_t PlayerIndex;
+    std::vector<IpcMappingEntry> Entries;
+};
+
+inline std::vector<uint8_t> MakeMappingsFrame(const std::vector<PlayerMappings>& players) {
+    std::vector<uint8_t> payload(sizeof(IpcMappingSetHeader));
+    payload[0] = static_cast<uint8_t>(players.size());
+
+    for (const auto& player : players) {
+        const IpcPlayerMappingsHeader header = {player.PlayerIndex, 0, static_cast<uint16_t>(player.Entries.size())};
+        const auto* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+        payload.insert(payload.end(), headerBytes, headerBytes + sizeof(header));
+
+        const auto* entries = reinterpret_cast<const uint8_t*>(player.Entries.data());
+        payload.insert(payload.end(), entries, entries + player.Entries.size() * sizeof(IpcMappingEntry));
+    }
+
+    return MakeFrame(IpcMessageType::SetMappings, payload.data(), payload.size());
+}
+
+inline IpcMappingEntry ButtonToButton(const Button from, const Button to) {
+    return {InputType::Button, 0, static_cast<uint16_t>(from), InputType::Button, 0, static_cast<uint16_t>(to)};
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "SharedPadTable.h"
+#include <Windows.h>
+
+/**
+ * Stands in for ShufflerPadFeed.cs in the controlling process: creates the "Local\ShufflerPadFeed" mapping and
+ * publishes player states into it through its own view.
+ */
+class PadFeedPublisher {
+    HANDLE _mapping = nullptr;
+    SharedPadTable* _table = nullptr;
+
+  public:
+    explicit PadFeedPublisher(const uint16_t slotCount = SharedPadTable::MAX_PLAYERS) {
+        _mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(SharedPadTable),
+                                      L"Local\\ShufflerPadFeed");
+        if (_mapping)
+            _table = static_cast<SharedPadTable*>(MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, sizeof(SharedPadTable)));
+        if (_table) {
+            _table->Magic = SharedPadTable::MAGIC;
+            _table->Version = SharedPadTable::VERSION;
+            _table->SlotCount = slotCount;
+        }
+    }
+
+    ~PadFeedPublisher() {
+        if (_table)
+            UnmapViewOfFile(_table);
+        if (_mapping)
+            CloseHandle(_mapping);
+    }
+
+    PadFeedPublisher(const PadFeedPublisher&) = delete;
+    PadFeedPublisher& operator=(const PadFeedPublisher&) = delete;
+
+    bool IsOpen() const {
+        return _table != nullptr;
+    }
+
+    SharedPadTable* GetTable() const {
+        return _table;
+    }
+
+    void Publish(const int player, const ControllerState& state, const bool connected) {
+        _table->Slots[player].State.Store({state, static_cast<uint8_t>(connected), {}});
+    }
+
+    // Leaves the slot's sequence odd, as a publisher that died in the middle of a write would
+    void AbandonWrite(const int player) {
+        reinterpret_cast<std::atomic<uint32_t>*>(&_table->Slots[player].State)->fetch_add(1);
+    }
+};
+
+// A state whose fields are all derived from value, so a reader can tell a torn copy from a whole one
+inline ControllerState MakeCheckedState(const uint32_t value) {
+    ControllerState state = {};
+    state.ButtonStates = static_cast<uint16_t>(value);
+    state.LeftTrigger = static_cast<uint8_t>(value >> 16);
+    state.RightTrigger = static_cast<uint8_t>(~(value >> 16));
+    state.LeftThumbstickX = static_cast<int16_t>(value);
+    state.LeftThumbstickY = static_cast<int16_t>(~value);
+    state.RightThumbstickX = static_cast<int16_t>(value >> 16);
+    state.RightThumbstickY = static_cast<int16_t>(~(value >> 16));
+    return state;
+}
+
+// Returns false if state is not one MakeCheckedState made, value is only set if it is
+inline bool ReadCheckedState(const ControllerState& state, uint32_t* value) {
+    const uint32_t decoded = state.ButtonStates | static_cast<uint32_t>(static_cast<uint16_t>(state.RightThumbstickX)) << 16;
+    const ControllerState expected = MakeCheckedState(decoded);
+    if (memcmp(&expected, &state, sizeof(state)) != 0)
+        return false;
+
+    *value = decoded;
+    return true;
+}
\ No newline at end of file
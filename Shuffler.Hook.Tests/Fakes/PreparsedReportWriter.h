@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Stands in for HidP_SetUsages and HidP_SetUsageValue: finds a usage's caps entry in a HIDP_PREPARSED_DATA image and
+ * writes into the report where that entry says, walking the image on every call like hid.dll does.
+ */
+class PreparsedReportWriter {
+    static constexpr size_t HEADER_SIZE = 0x2C;
+    static constexpr size_t CAPS_SIZE = 0x68;
+    static constexpr uint32_t CAPS_FLAG_BUTTON = 0x04;
+
+    struct Caps {
+        uint16_t UsagePage;
+        uint8_t StartBit;
+        uint16_t BitSize;
+        uint16_t StartByte;
+        uint32_t Flags;
+        uint16_t UsageMin;
+        uint16_t UsageMax;
+    };
+
+    const uint8_t* _data;
+
+  public:
+    explicit PreparsedReportWriter(const uint8_t* data) : _data(data) {}
+
+    bool SetUsage(const uint16_t usagePage, const uint16_t usage, uint8_t* report) const {
+        Caps caps;
+        if (!FindCaps(usagePage, usage, true, &caps))
+            return false;
+
+        const uint32_t bit = caps.StartByte * 8u + caps.StartBit + (usage - caps.UsageMin) * caps.BitSize;
+        report[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+        return true;
+    }
+
+    bool SetUsageValue(const uint16_t usagePage, const uint16_t usage, const uint32_t value, uint8_t* report) const {
+        Caps caps;
+        if (!FindCaps(usagePage, usage, false, &caps))
+            return false;
+
+        const uint32_t start = caps.StartByte * 8u + caps.StartBit;
+        for (uint32_t i = 0; i < caps.BitSize; i++) {
+            const uint32_t bit = start + i;
+            const auto mask = static_cast<uint8_t>(1u << (bit % 8));
+            if ((value >> i) & 1)
+                report[bit / 8] |= mask;
+            else
+                report[bit / 8] &= static_cast<uint8_t>(~mask);
+        }
+        return true;
+    }
+
+  private:
+    uint16_t ReadWord(const size_t offset) const {
+        return static_cast<uint16_t>(_data[offset] | (_data[offset + 1] << 8));
+    }
+
+    uint32_t ReadDword(const size_t offset) const {
+        return ReadWord(offset) | (static_cast<uint32_t>(ReadWord(offset + 2)) << 16);
+    }
+
+    bool FindCaps(const uint16_t usagePage, const uint16_t usage, const bool button, Caps* found) const {
+        const uint16_t first = ReadWord(0x10);
+        const uint16_t end = ReadWord(0x14);
+        for (uint16_t i = first; i < end; i++) {
+            const size_t offset = HEADER_SIZE + i * CAPS_SIZE;
+            const Caps caps = {
+                .UsagePage = ReadWord(offset + 0x00),
+                .StartBit = _data[offset + 0x03],
+                .BitSize = ReadWord(offset + 0x04),
+                .StartByte = ReadWord(offset + 0x08),
+                .Flags = ReadDword(offset + 0x18),
+                .UsageMin = ReadWord(offset + 0x3C),
+                .UsageMax = ReadWord(offset + 0x3E),
+            };
+
+            if (caps.UsagePage == usagePage && usage >= caps.UsageMin && usage <= caps.UsageMax &&
+                ((caps.Flags & CAPS_FLAG_BUTTON) != 0) == button) {
+                *found = caps;
+                return true;
+            }
+        }
+        return false;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "InputSource.h"
+#include <atomic>
+#include <chrono>
+
+/**
+ * Stands in for a physical controller. Every read returns the next state in a sequence, so callers can tell fresh
+ * reads from reused ones, and spins for ReadCost first to model how long XInputGetState takes.
+ */
+class SyntheticInputSource : public InputSource {
+    std::atomic<uint32_t> _reads[MAX_CONTROLLERS] = {};
+    std::atomic<uint32_t> _connectedMask;
+    std::chrono::nanoseconds _readCost;
+
+  public:
+    explicit SyntheticInputSource(const std::chrono::nanoseconds readCost = {}, const uint32_t connectedMask = 0xF)
+        : _connectedMask(connectedMask), _readCost(readCost) {}
+
+    bool GetState(const int controllerIndex, ControllerState* state) override {
+        const auto until = std::chrono::steady_clock::now() + _readCost;
+        while (_readCost.count() && std::chrono::steady_clock::now() < until) {
+        }
+
+        const uint32_t read = _reads[controllerIndex].fetch_add(1, std::memory_order_relaxed) + 1;
+        *state = {};
+        state->ButtonStates = static_cast<uint16_t>(read);
+        state->LeftThumbstickX = static_cast<int16_t>(controllerIndex);
+        return (_connectedMask.load(std::memory_order_relaxed) >> controllerIndex) & 1;
+    }
+
+    uint32_t GetReadCount(const int controllerIndex) const {
+        return _reads[controllerIndex].load(std::memory_order_relaxed);
+    }
+
+    void SetConnectedMask(const uint32_t mask) {
+        _connectedMask.store(mask, std::memory_order_relaxed);
+    }
+};
\ No newline at end of file
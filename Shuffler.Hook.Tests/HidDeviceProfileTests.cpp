@@ -0,0 +1,124 @@
+#include "EmulatedDeviceDefinitions.h"
+#include "Data/XboxOnePreparsedData.h"
+#include "Fakes/PreparsedReportWriter.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+// Paths EmulatedDeviceDefinitions.h listed literally before they were generated
+constexpr const wchar_t* XBOX_ONE_DEVICE_PATHS[] = {
+    L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e1&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+    L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e2&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+    L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e3&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+    L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e4&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+};
+
+// A DualShock 4 style layout: 8-bit axes, the hat before fourteen buttons, and the triggers as axes of their own
+constexpr HidDeviceProfile GENERIC_GAMEPAD_PROFILE = {
+    .VendorId = 0x054C,
+    .ProductId = 0x05C4,
+    .VersionNumber = 0x0100,
+    .UsagePage = 0x01,
+    .Usage = 0x05,
+    .ManufacturerString = L"Generic",
+    .ProductString = L"Gamepad",
+    .InstanceIdPrefix = "7&1b2c3d4",
+    .PhysicalCollectionCount = 1,
+    .Items = {
+        {.Type = HidItemType::Value, .Collection = 1, .UsagePage = 0x01,
+         .Usages = {HidDeviceGenerator::USAGE_X, HidDeviceGenerator::USAGE_Y, HidDeviceGenerator::USAGE_RX,
+                    HidDeviceGenerator::USAGE_RY},
+         .UsageCount = 4, .BitSize = 8, .ReportCount = 4, .LogicalMin = 0, .LogicalMax = 255, .PhysicalMax = 255},
+        {.Type = HidItemType::Value, .Collection = 0, .UsagePage = 0x01, .Usages = {HidDeviceGenerator::USAGE_HAT},
+         .UsageCount = 1, .BitSize = 4, .ReportCount = 1, .HasNullState = true, .LogicalMin = 0, .LogicalMax = 7,
+         .PhysicalMax = 315, .Units = 0x14},
+        {.Type = HidItemType::Buttons, .UsagePage = HidDeviceGenerator::USAGE_PAGE_BUTTON, .Usages = {1, 14},
+         .UsageCount = 2, .BitSize = 1, .ReportCount = 14},
+        {.Type = HidItemType::Padding, .BitSize = 6, .ReportCount = 1},
+        {.Type = HidItemType::Value, .Collection = 0, .UsagePage = 0x01, .Usages = {HidDeviceGenerator::USAGE_Z},
+         .UsageCount = 1, .BitSize = 8, .ReportCount = 1, .LogicalMin = 0, .LogicalMax = 255, .PhysicalMax = 255},
+    },
+    .ItemCount = 5,
+};
+
+constexpr auto GENERIC_PREPARSED_DATA = HidDeviceGenerator::GeneratePreparsedData<
+    HidDeviceGenerator::GetPreparsedDataSize(GENERIC_GAMEPAD_PROFILE)>(GENERIC_GAMEPAD_PROFILE);
+constexpr HidReportLayout GENERIC_LAYOUT = HidDeviceGenerator::GenerateLayout(GENERIC_GAMEPAD_PROFILE);
+
+// Sets value through the preparsed data and returns the bit range that changed in the report
+HidFieldLayout FindWrittenBits(const uint8_t* preparsedData, const uint16_t reportLength, const uint16_t usagePage,
+                               const uint16_t usage) {
+    const PreparsedReportWriter writer(preparsedData);
+    std::vector<uint8_t> report(reportLength);
+    if (usagePage == HidDeviceGenerator::USAGE_PAGE_BUTTON)
+        EXPECT_TRUE(writer.SetUsage(usagePage, usage, report.data()));
+    else
+        EXPECT_TRUE(writer.SetUsageValue(usagePage, usage, 0xFFFFFFFF, report.data()));
+
+    HidFieldLayout field = {0xFFFF, 0};
+    for (uint16_t bit = 0; bit < reportLength * 8; bit++) {
+        if (report[bit / 8] & (1u << (bit % 8))) {
+            if (field.BitOffset == 0xFFFF)
+                field.BitOffset = bit;
+            field.BitSize = static_cast<uint16_t>(bit - field.BitOffset + 1);
+        }
+    }
+    return field;
+}
+
+void ExpectLayoutMatchesPreparsedData(const HidReportLayout& layout, const uint8_t* preparsedData) {
+    const auto expectField = [&](const HidFieldLayout field, const uint16_t usage) {
+        const HidFieldLayout written = FindWrittenBits(preparsedData, layout.ReportLength, 0x01, usage);
+        EXPECT_EQ(field.BitOffset, written.BitOffset) << "usage " << usage;
+        EXPECT_EQ(field.BitSize, written.BitSize) << "usage " << usage;
+    };
+    expectField(layout.X, HidDeviceGenerator::USAGE_X);
+    expectField(layout.Y, HidDeviceGenerator::USAGE_Y);
+    expectField(layout.Z, HidDeviceGenerator::USAGE_Z);
+    expectField(layout.Rx, HidDeviceGenerator::USAGE_RX);
+    expectField(layout.Ry, HidDeviceGenerator::USAGE_RY);
+    expectField(layout.Hat, HidDeviceGenerator::USAGE_HAT);
+
+    for (uint16_t button = 0; button < layout.Buttons.BitSize; button++) {
+        const HidFieldLayout written =
+            FindWrittenBits(preparsedData, layout.ReportLength, HidDeviceGenerator::USAGE_PAGE_BUTTON, button + 1);
+        EXPECT_EQ(written.BitOffset, layout.Buttons.BitOffset + button) << "button " << button + 1;
+        EXPECT_EQ(written.BitSize, 1) << "button " << button + 1;
+    }
+}
+}
+
+TEST(HidDeviceProfileTests, GeneratedXboxOnePreparsedDataMatchesTheCapturedImage) {
+    ASSERT_EQ(EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE, sizeof(XBOX_ONE_PREPARSED_DATA));
+    for (size_t i = 0; i < sizeof(XBOX_ONE_PREPARSED_DATA); i++)
+        ASSERT_EQ(EmulatedDeviceDefinitions::PREPROCESSED_DATA[i], XBOX_ONE_PREPARSED_DATA[i]) << "offset " << i;
+}
+
+TEST(HidDeviceProfileTests, GeneratedXboxOneDevicePathsMatchTheOldPaths) {
+    for (int slot = 0; slot < EmulatedDeviceDefinitions::DEVICE_COUNT; slot++) {
+        EXPECT_EQ(std::wstring(EmulatedDeviceDefinitions::GetDevicePath(slot)),
+                  std::wstring(XBOX_ONE_DEVICE_PATHS[slot]));
+        EXPECT_EQ(EmulatedDeviceDefinitions::GetControllerIndex(XBOX_ONE_DEVICE_PATHS[slot]), slot + 1);
+    }
+}
+
+TEST(HidDeviceProfileTests, XboxOneLayoutMatchesTheCapturedImage) {
+    EXPECT_EQ(EmulatedDeviceDefinitions::REPORT_LAYOUT.ReportLength, 16);
+    ExpectLayoutMatchesPreparsedData(EmulatedDeviceDefinitions::REPORT_LAYOUT, XBOX_ONE_PREPARSED_DATA);
+}
+
+TEST(HidDeviceProfileTests, OtherProfilesGetAConsistentImageLayoutAndPath) {
+    EXPECT_EQ(GENERIC_LAYOUT.ReportLength, 9);
+    EXPECT_EQ(GENERIC_LAYOUT.Hat.BitOffset, 40);
+    EXPECT_EQ(GENERIC_LAYOUT.Buttons.BitOffset, 44);
+    EXPECT_EQ(GENERIC_LAYOUT.Buttons.BitSize, 14);
+    EXPECT_EQ(GENERIC_LAYOUT.Z.BitOffset, 64);
+    ExpectLayoutMatchesPreparsedData(GENERIC_LAYOUT, GENERIC_PREPARSED_DATA.data());
+
+    constexpr size_t length = HidDeviceGenerator::GetDevicePathLength(GENERIC_GAMEPAD_PROFILE);
+    constexpr auto path = HidDeviceGenerator::GenerateDevicePath<length>(GENERIC_GAMEPAD_PROFILE, 3);
+    EXPECT_EQ(std::wstring(path.data()),
+              L"\\\\?\\HID#VID_054C&PID_05C4&IG_00#7&1b2c3d43&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}");
+    EXPECT_EQ(path[HidDeviceGenerator::GetDevicePathNumberOffset(GENERIC_GAMEPAD_PROFILE)], L'3');
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "EmulatedDeviceDefinitions.h"
+
+#include <cwctype>
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+using EmulatedDeviceDefinitions::DEVICE_COUNT;
+using EmulatedDeviceDefinitions::DEVICE_PATH_MATCHER;
+
+constexpr size_t NUMBER_OFFSET = HidDeviceGenerator::GetDevicePathNumberOffset(EmulatedDeviceDefinitions::PROFILE);
+
+template <typename Char>
+std::basic_string<Char> Convert(const wchar_t* path) {
+    std::basic_string<Char> converted;
+    for (; *path; path++)
+        converted.push_back(static_cast<Char>(*path));
+    return converted;
+}
+
+std::wstring ControllerPath(const int number) {
+    return EmulatedDeviceDefinitions::GetDevicePath(number - 1);
+}
+}
+
+TEST(HidPathMatcherTests, MatchesEveryControllerPath) {
+    for (int number = 1; number <= DEVICE_COUNT; number++) {
+        const std::wstring path = ControllerPath(number);
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(path.c_str()), number);
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(Convert<char>(path.c_str()).c_str()), number);
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(Convert<char16_t>(path.c_str()).c_str()), number);
+    }
+}
+
+TEST(HidPathMatcherTests, IgnoresCase) {
+    std::wstring upper = ControllerPath(2);
+    std::wstring lower = upper;
+    for (auto& c : upper)
+        c = static_cast<wchar_t>(towupper(c));
+    for (auto& c : lower)
+        c = static_cast<wchar_t>(towlower(c));
+
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(upper.c_str()), 2);
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(lower.c_str()), 2);
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(Convert<char>(upper.c_str()).c_str()), 2);
+}
+
+TEST(HidPathMatcherTests, RejectsControllerNumbersOutOfRange) {
+    for (const wchar_t digit : {L'0', L'5', L'9', L'a', L'/', L':'}) {
+        std::wstring path = ControllerPath(1);
+        path[NUMBER_OFFSET] = digit;
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(path.c_str()), 0) << static_cast<char>(digit);
+    }
+}
+
+TEST(HidPathMatcherTests, RejectsTruncatedAndExtendedPaths) {
+    const std::wstring path = ControllerPath(1);
+    for (size_t length = 0; length < path.size(); length++)
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(path.substr(0, length).c_str()), 0) << length;
+
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match((path + L"\\").c_str()), 0);
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match((path + L"\\KeyboardClass").c_str()), 0);
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(static_cast<const wchar_t*>(nullptr)), 0);
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(static_cast<const char*>(nullptr)), 0);
+}
+
+TEST(HidPathMatcherTests, RejectsAnySingleCharacterChange) {
+    const std::wstring path = ControllerPath(3);
+    for (size_t i = 0; i < path.size(); i++) {
+        if (i == NUMBER_OFFSET)
+            continue;
+
+        std::wstring changed = path;
+        changed[i] = path[i] == L'x' || path[i] == L'X' ? L'y' : L'x';
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(changed.c_str()), 0) << i;
+    }
+}
+
+TEST(HidPathMatcherTests, RejectsOtherDevicesAndFiles) {
+    const wchar_t* paths[] = {
+        L"\\\\?\\HID#VID_045E&PID_0B12&IG_00#a&36fff2e1&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+        L"\\\\?\\HID#VID_054C&PID_09CC&MI_03#7&2c3c4b5d&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}",
+        L"\\\\?\\HID#VID_046D&PID_C52B&MI_00#8&1e34fb1&0&0000#{884b96c3-56ef-11d1-bc8c-00a0c91405dd}",
+        L"\\\\?\\USB#VID_045E&PID_02FF#0000000000000001#{a5dcbf10-6530-11d2-901f-00c04fb951ed}",
+        L"\\\\.\\pipe\\ShufflerHook",
+        L"C:\\Games\\Save\\profile.dat",
+        L"CONIN$",
+    };
+
+    for (const wchar_t* path : paths) {
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(path), 0) << Convert<char>(path);
+        EXPECT_EQ(DEVICE_PATH_MATCHER.Match(Convert<char>(path).c_str()), 0) << Convert<char>(path);
+    }
+}
+
+TEST(HidPathMatcherTests, DoesNotFoldCharactersOutsideAscii) {
+    // Code units that only match a pattern character when truncated to 8 bits, or under a non-ASCII case mapping
+    std::wstring path = ControllerPath(1);
+    std::wstring wide = path;
+    wide[4] = static_cast<wchar_t>(0x100 + 'H');
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(wide.c_str()), 0);
+
+    std::string narrow = Convert<char>(path.c_str());
+    narrow[4] = static_cast<char>('H' | 0x80);
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(narrow.c_str()), 0);
+}
+
+TEST(HidPathMatcherTests, ParsesNumbersForOtherCounts) {
+    constexpr size_t length = EmulatedDeviceDefinitions::DEVICE_PATH_LENGTH;
+    constexpr HidPathMatcher<length> matcher(EmulatedDeviceDefinitions::DEVICE_PATH_1, NUMBER_OFFSET, 8);
+    static_assert(matcher.Match(EmulatedDeviceDefinitions::DEVICE_PATH_4.data()) == 4);
+
+    std::wstring path = ControllerPath(1);
+    path[NUMBER_OFFSET] = L'8';
+    EXPECT_EQ(matcher.Match(path.c_str()), 8);
+    EXPECT_EQ(DEVICE_PATH_MATCHER.Match(path.c_str()), 0);
+    path[NUMBER_OFFSET] = L'9';
+    EXPECT_EQ(matcher.Match(path.c_str()), 0);
+}
\ No newline at end of file
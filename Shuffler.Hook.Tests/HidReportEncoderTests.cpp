@@ -0,0 +1,143 @@
+#include "HidReportEncoder.h"
+#include "Data/XboxOnePreparsedData.h"
+#include "Fakes/PreparsedReportWriter.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+using Report = std::array<uint8_t, HidReportEncoder::REPORT_LENGTH>;
+
+constexpr uint16_t USAGE_PAGE_GENERIC_DESKTOP = 0x01;
+constexpr uint16_t USAGE_PAGE_BUTTON = 0x09;
+
+// What RawInputHook did before the encoder: HidP_SetUsages for the pressed buttons and HidP_SetUsageValue for the hat,
+// sticks and triggers, against the preparsed data captured from the real controller
+Report EncodeReference(const ControllerState& state) {
+    const PreparsedReportWriter writer(XBOX_ONE_PREPARSED_DATA);
+    Report report = {};
+
+    // HID buttons 1-10 are A, B, X, Y, LB, RB, Back, Start, LS, RS
+    constexpr Button HID_BUTTONS[] = {Button::A,            Button::B,    Button::X,     Button::Y,
+                                      Button::LeftShoulder, Button::RightShoulder, Button::Back, Button::Start,
+                                      Button::LeftThumbstick, Button::RightThumbstick};
+    for (uint16_t i = 0; i < std::size(HID_BUTTONS); i++) {
+        if (state.ButtonStates & static_cast<uint16_t>(HID_BUTTONS[i]))
+            writer.SetUsage(USAGE_PAGE_BUTTON, static_cast<uint16_t>(i + 1), report.data());
+    }
+
+    const bool up = state.Bits.DpadUp, down = state.Bits.DpadDown;
+    const bool left = state.Bits.DpadLeft, right = state.Bits.DpadRight;
+    uint32_t hat = 0;
+    if (up && right)
+        hat = 2;
+    else if (down && right)
+        hat = 4;
+    else if (down && left)
+        hat = 6;
+    else if (up && left)
+        hat = 8;
+    else if (up)
+        hat = 1;
+    else if (right)
+        hat = 3;
+    else if (down)
+        hat = 5;
+    else if (left)
+        hat = 7;
+    if (hat)
+        writer.SetUsageValue(USAGE_PAGE_GENERIC_DESKTOP, HidDeviceGenerator::USAGE_HAT, hat, report.data());
+
+    const auto remapAxis = [](const int32_t value) { return static_cast<uint32_t>(std::clamp(value + 0x7FFF, 0, 0xFFFF)); };
+    writer.SetUsageValue(USAGE_PAGE_GENERIC_DESKTOP, HidDeviceGenerator::USAGE_X, remapAxis(state.LeftThumbstickX),
+                         report.data());
+    writer.SetUsageValue(USAGE_PAGE_GENERIC_DESKTOP, HidDeviceGenerator::USAGE_Y, remapAxis(-state.LeftThumbstickY),
+                         report.data());
+    writer.SetUsageValue(USAGE_PAGE_GENERIC_DESKTOP, HidDeviceGenerator::USAGE_RX, remapAxis(state.RightThumbstickX),
+                         report.data());
+    writer.SetUsageValue(USAGE_PAGE_GENERIC_DESKTOP, HidDeviceGenerator::USAGE_RY, remapAxis(-state.RightThumbstickY),
+                         report.data());
+
+    const int32_t triggers = 0x7FFF - state.RightTrigger * 128 + state.LeftTrigger * 128;
+    writer.SetUsageValue(USAGE_PAGE_GENERIC_DESKTOP, HidDeviceGenerator::USAGE_Z,
+                         static_cast<uint32_t>(std::clamp(triggers, 0, 0xFFFF)), report.data());
+    return report;
+}
+
+Report Encode(const ControllerState& state) {
+    Report report;
+    report.fill(0xCC);  // The encoder must write every byte, not rely on a zeroed buffer
+    HidReportEncoder::Encode(state, report.data());
+    return report;
+}
+
+std::string ToHex(const Report& report) {
+    std::string hex;
+    for (const uint8_t byte : report) {
+        constexpr char digits[] = "0123456789ABCDEF";
+        hex += digits[byte >> 4];
+        hex += digits[byte & 0xF];
+        hex += ' ';
+    }
+    return hex;
+}
+}
+
+TEST(HidReportEncoderTests, MatchesRecordedReports) {
+    // Neutral state: sticks and triggers centered, nothing pressed
+    EXPECT_EQ(ToHex(Encode({})), ToHex({0x00, 0xFF, 0x7F, 0xFF, 0x7F, 0xFF, 0x7F, 0xFF, 0x7F, 0xFF, 0x7F, 0x00, 0x00,
+                                        0x00, 0x00, 0x00}));
+
+    // A and D-pad up held, left stick fully right and down, left trigger fully pressed
+    ControllerState state = {};
+    state.ButtonStates = static_cast<uint16_t>(Button::A) | static_cast<uint16_t>(Button::DPadUp);
+    state.LeftThumbstickX = 32767;
+    state.LeftThumbstickY = -32768;
+    state.LeftTrigger = 255;
+    EXPECT_EQ(ToHex(Encode(state)), ToHex({0x00, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0x7F, 0x7F, 0xFF, 0x01,
+                                           0x00, 0x01, 0x00, 0x00}));
+
+    // Every button and every D-pad direction at once, right stick fully left and up, right trigger fully pressed
+    state = {};
+    state.ButtonStates = 0xF3FF;
+    state.RightThumbstickX = -32768;
+    state.RightThumbstickY = 32767;
+    state.RightTrigger = 255;
+    EXPECT_EQ(ToHex(Encode(state)), ToHex({0x00, 0xFF, 0x7F, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x00, 0xFF,
+                                           0x03, 0x02, 0x00, 0x00}));
+}
+
+TEST(HidReportEncoderTests, MatchesHidPForEveryButtonAndHatCombination) {
+    for (uint32_t buttons = 0; buttons <= 0xFFFF; buttons++) {
+        ControllerState state = {};
+        state.ButtonStates = static_cast<uint16_t>(buttons);
+        ASSERT_EQ(ToHex(Encode(state)), ToHex(EncodeReference(state))) << "buttons " << buttons;
+    }
+}
+
+TEST(HidReportEncoderTests, MatchesHidPForEveryAxisCombination) {
+    constexpr int16_t STICK_VALUES[] = {-32768, -32767, -16384, -1, 0, 1, 16384, 32766, 32767};
+    constexpr uint8_t TRIGGER_VALUES[] = {0, 1, 30, 31, 127, 128, 254, 255};
+
+    for (const int16_t x : STICK_VALUES) {
+        for (const int16_t y : STICK_VALUES) {
+            for (const int16_t rx : STICK_VALUES) {
+                for (const int16_t ry : STICK_VALUES) {
+                    for (const uint8_t left : TRIGGER_VALUES) {
+                        for (const uint8_t right : TRIGGER_VALUES) {
+                            ControllerState state = {};
+                            state.LeftThumbstickX = x;
+                            state.LeftThumbstickY = y;
+                            state.RightThumbstickX = rx;
+                            state.RightThumbstickY = ry;
+                            state.LeftTrigger = left;
+                            state.RightTrigger = right;
+                            ASSERT_EQ(Encode(state), EncodeReference(state))
+                                << x << " " << y << " " << rx << " " << ry << " " << +left << " " << +right;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
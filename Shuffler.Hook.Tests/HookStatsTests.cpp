@@ -0,0 +1,171 @@
+#include "HookStats.h"
+
+#include <array>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr size_t HOOK_COUNT = static_cast<size_t>(HookId::Count);
+
+uint64_t TicksFor(const uint32_t thread, const uint32_t call) {
+    // Spread over small and large buckets, including ones past 2^32
+    return (static_cast<uint64_t>(call) * 2654435761u + thread) >> (call % 40);
+}
+
+// Copies page the way the controlling process does, retrying while the publisher is writing
+void ReadConsistent(const HookStatsPage* page, HookStatsPage* copy) {
+    while (true) {
+        const uint32_t before = page->Sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        for (size_t hook = 0; hook < HOOK_COUNT; hook++)
+            copy->Hooks[hook] = page->Hooks[hook];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (page->Sequence.load(std::memory_order_relaxed) == before)
+            return;
+    }
+}
+}
+
+TEST(HookStatsTests, BucketsHoldValuesWithinAnEighth) {
+    using Buckets = HookLatencyBuckets;
+    std::mt19937_64 random(9);
+    uint32_t previousBucket = 0;
+
+    for (uint64_t i = 0; i < (1 << 20); i++) {
+        const uint64_t ticks = i < (1 << 16) ? i : random() >> (random() % 64);
+        const uint32_t bucket = Buckets::GetBucket(ticks);
+        ASSERT_LT(bucket, Buckets::BUCKET_COUNT);
+        if (i < (1 << 16)) {
+            ASSERT_GE(bucket, previousBucket) << ticks;
+            previousBucket = bucket;
+        }
+
+        if (ticks >> 32) {
+            EXPECT_EQ(bucket, Buckets::BUCKET_COUNT - 1);
+            continue;
+        }
+
+        const uint64_t start = Buckets::GetBucketStart(bucket);
+        const uint64_t end = Buckets::GetBucketStart(bucket + 1);
+        ASSERT_LE(start, ticks);
+        ASSERT_LT(ticks, end);
+        ASSERT_LE((end - start) * Buckets::SUB_BUCKET_COUNT, std::max<uint64_t>(start, Buckets::SUB_BUCKET_COUNT));
+    }
+}
+
+TEST(HookStatsTests, AggregatesEveryShardUnderContention) {
+    // More threads than shards, so some threads share one
+    constexpr uint32_t THREADS = 40;
+    constexpr uint32_t CALLS_PER_THREAD = 50000;
+
+    auto page = std::make_unique<HookStatsPage>();
+    HookStats::Aggregate(page.get());
+    auto before = std::make_unique<HookStatsPage>();
+    ReadConsistent(page.get(), before.get());
+
+    std::atomic<bool> stop = false;
+    bool monotonic = true;
+    uint32_t aggregations = 0;
+    std::thread aggregator([&] {
+        auto previous = std::make_unique<HookStatsPage>();
+        ReadConsistent(page.get(), previous.get());
+        while (!stop.load(std::memory_order_relaxed)) {
+            HookStats::Aggregate(page.get());
+            monotonic &= (page->Sequence.load(std::memory_order_relaxed) & 1) == 0;
+            for (size_t hook = 0; hook < HOOK_COUNT; hook++) {
+                const HookStatsEntry& entry = page->Hooks[hook];
+                monotonic &= entry.Calls >= previous->Hooks[hook].Calls;
+                monotonic &= entry.TotalTicks >= previous->Hooks[hook].TotalTicks;
+                for (uint32_t bucket = 0; bucket < HookLatencyBuckets::BUCKET_COUNT; bucket++)
+                    monotonic &= entry.Buckets[bucket] >= previous->Hooks[hook].Buckets[bucket];
+                previous->Hooks[hook] = entry;
+            }
+            aggregations++;
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < THREADS; thread++) {
+        threads.emplace_back([thread] {
+            for (uint32_t call = 0; call < CALLS_PER_THREAD; call++)
+                HookStats::Record(static_cast<HookId>((thread + call) % HOOK_COUNT), TicksFor(thread, call));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    stop = true;
+    aggregator.join();
+
+    // Expected totals, computed single-threaded
+    auto expected = std::make_unique<HookStatsPage>();
+    for (uint32_t thread = 0; thread < THREADS; thread++) {
+        for (uint32_t call = 0; call < CALLS_PER_THREAD; call++) {
+            HookStatsEntry& entry = expected->Hooks[(thread + call) % HOOK_COUNT];
+            const uint64_t ticks = TicksFor(thread, call);
+            entry.Calls++;
+            entry.TotalTicks += ticks;
+            entry.Buckets[HookLatencyBuckets::GetBucket(ticks)]++;
+        }
+    }
+
+    HookStats::Aggregate(page.get());
+    EXPECT_TRUE(monotonic);
+    EXPECT_GT(aggregations, 0u);
+    for (size_t hook = 0; hook < HOOK_COUNT; hook++) {
+        const HookStatsEntry& entry = page->Hooks[hook];
+        EXPECT_EQ(entry.Calls - before->Hooks[hook].Calls, expected->Hooks[hook].Calls) << hook;
+        EXPECT_EQ(entry.TotalTicks - before->Hooks[hook].TotalTicks, expected->Hooks[hook].TotalTicks) << hook;
+        for (uint32_t bucket = 0; bucket < HookLatencyBuckets::BUCKET_COUNT; bucket++) {
+            ASSERT_EQ(entry.Buckets[bucket] - before->Hooks[hook].Buckets[bucket],
+                      expected->Hooks[hook].Buckets[bucket])
+                << hook << " " << bucket;
+        }
+    }
+}
+
+TEST(HookStatsTests, PublishesToPageTheControllerMapsByName) {
+    ASSERT_TRUE(HookStats::Init());
+
+    const std::wstring name = L"Local\\ShufflerHookStats_" + std::to_wstring(GetCurrentProcessId());
+    const HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, name.c_str());
+    ASSERT_NE(mapping, nullptr);
+    const auto* page =
+        static_cast<const HookStatsPage*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(HookStatsPage)));
+    ASSERT_NE(page, nullptr);
+
+    EXPECT_EQ(page->Magic, HookStatsPage::MAGIC);
+    EXPECT_EQ(page->Version, HookStatsPage::VERSION);
+    EXPECT_EQ(page->HookCount, HOOK_COUNT);
+    EXPECT_EQ(page->BucketCount, HookLatencyBuckets::BUCKET_COUNT);
+    EXPECT_EQ(page->ProcessId, GetCurrentProcessId());
+    EXPECT_GT(page->TimestampFrequency, 0);
+
+    std::thread([] {
+        for (int i = 0; i < 1000; i++)
+            HOOK_STATS_SCOPE(HookId::CloseHandle);
+    }).join();
+
+    auto copy = std::make_unique<HookStatsPage>();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ReadConsistent(page, copy.get());
+    } while (copy->Hooks[static_cast<size_t>(HookId::CloseHandle)].Calls < 1000 &&
+             std::chrono::steady_clock::now() < deadline);
+
+    const HookStatsEntry& entry = copy->Hooks[static_cast<size_t>(HookId::CloseHandle)];
+    EXPECT_EQ(entry.Calls, 1000u);
+    uint64_t bucketed = 0;
+    for (const uint64_t count : entry.Buckets)
+        bucketed += count;
+    EXPECT_EQ(bucketed, 1000u);
+
+    UnmapViewOfFile(page);
+    CloseHandle(mapping);
+    HookStats::Shutdown();
+}
\ No newline at end of file
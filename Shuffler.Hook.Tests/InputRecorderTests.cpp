@@ -0,0 +1,188 @@
+#include "InputRecorder.h"
+
+#include <atomic>
+#include <fcntl.h>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+constexpr size_t HEADER_SIZE = 128;
+constexpr size_t RECORD_SIZE = 32;
+constexpr size_t SEQUENCE_OFFSET = 8;
+
+ControllerState MakeState(const uint16_t value) {
+    ControllerState state = {};
+    state.ButtonStates = value;
+    state.LeftThumbstickX = state.LeftThumbstickY = static_cast<int16_t>(value);
+    state.RightThumbstickX = state.RightThumbstickY = static_cast<int16_t>(value);
+    return state;
+}
+
+/**
+ * Reads a recording through the file, not the mapping, at the offsets Shuffler.Hook.RecordingDecoder uses.
+ */
+class RecordingFile {
+    int _descriptor;
+
+  public:
+    explicit RecordingFile(const std::filesystem::path& path) : _descriptor(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {}
+
+    ~RecordingFile() {
+        close(_descriptor);
+    }
+
+    RecordingFile(const RecordingFile&) = delete;
+    RecordingFile& operator=(const RecordingFile&) = delete;
+
+    template <typename T>
+    T ReadAt(const size_t offset) const {
+        T value = {};
+        EXPECT_EQ(pread(_descriptor, &value, sizeof(value), static_cast<off_t>(offset)),
+                  static_cast<ssize_t>(sizeof(value)));
+        return value;
+    }
+
+    // Like the decoder: the sequence before and after reading the record must both be index + 1
+    bool ReadRecord(const uint64_t index, InputRecord* record) const {
+        const size_t position = HEADER_SIZE + (index % ReadAt<uint32_t>(8)) * RECORD_SIZE;
+        const auto expected = static_cast<uint32_t>(index + 1);
+        const uint32_t before = ReadAt<uint32_t>(position + SEQUENCE_OFFSET);
+        *record = ReadAt<InputRecord>(position);
+        const uint32_t after = ReadAt<uint32_t>(position + SEQUENCE_OFFSET);
+        return before == expected && record->Sequence == expected && after == expected;
+    }
+};
+
+class InputRecorderTests : public testing::Test {
+  protected:
+    std::filesystem::path _path;
+
+    void SetUp() override {
+        _path = std::filesystem::temp_directory_path() /
+                ("InputRecorderTests." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())));
+    }
+
+    void TearDown() override {
+        InputRecorder::Shutdown();
+        std::error_code error;
+        std::filesystem::remove(_path, error);
+    }
+};
+}
+
+TEST_F(InputRecorderTests, HeaderLayoutMatchesTheDecoder) {
+    ASSERT_TRUE(InputRecorder::Init(_path.wstring(), 8));
+    EXPECT_EQ(std::filesystem::file_size(_path), HEADER_SIZE + 8 * RECORD_SIZE);
+
+    const RecordingFile file(_path);
+    EXPECT_EQ(file.ReadAt<uint32_t>(0), InputRecordHeader::MAGIC);
+    EXPECT_EQ(file.ReadAt<uint16_t>(4), InputRecordHeader::VERSION);
+    EXPECT_EQ(file.ReadAt<uint16_t>(6), RECORD_SIZE);
+    EXPECT_EQ(file.ReadAt<uint32_t>(8), 8u);
+    EXPECT_EQ(file.ReadAt<uint32_t>(12), GetCurrentProcessId());
+    EXPECT_GT(file.ReadAt<int64_t>(16), 0);
+    EXPECT_EQ(file.ReadAt<uint64_t>(64), 0u);
+
+    InputRecorder::Record(InputApi::Hid, 2, 3, MakeState(0x1234));
+    EXPECT_EQ(file.ReadAt<uint64_t>(64), 1u);
+
+    // Record 0 at the offsets the decoder reads its fields from
+    InputRecord record;
+    ASSERT_TRUE(file.ReadRecord(0, &record));
+    EXPECT_GE(record.Timestamp, file.ReadAt<int64_t>(24));
+    EXPECT_EQ(file.ReadAt<uint8_t>(HEADER_SIZE + 12), static_cast<uint8_t>(InputApi::Hid));
+    EXPECT_EQ(file.ReadAt<uint8_t>(HEADER_SIZE + 13), 2);
+    EXPECT_EQ(file.ReadAt<uint8_t>(HEADER_SIZE + 14), 3);
+    EXPECT_EQ(file.ReadAt<uint16_t>(HEADER_SIZE + 16), 0x1234);
+    EXPECT_EQ(file.ReadAt<int16_t>(HEADER_SIZE + 20), 0x1234);
+}
+
+TEST_F(InputRecorderTests, RejectsCapacitiesThatAreNotPowersOfTwo) {
+    EXPECT_FALSE(InputRecorder::Init(_path.wstring(), 0));
+    EXPECT_FALSE(InputRecorder::Init(_path.wstring(), 12));
+}
+
+TEST_F(InputRecorderTests, KeepsTheLastLapAfterWrapping) {
+    constexpr uint32_t capacity = 8;
+    constexpr uint64_t count = 3 * capacity - 3;
+    ASSERT_TRUE(InputRecorder::Init(_path.wstring(), capacity));
+    for (uint64_t i = 0; i < count; i++)
+        InputRecorder::Record(InputApi::XInput, 0, 0, MakeState(static_cast<uint16_t>(i)));
+
+    const RecordingFile file(_path);
+    ASSERT_EQ(file.ReadAt<uint64_t>(64), count);
+
+    InputRecord record;
+    for (uint64_t index = count - capacity; index < count; index++) {
+        ASSERT_TRUE(file.ReadRecord(index, &record)) << index;
+        EXPECT_EQ(record.State.ButtonStates, index);
+    }
+
+    // The laps before were overwritten, their sequences no longer match
+    for (uint64_t index = 0; index < count - capacity; index++)
+        EXPECT_FALSE(file.ReadRecord(index, &record)) << index;
+}
+
+TEST_F(InputRecorderTests, SkipsRecordsWhoseSequenceDoesNotMatch) {
+    ASSERT_TRUE(InputRecorder::Init(_path.wstring(), 8));
+    for (uint16_t i = 0; i < 3; i++)
+        InputRecorder::Record(InputApi::RawInput, 0, 0, MakeState(i));
+
+    // A record a writer is still in the middle of has its sequence cleared, one never written has none
+    const int descriptor = open(_path.c_str(), O_RDWR | O_CLOEXEC);
+    const uint32_t cleared = 0;
+    ASSERT_EQ(pwrite(descriptor, &cleared, sizeof(cleared), HEADER_SIZE + RECORD_SIZE + SEQUENCE_OFFSET),
+              static_cast<ssize_t>(sizeof(cleared)));
+    close(descriptor);
+
+    const RecordingFile file(_path);
+    InputRecord record;
+    EXPECT_TRUE(file.ReadRecord(0, &record));
+    EXPECT_FALSE(file.ReadRecord(1, &record));
+    EXPECT_TRUE(file.ReadRecord(2, &record));
+    EXPECT_FALSE(file.ReadRecord(3, &record));
+}
+
+TEST_F(InputRecorderTests, RacingLapsNeverPassATornRecord) {
+    // A tiny ring, so writers lap the reader all the time
+    constexpr uint32_t capacity = 4;
+    ASSERT_TRUE(InputRecorder::Init(_path.wstring(), capacity));
+
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < 2; writer++) {
+        writers.emplace_back([&stop] {
+            for (uint16_t value = 0; !stop.load(std::memory_order_relaxed); value++)
+                InputRecorder::Record(InputApi::XInput, 0, 0, MakeState(value));
+        });
+    }
+
+    const RecordingFile file(_path);
+    int accepted = 0;
+    int torn = 0;
+    for (int pass = 0; pass < 20000; pass++) {
+        const uint64_t next = file.ReadAt<uint64_t>(64);
+        for (uint64_t index = next > capacity ? next - capacity : 0; index < next; index++) {
+            InputRecord record;
+            if (!file.ReadRecord(index, &record))
+                continue;
+
+            // Every field of a record comes from one value, a mix of two means it was torn
+            const ControllerState& state = record.State;
+            const auto value = static_cast<int16_t>(state.ButtonStates);
+            accepted++;
+            torn += state.LeftThumbstickX != value || state.LeftThumbstickY != value ||
+                    state.RightThumbstickX != value || state.RightThumbstickY != value;
+        }
+    }
+
+    stop = true;
+    for (auto& writer : writers)
+        writer.join();
+
+    EXPECT_GT(accepted, 0);
+    EXPECT_EQ(torn, 0);
+}
\ No newline at end of file
@@ -0,0 +1,350 @@
+#include "InputSource.h"
+#include "InputStream.h"
+#include "InputStreamRecorder.h"
+#include "Fakes/InputSession.h"
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+bool SameState(const ControllerState& a, const ControllerState& b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// What a reader gives back for samples: consecutive repeats are not encoded
+std::vector<InputStreamSample> Distinct(const std::vector<InputStreamSample>& samples) {
+    std::vector<InputStreamSample> distinct;
+    for (const auto& sample : samples) {
+        if (distinct.empty() || !SameState(distinct.back().State, sample.State) ||
+            distinct.back().Connected != sample.Connected)
+            distinct.push_back(sample);
+    }
+    return distinct;
+}
+
+std::vector<InputStreamSample> ReadAll(InputStreamReader& reader) {
+    std::vector<InputStreamSample> samples;
+    InputStreamSample sample;
+    while (reader.Next(&sample))
+        samples.push_back(sample);
+    return samples;
+}
+
+void ExpectSamples(const std::vector<InputStreamSample>& actual, const std::vector<InputStreamSample>& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); i++) {
+        ASSERT_EQ(actual[i].Timestamp, expected[i].Timestamp) << "sample " << i;
+        ASSERT_TRUE(SameState(actual[i].State, expected[i].State)) << "sample " << i;
+        ASSERT_EQ(actual[i].Connected, expected[i].Connected) << "sample " << i;
+    }
+}
+
+// Offsets of the block headers in an encoded stream
+std::vector<size_t> GetBlockOffsets(const std::vector<uint8_t>& data) {
+    std::vector<size_t> offsets;
+    for (size_t offset = sizeof(InputStreamHeader); offset < data.size();) {
+        InputStreamBlockHeader block;
+        memcpy(&block, data.data() + offset, sizeof(block));
+        offsets.push_back(offset);
+        offset += sizeof(block) + block.Size;
+    }
+    return offsets;
+}
+
+class TempFile {
+    std::filesystem::path _path;
+
+  public:
+    explicit TempFile(const char* name)
+        : _path(std::filesystem::temp_directory_path() /
+                (std::string(name) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())))) {}
+
+    ~TempFile() {
+        std::error_code error;
+        std::filesystem::remove(_path, error);
+    }
+
+    std::wstring GetPath() const {
+        return _path.wstring();
+    }
+
+    void Write(const std::vector<uint8_t>& data) const {
+        std::ofstream(_path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()),
+                                                     static_cast<std::streamsize>(data.size()));
+    }
+
+    std::vector<uint8_t> Read() const {
+        std::ifstream file(_path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+};
+}
+
+TEST(InputStreamTests, RoundTripsSessionsAcrossBlocks) {
+    for (const uint16_t keyframeInterval : {1, 7, 256}) {
+        const auto samples = InputSession::Make(keyframeInterval, 5000);
+        const auto data = InputSession::Encode(samples, keyframeInterval);
+
+        InputStreamReader reader;
+        ASSERT_TRUE(reader.Open(data));
+        EXPECT_EQ(reader.GetHeader().KeyframeInterval, keyframeInterval);
+        EXPECT_GT(reader.GetBlockCount(), 1u);
+        EXPECT_EQ(reader.GetFirstTimestamp(), samples.front().Timestamp);
+        ExpectSamples(ReadAll(reader), Distinct(samples));
+    }
+}
+
+TEST(InputStreamTests, EncodesOnlyChanges) {
+    InputStreamEncoder encoder(16);
+    ControllerState state = {};
+    state.LeftThumbstickX = 1000;
+
+    EXPECT_TRUE(encoder.Add(1, state, true));
+    EXPECT_FALSE(encoder.Add(2, state, true));
+    EXPECT_TRUE(encoder.Add(3, state, false));
+    state.Bits.DpadUp = 1;
+    EXPECT_TRUE(encoder.Add(4, state, false));
+    EXPECT_FALSE(encoder.IsBlockFull());
+
+    // A one button change costs a tick delta, the flags and one field
+    const auto block = encoder.FinishBlock();
+    EXPECT_EQ(block.size(), sizeof(InputStreamBlockHeader) + 2 + 3);
+    EXPECT_TRUE(encoder.IsBlockEmpty());
+}
+
+TEST(InputStreamTests, ClampsTimestampsThatGoBackwards) {
+    InputStreamEncoder encoder(16);
+    ControllerState state = {};
+    encoder.Add(100, state, true);
+    state.LeftTrigger = 1;
+    encoder.Add(90, state, true);
+    state.LeftTrigger = 2;
+    encoder.Add(110, state, true);
+
+    std::vector<uint8_t> data(sizeof(InputStreamHeader));
+    const InputStreamHeader header = {InputStreamHeader::MAGIC, InputStreamHeader::VERSION, 16, 1, 100};
+    memcpy(data.data(), &header, sizeof(header));
+    const auto block = encoder.FinishBlock();
+    data.insert(data.end(), block.begin(), block.end());
+
+    InputStreamReader reader;
+    ASSERT_TRUE(reader.Open(data));
+    const auto samples = ReadAll(reader);
+    ASSERT_EQ(samples.size(), 3u);
+    EXPECT_EQ(samples[0].Timestamp, 100);
+    EXPECT_EQ(samples[1].Timestamp, 100);
+    EXPECT_EQ(samples[2].Timestamp, 110);
+}
+
+TEST(InputStreamTests, RejectsOtherFiles) {
+    auto data = InputSession::Encode(InputSession::Make(1, 10), 16);
+    InputStreamReader reader;
+
+    EXPECT_FALSE(reader.Open(std::span(data).first(sizeof(InputStreamHeader) - 1)));
+    data[0] ^= 1;
+    EXPECT_FALSE(reader.Open(data));
+    data[0] ^= 1;
+    data[offsetof(InputStreamHeader, Version)]++;
+    EXPECT_FALSE(reader.Open(data));
+}
+
+TEST(InputStreamTests, CorruptRecordSkipsTheRestOfItsBlock) {
+    const auto samples = Distinct(InputSession::Make(2, 1000));
+    auto data = InputSession::Encode(samples, 64);
+    const auto offsets = GetBlockOffsets(data);
+    ASSERT_GT(offsets.size(), 3u);
+
+    // A varint that never ends in the second block
+    InputStreamBlockHeader block;
+    memcpy(&block, data.data() + offsets[1], sizeof(block));
+    std::fill_n(data.begin() + static_cast<ptrdiff_t>(offsets[1] + sizeof(block)), block.Size, 0xFF);
+
+    InputStreamReader reader;
+    ASSERT_TRUE(reader.Open(data));
+    const auto decoded = ReadAll(reader);
+
+    // The keyframe of the corrupt block still decodes, its records are lost
+    std::vector<InputStreamSample> expected(samples.begin(), samples.begin() + 65 + 1);
+    expected.insert(expected.end(), samples.begin() + 2 * 65, samples.end());
+    ExpectSamples(decoded, expected);
+}
+
+TEST(InputStreamTests, RecordClaimingTooManyFieldsSkipsTheRestOfItsBlock) {
+    const auto samples = Distinct(InputSession::Make(3, 200));
+    auto data = InputSession::Encode(samples, 64);
+    const auto offsets = GetBlockOffsets(data);
+
+    // The last record of the first block claims every field changed, running out of bytes halfway
+    InputStreamBlockHeader block;
+    memcpy(&block, data.data() + offsets[0], sizeof(block));
+    size_t record = offsets[0] + sizeof(block);
+    const uint8_t* end = data.data() + record + block.Size;
+    for (uint32_t i = 0; i + 1 < block.Count; i++) {
+        uint64_t value;
+        const uint8_t* in = InputStreamCodec::ReadVarint(data.data() + record, end, &value);
+        const uint8_t flags = *in++;
+        for (int field = 0; field < InputStreamCodec::FIELD_COUNT; field++) {
+            if (flags & (1 << field))
+                in = InputStreamCodec::ReadVarint(in, end, &value);
+        }
+        record = in - data.data();
+    }
+    uint64_t delta;
+    const uint8_t* flags = InputStreamCodec::ReadVarint(data.data() + record, end, &delta);
+    data[flags - data.data()] = 0xBF;
+
+    InputStreamReader reader;
+    ASSERT_TRUE(reader.Open(data));
+    std::vector<InputStreamSample> expected(samples.begin(), samples.begin() + 64);
+    expected.insert(expected.end(), samples.begin() + 65, samples.end());
+    ExpectSamples(ReadAll(reader), expected);
+}
+
+TEST(InputStreamTests, TruncatedBlockEndsTheStream) {
+    const auto samples = Distinct(InputSession::Make(4, 1000));
+    const auto data = InputSession::Encode(samples, 64);
+    const auto offsets = GetBlockOffsets(data);
+
+    // Cut inside the header and inside the records of the fourth block, as a crash mid-write would
+    for (const size_t cut : {offsets[3] + 5, offsets[3] + sizeof(InputStreamBlockHeader) + 3}) {
+        InputStreamReader reader;
+        ASSERT_TRUE(reader.Open(std::span(data).first(cut)));
+        EXPECT_EQ(reader.GetBlockCount(), 3u);
+        ExpectSamples(ReadAll(reader), std::vector(samples.begin(), samples.begin() + 3 * 65));
+    }
+}
+
+TEST(InputStreamTests, SeeksToTheBlockHoldingATimestamp) {
+    const auto samples = Distinct(InputSession::Make(5, 2000));
+    const auto data = InputSession::Encode(samples, 100);
+
+    InputStreamReader reader;
+    ASSERT_TRUE(reader.Open(data));
+    const size_t blockCount = reader.GetBlockCount();
+    ASSERT_GT(blockCount, 5u);
+
+    const auto expectNextIs = [&](const size_t index) {
+        InputStreamSample sample;
+        ASSERT_TRUE(reader.Next(&sample));
+        EXPECT_EQ(sample.Timestamp, samples[index].Timestamp);
+        EXPECT_TRUE(SameState(sample.State, samples[index].State));
+    };
+
+    for (size_t block = 0; block < blockCount; block++) {
+        const size_t first = block * 101;
+        reader.Seek(samples[first].Timestamp);
+        expectNextIs(first);
+
+        const size_t middle = std::min(first + 50, samples.size() - 1);
+        reader.Seek(samples[middle].Timestamp);
+        expectNextIs(first);
+        for (size_t i = first + 1; i <= middle; i++)
+            expectNextIs(i);
+    }
+
+    reader.Seek(INT64_MIN);
+    expectNextIs(0);
+    reader.Seek(INT64_MAX);
+    expectNextIs((blockCount - 1) * 101);
+}
+
+TEST(InputStreamTests, ReplayPlaysTheSessionBack) {
+    const auto samples = Distinct(InputSession::Make(6, 1000));
+    TempFile file("ReplayPlaysTheSessionBack");
+    file.Write(InputSession::Encode(samples, 256));
+
+    ReplayInputSource replay;
+    ControllerState state;
+    EXPECT_FALSE(replay.GetState(0, &state));
+
+    // A second of input at 1000x plays back in a millisecond, and every state read is one the session went through,
+    // in order
+    ASSERT_TRUE(replay.Open(file.GetPath(), 1000, false));
+    size_t position = 0;
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (position + 1 < samples.size() && std::chrono::steady_clock::now() < deadline) {
+        const bool connected = replay.GetState(3, &state);
+        while (position < samples.size() &&
+               (!SameState(samples[position].State, state) || samples[position].Connected != connected))
+            position++;
+        ASSERT_LT(position, samples.size());
+    }
+
+    EXPECT_EQ(position + 1, samples.size());
+    EXPECT_EQ(replay.GetState(0, &state), samples.back().Connected);
+    EXPECT_TRUE(SameState(state, samples.back().State));
+}
+
+TEST(InputStreamTests, ReplayLoops) {
+    const auto samples = Distinct(InputSession::Make(7, 50));
+    TempFile file("ReplayLoops");
+    file.Write(InputSession::Encode(samples, 16));
+
+    ReplayInputSource replay;
+    ASSERT_TRUE(replay.Open(file.GetPath(), 1000, true));
+
+    // 50 ms of input replays in 50 us, then starts over
+    bool sawEnd = false;
+    bool sawStartAgain = false;
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    ControllerState state;
+    while (!sawStartAgain && std::chrono::steady_clock::now() < deadline) {
+        replay.GetState(0, &state);
+        if (SameState(state, samples.back().State))
+            sawEnd = true;
+        else if (sawEnd && SameState(state, samples.front().State))
+            sawStartAgain = true;
+    }
+    EXPECT_TRUE(sawStartAgain);
+}
+
+TEST(InputStreamTests, ReplayRejectsMissingAndForeignFiles) {
+    TempFile file("ReplayRejectsMissingAndForeignFiles");
+    ReplayInputSource replay;
+    EXPECT_FALSE(replay.Open(file.GetPath(), 1, false));
+
+    file.Write(std::vector<uint8_t>(64, 0x5A));
+    EXPECT_FALSE(replay.Open(file.GetPath(), 1, false));
+    ControllerState state;
+    EXPECT_FALSE(replay.GetState(0, &state));
+}
+
+TEST(InputStreamTests, RecorderWritesADecodableStream) {
+    TempFile file("RecorderWritesADecodableStream");
+    const auto samples = Distinct(InputSession::Make(8, 3000));
+
+    InputStreamRecorder::Record(samples[0].State, true);  // Not recording yet
+    ASSERT_TRUE(InputStreamRecorder::Start(file.GetPath()));
+    for (const auto& sample : samples) {
+        InputStreamRecorder::Record(sample.State, sample.Connected);
+        InputStreamRecorder::Record(sample.State, sample.Connected);
+    }
+    InputStreamRecorder::Stop();
+    InputStreamRecorder::Record(samples[0].State, true);  // Not recording anymore
+
+    const auto data = file.Read();
+    InputStreamReader reader;
+    ASSERT_TRUE(reader.Open(data));
+    EXPECT_GT(reader.GetBlockCount(), 10u);
+
+    const auto decoded = ReadAll(reader);
+    ASSERT_EQ(decoded.size(), samples.size());
+    for (size_t i = 0; i < decoded.size(); i++) {
+        ASSERT_TRUE(SameState(decoded[i].State, samples[i].State)) << "sample " << i;
+        ASSERT_EQ(decoded[i].Connected, samples[i].Connected) << "sample " << i;
+    }
+    for (size_t i = 1; i < decoded.size(); i++)
+        ASSERT_GE(decoded[i].Timestamp, decoded[i - 1].Timestamp);
+
+    // Recording again replaces the file
+    ASSERT_TRUE(InputStreamRecorder::Start(file.GetPath()));
+    InputStreamRecorder::Record(samples[0].State, true);
+    InputStreamRecorder::Stop();
+    const auto replaced = file.Read();
+    ASSERT_TRUE(reader.Open(replaced));
+    EXPECT_EQ(ReadAll(reader).size(), 1u);
+}
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "IpcProtocol.h"
+
+#include "Fakes/IpcFrames.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+bool Parse(const std::vector<uint8_t>& frame, IpcMessage* message = nullptr) {
+    IpcMessage parsed;
+    return IpcMessage::TryParse(frame, message ? message : &parsed);
+}
+
+std::vector<ActionMapping> Collect(const IpcPlayerMappings& mappings) {
+    std::vector<ActionMapping> result;
+    for (size_t i = 0; i < mappings.GetCount(); i++)
+        result.push_back(mappings[i]);
+    return result;
+}
+
+IpcSetAnalogSettings MakeAnalogSettings() {
+    IpcSetAnalogSettings settings = {};
+    settings.PlayerIndex = 2;
+    settings.LeftStick = {1000, 2000, 30000, 50, 1.5f};
+    settings.RightStick = {10, 20, 32767, 0, 0.5f};
+    settings.LeftTrigger = {5, 6, 7, 0, 2.0f};
+    settings.RightTrigger = {0, 0, 0, 0, 1.0f};
+    return settings;
+}
+}
+
+// Frames as ShufflerHookIpcProtocol.cs encodes them, byte for byte
+TEST(IpcProtocolTests, ParsesFramesEncodedByShufflerCore) {
+    const std::vector<uint8_t> enable = {0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x01, 0x00,
+                                         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    IpcMessage message;
+    ASSERT_TRUE(Parse(enable, &message));
+    EXPECT_EQ(message.Type, IpcMessageType::Enable);
+    EXPECT_TRUE(message.Payload.empty());
+
+    const std::vector<uint8_t> setActiveController = {0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x03, 0x00, 0x04, 0x00,
+                                                      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00};
+    ASSERT_TRUE(Parse(setActiveController, &message));
+    EXPECT_EQ(message.Type, IpcMessageType::SetActiveController);
+    EXPECT_EQ(message.GetControllerId(), 2);
+
+    const std::vector<uint8_t> setPolled = {0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x05, 0x00, 0x04, 0x00,
+                                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0xE8, 0x03};
+    ASSERT_TRUE(Parse(setPolled, &message));
+    EXPECT_EQ(message.GetInputSource().Source, IpcInputSource::Polled);
+    EXPECT_EQ(message.GetInputSource().PollIntervalMicroseconds, 1000);
+
+    // Player 0 swaps A to B and the left trigger to the right one, player 3 has no mappings
+    const std::vector<uint8_t> setMappings = {
+        0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x04, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Header
+        0x02, 0x00, 0x00, 0x00,                                                                          // 2 players
+        0x00, 0x00, 0x02, 0x00,                                                                          // Player 0
+        0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x20,                                                  // A -> B
+        0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00,                                                  // LT -> RT
+        0x03, 0x00, 0x00, 0x00,                                                                          // Player 3
+    };
+    ASSERT_TRUE(Parse(setMappings, &message));
+    ASSERT_EQ(message.Type, IpcMessageType::SetMappings);
+
+    const IpcMappingSet set = message.GetMappingSet();
+    ASSERT_EQ(set.GetPlayerCount(), 2);
+    std::vector<std::pair<uint8_t, std::vector<ActionMapping>>> players;
+    set.ForEachPlayer([&](const uint8_t player, const IpcPlayerMappings& mappings) {
+        players.emplace_back(player, Collect(mappings));
+    });
+
+    ASSERT_EQ(players.size(), 2u);
+    EXPECT_EQ(players[0].first, 0);
+    ASSERT_EQ(players[0].second.size(), 2u);
+    EXPECT_EQ(players[0].second[0].From.Type, InputType::Button);
+    EXPECT_EQ(players[0].second[0].From.Button, Button::A);
+    EXPECT_EQ(players[0].second[0].To.Button, Button::B);
+    EXPECT_EQ(players[0].second[1].From.Type, InputType::Trigger);
+    EXPECT_EQ(players[0].second[1].From.Trigger, TriggerInput::LeftTrigger);
+    EXPECT_EQ(players[0].second[1].To.Trigger, TriggerInput::RightTrigger);
+    EXPECT_EQ(players[1].first, 3);
+    EXPECT_TRUE(players[1].second.empty());
+}
+
+TEST(IpcProtocolTests, MappingsPointIntoTheFrame) {
+    const auto frame = MakeMappingsFrame({{1, {ButtonToButton(Button::X, Button::Y)}}});
+    IpcMessage message;
+    ASSERT_TRUE(Parse(frame, &message));
+
+    EXPECT_EQ(message.Payload.data(), frame.data() + sizeof(IpcFrameHeader));
+    EXPECT_EQ(message.Payload.size(), frame.size() - sizeof(IpcFrameHeader));
+}
+
+TEST(IpcProtocolTests, RejectsBadHeaders) {
+    const auto valid = MakeFrame(IpcMessageType::Enable, nullptr, 0);
+    ASSERT_TRUE(Parse(valid));
+
+    auto frame = valid;
+    frame[0] ^= 1;
+    EXPECT_FALSE(Parse(frame)) << "magic";
+
+    frame = valid;
+    frame[4] = 2;
+    EXPECT_FALSE(Parse(frame)) << "version";
+
+    frame = valid;
+    frame[6] = 0;
+    EXPECT_FALSE(Parse(frame)) << "type 0";
+    frame[6] = 0xFF;
+    EXPECT_FALSE(Parse(frame)) << "unknown type";
+
+    frame = valid;
+    frame.push_back(0);
+    EXPECT_FALSE(Parse(frame)) << "payload longer than declared";
+
+    frame = valid;
+    frame.pop_back();
+    EXPECT_FALSE(Parse(frame)) << "truncated header";
+    EXPECT_FALSE(Parse({}));
+}
+
+TEST(IpcProtocolTests, RejectsPayloadsOfTheWrongSize) {
+    const int32_t controllerId = 1;
+    EXPECT_TRUE(Parse(MakeFrame(IpcMessageType::SetActiveController, controllerId)));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetActiveController, &controllerId, 2)));
+
+    const auto settings = MakeAnalogSettings();
+    EXPECT_TRUE(Parse(MakeFrame(IpcMessageType::SetAnalogSettings, settings)));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetAnalogSettings, &settings, sizeof(settings) - 1)));
+
+    const IpcSetVirtualSlot slot = {1, 1, 0, 2};
+    EXPECT_TRUE(Parse(MakeFrame(IpcMessageType::SetVirtualSlot, slot)));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetVirtualSlot, &slot, 3)));
+}
+
+TEST(IpcProtocolTests, RejectsOutOfRangeValues) {
+    EXPECT_TRUE(Parse(MakeFrame(IpcMessageType::SetInputSource, IpcSetInputSource{IpcInputSource::SharedPadFeed, 0, 0})));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetInputSource, IpcSetInputSource{static_cast<IpcInputSource>(9), 0, 0})));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetInputSource, IpcSetInputSource{IpcInputSource::Polled, 0, 0})));
+
+    for (const float curve : {0.0f, -1.0f, 16.5f, NAN, INFINITY}) {
+        auto settings = MakeAnalogSettings();
+        settings.RightTrigger.Curve = curve;
+        EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetAnalogSettings, settings))) << curve;
+    }
+
+    IpcSetAxisRouting routing = {};
+    EXPECT_TRUE(Parse(MakeFrame(IpcMessageType::SetAxisRouting, routing)));
+    routing.Matrix[3][5] = NAN;
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetAxisRouting, routing)));
+    routing.Matrix[3][5] = 0;
+    routing.StickToDpad = static_cast<StickSelection>(3);
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetAxisRouting, routing)));
+
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetVirtualSlot, IpcSetVirtualSlot{VirtualSlotTable::MAX_SLOTS, 1, 0, 0})));
+}
+
+TEST(IpcProtocolTests, RejectsMalformedMappingSets) {
+    const auto valid = ButtonToButton(Button::A, Button::B);
+    EXPECT_TRUE(Parse(MakeMappingsFrame({})));
+    EXPECT_TRUE(Parse(MakeMappingsFrame({{0, {valid}}})));
+
+    for (const uint16_t button : {0x0000, 0x0003, 0x0400, 0x0800, 0x9000}) {
+        auto entry = valid;
+        entry.To = button;
+        EXPECT_FALSE(Parse(MakeMappingsFrame({{0, {entry}}}))) << button;
+    }
+
+    auto entry = valid;
+    entry.FromType = InputType::Trigger;
+    entry.From = 2;
+    EXPECT_FALSE(Parse(MakeMappingsFrame({{0, {entry}}}))) << "trigger 2";
+
+    entry = valid;
+    entry.ToType = static_cast<InputType>(2);
+    EXPECT_FALSE(Parse(MakeMappingsFrame({{0, {entry}}}))) << "type 2";
+
+    // Declared counts that do not match the entries that follow
+    auto frame = MakeMappingsFrame({{0, {valid, valid}}});
+    frame[sizeof(IpcFrameHeader) + 6] = 3;
+    EXPECT_FALSE(Parse(frame));
+    frame[sizeof(IpcFrameHeader) + 6] = 1;
+    EXPECT_FALSE(Parse(frame));
+    frame[sizeof(IpcFrameHeader) + 6] = 2;
+    frame[sizeof(IpcFrameHeader)] = 2;
+    EXPECT_FALSE(Parse(frame)) << "player count";
+    frame[sizeof(IpcFrameHeader) + 7] = 0xFF;
+    EXPECT_FALSE(Parse(frame)) << "mapping count overflow";
+}
+
+TEST(IpcProtocolTests, AcceptsOnlyTheWholeFrameOfEveryTruncation) {
+    std::vector<IpcMappingEntry> entries;
+    for (int i = 0; i < 14; i++)
+        entries.push_back(ButtonToButton(static_cast<Button>(1 << (i < 10 ? i : i + 2)), Button::A));
+    const auto frame = MakeMappingsFrame({{0, entries}, {1, {}}, {2, entries}});
+
+    for (size_t length = 0; length < frame.size(); length++) {
+        std::vector<uint8_t> truncated(frame.begin(), frame.begin() + length);
+        if (length >= sizeof(IpcFrameHeader)) {
+            // With the size fixed up, so it is the payload that is short
+            const uint32_t payloadSize = static_cast<uint32_t>(length - sizeof(IpcFrameHeader));
+            memcpy(truncated.data() + offsetof(IpcFrameHeader, PayloadSize), &payloadSize, sizeof(payloadSize));
+        }
+        EXPECT_FALSE(Parse(truncated)) << length;
+    }
+    EXPECT_TRUE(Parse(frame));
+}
+
+TEST(IpcProtocolTests, AcceptedRandomFramesStayWithinTheirPayload) {
+    std::mt19937 random(11);
+    const auto valid = MakeMappingsFrame({{0, {ButtonToButton(Button::A, Button::B)}}, {1, {}}});
+    size_t accepted = 0;
+
+    for (int i = 0; i < 200000; i++) {
+        auto frame = valid;
+        const int flips = 1 + static_cast<int>(random() % 3);
+        for (int flip = 0; flip < flips; flip++)
+            frame[sizeof(IpcFrameHeader) + random() % (frame.size() - sizeof(IpcFrameHeader))] ^= 1 << (random() % 8);
+
+        IpcMessage message;
+        if (!IpcMessage::TryParse(frame, &message))
+            continue;
+        accepted++;
+
+        size_t walked = sizeof(IpcMappingSetHeader);
+        message.GetMappingSet().ForEachPlayer([&](uint8_t, const IpcPlayerMappings& mappings) {
+            walked += sizeof(IpcPlayerMappingsHeader) + mappings.GetCount() * sizeof(IpcMappingEntry);
+            for (size_t mapping = 0; mapping < mappings.GetCount(); mapping++) {
+                const ActionMapping action = mappings[mapping];
+                EXPECT_TRUE(action.From.Type == InputType::Button || action.From.Type == InputType::Trigger);
+            }
+        });
+        ASSERT_EQ(walked, message.Payload.size());
+    }
+    EXPECT_GT(accepted, 0u);
+}
+
+TEST(IpcProtocolTests, DecodesAnalogSettingsAndAxisRouting) {
+    IpcMessage message;
+    ASSERT_TRUE(Parse(MakeFrame(IpcMessageType::SetAnalogSettings, MakeAnalogSettings()), &message));
+    uint8_t player = 0;
+    const AnalogSettings settings = message.GetAnalogSettings(&player);
+    EXPECT_EQ(player, 2);
+    EXPECT_EQ(settings.LeftStick.Deadzone, 1000);
+    EXPECT_EQ(settings.LeftStick.AntiDeadzone, 2000);
+    EXPECT_EQ(settings.LeftStick.OuterDeadzone, 30000);
+    EXPECT_EQ(settings.LeftStick.NoiseGate, 50);
+    EXPECT_EQ(settings.LeftStick.Curve, 1.5f);
+    EXPECT_EQ(settings.RightStick.Curve, 0.5f);
+    EXPECT_EQ(settings.LeftTrigger.Deadzone, 5);
+    EXPECT_EQ(settings.LeftTrigger.AntiDeadzone, 6);
+    EXPECT_EQ(settings.LeftTrigger.NoiseGate, 7);
+    EXPECT_EQ(settings.LeftTrigger.Curve, 2.0f);
+
+    IpcSetAxisRouting routing = {};
+    routing.PlayerIndex = 1;
+    routing.DpadToStick = StickSelection::Right;
+    routing.StickToDpadThreshold = 12000;
+    routing.Matrix[0][1] = -1.25f;
+    ASSERT_TRUE(Parse(MakeFrame(IpcMessageType::SetAxisRouting, routing), &message));
+    const AxisRoutingSettings decoded = message.GetAxisRouting(&player);
+    EXPECT_EQ(player, 1);
+    EXPECT_EQ(decoded.DpadToStick, StickSelection::Right);
+    EXPECT_EQ(decoded.StickToDpad, StickSelection::None);
+    EXPECT_EQ(decoded.StickToDpadThreshold, 12000);
+    EXPECT_EQ(decoded.Matrix[0][1], -1.25f);
+    EXPECT_EQ(decoded.Matrix[0][0], 0.0f);
+}
+
+// SetReplayInputSource("C:\a.sis", 2, loop: true), StartInputRecording("C:\a.sis") and StopInputRecording() as
+// ShufflerHookIpcProtocol.cs encodes them
+TEST(IpcProtocolTests, ParsesReplayAndRecordingFrames) {
+    const std::vector<uint8_t> setReplay = {
+        0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x05, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Header
+        0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x01, 0x00, 0x08, 0x00,                          // 2x, loop
+        0x43, 0x00, 0x3A, 0x00, 0x5C, 0x00, 0x61, 0x00, 0x2E, 0x00, 0x73, 0x00, 0x69, 0x00, 0x73, 0x00,  // Path
+    };
+    IpcMessage message;
+    ASSERT_TRUE(Parse(setReplay, &message));
+    ASSERT_EQ(message.GetInputSource().Source, IpcInputSource::Replay);
+    std::wstring path;
+    const IpcReplaySource replay = message.GetReplaySource(&path);
+    EXPECT_EQ(replay.Speed, 2.0f);
+    EXPECT_EQ(replay.Loop, 1);
+    EXPECT_EQ(path, L"C:\\a.sis");
+
+    const std::vector<uint8_t> startRecording = {
+        0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x09, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Header
+        0x01, 0x00, 0x08, 0x00,                                                                          // Start
+        0x43, 0x00, 0x3A, 0x00, 0x5C, 0x00, 0x61, 0x00, 0x2E, 0x00, 0x73, 0x00, 0x69, 0x00, 0x73, 0x00,  // Path
+    };
+    ASSERT_TRUE(Parse(startRecording, &message));
+    EXPECT_EQ(message.Type, IpcMessageType::SetInputRecording);
+    EXPECT_EQ(message.GetInputRecording(&path).Recording, 1);
+    EXPECT_EQ(path, L"C:\\a.sis");
+
+    const std::vector<uint8_t> stopRecording = {0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x09, 0x00, 0x04, 0x00,
+                                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    ASSERT_TRUE(Parse(stopRecording, &message));
+    EXPECT_EQ(message.GetInputRecording(&path).Recording, 0);
+    EXPECT_TRUE(path.empty());
+}
+
+TEST(IpcProtocolTests, RejectsMalformedReplayAndRecordingFrames) {
+    const auto makeFrame = [](const IpcMessageType type, const auto& header, const std::u16string& path) {
+        std::vector<uint8_t> payload(sizeof(header) + path.size() * sizeof(char16_t));
+        memcpy(payload.data(), &header, sizeof(header));
+        memcpy(payload.data() + sizeof(header), path.data(), path.size() * sizeof(char16_t));
+        return MakeFrame(type, payload.data(), payload.size());
+    };
+    const auto replay = [&](const float speed, const uint16_t pathLength, const std::u16string& path) {
+        struct {
+            IpcSetInputSource Source;
+            IpcReplaySource Replay;
+        } header = {{IpcInputSource::Replay, 0, 0}, {speed, 0, 0, pathLength}};
+        return makeFrame(IpcMessageType::SetInputSource, header, path);
+    };
+    const auto recording = [&](const uint8_t start, const uint16_t pathLength, const std::u16string& path) {
+        return makeFrame(IpcMessageType::SetInputRecording, IpcSetInputRecording{start, 0, pathLength}, path);
+    };
+
+    EXPECT_TRUE(Parse(replay(1, 3, u"a.b")));
+    EXPECT_TRUE(Parse(replay(IpcReplaySource::MAX_SPEED, 3, u"a.b")));
+    EXPECT_FALSE(Parse(replay(0, 3, u"a.b")));
+    EXPECT_FALSE(Parse(replay(-1, 3, u"a.b")));
+    EXPECT_FALSE(Parse(replay(IpcReplaySource::MAX_SPEED * 2, 3, u"a.b")));
+    EXPECT_FALSE(Parse(replay(NAN, 3, u"a.b")));
+    EXPECT_FALSE(Parse(replay(INFINITY, 3, u"a.b")));
+    EXPECT_FALSE(Parse(replay(1, 0, u"")));
+    EXPECT_FALSE(Parse(replay(1, 4, u"a.b")));
+    EXPECT_FALSE(Parse(replay(1, 2, u"a.b")));
+    EXPECT_FALSE(Parse(replay(1, 3, std::u16string(u"a\0b", 3))));
+
+    // The other sources take no path
+    IpcSetInputSource xinput = {IpcInputSource::XInput, 0, 0};
+    EXPECT_FALSE(Parse(makeFrame(IpcMessageType::SetInputSource, xinput, u"a.b")));
+
+    EXPECT_TRUE(Parse(recording(1, 3, u"a.b")));
+    EXPECT_TRUE(Parse(recording(0, 0, u"")));
+    EXPECT_FALSE(Parse(recording(1, 0, u"")));
+    EXPECT_FALSE(Parse(recording(0, 3, u"a.b")));
+    EXPECT_FALSE(Parse(recording(2, 3, u"a.b")));
+    EXPECT_FALSE(Parse(recording(1, 3, std::u16string(u"a\0b", 3))));
+}
+
+TEST(IpcProtocolTests, ParsesStateFreshnessFrames) {
+    // EncodeSetStateFreshness(250)
+    const std::vector<uint8_t> setFreshness = {0x53, 0x48, 0x49, 0x50, 0x01, 0x00, 0x0A, 0x00, 0x04, 0x00,
+                                               0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFA, 0x00, 0x00, 0x00};
+    IpcMessage message;
+    ASSERT_TRUE(Parse(setFreshness, &message));
+    EXPECT_EQ(message.Type, IpcMessageType::SetStateFreshness);
+    EXPECT_EQ(message.GetStateFreshness(), 250u);
+
+    EXPECT_TRUE(Parse(MakeFrame(IpcMessageType::SetStateFreshness, IpcSetStateFreshness{0})));
+    EXPECT_TRUE(Parse(MakeFrame(IpcMessageType::SetStateFreshness,
+                                IpcSetStateFreshness{IpcSetStateFreshness::MAX_MICROSECONDS})));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetStateFreshness,
+                                 IpcSetStateFreshness{IpcSetStateFreshness::MAX_MICROSECONDS + 1})));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetStateFreshness, IpcSetStateFreshness{UINT32_MAX})));
+
+    const uint16_t tooShort = 250;
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetStateFreshness, tooShort)));
+    EXPECT_FALSE(Parse(MakeFrame(IpcMessageType::SetStateFreshness, uint64_t{250})));
+}
\ No newline at end of file
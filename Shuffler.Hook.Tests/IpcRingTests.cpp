@@ -0,0 +1,173 @@
+#include "IpcRing.h"
+
+#include "Fakes/EventFdSignal.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr uint32_t CAPACITY = 256;
+
+class IpcRingTests : public testing::Test {
+  protected:
+    std::unique_ptr<uint8_t[]> _memory;
+    IpcRingHeader* _header;
+    IpcRing _ring;
+
+    uint8_t* GetData() const {
+        return reinterpret_cast<uint8_t*>(_header + 1);
+    }
+
+    void SetUp() override {
+        _memory = std::make_unique<uint8_t[]>(IpcRing::GetMappingSize(CAPACITY));
+        _header = reinterpret_cast<IpcRingHeader*>(_memory.get());
+        _ring = IpcRing::Create(_memory.get(), CAPACITY);
+    }
+
+    std::vector<std::vector<uint8_t>> ReadAll() {
+        std::vector<std::vector<uint8_t>> records;
+        _ring.ReadAll([&](const std::span<const uint8_t> record) { records.emplace_back(record.begin(), record.end()); });
+        return records;
+    }
+
+    static std::vector<uint8_t> MakePayload(const size_t length, const uint8_t seed) {
+        std::vector<uint8_t> payload(length);
+        for (size_t i = 0; i < length; i++)
+            payload[i] = static_cast<uint8_t>(seed + i * 7);
+        return payload;
+    }
+};
+}
+
+TEST_F(IpcRingTests, RoundTripsRecordsOfEveryLengthAcrossWraps) {
+    EXPECT_EQ(_header->Magic, IpcRingHeader::MAGIC);
+    EXPECT_EQ(_header->Capacity, CAPACITY);
+
+    // Anything up to half the ring fits an empty ring wherever the last record ended
+    for (size_t length = 0; length <= CAPACITY / 2 - 8; length++) {
+        const auto payload = MakePayload(length, static_cast<uint8_t>(length));
+        ASSERT_TRUE(_ring.TryWrite(payload)) << length;
+
+        const auto records = ReadAll();
+        ASSERT_EQ(records.size(), 1u);
+        EXPECT_EQ(records[0], payload);
+    }
+}
+
+TEST_F(IpcRingTests, RejectsWritesThatDoNotFit) {
+    EXPECT_FALSE(_ring.TryWrite(MakePayload(CAPACITY - 7, 0)));
+
+    const auto payload = MakePayload(24, 1);  // 32 byte records
+    for (uint32_t i = 0; i < CAPACITY / 32; i++)
+        ASSERT_TRUE(_ring.TryWrite(payload));
+    EXPECT_FALSE(_ring.TryWrite(payload));
+    EXPECT_FALSE(_ring.TryWrite({}));
+
+    EXPECT_EQ(ReadAll().size(), CAPACITY / 32);
+    EXPECT_TRUE(_ring.TryWrite(payload));
+}
+
+TEST_F(IpcRingTests, KeepsTheCapacityItWasCreatedWith) {
+    // The other process rewrites the shared header
+    _header->Capacity = 1u << 30;
+
+    EXPECT_FALSE(_ring.TryWrite(MakePayload(CAPACITY, 0)));
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(100, 0)));
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(100, 1)));
+    ASSERT_EQ(ReadAll().size(), 2u);
+
+    // Wraps at the real end of the ring
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(100, 2)));
+    const auto records = ReadAll();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0], MakePayload(100, 2));
+}
+
+TEST_F(IpcRingTests, DropsEverythingWhenTheTailIsMoreThanARingAhead) {
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(8, 0)));
+    _header->Tail.store(CAPACITY + 8);
+
+    size_t calls = 0;
+    const uint64_t head = _ring.Peek([&](std::span<const uint8_t>) { calls++; });
+    EXPECT_EQ(calls, 0u);
+    EXPECT_EQ(head, CAPACITY + 8);
+}
+
+TEST_F(IpcRingTests, DropsEverythingWhenTheTailIsBehindTheHead) {
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(8, 0)));
+    ASSERT_EQ(ReadAll().size(), 1u);
+    _header->Tail.store(0);
+
+    size_t calls = 0;
+    EXPECT_EQ(_ring.Peek([&](std::span<const uint8_t>) { calls++; }), 0u);
+    EXPECT_EQ(calls, 0u);
+}
+
+TEST_F(IpcRingTests, DropsRecordsWithImpossibleLengths) {
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(8, 0)));
+    const uint32_t tooLong = CAPACITY;
+    memcpy(GetData(), &tooLong, sizeof(tooLong));
+    EXPECT_TRUE(ReadAll().empty());
+
+    // A length that fits the ring but runs past what the producer published
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(8, 0)));
+    const uint32_t pastTail = 64;
+    memcpy(GetData() + 16, &pastTail, sizeof(pastTail));
+    EXPECT_TRUE(ReadAll().empty());
+    EXPECT_EQ(_header->Head.load(), _header->Tail.load());
+
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(8, 3)));
+    EXPECT_EQ(ReadAll().size(), 1u);
+}
+
+TEST_F(IpcRingTests, DoesNotSkipPastATrailingWrapMarker) {
+    ASSERT_TRUE(_ring.TryWrite(MakePayload(8, 0)));
+    ASSERT_EQ(ReadAll().size(), 1u);
+
+    const uint32_t wrap[2] = {0xFFFFFFFF, 0};
+    memcpy(GetData() + 16, wrap, sizeof(wrap));
+    _header->Tail.store(24);
+
+    EXPECT_EQ(_ring.Peek([](std::span<const uint8_t>) {}), 24u);
+}
+
+TEST_F(IpcRingTests, DeliversEveryRecordInOrderToAConsumerWokenByEvent) {
+    constexpr uint32_t RECORDS = 200000;
+    EventFdSignal dataEvent;
+    std::atomic<bool> done = false;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < RECORDS; i++) {
+            const uint32_t record[2] = {i, ~i};
+            const size_t length = 4 + i % 5;  // Varying lengths, so wraps land at different offsets
+            while (!_ring.TryWrite(std::span(reinterpret_cast<const uint8_t*>(record), length)))
+                std::this_thread::yield();
+            dataEvent.Notify();
+        }
+        done = true;
+        dataEvent.Notify();
+    });
+
+    // The transport's read loop: wake up, hand over everything queued, then give the space back
+    uint32_t next = 0;
+    bool valid = true;
+    size_t wakeups = 0;
+    while (!done || next < RECORDS) {
+        if (!dataEvent.WaitFor(5000))
+            break;
+        wakeups++;
+
+        _ring.Release(_ring.Peek([&](const std::span<const uint8_t> record) {
+            uint32_t value;
+            valid &= record.size() == 4 + next % 5;
+            memcpy(&value, record.data(), sizeof(value));
+            valid &= value == next++;
+        }));
+    }
+    producer.join();
+
+    EXPECT_TRUE(valid);
+    EXPECT_EQ(next, RECORDS);
+    EXPECT_LE(wakeups, RECORDS + 1);
+}
\ No newline at end of file
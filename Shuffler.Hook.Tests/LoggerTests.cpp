@@ -0,0 +1,131 @@
+#include "Logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+class LoggerTests : public testing::Test {
+  protected:
+    std::filesystem::path _path;
+
+    void SetUp() override {
+        _path = std::filesystem::temp_directory_path() /
+                ("shuffler_logger_test_" + std::to_string(getpid()) + "_" +
+                 testing::UnitTest::GetInstance()->current_test_info()->name() + ".log");
+        std::filesystem::remove(_path);
+        Logger::Init(_path.string());
+    }
+
+    void TearDown() override {
+        Logger::Shutdown();
+        std::filesystem::remove(_path);
+    }
+
+    std::vector<std::string> ReadLines() const {
+        std::ifstream file(_path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(file, line);)
+            lines.push_back(line);
+        return lines;
+    }
+
+    // Text after the "[time] [app] [PID:n] " prefix
+    static std::string StripPrefix(const std::string& line) {
+        size_t position = 0;
+        for (int i = 0; i < 3; i++)
+            position = line.find("] ", position) + 2;
+        return line.substr(position);
+    }
+};
+}
+
+TEST_F(LoggerTests, WritesEveryLineOnShutdown) {
+    Logger logger("Test");
+    logger.Info("plain message");
+    logger.InfoFormat("formatted {} and {}", 42, std::string("a string"));
+    logger.Error("error message");
+    Logger::Shutdown();
+
+    const auto lines = ReadLines();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(StripPrefix(lines[0]), "[INFO] [Test] plain message");
+    EXPECT_EQ(StripPrefix(lines[1]), "[INFO] [Test] formatted 42 and a string");
+    EXPECT_EQ(StripPrefix(lines[2]), "[ERROR] [Test] error message");
+    EXPECT_NE(lines[0].find("[PID:" + std::to_string(getpid()) + "]"), std::string::npos);
+}
+
+TEST_F(LoggerTests, FiltersLevelsPerSource) {
+    Logger quiet("Quiet");
+    Logger loud("Loud");
+    Logger::SetLevel("Quiet", LogLevel::Error);
+
+    quiet.Info("dropped");
+    quiet.WarningFormat("dropped {}", 1);
+    quiet.Error("kept");
+    loud.Warning("kept too");
+    loud.Debug("below the compiled minimum");
+    Logger::Shutdown();
+
+    const auto lines = ReadLines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(StripPrefix(lines[0]), "[ERROR] [Quiet] kept");
+    EXPECT_EQ(StripPrefix(lines[1]), "[WARN] [Loud] kept too");
+}
+
+TEST_F(LoggerTests, TruncatesLongMessages) {
+    Logger logger("Test");
+    logger.Info(std::string(1000, 'x'));
+    Logger::Shutdown();
+
+    const auto lines = ReadLines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_EQ(StripPrefix(lines[0]), "[INFO] [Test] " + std::string(LogEntry::MESSAGE_CAPACITY, 'x'));
+}
+
+TEST_F(LoggerTests, KeepsOrAccountsForEveryLineFromManyThreads) {
+    constexpr int THREADS = 8;
+    constexpr int LINES_PER_THREAD = 20000;
+    const uint64_t droppedBefore = Logger::GetDroppedCount();
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < THREADS; thread++) {
+        threads.emplace_back([thread] {
+            Logger logger("Thread");
+            for (int i = 0; i < LINES_PER_THREAD; i++)
+                logger.InfoFormat("{} {}", thread, i);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    Logger::Shutdown();
+
+    // A full queue drops lines instead of blocking, and the writer reports how many
+    const uint64_t dropped = Logger::GetDroppedCount() - droppedBefore;
+    uint64_t reportedDrops = 0;
+    std::set<std::pair<int, int>> seen;
+    int lastLine[THREADS];
+    std::fill(std::begin(lastLine), std::end(lastLine), -1);
+    bool inOrder = true;
+
+    for (const auto& line : ReadLines()) {
+        const std::string text = StripPrefix(line);
+        if (text.starts_with("[WARN] [Logger] Dropped ")) {
+            reportedDrops += std::stoull(text.substr(strlen("[WARN] [Logger] Dropped ")));
+            continue;
+        }
+
+        int thread, index;
+        ASSERT_EQ(sscanf(text.c_str(), "[INFO] [Thread] %d %d", &thread, &index), 2) << text;
+        inOrder &= index > lastLine[thread];
+        lastLine[thread] = index;
+        seen.emplace(thread, index);
+    }
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_EQ(reportedDrops, dropped);
+    EXPECT_EQ(seen.size() + dropped, static_cast<uint64_t>(THREADS * LINES_PER_THREAD));
+}
\ No newline at end of file
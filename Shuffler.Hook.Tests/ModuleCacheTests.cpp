@@ -0,0 +1,114 @@
+#include "ModuleCache.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+// Module handles are image base addresses, 64 KB aligned
+const void* Module(const uintptr_t index) {
+    return reinterpret_cast<const void*>(0x7FF800000000ull + (index << 16));
+}
+}
+
+TEST(ModuleCacheTests, ReturnsFallbackWhenEmpty) {
+    const ModuleCache<int> cache;
+    EXPECT_EQ(cache.Find(Module(1)), 0);
+    EXPECT_EQ(cache.Find(Module(1), -1), -1);
+    EXPECT_EQ(cache.Find(nullptr, -1), -1);
+}
+
+TEST(ModuleCacheTests, FindsAddedModules) {
+    ModuleCache<int> cache;
+    for (int i = 0; i < 8; i++)
+        EXPECT_TRUE(cache.Add(Module(i), i + 100));
+
+    for (int i = 0; i < 8; i++)
+        EXPECT_EQ(cache.Find(Module(i), -1), i + 100);
+    EXPECT_EQ(cache.Find(Module(8), -1), -1);
+}
+
+TEST(ModuleCacheTests, AddUpdatesExistingModule) {
+    ModuleCache<int> cache;
+    EXPECT_TRUE(cache.Add(Module(3), 1));
+    EXPECT_TRUE(cache.Add(Module(3), 2));
+    EXPECT_EQ(cache.Find(Module(3)), 2);
+}
+
+TEST(ModuleCacheTests, RejectsNullModule) {
+    ModuleCache<int> cache;
+    EXPECT_FALSE(cache.Add(nullptr, 1));
+    EXPECT_EQ(cache.Find(nullptr, -1), -1);
+}
+
+TEST(ModuleCacheTests, AddFailsOnceFull) {
+    ModuleCache<int, 4> cache;
+    for (int i = 0; i < 4; i++)
+        EXPECT_TRUE(cache.Add(Module(i), i));
+
+    EXPECT_FALSE(cache.Add(Module(4), 4));
+    EXPECT_TRUE(cache.Add(Module(2), 20));
+    EXPECT_EQ(cache.Find(Module(4), -1), -1);
+    EXPECT_EQ(cache.Find(Module(2)), 20);
+}
+
+TEST(ModuleCacheTests, ProbesPastCollidingModules) {
+    // Bases that differ only above the bits the index is taken from all start probing at the same entry
+    ModuleCache<int> cache;
+    std::vector<const void*> modules;
+    for (uintptr_t i = 0; i < 16; i++)
+        modules.push_back(reinterpret_cast<const void*>(0x10000ull + (i << 32)));
+
+    for (size_t i = 0; i < modules.size(); i++)
+        EXPECT_TRUE(cache.Add(modules[i], static_cast<int>(i)));
+    for (size_t i = 0; i < modules.size(); i++)
+        EXPECT_EQ(cache.Find(modules[i], -1), static_cast<int>(i));
+    EXPECT_EQ(cache.Find(reinterpret_cast<const void*>(0x10000ull + (16ull << 32)), -1), -1);
+}
+
+TEST(ModuleCacheTests, ClearForgetsEveryModule) {
+    ModuleCache<int, 4> cache;
+    for (int i = 0; i < 4; i++)
+        cache.Add(Module(i), i);
+
+    cache.Clear();
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(cache.Find(Module(i), -1), -1);
+    for (int i = 4; i < 8; i++)
+        EXPECT_TRUE(cache.Add(Module(i), i));
+}
+
+TEST(ModuleCacheTests, ReadersSeeAddedModulesWithTheirValues) {
+    constexpr int modules = 12;
+    ModuleCache<int> cache;
+    std::atomic<bool> stop = false;
+    std::atomic<int> failures = 0;
+
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 3; reader++) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < modules; i++) {
+                    // A module is either not there yet or there with the value it was added with
+                    const int value = cache.Find(Module(i), -1);
+                    if (value != -1 && value != i * 7)
+                        failures.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < modules; i++) {
+        cache.Add(Module(i), i * 7);
+        std::this_thread::yield();
+    }
+
+    stop = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(failures.load(), 0);
+    for (int i = 0; i < modules; i++)
+        EXPECT_EQ(cache.Find(Module(i), -1), i * 7);
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "MpscQueue.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Item {
+    uint32_t Producer;
+    uint32_t Sequence;
+};
+}
+
+TEST(MpscQueueTests, PopsInPushOrder) {
+    MpscQueue<Item, 8> queue;
+    EXPECT_TRUE(queue.IsEmpty());
+
+    for (uint32_t i = 0; i < 5; i++)
+        ASSERT_TRUE(queue.TryPush([i](Item& item) { item = {0, i}; }));
+    EXPECT_FALSE(queue.IsEmpty());
+
+    Item item;
+    for (uint32_t i = 0; i < 5; i++) {
+        ASSERT_TRUE(queue.TryPop(&item));
+        EXPECT_EQ(item.Sequence, i);
+    }
+    EXPECT_FALSE(queue.TryPop(&item));
+    EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(MpscQueueTests, RejectsPushesWhenFullWithoutCallingFill) {
+    MpscQueue<Item, 4> queue;
+    for (uint32_t i = 0; i < 4; i++)
+        ASSERT_TRUE(queue.TryPush([i](Item& item) { item = {0, i}; }));
+
+    bool filled = false;
+    EXPECT_FALSE(queue.TryPush([&](Item&) { filled = true; }));
+    EXPECT_FALSE(filled);
+
+    // Popping one frees exactly one slot, across the wrap
+    Item item;
+    ASSERT_TRUE(queue.TryPop(&item));
+    EXPECT_TRUE(queue.TryPush([](Item& item) { item = {0, 4}; }));
+    EXPECT_FALSE(queue.TryPush([](Item&) {}));
+}
+
+TEST(MpscQueueTests, KeepsEveryProducersOrderUnderContention) {
+    constexpr uint32_t PRODUCERS = 8;
+    constexpr uint32_t ITEMS_PER_PRODUCER = 100000;
+    MpscQueue<Item, 256> queue;
+
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < PRODUCERS; producer++) {
+        producers.emplace_back([&queue, producer] {
+            for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; i++) {
+                while (!queue.TryPush([&](Item& item) { item = {producer, i}; }))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    uint32_t next[PRODUCERS] = {};
+    uint64_t popped = 0;
+    bool inOrder = true;
+    while (popped < PRODUCERS * ITEMS_PER_PRODUCER) {
+        Item item;
+        if (!queue.TryPop(&item)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        inOrder &= item.Producer < PRODUCERS && item.Sequence == next[item.Producer];
+        next[item.Producer] = item.Sequence + 1;
+        popped++;
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(queue.IsEmpty());
+    for (const uint32_t count : next)
+        EXPECT_EQ(count, ITEMS_PER_PRODUCER);
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "InputSource.h"
+#include "Fakes/SyntheticInputSource.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+// Waits until predicate holds, the poll thread runs on its own schedule
+template <typename F>
+bool WaitFor(F&& predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(100us);
+    }
+    return true;
+}
+}
+
+TEST(PolledInputSourceTests, ReadsTheSourceDirectlyUntilStarted) {
+    SyntheticInputSource source;
+    PolledInputSource polled(&source, 100us);
+
+    ControllerState state;
+    ASSERT_TRUE(polled.GetState(0, &state));
+    ASSERT_TRUE(polled.GetState(0, &state));
+    EXPECT_EQ(state.ButtonStates, 2);
+    EXPECT_EQ(source.GetReadCount(0), 2u);
+}
+
+TEST(PolledInputSourceTests, HandsOutWhatThePollThreadPublished) {
+    SyntheticInputSource source;
+    PolledInputSource polled(&source, 100us);
+    ASSERT_TRUE(polled.Start());
+
+    ControllerState state;
+    ASSERT_TRUE(polled.GetState(1, &state));
+    ASSERT_TRUE(WaitFor([&] { return source.GetReadCount(1) >= 10; }));
+
+    // Reads between two polls copy the same published state instead of reading the source
+    polled.Stop();
+    const uint32_t reads = source.GetReadCount(1);
+    ControllerState first, second;
+    ASSERT_TRUE(polled.GetState(1, &first));
+    ASSERT_TRUE(polled.GetState(1, &second));
+    EXPECT_EQ(first.ButtonStates, second.ButtonStates);
+    EXPECT_EQ(first.LeftThumbstickX, 1);
+    EXPECT_EQ(source.GetReadCount(1), reads);
+}
+
+TEST(PolledInputSourceTests, PollsOnlyRequestedControllers) {
+    SyntheticInputSource source;
+    PolledInputSource polled(&source, 100us);
+    ASSERT_TRUE(polled.Start());
+
+    ControllerState state;
+    polled.GetState(2, &state);
+    ASSERT_TRUE(WaitFor([&] { return source.GetReadCount(2) >= 10; }));
+    polled.Stop();
+
+    EXPECT_EQ(source.GetReadCount(0), 0u);
+    EXPECT_EQ(source.GetReadCount(1), 0u);
+    EXPECT_EQ(source.GetReadCount(3), 0u);
+}
+
+TEST(PolledInputSourceTests, ReportsDisconnectedControllers) {
+    SyntheticInputSource source(0ns, 0b01);
+    PolledInputSource polled(&source, 100us);
+    ASSERT_TRUE(polled.Start());
+
+    ControllerState state;
+    polled.GetState(0, &state);
+    polled.GetState(1, &state);
+    ASSERT_TRUE(WaitFor([&] { return source.GetReadCount(1) >= 2; }));
+
+    EXPECT_TRUE(polled.GetState(0, &state));
+    EXPECT_FALSE(polled.GetState(1, &state));
+
+    source.SetConnectedMask(0b10);
+    const uint32_t reads = source.GetReadCount(0);
+    ASSERT_TRUE(WaitFor([&] { return source.GetReadCount(0) >= reads + 2; }));
+    EXPECT_FALSE(polled.GetState(0, &state));
+    EXPECT_TRUE(polled.GetState(1, &state));
+}
+
+TEST(PolledInputSourceTests, RejectsControllersOutOfRange) {
+    SyntheticInputSource source;
+    PolledInputSource polled(&source, 100us);
+
+    ControllerState state;
+    EXPECT_FALSE(polled.GetState(-1, &state));
+    EXPECT_FALSE(polled.GetState(InputSource::MAX_CONTROLLERS, &state));
+}
+
+TEST(PolledInputSourceTests, PollsAtTheSetInterval) {
+    SyntheticInputSource source;
+    PolledInputSource polled(&source, 10ms);
+    ControllerState state;
+    polled.GetState(0, &state);
+
+    ASSERT_TRUE(polled.Start());
+    std::this_thread::sleep_for(100ms);
+    const uint32_t slowReads = source.GetReadCount(0);
+
+    polled.SetInterval(100us);
+    std::this_thread::sleep_for(100ms);
+    polled.Stop();
+    const uint32_t fastReads = source.GetReadCount(0) - slowReads;
+
+    // Loose bounds, only the order of magnitude is dependable on a loaded machine
+    EXPECT_LE(slowReads, 25u);
+    EXPECT_GT(fastReads, slowReads * 2);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "ProcNameTable.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+// The set GetProcAddressHook dispatches on, and the named exports of the XInput DLLs
+constexpr const char* HOOKED_NAMES[] = {"XInputGetState", "XInputGetCapabilities"};
+constexpr const char* XINPUT_NAMES[] = {
+    "XInputEnable",
+    "XInputGetAudioDeviceIds",
+    "XInputGetBatteryInformation",
+    "XInputGetCapabilities",
+    "XInputGetCapabilitiesEx",
+    "XInputGetKeystroke",
+    "XInputGetState",
+    "XInputGetStateEx",
+    "XInputSetState",
+    "XInputGetDSoundAudioDeviceGuids",
+    "XInputPowerOffController",
+    "XInputWaitForGuideButton",
+    "XInputCancelGuideButtonWait",
+    "DllMain",
+};
+
+// Names outside both sets, including ones that share what the hash looks at with a member: the length, the first
+// eight characters and the last one
+constexpr const char* OTHER_NAMES[] = {
+    "",
+    "X",
+    "XInput",
+    "XInputGetStat",
+    "XInputGetStatee",
+    "XInputGetStaxe",
+    "XInputGetCapabilitixs",
+    "XInputGetCapabilitieS",
+    "xinputgetstate",
+    "XInputGetState\xff",
+    "XInputGetStateEx2_with_a_much_longer_tail_than_any_export_has",
+    "GetProcAddress",
+    "LoadLibraryA",
+    "D3D11CreateDevice",
+    "DirectInput8Create",
+};
+
+constexpr ProcNameTable<std::size(HOOKED_NAMES)> HOOKED_TABLE(HOOKED_NAMES);
+constexpr ProcNameTable<std::size(XINPUT_NAMES)> XINPUT_TABLE(XINPUT_NAMES);
+}
+
+TEST(ProcNameTableTests, FindsEveryNameInTheSet) {
+    for (size_t i = 0; i < std::size(HOOKED_NAMES); i++)
+        EXPECT_EQ(HOOKED_TABLE.Find(HOOKED_NAMES[i]), static_cast<int>(i)) << HOOKED_NAMES[i];
+    for (size_t i = 0; i < std::size(XINPUT_NAMES); i++)
+        EXPECT_EQ(XINPUT_TABLE.Find(XINPUT_NAMES[i]), static_cast<int>(i)) << XINPUT_NAMES[i];
+}
+
+TEST(ProcNameTableTests, ComparesNamesByContent) {
+    const std::string copy = "XInputGetCapabilities";
+    EXPECT_EQ(HOOKED_TABLE.Find(copy.c_str()), 1);
+}
+
+TEST(ProcNameTableTests, RejectsNamesOutsideTheSet) {
+    for (const char* name : OTHER_NAMES) {
+        EXPECT_EQ(HOOKED_TABLE.Find(name), -1) << name;
+        EXPECT_EQ(XINPUT_TABLE.Find(name), -1) << name;
+    }
+
+    // Exports the hook leaves to the real DLL
+    EXPECT_EQ(HOOKED_TABLE.Find("XInputGetStateEx"), -1);
+    EXPECT_EQ(HOOKED_TABLE.Find("XInputSetState"), -1);
+    EXPECT_EQ(HOOKED_TABLE.Find("XInputEnable"), -1);
+}
+
+TEST(ProcNameTableTests, BuildsForNamesDifferingOnlyInLengthOrLastCharacter) {
+    static constexpr const char* names[] = {
+        "A",     "B",     "C",     "D",     "E",     "F",     "G",     "H",     "I",     "J",
+        "AA",    "AB",    "AC",    "AD",    "AE",    "AF",    "AG",    "AH",    "AI",    "AJ",
+        "Func0", "Func1", "Func2", "Func3", "Func4", "Func5", "Func6", "Func7", "Func8", "Func9",
+        "LongExportName_0", "LongExportName_1", "LongExportName_2", "LongExportName_3",
+    };
+    constexpr ProcNameTable<std::size(names)> table(names);
+
+    for (size_t i = 0; i < std::size(names); i++)
+        EXPECT_EQ(table.Find(names[i]), static_cast<int>(i)) << names[i];
+    EXPECT_EQ(table.Find("Func"), -1);
+    EXPECT_EQ(table.Find("Func10"), -1);
+    EXPECT_EQ(table.Find("LongExportName_4"), -1);
+    EXPECT_EQ(table.Find("LongExportNameX3"), -1);
+}
\ No newline at end of file
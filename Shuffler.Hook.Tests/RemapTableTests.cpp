@@ -0,0 +1,190 @@
+#include "RemapTable.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+constexpr Button ALL_BUTTONS[] = {
+    Button::A,        Button::B,         Button::X,              Button::Y,
+    Button::Start,    Button::Back,      Button::DPadUp,         Button::DPadDown,
+    Button::DPadLeft, Button::DPadRight, Button::LeftShoulder,   Button::RightShoulder,
+    Button::LeftThumbstick, Button::RightThumbstick,
+};
+
+InputAction MakeButton(const Button button) {
+    InputAction action{};
+    action.Type = InputType::Button;
+    action.Button = button;
+    return action;
+}
+
+InputAction MakeTrigger(const TriggerInput trigger) {
+    InputAction action{};
+    action.Type = InputType::Trigger;
+    action.Trigger = trigger;
+    return action;
+}
+
+// The mapping loop ControllerManager::GetState ran before mappings were compiled into tables, except that a mapping
+// onto a trigger that is not itself remapped presses it fully instead of being overwritten by the raw value
+void ApplyReference(const std::vector<ActionMapping>& mappings, const ControllerState& source,
+                    ControllerState* state) {
+    *state = source;
+    state->ButtonStates = 0;
+    state->LeftTrigger = 0;
+    state->RightTrigger = 0;
+
+    uint16_t remappedButtons = 0;
+    bool leftTriggerRemapped = false;
+    bool rightTriggerRemapped = false;
+
+    for (const auto& [From, To] : mappings) {
+        bool sourceIsActive = false;
+
+        if (From.Type == InputType::Button) {
+            sourceIsActive = (source.ButtonStates & static_cast<uint16_t>(From.Button)) != 0;
+            remappedButtons |= static_cast<uint16_t>(From.Button);
+        } else if (From.Type == InputType::Trigger) {
+            if (From.Trigger == TriggerInput::LeftTrigger) {
+                sourceIsActive = source.LeftTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD;
+                leftTriggerRemapped = true;
+            } else {
+                sourceIsActive = source.RightTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD;
+                rightTriggerRemapped = true;
+            }
+        }
+
+        if (sourceIsActive) {
+            if (To.Type == InputType::Button)
+                state->ButtonStates |= static_cast<uint16_t>(To.Button);
+            else if (To.Trigger == TriggerInput::LeftTrigger)
+                state->LeftTrigger = 255;
+            else
+                state->RightTrigger = 255;
+        }
+    }
+
+    state->ButtonStates |= source.ButtonStates & ~remappedButtons;
+    if (!leftTriggerRemapped)
+        state->LeftTrigger |= source.LeftTrigger;
+    if (!rightTriggerRemapped)
+        state->RightTrigger |= source.RightTrigger;
+}
+
+InputAction RandomAction(std::mt19937& random) {
+    const auto index = std::uniform_int_distribution<size_t>(0, std::size(ALL_BUTTONS) + 1)(random);
+    if (index < std::size(ALL_BUTTONS))
+        return MakeButton(ALL_BUTTONS[index]);
+    return MakeTrigger(index == std::size(ALL_BUTTONS) ? TriggerInput::LeftTrigger : TriggerInput::RightTrigger);
+}
+
+ControllerState RandomState(std::mt19937& random) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> axis(-32768, 32767);
+
+    ControllerState state{};
+    state.ButtonStates = static_cast<uint16_t>(std::uniform_int_distribution<int>(0, 0xFFFF)(random) & 0xF3FF);
+    state.LeftTrigger = static_cast<uint8_t>(byte(random));
+    state.RightTrigger = static_cast<uint8_t>(byte(random));
+    state.LeftThumbstickX = static_cast<int16_t>(axis(random));
+    state.LeftThumbstickY = static_cast<int16_t>(axis(random));
+    state.RightThumbstickX = static_cast<int16_t>(axis(random));
+    state.RightThumbstickY = static_cast<int16_t>(axis(random));
+    return state;
+}
+
+void ExpectStatesEqual(const ControllerState& expected, const ControllerState& actual) {
+    EXPECT_EQ(expected.ButtonStates, actual.ButtonStates);
+    EXPECT_EQ(expected.LeftTrigger, actual.LeftTrigger);
+    EXPECT_EQ(expected.RightTrigger, actual.RightTrigger);
+    EXPECT_EQ(expected.LeftThumbstickX, actual.LeftThumbstickX);
+    EXPECT_EQ(expected.LeftThumbstickY, actual.LeftThumbstickY);
+    EXPECT_EQ(expected.RightThumbstickX, actual.RightThumbstickX);
+    EXPECT_EQ(expected.RightThumbstickY, actual.RightThumbstickY);
+}
+}
+
+TEST(RemapTableTests, WithoutMappingsPassesEverythingThrough) {
+    const RemapTable table = RemapTable::Compile({});
+    std::mt19937 random(1);
+
+    for (int i = 0; i < 1000; i++) {
+        const ControllerState source = RandomState(random);
+        ControllerState state{};
+        table.Apply(source, &state);
+        ExpectStatesEqual(source, state);
+    }
+}
+
+TEST(RemapTableTests, SwapsButtons) {
+    const RemapTable table = RemapTable::Compile({
+        {MakeButton(Button::A), MakeButton(Button::B)},
+        {MakeButton(Button::B), MakeButton(Button::A)},
+    });
+
+    ControllerState source{};
+    source.ButtonStates = static_cast<uint16_t>(Button::A) | static_cast<uint16_t>(Button::Start);
+    ControllerState state{};
+    table.Apply(source, &state);
+
+    EXPECT_EQ(state.ButtonStates, static_cast<uint16_t>(Button::B) | static_cast<uint16_t>(Button::Start));
+}
+
+TEST(RemapTableTests, SkipsMappingsFromNoOrSeveralButtons) {
+    const RemapTable table = RemapTable::Compile({
+        {MakeButton(static_cast<Button>(0)), MakeButton(Button::X)},
+        {MakeButton(static_cast<Button>(0x3000)), MakeButton(Button::Y)},
+        {MakeButton(Button::B), MakeButton(Button::A)},
+    });
+
+    ControllerState source{};
+    source.ButtonStates = static_cast<uint16_t>(Button::A) | static_cast<uint16_t>(Button::B);
+    ControllerState state{};
+    table.Apply(source, &state);
+    EXPECT_EQ(state.ButtonStates, static_cast<uint16_t>(Button::A));
+}
+
+TEST(RemapTableTests, TriggersPressPastTheThreshold) {
+    const RemapTable table = RemapTable::Compile({
+        {MakeTrigger(TriggerInput::LeftTrigger), MakeButton(Button::X)},
+        {MakeButton(Button::Y), MakeTrigger(TriggerInput::RightTrigger)},
+    });
+
+    ControllerState source{};
+    source.LeftTrigger = XINPUT_GAMEPAD_TRIGGER_THRESHOLD;
+    source.RightTrigger = 12;
+    ControllerState state{};
+    table.Apply(source, &state);
+    EXPECT_EQ(state.ButtonStates, 0);
+    EXPECT_EQ(state.LeftTrigger, 0);
+    EXPECT_EQ(state.RightTrigger, 12);
+
+    source.LeftTrigger = XINPUT_GAMEPAD_TRIGGER_THRESHOLD + 1;
+    source.ButtonStates = static_cast<uint16_t>(Button::Y);
+    table.Apply(source, &state);
+    EXPECT_EQ(state.ButtonStates, static_cast<uint16_t>(Button::X));
+    EXPECT_EQ(state.LeftTrigger, 0);
+    EXPECT_EQ(state.RightTrigger, 255);
+}
+
+TEST(RemapTableTests, MatchesTheMappingLoopForRandomMappings) {
+    std::mt19937 random(2);
+
+    for (int table = 0; table < 500; table++) {
+        std::vector<ActionMapping> mappings(std::uniform_int_distribution<size_t>(0, 20)(random));
+        for (auto& mapping : mappings)
+            mapping = {RandomAction(random), RandomAction(random)};
+
+        const RemapTable compiled = RemapTable::Compile(mappings);
+        for (int i = 0; i < 200; i++) {
+            const ControllerState source = RandomState(random);
+            ControllerState expected{};
+            ControllerState actual{};
+            ApplyReference(mappings, source, &expected);
+            compiled.Apply(source, &actual);
+            ExpectStatesEqual(expected, actual);
+            if (HasFailure())
+                return;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "HidReportEncoder.h"
+#include "ReportBatch.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+// RAWINPUTHEADER and RAWHID as user32 lays them out for a process whose pointers are Pointer
+template <typename Pointer>
+struct RawInputHeader {
+    uint32_t Type;
+    uint32_t Size;
+    Pointer Device;
+    Pointer WParam;
+};
+
+struct RawHid {
+    uint32_t SizeHid;
+    uint32_t Count;
+    uint8_t RawData[1];
+};
+
+template <typename Pointer>
+struct RawInput {
+    RawInputHeader<Pointer> Header;
+    RawHid Hid;
+};
+
+constexpr uint32_t RIM_TYPEHID = 2;
+
+// What RawInputHook appends for one slot
+template <typename Pointer>
+constexpr size_t HID_RECORD_SIZE =
+    sizeof(RawInputHeader<Pointer>) + offsetof(RawHid, RawData) + HidReportEncoder::REPORT_LENGTH;
+
+// NEXTRAWINPUTBLOCK: the next record starts at the end of this one, rounded up to pointer size
+template <typename Pointer>
+const RawInput<Pointer>* NextRawInputBlock(const RawInput<Pointer>* record) {
+    const auto end = reinterpret_cast<uintptr_t>(record) + record->Header.Size;
+    return reinterpret_cast<const RawInput<Pointer>*>(RecordBatchWriter::Align(end, sizeof(Pointer)));
+}
+
+template <typename Pointer>
+void WriteHidRecord(void* space, const int slot, const ControllerState& state) {
+    auto* record = static_cast<RawInput<Pointer>*>(space);
+    record->Header = {RIM_TYPEHID, static_cast<uint32_t>(HID_RECORD_SIZE<Pointer>), static_cast<Pointer>(slot), 0};
+    record->Hid.SizeHid = HidReportEncoder::REPORT_LENGTH;
+    record->Hid.Count = 1;
+    HidReportEncoder::Encode(state, record->Hid.RawData);
+}
+
+ControllerState MakeState(const int slot) {
+    ControllerState state = {};
+    state.LeftThumbstickX = static_cast<int16_t>(1000 * (slot + 1));
+    state.ButtonStates = static_cast<uint16_t>(1u << slot);
+    return state;
+}
+
+// Fills a batch the way GetRawInputBuffer is answered: one HID record per slot while they fit, then records of
+// otherSize from the real devices in what is left. Walks the result with NEXTRAWINPUTBLOCK and checks every record
+template <typename Pointer>
+void ExpectBatchWalks(const size_t capacity, const size_t otherSize, const int slots) {
+    alignas(16) uint8_t buffer[1024] = {};
+    ASSERT_LE(capacity, sizeof(buffer));
+
+    RecordBatchWriter batch(buffer, capacity, sizeof(Pointer));
+    for (int slot = 0; slot < slots && batch.CanFit(HID_RECORD_SIZE<Pointer>); slot++)
+        WriteHidRecord<Pointer>(batch.Append(HID_RECORD_SIZE<Pointer>), slot, MakeState(slot));
+    const uint32_t hidCount = batch.GetCount();
+
+    // The real devices get the rest of the buffer as a batch of their own, starting where the next record would
+    const size_t offset = std::min(batch.GetNextOffset(), batch.GetCapacity());
+    RecordBatchWriter rest(buffer + offset, batch.GetCapacity() - offset, sizeof(Pointer));
+    while (void* space = rest.Append(otherSize)) {
+        auto* record = static_cast<RawInput<Pointer>*>(space);
+        record->Header = {1, static_cast<uint32_t>(otherSize), 0x4242, 0};
+    }
+
+    const auto* record = reinterpret_cast<const RawInput<Pointer>*>(buffer);
+    for (uint32_t i = 0; i < hidCount + rest.GetCount(); i++) {
+        const auto address = reinterpret_cast<uintptr_t>(record);
+        ASSERT_EQ(address % sizeof(Pointer), 0u) << "record " << i;
+        ASSERT_LE(address + record->Header.Size, reinterpret_cast<uintptr_t>(buffer) + capacity) << "record " << i;
+
+        if (i < hidCount) {
+            ASSERT_EQ(record->Header.Type, RIM_TYPEHID) << "record " << i;
+            ASSERT_EQ(record->Header.Device, static_cast<Pointer>(i));
+            std::array<uint8_t, HidReportEncoder::REPORT_LENGTH> expected;
+            HidReportEncoder::Encode(MakeState(static_cast<int>(i)), expected.data());
+            ASSERT_EQ(memcmp(record->Hid.RawData, expected.data(), expected.size()), 0) << "record " << i;
+        } else {
+            ASSERT_EQ(record->Header.Device, static_cast<Pointer>(0x4242)) << "record " << i;
+            ASSERT_EQ(record->Header.Size, otherSize) << "record " << i;
+        }
+
+        record = NextRawInputBlock(record);
+    }
+}
+}
+
+TEST(ReportBatchTests, AlignRoundsUpToTheAlignment) {
+    EXPECT_EQ(RecordBatchWriter::Align(0, 8), 0u);
+    EXPECT_EQ(RecordBatchWriter::Align(1, 8), 8u);
+    EXPECT_EQ(RecordBatchWriter::Align(8, 8), 8u);
+    EXPECT_EQ(RecordBatchWriter::Align(9, 4), 12u);
+    EXPECT_EQ(RecordBatchWriter::Align(45, 1), 45u);
+}
+
+TEST(ReportBatchTests, RecordsStartAtAlignedOffsets) {
+    alignas(8) uint8_t buffer[256];
+    RecordBatchWriter batch(buffer, sizeof(buffer), 8);
+
+    const size_t sizes[] = {37, 8, 1, 45, 16};
+    size_t expectedOffset = 0;
+    for (const size_t size : sizes) {
+        auto* record = static_cast<uint8_t*>(batch.Append(size));
+        ASSERT_NE(record, nullptr);
+        EXPECT_EQ(static_cast<size_t>(record - buffer), expectedOffset);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(record) % 8, 0u);
+        expectedOffset = RecordBatchWriter::Align(expectedOffset + size, 8);
+    }
+
+    EXPECT_EQ(batch.GetCount(), std::size(sizes));
+    EXPECT_EQ(batch.GetNextOffset(), expectedOffset);
+}
+
+TEST(ReportBatchTests, FillsTheBufferExactly) {
+    alignas(8) uint8_t buffer[100];
+    RecordBatchWriter batch(buffer, sizeof(buffer), 8);
+
+    // 40 + 40 end at 80, the last record may end on the last byte even though it is not aligned
+    EXPECT_NE(batch.Append(40), nullptr);
+    EXPECT_NE(batch.Append(40), nullptr);
+    EXPECT_FALSE(batch.CanFit(21));
+    EXPECT_EQ(batch.Append(21), nullptr);
+    EXPECT_NE(batch.Append(20), nullptr);
+    EXPECT_EQ(batch.GetCount(), 3u);
+
+    // The next offset rounds past the capacity, which is why the rest of the buffer is taken from min(next, capacity)
+    EXPECT_EQ(batch.GetNextOffset(), 104u);
+    EXPECT_FALSE(batch.CanFit(0));
+    EXPECT_EQ(batch.Append(1), nullptr);
+}
+
+TEST(ReportBatchTests, NullOrTinyBufferFitsNothing) {
+    RecordBatchWriter null(nullptr, 4096, 8);
+    EXPECT_EQ(null.GetCapacity(), 0u);
+    EXPECT_FALSE(null.CanFit(1));
+    EXPECT_EQ(null.Append(1), nullptr);
+
+    alignas(8) uint8_t buffer[HID_RECORD_SIZE<uint64_t> - 1];
+    RecordBatchWriter tiny(buffer, sizeof(buffer), 8);
+    EXPECT_FALSE(tiny.CanFit(HID_RECORD_SIZE<uint64_t>));
+    EXPECT_EQ(tiny.GetCount(), 0u);
+}
+
+TEST(ReportBatchTests, HidRecordsWalkWithNextRawInputBlock) {
+    // 64-bit processes, and 32-bit ones whose RAWINPUT is 4-byte aligned
+    for (const int slots : {1, 2, 4}) {
+        ExpectBatchWalks<uint64_t>(1024, 48, slots);
+        ExpectBatchWalks<uint32_t>(1024, 40, slots);
+    }
+}
+
+TEST(ReportBatchTests, RealDeviceRecordsOfOddSizesFollowTheHidRecords) {
+    // Mouse and keyboard records are not multiples of the alignment on every build, the walk must still line up
+    for (const size_t otherSize : {size_t{37}, size_t{45}, size_t{47}, size_t{48}}) {
+        ExpectBatchWalks<uint64_t>(512, otherSize, 4);
+        ExpectBatchWalks<uint32_t>(512, otherSize, 4);
+    }
+}
+
+TEST(ReportBatchTests, BuffersThatEndMidRecordHoldWholeRecordsOnly) {
+    for (size_t capacity = HID_RECORD_SIZE<uint64_t>; capacity < 4 * HID_RECORD_SIZE<uint64_t> + 64; capacity += 3) {
+        ExpectBatchWalks<uint64_t>(capacity, 45, 4);
+        ExpectBatchWalks<uint32_t>(capacity, 45, 4);
+    }
+}
+
+TEST(ReportBatchTests, ReportChangeFilterHandsOutEachPacketOnce) {
+    ReportChangeFilter<4> filter;
+    EXPECT_TRUE(filter.Claim(0, 0));
+    EXPECT_FALSE(filter.Claim(0, 0));
+    EXPECT_TRUE(filter.Claim(1, 0));
+    EXPECT_TRUE(filter.Claim(0, 5));
+    EXPECT_FALSE(filter.Claim(0, 5));
+
+    // A caller that read an older packet after a newer one went out does not hand it out again
+    EXPECT_FALSE(filter.Claim(0, 4));
+    EXPECT_TRUE(filter.Claim(0, 6));
+
+    // Packet numbers wrap
+    EXPECT_TRUE(filter.Claim(2, 0xFFFFFFFF));
+    EXPECT_TRUE(filter.Claim(2, 0));
+    EXPECT_FALSE(filter.Claim(2, 0xFFFFFFFF));
+}
+
+TEST(ReportBatchTests, ReportChangeFilterHasOneWinnerPerPacket) {
+    ReportChangeFilter<1> filter;
+    constexpr uint32_t packets = 20000;
+    std::atomic<uint32_t> published = 0;
+    std::atomic<uint32_t> claims[packets] = {};
+    std::atomic<bool> stop = false;
+
+    // Readers poll the latest packet number, like game threads polling GetRawInputBuffer while the state changes
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 3; reader++) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                const uint32_t packet = published.load(std::memory_order_relaxed);
+                if (filter.Claim(0, packet))
+                    claims[packet].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (uint32_t packet = 1; packet < packets; packet++) {
+        published.store(packet, std::memory_order_relaxed);
+        if (packet % 64 == 0)
+            std::this_thread::yield();
+    }
+    std::this_thread::yield();
+    stop = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    for (uint32_t packet = 0; packet < packets; packet++)
+        ASSERT_LE(claims[packet].load(), 1u) << "packet " << packet;
+}
\ No newline at end of file
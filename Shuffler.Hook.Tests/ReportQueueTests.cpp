@@ -0,0 +1,283 @@
+#include "ReportQueue.h"
+#include "Fakes/EventFdSignal.h"
+#include "Fakes/FutexSignal.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr uint64_t SESSION = 0x1000;
+constexpr uint64_t NEXT_SESSION = 0x1001;
+constexpr size_t CAPACITY = 4;
+
+// Counts the waits of a signal, a reader that spins instead of sleeping until it is notified drives it up
+template <typename Signal>
+class CountingSignal : public Signal {
+  public:
+    static inline std::atomic<uint32_t> WaitCount = 0;
+
+    void Wait() {
+        WaitCount.fetch_add(1, std::memory_order_relaxed);
+        Signal::Wait();
+    }
+};
+
+template <typename Signal>
+using TestQueue = ReportQueue<sizeof(uint32_t), CAPACITY, CountingSignal<Signal>>;
+
+// Every report holds its own sequence number, so a read tells which report it got
+template <typename Queue>
+bool Push(Queue& queue, const uint32_t sequence, typename Queue::PendingRead* completed = nullptr,
+          const uint64_t session = SESSION) {
+    typename Queue::PendingRead ignored;
+    return queue.Push(session, sequence, reinterpret_cast<const uint8_t*>(&sequence), completed ? completed : &ignored);
+}
+
+template <typename Queue>
+uint32_t TryRead(Queue& queue, const uint64_t session = SESSION) {
+    uint32_t report = 0;
+    EXPECT_EQ(queue.TryRead(session, reinterpret_cast<uint8_t*>(&report)), Queue::ReadResult::Completed);
+    return report;
+}
+
+template <typename Signal>
+class ReportQueueTests : public testing::Test {
+  protected:
+    TestQueue<Signal> _queue;
+
+    void SetUp() override {
+        CountingSignal<Signal>::WaitCount = 0;
+        _queue.Open(SESSION);
+    }
+};
+
+using Signals = testing::Types<EventFdSignal, FutexSignal>;
+TYPED_TEST_SUITE(ReportQueueTests, Signals);
+}
+
+TYPED_TEST(ReportQueueTests, ReadsReportsInOrder) {
+    auto& queue = this->_queue;
+    uint32_t report;
+    EXPECT_EQ(queue.TryRead(SESSION, reinterpret_cast<uint8_t*>(&report)), TestQueue<TypeParam>::ReadResult::Pending);
+
+    for (uint32_t sequence = 1; sequence <= 3; sequence++)
+        EXPECT_FALSE(Push(queue, sequence));
+    for (uint32_t sequence = 1; sequence <= 3; sequence++)
+        EXPECT_EQ(TryRead(queue), sequence);
+}
+
+TYPED_TEST(ReportQueueTests, DropsTheOldestReportWhenFull) {
+    auto& queue = this->_queue;
+    for (uint32_t sequence = 1; sequence <= CAPACITY + 2; sequence++)
+        Push(queue, sequence);
+
+    for (uint32_t sequence = 3; sequence <= CAPACITY + 2; sequence++)
+        EXPECT_EQ(TryRead(queue), sequence);
+}
+
+TYPED_TEST(ReportQueueTests, DropsReportsThatAreNotNewer) {
+    auto& queue = this->_queue;
+    Push(queue, 5);
+    Push(queue, 4);
+    Push(queue, 5);
+    Push(queue, 7);
+    EXPECT_EQ(TryRead(queue), 5u);
+    EXPECT_EQ(TryRead(queue), 7u);
+
+    uint32_t report;
+    EXPECT_EQ(queue.TryRead(SESSION, reinterpret_cast<uint8_t*>(&report)), TestQueue<TypeParam>::ReadResult::Pending);
+
+    // A new session takes any sequence first, and sequences wrap
+    queue.Open(NEXT_SESSION);
+    Push(queue, 0xFFFFFFFF, nullptr, NEXT_SESSION);
+    Push(queue, 0, nullptr, NEXT_SESSION);
+    Push(queue, 0xFFFFFFFE, nullptr, NEXT_SESSION);
+    EXPECT_EQ(TryRead(queue, NEXT_SESSION), 0xFFFFFFFFu);
+    EXPECT_EQ(TryRead(queue, NEXT_SESSION), 0u);
+    EXPECT_EQ(queue.TryRead(NEXT_SESSION, reinterpret_cast<uint8_t*>(&report)),
+              TestQueue<TypeParam>::ReadResult::Pending);
+}
+
+TYPED_TEST(ReportQueueTests, PushesFillPendingReadsFirst) {
+    using Queue = TestQueue<TypeParam>;
+    auto& queue = this->_queue;
+    uint32_t buffers[2] = {};
+    int contexts[2];
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(queue.Read(SESSION, reinterpret_cast<uint8_t*>(&buffers[i]), &contexts[i]),
+                  Queue::ReadResult::Pending);
+    }
+
+    // Oldest pending read first, then the queue
+    typename Queue::PendingRead completed;
+    ASSERT_TRUE(Push(queue, 10, &completed));
+    EXPECT_EQ(completed.Context, &contexts[0]);
+    EXPECT_EQ(buffers[0], 10u);
+    ASSERT_TRUE(Push(queue, 11, &completed));
+    EXPECT_EQ(completed.Context, &contexts[1]);
+    EXPECT_EQ(buffers[1], 11u);
+
+    EXPECT_FALSE(Push(queue, 12, &completed));
+    uint32_t report;
+    EXPECT_EQ(queue.Read(SESSION, reinterpret_cast<uint8_t*>(&report), &contexts[0]), Queue::ReadResult::Completed);
+    EXPECT_EQ(report, 12u);
+}
+
+TYPED_TEST(ReportQueueTests, LimitsPendingReads) {
+    using Queue = TestQueue<TypeParam>;
+    auto& queue = this->_queue;
+    uint32_t buffers[Queue::MAX_PENDING_READS + 1];
+    for (size_t i = 0; i < Queue::MAX_PENDING_READS; i++) {
+        ASSERT_EQ(queue.Read(SESSION, reinterpret_cast<uint8_t*>(&buffers[i]), &buffers[i]),
+                  Queue::ReadResult::Pending);
+    }
+
+    uint8_t* last = reinterpret_cast<uint8_t*>(&buffers[Queue::MAX_PENDING_READS]);
+    EXPECT_EQ(queue.Read(SESSION, last, last), Queue::ReadResult::TooManyPending);
+}
+
+TYPED_TEST(ReportQueueTests, CancelsOneOrEveryPendingRead) {
+    using Queue = TestQueue<TypeParam>;
+    auto& queue = this->_queue;
+    uint32_t buffers[3];
+    for (auto& buffer : buffers)
+        ASSERT_EQ(queue.Read(SESSION, reinterpret_cast<uint8_t*>(&buffer), &buffer), Queue::ReadResult::Pending);
+
+    typename Queue::PendingRead cancelled[Queue::MAX_PENDING_READS];
+    ASSERT_EQ(queue.Cancel(SESSION, &buffers[1], cancelled), 1u);
+    EXPECT_EQ(cancelled[0].Context, &buffers[1]);
+    EXPECT_EQ(queue.Cancel(SESSION, &buffers[1], cancelled), 0u);
+    EXPECT_EQ(queue.Cancel(NEXT_SESSION, nullptr, cancelled), 0u);
+
+    // The reads left keep their order
+    ASSERT_EQ(queue.Cancel(SESSION, nullptr, cancelled), 2u);
+    EXPECT_EQ(cancelled[0].Context, &buffers[0]);
+    EXPECT_EQ(cancelled[1].Context, &buffers[2]);
+    EXPECT_FALSE(Push(queue, 1));
+}
+
+TYPED_TEST(ReportQueueTests, ClosedSessionsFailAndIgnorePushes) {
+    using Queue = TestQueue<TypeParam>;
+    auto& queue = this->_queue;
+    uint32_t buffer;
+    ASSERT_EQ(queue.Read(SESSION, reinterpret_cast<uint8_t*>(&buffer), &buffer), Queue::ReadResult::Pending);
+    Push(queue, 1);
+
+    typename Queue::PendingRead cancelled[Queue::MAX_PENDING_READS];
+    EXPECT_EQ(queue.Close(NEXT_SESSION, cancelled), 0u);
+    Push(queue, 2);
+    ASSERT_EQ(queue.Read(SESSION, reinterpret_cast<uint8_t*>(&buffer), &buffer), Queue::ReadResult::Completed);
+    ASSERT_EQ(queue.Read(SESSION, reinterpret_cast<uint8_t*>(&buffer), &buffer), Queue::ReadResult::Pending);
+
+    ASSERT_EQ(queue.Close(SESSION, cancelled), 1u);
+    EXPECT_EQ(cancelled[0].Context, &buffer);
+    EXPECT_FALSE(Push(queue, 3));
+    EXPECT_EQ(queue.TryRead(SESSION, reinterpret_cast<uint8_t*>(&buffer)), Queue::ReadResult::Closed);
+    EXPECT_EQ(queue.WaitRead(SESSION, reinterpret_cast<uint8_t*>(&buffer)), Queue::ReadResult::Closed);
+
+    // The next handle reusing the queue starts empty, and a producer still pushing for the old one cannot reach it
+    queue.Open(NEXT_SESSION);
+    EXPECT_FALSE(Push(queue, 4));
+    EXPECT_EQ(queue.TryRead(NEXT_SESSION, reinterpret_cast<uint8_t*>(&buffer)), Queue::ReadResult::Pending);
+}
+
+TYPED_TEST(ReportQueueTests, BlockingReaderWakesOnPush) {
+    using Queue = TestQueue<TypeParam>;
+    auto& queue = this->_queue;
+    std::atomic<uint32_t> report = 0;
+    std::thread reader([&] {
+        uint32_t buffer;
+        if (queue.WaitRead(SESSION, reinterpret_cast<uint8_t*>(&buffer)) == Queue::ReadResult::Completed)
+            report = buffer;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    Push(queue, 42);
+    reader.join();
+    EXPECT_EQ(report.load(), 42u);
+}
+
+TYPED_TEST(ReportQueueTests, IdleBlockingReaderSleeps) {
+    auto& queue = this->_queue;
+    std::thread reader([&] {
+        uint32_t buffer;
+        queue.WaitRead(SESSION, reinterpret_cast<uint8_t*>(&buffer));
+    });
+
+    // A reader that spins would have waited thousands of times by now, one that sleeps waits once
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const uint32_t waits = CountingSignal<TypeParam>::WaitCount.load();
+    Push(queue, 1);
+    reader.join();
+    EXPECT_LE(waits, 1u);
+}
+
+TYPED_TEST(ReportQueueTests, CloseWakesEveryBlockingReader) {
+    using Queue = TestQueue<TypeParam>;
+    auto& queue = this->_queue;
+    std::atomic<int> closedReads = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&] {
+            uint32_t buffer;
+            if (queue.WaitRead(SESSION, reinterpret_cast<uint8_t*>(&buffer)) == Queue::ReadResult::Closed)
+                closedReads.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    typename Queue::PendingRead cancelled[Queue::MAX_PENDING_READS];
+    queue.Close(SESSION, cancelled);
+    for (auto& reader : readers)
+        reader.join();
+    EXPECT_EQ(closedReads.load(), 3);
+}
+
+TYPED_TEST(ReportQueueTests, RacingProducersAndReadersKeepReportsInOrder) {
+    using Queue = TestQueue<TypeParam>;
+    auto& queue = this->_queue;
+    constexpr uint32_t reports = 20000;
+    std::atomic<uint32_t> nextSequence = 1;
+    std::atomic<int> outOfOrder = 0;
+    std::atomic<bool> newestRead = false;
+
+    // Like game threads whose reads move the packet number, each pushing what it read
+    std::vector<std::thread> producers;
+    for (int i = 0; i < 2; i++) {
+        producers.emplace_back([&] {
+            for (uint32_t sequence; (sequence = nextSequence.fetch_add(1)) <= reports;)
+                Push(queue, sequence);
+        });
+    }
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; i++) {
+        readers.emplace_back([&] {
+            uint32_t previous = 0;
+            uint32_t buffer;
+            while (queue.WaitRead(SESSION, reinterpret_cast<uint8_t*>(&buffer)) == Queue::ReadResult::Completed) {
+                if (buffer <= previous)
+                    outOfOrder.fetch_add(1, std::memory_order_relaxed);
+                previous = buffer;
+                if (buffer == reports)
+                    newestRead = true;
+            }
+        });
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    // Whatever was dropped on the way, the last report pushed is the newest one
+    while (!newestRead.load())
+        std::this_thread::yield();
+
+    typename Queue::PendingRead cancelled[Queue::MAX_PENDING_READS];
+    queue.Close(SESSION, cancelled);
+    for (auto& reader : readers)
+        reader.join();
+    EXPECT_EQ(outOfOrder.load(), 0);
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "EmulatedDeviceDefinitions.h"
+#include "SharedBlock.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr uint8_t DATA[32] = {1, 2, 3};
+constexpr uint8_t OTHER_DATA[32] = {4, 5, 6};
+}
+
+TEST(SharedBlockTests, HandsEveryCallerTheSameBlock) {
+    SharedBlock block(DATA, sizeof(DATA));
+    EXPECT_EQ(block.Acquire(), DATA);
+    EXPECT_EQ(block.Acquire(), DATA);
+    EXPECT_EQ(block.GetReferenceCount(), 2u);
+    EXPECT_EQ(block.GetSize(), sizeof(DATA));
+    EXPECT_TRUE(block.Owns(DATA));
+    EXPECT_FALSE(block.Owns(OTHER_DATA));
+}
+
+TEST(SharedBlockTests, ReleasesOncePerAcquire) {
+    SharedBlock block(DATA, sizeof(DATA));
+    const void* first = block.Acquire();
+    const void* second = block.Acquire();
+
+    EXPECT_TRUE(block.Release(first));
+    EXPECT_TRUE(block.Release(second));
+    EXPECT_EQ(block.GetReferenceCount(), 0u);
+    EXPECT_FALSE(block.Release(first));
+    EXPECT_EQ(block.GetReferenceCount(), 0u);
+}
+
+TEST(SharedBlockTests, RejectsOtherPointers) {
+    SharedBlock block(DATA, sizeof(DATA));
+    block.Acquire();
+
+    // Another block, a pointer into this one, and the null a failed HidD_GetPreparsedData leaves behind
+    EXPECT_FALSE(block.Release(OTHER_DATA));
+    EXPECT_FALSE(block.Release(DATA + 1));
+    EXPECT_FALSE(block.Release(nullptr));
+    EXPECT_EQ(block.GetReferenceCount(), 1u);
+}
+
+TEST(SharedBlockTests, RepeatedEnumerationKeepsOneBlock) {
+    SharedBlock block(DATA, sizeof(DATA));
+    for (int pass = 0; pass < 10000; pass++) {
+        const void* data = block.Acquire();
+        ASSERT_EQ(data, DATA);
+        ASSERT_TRUE(block.Release(data));
+    }
+    EXPECT_EQ(block.GetReferenceCount(), 0u);
+}
+
+TEST(SharedBlockTests, ConcurrentCallersBalanceOut) {
+    SharedBlock block(DATA, sizeof(DATA));
+    constexpr int threadCount = 4;
+    constexpr int rounds = 50000;
+    std::atomic<int> failures = 0;
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadCount; thread++) {
+        threads.emplace_back([&] {
+            for (int round = 0; round < rounds; round++) {
+                const void* first = block.Acquire();
+                const void* second = block.Acquire();
+                if (!block.Release(second) || !block.Release(first))
+                    failures.fetch_add(1, std::memory_order_relaxed);
+                // Unmatched releases racing the others must never take their references
+                if (block.Release(OTHER_DATA))
+                    failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(block.GetReferenceCount(), 0u);
+}
+
+TEST(SharedBlockTests, ExtraReleasesNeverUnderflow) {
+    SharedBlock block(DATA, sizeof(DATA));
+    constexpr int references = 1000;
+    for (int i = 0; i < references; i++)
+        block.Acquire();
+
+    // Twice as many releases as references, from several threads: exactly the references succeed
+    std::atomic<int> released = 0;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; thread++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < references / 2; i++) {
+                if (block.Release(DATA))
+                    released.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(released.load(), references);
+    EXPECT_EQ(block.GetReferenceCount(), 0u);
+}
+
+TEST(SharedBlockTests, PreparsedDataImageIsAlignedLikeAHeapBlock) {
+    const auto address = reinterpret_cast<uintptr_t>(EmulatedDeviceDefinitions::PREPROCESSED_DATA.data());
+    EXPECT_EQ(address % 16, 0u);
+
+    SharedBlock block(EmulatedDeviceDefinitions::PREPROCESSED_DATA.data(),
+                      EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE);
+    EXPECT_EQ(block.Acquire(), EmulatedDeviceDefinitions::PREPROCESSED_DATA.data());
+    EXPECT_EQ(block.GetSize(), EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE);
+}
\ No newline at end of file
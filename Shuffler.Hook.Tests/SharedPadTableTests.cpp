@@ -0,0 +1,137 @@
+#include "InputSource.h"
+#include "Fakes/PadFeedPublisher.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(SharedPadTableTests, OpenFailsUntilTheFeedIsPublished) {
+    SharedPadInputSource source;
+    EXPECT_FALSE(source.Open());
+
+    PadFeedPublisher publisher;
+    ASSERT_TRUE(publisher.IsOpen());
+    EXPECT_TRUE(source.Open());
+}
+
+TEST(SharedPadTableTests, ReadsThePlayersSlotThroughItsOwnView) {
+    PadFeedPublisher publisher(4);
+    SharedPadInputSource source;
+    ASSERT_TRUE(source.Open());
+
+    ControllerState state;
+    EXPECT_FALSE(source.GetState(0, &state)) << "never published";
+
+    publisher.Publish(0, MakeCheckedState(10), true);
+    publisher.Publish(3, MakeCheckedState(13), true);
+    publisher.Publish(2, MakeCheckedState(12), false);
+
+    uint32_t value = 0;
+    ASSERT_TRUE(source.GetState(0, &state));
+    ASSERT_TRUE(ReadCheckedState(state, &value));
+    EXPECT_EQ(value, 10u);
+    ASSERT_TRUE(source.GetState(3, &state));
+    ASSERT_TRUE(ReadCheckedState(state, &value));
+    EXPECT_EQ(value, 13u);
+
+    // Disconnected players still hand back what was published for them
+    EXPECT_FALSE(source.GetState(2, &state));
+    ASSERT_TRUE(ReadCheckedState(state, &value));
+    EXPECT_EQ(value, 12u);
+
+    // Past the slots the publisher declared, or out of range
+    EXPECT_FALSE(source.GetState(4, &state));
+    EXPECT_FALSE(source.GetState(-1, &state));
+    publisher.GetTable()->SlotCount = 1000;
+    EXPECT_FALSE(source.GetState(SharedPadTable::MAX_PLAYERS, &state));
+}
+
+TEST(SharedPadTableTests, GivesUpOnASlotWhosePublisherDiedMidWrite) {
+    PadFeedPublisher publisher;
+    SharedPadInputSource source;
+    ASSERT_TRUE(source.Open());
+    publisher.Publish(1, MakeCheckedState(1), true);
+    publisher.AbandonWrite(1);
+
+    ControllerState state;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(source.GetState(1, &state));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+}
+
+TEST(SharedPadTableTests, RejectsATableOfAnotherVersion) {
+    PadFeedPublisher publisher;
+    publisher.GetTable()->Version = SharedPadTable::VERSION + 1;
+
+    SharedPadInputSource source;
+    EXPECT_FALSE(source.Open());
+}
+
+// Readers in every game poll while the controlling process publishes flat out: no reader may see a torn state or go
+// back in time, and readers must not slow each other down to a crawl
+TEST(SharedPadTableTests, ManyReadersSeeWholeMonotonicStates) {
+    constexpr int READERS = 8;
+    constexpr int PLAYERS = 4;
+    constexpr auto DURATION = std::chrono::milliseconds(300);
+
+    PadFeedPublisher publisher;
+    for (int player = 0; player < PLAYERS; player++)
+        publisher.Publish(player, MakeCheckedState(0), true);
+
+    std::atomic<bool> stop = false;
+    std::thread writer([&] {
+        for (uint32_t value = 1; !stop.load(std::memory_order_relaxed); value++) {
+            for (int player = 0; player < PLAYERS; player++)
+                publisher.Publish(player, MakeCheckedState(value * PLAYERS + player), true);
+        }
+    });
+
+    std::vector<uint64_t> reads(READERS);
+    std::vector<uint64_t> failures(READERS);
+    std::vector<uint8_t> valid(READERS, 1);
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < READERS; reader++) {
+        readers.emplace_back([&, reader] {
+            SharedPadInputSource source;
+            if (!source.Open()) {
+                valid[reader] = false;
+                return;
+            }
+
+            uint32_t last[PLAYERS] = {};
+            while (!stop.load(std::memory_order_relaxed)) {
+                const int player = static_cast<int>(reads[reader] % PLAYERS);
+                ControllerState state;
+                uint32_t value = 0;
+                if (!source.GetState(player, &state)) {
+                    failures[reader]++;  // Raced the writer MAX_READ_ATTEMPTS times in a row
+                    continue;
+                }
+
+                valid[reader] &= ReadCheckedState(state, &value) && value % PLAYERS == static_cast<uint32_t>(player) &&
+                                 value >= last[player];
+                last[player] = value;
+                reads[reader]++;
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(DURATION);
+    stop = true;
+    writer.join();
+    for (auto& reader : readers)
+        reader.join();
+
+    uint64_t totalReads = 0;
+    for (int reader = 0; reader < READERS; reader++) {
+        EXPECT_TRUE(valid[reader]) << reader;
+        EXPECT_GT(reads[reader], 1000u) << reader;
+        // A read only fails if the writer stays mid-write for a whole retry loop, which takes the writer being
+        // preempted there, so this is rare with a core to spare and a few percent on a single core
+        EXPECT_LT(failures[reader], reads[reader] / 10 + 1) << reader;
+        totalReads += reads[reader];
+    }
+
+    const double seconds = std::chrono::duration<double>(DURATION).count();
+    RecordProperty("ReadsPerSecond", std::to_string(static_cast<uint64_t>(static_cast<double>(totalReads) / seconds)));
+}
\ No newline at end of file
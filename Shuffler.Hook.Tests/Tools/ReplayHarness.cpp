@@ -0,0 +1,201 @@
+// Replays an input stream through the remap pipeline and the HID report encoder and prints a hash of everything the
+// game would have been handed, so a session recorded with InputStreamRecorder can check that a change to the pipeline
+// leaves its output alone, or show that it does not.
+//
+// Samples are fed in recorded order on the stream's own timestamps. ReplayInputSource is not used because it paces
+// playback by the wall clock, which makes which samples get read depend on scheduling.
+//
+// Usage: ReplayHarness [--file <stream> | --seed <n>] [--runs <n>] [--expect <hash>]
+
+#include "AnalogResponse.h"
+#include "AxisNoiseGate.h"
+#include "AxisRouter.h"
+#include "HidReportEncoder.h"
+#include "InputStream.h"
+#include "RemapTable.h"
+#include "Fakes/InputSession.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325;
+constexpr uint64_t FNV_PRIME = 0x100000001B3;
+constexpr size_t SYNTHETIC_SAMPLES = 200'000;
+
+struct ReplayResult {
+    uint64_t Hash = FNV_OFFSET;
+    size_t Samples = 0;
+    size_t ReportChanges = 0;
+};
+
+void Hash(uint64_t* hash, const void* data, const size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+        *hash = (*hash ^ bytes[i]) * FNV_PRIME;
+}
+
+InputAction MakeButton(const Button button) {
+    InputAction action{};
+    action.Type = InputType::Button;
+    action.Button = button;
+    return action;
+}
+
+InputAction MakeTrigger(const TriggerInput trigger) {
+    InputAction action{};
+    action.Type = InputType::Trigger;
+    action.Trigger = trigger;
+    return action;
+}
+
+// A profile that exercises every stage: gated and curved sticks, mixed axes, a stick driving the D-pad and remapped
+// buttons and triggers
+struct Profile {
+    AnalogSettings Analog;
+    AnalogResponse Response;
+    AxisRouter Router;
+    RemapTable Table;
+
+    Profile() : Response(AnalogResponse::Compile(MakeAnalog())), Router(AxisRouter::Compile(MakeRouting())),
+                Table(RemapTable::Compile(MakeMappings())) {
+        Analog = MakeAnalog();
+    }
+
+  private:
+    static AnalogSettings MakeAnalog() {
+        AnalogSettings settings;
+        settings.LeftStick = {.Deadzone = 4000, .AntiDeadzone = 2000, .OuterDeadzone = 31000, .Curve = 1.6f,
+                              .NoiseGate = 300};
+        settings.RightStick = {.Deadzone = 2500, .Curve = 0.8f, .NoiseGate = 12};
+        settings.LeftTrigger = {.Deadzone = 10, .Curve = 2.0f, .NoiseGate = 6};
+        settings.RightTrigger = {.AntiDeadzone = 20};
+        return settings;
+    }
+
+    static AxisRoutingSettings MakeRouting() {
+        AxisRoutingSettings settings;
+        settings.Matrix[0][0] = 0.75f;
+        settings.Matrix[0][2] = 0.25f;
+        settings.Matrix[1][1] = -1;
+        settings.Matrix[4][4] = 0.5f;
+        settings.Matrix[4][5] = 0.5f;
+        settings.StickToDpad = StickSelection::Right;
+        settings.StickToDpadThreshold = 20000;
+        return settings;
+    }
+
+    static std::vector<ActionMapping> MakeMappings() {
+        return {
+            {MakeButton(Button::A), MakeButton(Button::B)},
+            {MakeButton(Button::B), MakeButton(Button::A)},
+            {MakeButton(Button::X), MakeTrigger(TriggerInput::RightTrigger)},
+            {MakeTrigger(TriggerInput::LeftTrigger), MakeButton(Button::LeftShoulder)},
+        };
+    }
+};
+
+ReplayResult Replay(const std::vector<uint8_t>& data) {
+    InputStreamReader reader;
+    if (!reader.Open(data)) {
+        fprintf(stderr, "Not an input stream or an unsupported version\n");
+        exit(2);
+    }
+
+    const Profile profile;
+    AxisNoiseGate gate;
+    ReplayResult result;
+    uint8_t report[HidReportEncoder::REPORT_LENGTH];
+    uint8_t lastReport[HidReportEncoder::REPORT_LENGTH] = {};
+
+    InputStreamSample sample;
+    while (reader.Next(&sample)) {
+        ControllerState source = sample.State;
+        ControllerState state = {};
+        gate.Apply(profile.Analog, &source);
+        profile.Response.Apply(&source);
+        profile.Router.Apply(&source);
+        profile.Table.Apply(source, &state);
+        HidReportEncoder::Encode(state, report);
+
+        Hash(&result.Hash, &sample.Timestamp, sizeof(sample.Timestamp));
+        Hash(&result.Hash, &sample.Connected, sizeof(sample.Connected));
+        Hash(&result.Hash, &state, sizeof(state));
+        Hash(&result.Hash, report, sizeof(report));
+
+        result.Samples++;
+        if (memcmp(report, lastReport, sizeof(report)) != 0) {
+            result.ReportChanges++;
+            memcpy(lastReport, report, sizeof(report));
+        }
+    }
+    return result;
+}
+
+[[noreturn]] void Usage() {
+    fprintf(stderr, "Usage: ReplayHarness [--file <stream> | --seed <n>] [--runs <n>] [--expect <hash>]\n");
+    exit(2);
+}
+}
+
+int main(const int argc, char** argv) {
+    const char* path = nullptr;
+    uint32_t seed = 1;
+    int runs = 2;
+    const char* expected = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 == argc)
+            Usage();
+        if (strcmp(argv[i], "--file") == 0)
+            path = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0)
+            seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--runs") == 0)
+            runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--expect") == 0)
+            expected = argv[++i];
+        else
+            Usage();
+    }
+    if (runs < 1)
+        Usage();
+
+    std::vector<uint8_t> data;
+    if (path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "Failed to open %s\n", path);
+            return 2;
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+        data = InputSession::Encode(InputSession::Make(seed, SYNTHETIC_SAMPLES), 256);
+    }
+
+    // Every run starts from fresh tables and gates, so state left over from one run cannot hide in the next
+    const ReplayResult first = Replay(data);
+    for (int run = 1; run < runs; run++) {
+        const ReplayResult result = Replay(data);
+        if (result.Hash != first.Hash) {
+            fprintf(stderr, "Run %d produced %016llx instead of %016llx\n", run + 1,
+                    static_cast<unsigned long long>(result.Hash), static_cast<unsigned long long>(first.Hash));
+            return 1;
+        }
+    }
+
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(first.Hash));
+    printf("%s  %zu samples, %zu report changes, %d runs\n", hash, first.Samples, first.ReportChanges, runs);
+
+    if (expected && strcmp(expected, hash) != 0) {
+        fprintf(stderr, "Expected %s\n", expected);
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
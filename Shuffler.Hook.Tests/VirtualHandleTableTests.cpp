@@ -0,0 +1,195 @@
+#include "VirtualHandleTable.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+using Table = VirtualHandleTable<uint32_t, 4>;
+
+void* Handle(const uintptr_t value) {
+    return reinterpret_cast<void*>(value);
+}
+}
+
+TEST(VirtualHandleTableTests, OpensDistinctHandlesInRange) {
+    Table table;
+    std::set<void*> handles;
+    std::set<int> indices;
+    for (uint32_t i = 0; i < Table::CAPACITY; i++) {
+        void* handle = table.Open(i + 10);
+        ASSERT_NE(handle, nullptr);
+        EXPECT_TRUE(Table::IsInRange(handle));
+        handles.insert(handle);
+        indices.insert(table.GetIndex(handle));
+    }
+
+    EXPECT_EQ(handles.size(), Table::CAPACITY);
+    EXPECT_EQ(indices.size(), Table::CAPACITY);
+    EXPECT_EQ(*indices.begin(), 0);
+    EXPECT_EQ(*indices.rbegin(), static_cast<int>(Table::CAPACITY) - 1);
+}
+
+TEST(VirtualHandleTableTests, ReturnsTheValueOfEachHandle) {
+    Table table;
+    void* first = table.Open(1);
+    void* second = table.Open(2);
+
+    uint32_t value = 0;
+    EXPECT_TRUE(table.TryGet(first, &value));
+    EXPECT_EQ(value, 1u);
+    EXPECT_TRUE(table.TryGet(second, &value));
+    EXPECT_EQ(value, 2u);
+}
+
+TEST(VirtualHandleTableTests, OpenFailsOnceFullUntilAHandleCloses) {
+    Table table;
+    std::vector<void*> handles;
+    for (uint32_t i = 0; i < Table::CAPACITY; i++)
+        handles.push_back(table.Open(i));
+
+    EXPECT_EQ(table.Open(99), nullptr);
+    EXPECT_TRUE(table.Close(handles[2]));
+
+    void* reopened = table.Open(99);
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_EQ(table.GetIndex(reopened), 2);
+    EXPECT_EQ(table.Open(100), nullptr);
+}
+
+TEST(VirtualHandleTableTests, RejectsClosedHandlesAfterTheirEntryIsReused) {
+    Table table;
+    void* closed = table.Open(1);
+    EXPECT_TRUE(table.Close(closed));
+    EXPECT_FALSE(table.Close(closed));
+
+    void* reused = table.Open(2);
+    ASSERT_EQ(table.GetIndex(reused), 0);
+    EXPECT_NE(reused, closed);
+
+    uint32_t value = 0;
+    EXPECT_FALSE(table.TryGet(closed, &value));
+    EXPECT_EQ(table.GetIndex(closed), -1);
+    EXPECT_FALSE(table.Close(closed));
+    EXPECT_TRUE(table.TryGet(reused, &value));
+    EXPECT_EQ(value, 2u);
+}
+
+TEST(VirtualHandleTableTests, RejectsHandlesItNeverIssued) {
+    Table table;
+    void* open = table.Open(1);
+    const auto base = Table::BASE;
+
+    const uintptr_t others[] = {
+        0,
+        4,
+        0x1234,                                       // An emulated raw input device
+        0x00FFFFFC,                                   // The highest kernel handle value
+        static_cast<uintptr_t>(-1),                   // INVALID_HANDLE_VALUE and the current process
+        static_cast<uintptr_t>(-2),                   // The current thread
+        base + 1,                                     // Not a multiple of 4
+        base | Table::CAPACITY << 2,                  // Past the last entry
+        reinterpret_cast<uintptr_t>(open) ^ 1 << 8,   // Another generation
+        reinterpret_cast<uintptr_t>(open) | 1ull << 32,
+    };
+
+    uint32_t value = 0;
+    for (const uintptr_t other : others) {
+        EXPECT_FALSE(table.TryGet(Handle(other), &value)) << std::hex << other;
+        EXPECT_EQ(table.GetIndex(Handle(other)), -1) << std::hex << other;
+        EXPECT_FALSE(table.Close(Handle(other))) << std::hex << other;
+    }
+
+    EXPECT_FALSE(Table::IsInRange(Handle(0x00FFFFFC)));
+    EXPECT_FALSE(Table::IsInRange(Handle(base | Table::CAPACITY << 2)));
+    EXPECT_TRUE(Table::IsInRange(Handle(base | (Table::CAPACITY - 1) << 2)));
+    EXPECT_TRUE(table.TryGet(open, &value));
+}
+
+TEST(VirtualHandleTableTests, HandlesOfAReusedEntryDifferUntilTheGenerationWraps) {
+    Table table;
+    void* first = table.Open(0);
+    table.Close(first);
+
+    std::set<void*> handles = {first};
+    for (int i = 1; i < 0x10000; i++) {
+        void* handle = table.Open(0);
+        ASSERT_EQ(table.GetIndex(handle), 0);
+        EXPECT_TRUE(handles.insert(handle).second) << i;
+        table.Close(handle);
+    }
+
+    EXPECT_EQ(table.Open(0), first);
+}
+
+TEST(VirtualHandleTableTests, ThreadsOpenAndCloseWithoutSharingEntries) {
+    VirtualHandleTable<uint32_t, 8> table;
+    constexpr int threadCount = 4;
+    constexpr int rounds = 20000;
+    std::atomic<int> failures = 0;
+    std::atomic<int> owners[8] = {};
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < threadCount; thread++) {
+        threads.emplace_back([&, thread] {
+            void* handles[2] = {};
+            int indices[2] = {};
+            for (uint32_t round = 0; round < rounds; round++) {
+                const uint32_t value = thread << 24 | round;
+                // Four threads holding at most two handles each never run out of entries
+                void* handle = table.Open(value);
+                if (!handle) {
+                    failures.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                // No other thread may be holding the same entry
+                const int index = table.GetIndex(handle);
+                if (index < 0 || owners[index].fetch_add(1, std::memory_order_relaxed) != 0) {
+                    failures.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                uint32_t read = 0;
+                if (!table.TryGet(handle, &read) || read != value)
+                    failures.fetch_add(1, std::memory_order_relaxed);
+
+                handles[round % 2] = handle;
+                indices[round % 2] = index;
+
+                void*& previous = handles[(round + 1) % 2];
+                if (previous) {
+                    owners[indices[(round + 1) % 2]].fetch_sub(1, std::memory_order_relaxed);
+                    if (!table.Close(previous))
+                        failures.fetch_add(1, std::memory_order_relaxed);
+                    // Only the entry's next generation can be open now, under another handle
+                    if (table.TryGet(previous, &read) || table.Close(previous))
+                        failures.fetch_add(1, std::memory_order_relaxed);
+                    previous = nullptr;
+                }
+            }
+
+            for (int i = 0; i < 2; i++) {
+                if (handles[i]) {
+                    owners[indices[i]].fetch_sub(1, std::memory_order_relaxed);
+                    table.Close(handles[i]);
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(failures.load(), 0);
+
+    // Every entry is back on the free list exactly once
+    std::set<void*> handles;
+    for (size_t i = 0; i < decltype(table)::CAPACITY; i++)
+        handles.insert(table.Open(0));
+    EXPECT_EQ(handles.size(), decltype(table)::CAPACITY);
+    EXPECT_EQ(handles.count(nullptr), 0u);
+    EXPECT_EQ(table.Open(0), nullptr);
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "VirtualSlotTable.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(VirtualSlotTableTests, OnlySlotZeroIsConnectedByDefault) {
+    const VirtualSlotTable table;
+    VirtualSlot slot = {0xFF, 0xFF};
+    ASSERT_TRUE(table.TryGet(0, &slot));
+    EXPECT_EQ(slot.PlayerIndex, 0);
+    EXPECT_EQ(slot.ControllerIndex, 0);
+    EXPECT_EQ(table.GetConnectedMask(), 1u);
+
+    for (const int index : {1, 2, 3}) {
+        EXPECT_FALSE(table.TryGet(index, &slot));
+        EXPECT_FALSE(table.IsConnected(index));
+    }
+}
+
+TEST(VirtualSlotTableTests, RejectsSlotsOutOfRange) {
+    VirtualSlotTable table;
+    VirtualSlot slot;
+    for (const int index : {-1, VirtualSlotTable::MAX_SLOTS, 255}) {
+        EXPECT_FALSE(table.TryGet(index, &slot));
+        EXPECT_FALSE(table.IsConnected(index));
+        EXPECT_FALSE(table.Bind(index, {1, 1}));
+        EXPECT_FALSE(table.SetPlayer(index, 1));
+        EXPECT_FALSE(table.Unbind(index));
+    }
+    EXPECT_EQ(table.GetConnectedMask(), 1u);
+}
+
+TEST(VirtualSlotTableTests, BindsEverySlotIndependently) {
+    VirtualSlotTable table;
+    for (int index = 0; index < VirtualSlotTable::MAX_SLOTS; index++)
+        ASSERT_TRUE(table.Bind(index, {static_cast<uint8_t>(10 + index), static_cast<uint8_t>(3 - index)}));
+    EXPECT_EQ(table.GetConnectedMask(), 0xFu);
+
+    ASSERT_TRUE(table.Unbind(1));
+    ASSERT_TRUE(table.SetPlayer(2, 200));
+    EXPECT_EQ(table.GetConnectedMask(), 0xDu);
+
+    VirtualSlot slot;
+    ASSERT_TRUE(table.TryGet(0, &slot));
+    EXPECT_EQ(slot.PlayerIndex, 10);
+    EXPECT_EQ(slot.ControllerIndex, 3);
+    EXPECT_FALSE(table.TryGet(1, &slot));
+    ASSERT_TRUE(table.TryGet(2, &slot));
+    EXPECT_EQ(slot.PlayerIndex, 200);
+    EXPECT_EQ(slot.ControllerIndex, 1);
+    ASSERT_TRUE(table.TryGet(3, &slot));
+    EXPECT_EQ(slot.PlayerIndex, 13);
+    EXPECT_EQ(slot.ControllerIndex, 0);
+}
+
+TEST(VirtualSlotTableTests, SetPlayerKeepsTheConnectionAsItIs) {
+    VirtualSlotTable table;
+    ASSERT_TRUE(table.SetPlayer(1, 5));
+    EXPECT_FALSE(table.IsConnected(1));
+
+    // Binding later connects it with the player set in the meantime overwritten, like any bind
+    ASSERT_TRUE(table.Bind(1, {6, 2}));
+    ASSERT_TRUE(table.SetPlayer(1, 7));
+    VirtualSlot slot;
+    ASSERT_TRUE(table.TryGet(1, &slot));
+    EXPECT_EQ(slot.PlayerIndex, 7);
+    EXPECT_EQ(slot.ControllerIndex, 2);
+}
+
+// Bindings change while the hooks read them: a reader must always see a binding that was actually made, never the
+// player of one and the controller of another
+TEST(VirtualSlotTableTests, ReadersNeverSeeHalfABinding) {
+    VirtualSlotTable table;
+    std::atomic<bool> stop = false;
+    std::atomic<uint64_t> torn = 0;
+    std::atomic<uint64_t> reads = 0;
+
+    std::vector<std::thread> threads;
+    for (int index = 0; index < VirtualSlotTable::MAX_SLOTS; index++) {
+        threads.emplace_back([&, index] {
+            for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                const auto value = static_cast<uint8_t>(i);
+                if (i % 7 == 0)
+                    table.Unbind(index);
+                else
+                    table.Bind(index, {value, value});
+            }
+        });
+    }
+
+    // SetPlayer races the binds of slot 0 and may only ever change the player
+    threads.emplace_back([&] {
+        for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+            VirtualSlot slot;
+            if (table.TryGet(0, &slot))
+                table.SetPlayer(0, slot.ControllerIndex);
+        }
+    });
+
+    for (int reader = 0; reader < 2; reader++) {
+        threads.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int index = 0; index < VirtualSlotTable::MAX_SLOTS; index++) {
+                    VirtualSlot slot;
+                    if (table.TryGet(index, &slot)) {
+                        torn.fetch_add(slot.PlayerIndex != slot.ControllerIndex, std::memory_order_relaxed);
+                        reads.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stop = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_GT(reads.load(), 1000u);
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "AnalogResponse.h"
+
+#include <algorithm>
+#include <cmath>
+
+AnalogResponse::AnalogResponse() : _sticks{}, _triggers{} {
+    for (auto& stick : _sticks)
+        stick.Passthrough = true;
+
+    for (auto& trigger : _triggers) {
+        for (int value = 0; value < 256; value++)
+            trigger[value] = static_cast<uint8_t>(value);
+    }
+}
+
+AnalogResponse AnalogResponse::Compile(const AnalogSettings& settings) {
+    AnalogResponse response;
+    CompileStick(settings.LeftStick, &response._sticks[0]);
+    CompileStick(settings.RightStick, &response._sticks[1]);
+    CompileTrigger(settings.LeftTrigger, response._triggers[0]);
+    CompileTrigger(settings.RightTrigger, response._triggers[1]);
+    return response;
+}
+
+void AnalogResponse::CompileStick(const StickResponse& response, StickTable* table) {
+    const StickResponse passthrough;
+    table->Passthrough = response.Deadzone == passthrough.Deadzone &&
+                         response.AntiDeadzone == passthrough.AntiDeadzone &&
+                         response.OuterDeadzone >= passthrough.OuterDeadzone && response.Curve == passthrough.Curve;
+    if (table->Passthrough)
+        return;
+
+    const double deadzone = response.Deadzone;
+    const double outer = std::max<double>(response.OuterDeadzone, deadzone + 1);
+    const double antiDeadzone = std::min<double>(response.AntiDeadzone, 32767);
+    const double curve = response.Curve > 0 ? response.Curve : 1.0;
+
+    table->DeadzoneSquared = static_cast<uint32_t>(deadzone * deadzone);
+
+    // Apply zeroes the deadzone itself. Samples inside it take the value just past its edge instead, so the interval
+    // the edge falls in interpolates between two outputs the stick can reach and the anti-deadzone is not smeared
+    // across it. The first interval, magnitudes up to 1024, keeps the scale of its end: near the center the scale can
+    // grow without bound, which interpolating towards would overshoot
+    for (uint32_t index = 0; index < SCALE_COUNT; index++) {
+        const double magnitude = std::max(
+            std::sqrt(static_cast<double>(std::max(index, 1u)) * (1u << MAGNITUDE_SHIFT)), deadzone + 0.5);
+        const double position = std::min((magnitude - deadzone) / (outer - deadzone), 1.0);
+        const double output = antiDeadzone + (32767 - antiDeadzone) * std::pow(position, curve);
+        table->Scales[index] = static_cast<uint32_t>(std::lround(output / magnitude * 65536));
+    }
+}
+
+void AnalogResponse::CompileTrigger(const TriggerResponse& response, uint8_t* table) {
+    const double deadzone = std::min<double>(response.Deadzone, 254);
+    const double antiDeadzone = response.AntiDeadzone;
+    const double curve = response.Curve > 0 ? response.Curve : 1.0;
+
+    for (int value = 0; value < 256; value++) {
+        if (value <= deadzone) {
+            table[value] = 0;
+            continue;
+        }
+
+        const double position = (value - deadzone) / (255 - deadzone);
+        const double output = antiDeadzone + (255 - antiDeadzone) * std::pow(position, curve);
+        table[value] = static_cast<uint8_t>(std::lround(output));
+    }
+}
\ No newline at end of file
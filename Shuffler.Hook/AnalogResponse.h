@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include <cstdint>
+
+struct StickResponse {
+    uint16_t Deadzone = 0;           // Radial, magnitudes up to this read as centered
+    uint16_t AntiDeadzone = 0;       // Smallest magnitude handed out once the stick leaves the deadzone
+    uint16_t OuterDeadzone = 32767;  // Magnitudes past this read as fully deflected
+    float Curve = 1.0f;              // Exponent applied between the deadzones, 1 is linear
+    uint16_t NoiseGate = 0;          // Axis movements up to this are held back, see AxisNoiseGate
+};
+
+struct TriggerResponse {
+    uint8_t Deadzone = 0;
+    uint8_t AntiDeadzone = 0;
+    float Curve = 1.0f;
+    uint8_t NoiseGate = 0;
+};
+
+struct AnalogSettings {
+    StickResponse LeftStick;
+    StickResponse RightStick;
+    TriggerResponse LeftTrigger;
+    TriggerResponse RightTrigger;
+};
+
+/**
+ * A player's AnalogSettings baked into lookup tables, so applying deadzones and curves costs a few table reads and
+ * multiplies instead of square roots and pow on every poll.
+ *
+ * Each stick has a table of the 16.16 fixed point factor both axes are scaled by, sampled at evenly spaced squared
+ * magnitudes and linearly interpolated in between. Each trigger has a table with the output for every input value.
+ */
+class AnalogResponse {
+    static constexpr uint32_t MAGNITUDE_SHIFT = 20;
+    static constexpr uint32_t MAX_SQUARED_MAGNITUDE = 2u * 32768 * 32768;
+    static constexpr uint32_t SCALE_COUNT = (MAX_SQUARED_MAGNITUDE >> MAGNITUDE_SHIFT) + 2;
+
+    struct StickTable {
+        bool Passthrough;
+        uint32_t DeadzoneSquared;
+        uint32_t Scales[SCALE_COUNT];
+    };
+
+    StickTable _sticks[2];
+    uint8_t _triggers[2][256];
+
+  public:
+    AnalogResponse();
+
+    static AnalogResponse Compile(const AnalogSettings& settings);
+
+    void Apply(ControllerState* state) const {
+        ApplyStick(_sticks[0], &state->LeftThumbstickX, &state->LeftThumbstickY);
+        ApplyStick(_sticks[1], &state->RightThumbstickX, &state->RightThumbstickY);
+        state->LeftTrigger = _triggers[0][state->LeftTrigger];
+        state->RightTrigger = _triggers[1][state->RightTrigger];
+    }
+
+  private:
+    static void CompileStick(const StickResponse& response, StickTable* table);
+    static void CompileTrigger(const TriggerResponse& response, uint8_t* table);
+
+    static void ApplyStick(const StickTable& table, int16_t* x, int16_t* y) {
+        if (table.Passthrough)
+            return;
+
+        const int32_t sourceX = *x;
+        const int32_t sourceY = *y;
+        const uint32_t squaredMagnitude =
+            static_cast<uint32_t>(sourceX * sourceX) + static_cast<uint32_t>(sourceY * sourceY);
+        if (squaredMagnitude <= table.DeadzoneSquared) {
+            *x = *y = 0;
+            return;
+        }
+
+        const uint32_t index = squaredMagnitude >> MAGNITUDE_SHIFT;
+        const int64_t fraction = squaredMagnitude & ((1u << MAGNITUDE_SHIFT) - 1);
+        const int64_t low = table.Scales[index];
+        const int64_t scale = low + (((table.Scales[index + 1] - low) * fraction) >> MAGNITUDE_SHIFT);
+        *x = ClampAxis((sourceX * scale) >> 16);
+        *y = ClampAxis((sourceY * scale) >> 16);
+    }
+
+    static int16_t ClampAxis(const int64_t value) {
+        return static_cast<int16_t>(value < -32768 ? -32768 : value > 32767 ? 32767 : value);
+    }
+};
\ No newline at end of file
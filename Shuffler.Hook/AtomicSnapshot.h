@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Publishes immutable snapshots of T to readers on any thread without locks or allocation on the read side.
+ *
+ * Readers protect the snapshot they are looking at with a hazard slot; writers are serialized, swap the whole
+ * snapshot with a single atomic exchange, and only free retired snapshots that no hazard slot points to.
+ */
+template <typename T>
+class AtomicSnapshot {
+    static constexpr size_t MAX_READERS = 64;
+
+    struct alignas(64) HazardSlot {
+        std::atomic<bool> InUse{false};
+        std::atomic<const T*> Pointer{nullptr};
+    };
+
+    // Read-side state, each on its own cache line so writers and other readers do not bounce it
+    alignas(64) std::atomic<const T*> _current;
+    std::atomic<uint64_t> _version{0};
+    HazardSlot _slots[MAX_READERS];
+    alignas(64) std::atomic<uint32_t> _unprotectedReaders{0};
+
+    // Write-side state
+    alignas(64) std::mutex _writeMutex;
+    std::vector<const T*> _retired;
+
+  public:
+    class ReadGuard {
+        AtomicSnapshot* _owner;
+        HazardSlot* _slot;
+        const T* _snapshot;
+
+      public:
+        explicit ReadGuard(AtomicSnapshot* owner) : _owner(owner), _slot(owner->AcquireSlot()) {
+            _snapshot = _owner->Protect(_slot);
+        }
+
+        ~ReadGuard() {
+            _owner->Release(_slot);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T* operator->() const {
+            return _snapshot;
+        }
+
+        const T& operator*() const {
+            return *_snapshot;
+        }
+    };
+
+    AtomicSnapshot() : _current(new T()) {}
+
+    ~AtomicSnapshot() {
+        delete _current.load();
+        for (const T* retired : _retired)
+            delete retired;
+    }
+
+    AtomicSnapshot(const AtomicSnapshot&) = delete;
+    AtomicSnapshot& operator=(const AtomicSnapshot&) = delete;
+
+    ReadGuard Read() {
+        return ReadGuard(this);
+    }
+
+    // Moves on with every published snapshot. Read before Read(), a result derived from that snapshot is current for as
+    // long as the version stays the same
+    uint64_t GetVersion() const {
+        return _version.load(std::memory_order_acquire);
+    }
+
+    void Publish(T snapshot) {
+        std::lock_guard lock(_writeMutex);
+        PublishLocked(new T(std::move(snapshot)));
+    }
+
+    // Copies the current snapshot, lets the caller modify the copy, and publishes it
+    void Update(const std::function<void(T&)>& update) {
+        std::lock_guard lock(_writeMutex);
+        auto* next = new T(*_current.load(std::memory_order_acquire));
+        update(*next);
+        PublishLocked(next);
+    }
+
+  private:
+    HazardSlot* AcquireSlot() {
+        const size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (size_t i = 0; i < MAX_READERS; i++) {
+            HazardSlot& slot = _slots[(start + i) % MAX_READERS];
+            bool expected = false;
+            if (!slot.InUse.load(std::memory_order_relaxed) &&
+                slot.InUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return &slot;
+        }
+
+        // Every slot is taken, so block reclamation entirely until this reader is done
+        _unprotectedReaders.fetch_add(1);
+        return nullptr;
+    }
+
+    const T* Protect(HazardSlot* slot) {
+        if (!slot)
+            return _current.load();
+
+        const T* snapshot = _current.load(std::memory_order_acquire);
+        while (true) {
+            slot->Pointer.store(snapshot);
+            const T* current = _current.load();
+            if (current == snapshot)
+                return snapshot;
+            snapshot = current;
+        }
+    }
+
+    void Release(HazardSlot* slot) {
+        if (!slot) {
+            _unprotectedReaders.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+
+        slot->Pointer.store(nullptr, std::memory_order_release);
+        slot->InUse.store(false, std::memory_order_release);
+    }
+
+    void PublishLocked(const T* next) {
+        _retired.push_back(_current.exchange(next));
+        _version.fetch_add(1, std::memory_order_release);
+
+        if (_unprotectedReaders.load() != 0)
+            return;
+
+        std::erase_if(_retired, [this](const T* retired) {
+            for (const HazardSlot& slot : _slots) {
+                if (slot.Pointer.load() == retired)
+                    return false;
+            }
+
+            delete retired;
+            return true;
+        });
+    }
+};
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "AnalogResponse.h"
+#include "ControllerTypes.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Holds back axis movements no larger than the player's noise gate, so a stick jittering by a few units at rest keeps
+ * reporting one state instead of a new one on every poll.
+ *
+ * Each axis repeats the last value it let through until the raw value moves more than the gate away from it. Center and
+ * both ends of the range always get through, so a released or fully pressed axis is never kept just short of it.
+ *
+ * The held values belong to one controller stream, so there is one gate per virtual slot. They are kept in two atomics
+ * that are read and written as a whole; when two threads poll the same slot at once, one of their results wins and the
+ * other is simply gated against it on the next poll.
+ */
+class AxisNoiseGate {
+    std::atomic<uint64_t> _sticks{0};    // LX, LY, RX, RY, 16 bits each
+    std::atomic<uint16_t> _triggers{0};  // Left in the low byte, right in the high byte
+
+  public:
+    void Apply(const AnalogSettings& settings, ControllerState* state) {
+        const int32_t leftStick = settings.LeftStick.NoiseGate;
+        const int32_t rightStick = settings.RightStick.NoiseGate;
+        const int32_t leftTrigger = settings.LeftTrigger.NoiseGate;
+        const int32_t rightTrigger = settings.RightTrigger.NoiseGate;
+
+        if (leftStick | rightStick) {
+            const uint64_t held = _sticks.load(std::memory_order_relaxed);
+            state->LeftThumbstickX = static_cast<int16_t>(
+                Gate(state->LeftThumbstickX, static_cast<int16_t>(held), leftStick, INT16_MIN, INT16_MAX));
+            state->LeftThumbstickY = static_cast<int16_t>(
+                Gate(state->LeftThumbstickY, static_cast<int16_t>(held >> 16), leftStick, INT16_MIN, INT16_MAX));
+            state->RightThumbstickX = static_cast<int16_t>(
+                Gate(state->RightThumbstickX, static_cast<int16_t>(held >> 32), rightStick, INT16_MIN, INT16_MAX));
+            state->RightThumbstickY = static_cast<int16_t>(
+                Gate(state->RightThumbstickY, static_cast<int16_t>(held >> 48), rightStick, INT16_MIN, INT16_MAX));
+
+            _sticks.store(static_cast<uint16_t>(state->LeftThumbstickX) |
+                              static_cast<uint64_t>(static_cast<uint16_t>(state->LeftThumbstickY)) << 16 |
+                              static_cast<uint64_t>(static_cast<uint16_t>(state->RightThumbstickX)) << 32 |
+                              static_cast<uint64_t>(static_cast<uint16_t>(state->RightThumbstickY)) << 48,
+                          std::memory_order_relaxed);
+        }
+
+        if (leftTrigger | rightTrigger) {
+            const uint16_t held = _triggers.load(std::memory_order_relaxed);
+            state->LeftTrigger = static_cast<uint8_t>(Gate(state->LeftTrigger, held & 0xFF, leftTrigger, 0, 255));
+            state->RightTrigger = static_cast<uint8_t>(Gate(state->RightTrigger, held >> 8, rightTrigger, 0, 255));
+            _triggers.store(static_cast<uint16_t>(state->LeftTrigger | state->RightTrigger << 8),
+                            std::memory_order_relaxed);
+        }
+    }
+
+  private:
+    // A gate of 0 lets every value through
+    static int32_t Gate(const int32_t value, const int32_t held, const int32_t gate, const int32_t min,
+                        const int32_t max) {
+        const int32_t distance = value > held ? value - held : held - value;
+        return distance > gate || value == 0 || value == min || value == max ? value : held;
+    }
+};
\ No newline at end of file
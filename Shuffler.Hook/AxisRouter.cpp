@@ -0,0 +1,101 @@
+#include "AxisRouter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr uint16_t DPAD_UP = static_cast<uint16_t>(Button::DPadUp);
+constexpr uint16_t DPAD_DOWN = static_cast<uint16_t>(Button::DPadDown);
+constexpr uint16_t DPAD_LEFT = static_cast<uint16_t>(Button::DPadLeft);
+constexpr uint16_t DPAD_RIGHT = static_cast<uint16_t>(Button::DPadRight);
+
+uint8_t GetFirstAxis(const StickSelection stick) {
+    return stick == StickSelection::Left ? static_cast<uint8_t>(Axis::LeftX) : static_cast<uint8_t>(Axis::RightX);
+}
+}  // namespace
+
+AxisRouter::AxisRouter()
+    : _weights{}, _dpadVectors{}, _stickDpadButtons{}, _clearedButtons(0), _stickToDpadThreshold(0),
+      _stickToDpadAxis(0xFF), _passthrough(true) {}
+
+AxisRouter AxisRouter::Compile(const AxisRoutingSettings& settings) {
+    constexpr int axisCount = AxisRoutingSettings::AXIS_COUNT;
+    constexpr float maxWeight = 32767.0f / (1 << SCALE_BITS);
+    constexpr float maxRowWeight = MAX_ROW_WEIGHT / static_cast<float>(1 << SCALE_BITS);
+
+    AxisRouter router;
+    const AxisRoutingSettings passthrough;
+    router._passthrough = std::equal(&settings.Matrix[0][0], &settings.Matrix[0][0] + axisCount * axisCount,
+                                     &passthrough.Matrix[0][0]) &&
+                          settings.DpadToStick == StickSelection::None && settings.StickToDpad == StickSelection::None;
+    if (router._passthrough)
+        return router;
+
+    for (int output = 0; output < axisCount; output++) {
+        // Keeping every row's weights within 4 in total keeps the 32-bit sums from overflowing
+        float rowWeight = 0;
+        for (int input = 0; input < axisCount; input++)
+            rowWeight += std::min(std::abs(settings.Matrix[output][input]), maxWeight);
+        const float rowScale = rowWeight > maxRowWeight ? maxRowWeight / rowWeight : 1.0f;
+
+        int32_t weights[axisCount];
+        int32_t total = 0;
+        for (int input = 0; input < axisCount; input++) {
+            const float weight = std::clamp(settings.Matrix[output][input], -maxWeight, maxWeight) * rowScale;
+            weights[input] = static_cast<int32_t>(std::lround(weight * (1 << SCALE_BITS)));
+            total += std::abs(weights[input]);
+        }
+
+        // Rounding can still carry a scaled down row up to half a unit per weight over the limit, which is what
+        // actually bounds the sums, so the largest weights give up the difference
+        while (total > MAX_ROW_WEIGHT) {
+            int32_t* largest = std::max_element(weights, weights + axisCount, [](const int32_t a, const int32_t b) {
+                return std::abs(a) < std::abs(b);
+            });
+            *largest -= *largest > 0 ? 1 : -1;
+            total--;
+        }
+
+        for (int input = 0; input < axisCount; input++)
+            router._weights[input / 2][output / 4][output % 4 * 2 + input % 2] = static_cast<int16_t>(weights[input]);
+    }
+
+    if (settings.DpadToStick != StickSelection::None) {
+        const uint8_t axis = GetFirstAxis(settings.DpadToStick);
+        for (uint16_t dpad = 0; dpad < 16; dpad++) {
+            const int x = !!(dpad & DPAD_RIGHT) - !!(dpad & DPAD_LEFT);
+            const int y = !!(dpad & DPAD_UP) - !!(dpad & DPAD_DOWN);
+            const int magnitude = x && y ? 23170 : 32767;  // Diagonals stay on the unit circle
+            router._dpadVectors[dpad][axis] = static_cast<int16_t>(x * magnitude);
+            router._dpadVectors[dpad][axis + 1] = static_cast<int16_t>(y * magnitude);
+        }
+
+        router._clearedButtons = DPAD_MASK;
+    }
+
+    if (settings.StickToDpad != StickSelection::None) {
+        router._stickToDpadAxis = GetFirstAxis(settings.StickToDpad);
+        router._stickToDpadThreshold = static_cast<int16_t>(std::min<uint16_t>(settings.StickToDpadThreshold, 32767));
+        for (int directions = 0; directions < 16; directions++) {
+            router._stickDpadButtons[directions] =
+                static_cast<uint16_t>((directions & 1 ? DPAD_RIGHT : 0) | (directions & 2 ? DPAD_LEFT : 0) |
+                                      (directions & 4 ? DPAD_UP : 0) | (directions & 8 ? DPAD_DOWN : 0));
+        }
+    }
+
+    return router;
+}
+
+void AxisRouter::ApplyScalar(int16_t* axes, const int16_t* dpadVector) const {
+    int16_t output[LANE_COUNT];
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        int32_t sum = 1 << (SCALE_BITS - 1);
+        for (int input = 0; input < AxisRoutingSettings::AXIS_COUNT; input++)
+            sum += _weights[input / 2][lane / 4][lane % 4 * 2 + input % 2] * axes[input];
+
+        const int32_t routed = std::clamp(sum >> SCALE_BITS, -32768, 32767);
+        output[lane] = static_cast<int16_t>(std::clamp(routed + dpadVector[lane], -32768, 32767));
+    }
+
+    std::copy(output, output + LANE_COUNT, axes);
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include <cstdint>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SHUFFLER_AXIS_ROUTER_SSE2
+#include <emmintrin.h>
+#endif
+
+// The analog inputs in the order the routing matrix uses them
+enum class Axis : uint8_t { LeftX, LeftY, RightX, RightY, LeftTrigger, RightTrigger, Count };
+
+enum class StickSelection : uint8_t { None, Left, Right };
+
+struct AxisRoutingSettings {
+    static constexpr int AXIS_COUNT = static_cast<int>(Axis::Count);
+
+    // Matrix[output][input], each output is the weighted sum of the inputs. Triggers count as 0 to 32767 like a
+    // stick's positive half. Weights are limited to +-2, and a row whose weights add up to more than 4 in magnitude is
+    // scaled down to 4.
+    float Matrix[AXIS_COUNT][AXIS_COUNT] = {
+        {1, 0, 0, 0, 0, 0}, {0, 1, 0, 0, 0, 0}, {0, 0, 1, 0, 0, 0},
+        {0, 0, 0, 1, 0, 0}, {0, 0, 0, 0, 1, 0}, {0, 0, 0, 0, 0, 1},
+    };
+    StickSelection DpadToStick = StickSelection::None;  // The D-pad moves this stick instead of pressing buttons
+    StickSelection StickToDpad = StickSelection::None;  // This stick also presses the D-pad past the threshold
+    uint16_t StickToDpadThreshold = 16384;
+};
+
+/**
+ * Routes the stick axes and triggers through a per-player matrix in 2.14 fixed point, which covers swapping,
+ * inverting, scaling and mixing axes, and converts between the D-pad and a stick with lookup tables.
+ *
+ * The six inputs are treated as one vector of 16-bit lanes, so with SSE2 the matrix is applied with three multiply-adds
+ * per half of the output. The scalar path produces the same results bit for bit.
+ */
+class AxisRouter {
+    static constexpr int LANE_COUNT = 8;
+    static constexpr int SCALE_BITS = 14;
+    // Sum of a row's weights in magnitude. Inputs are at most 32768 in magnitude, so with rounding a row sums to
+    // less than 2^31
+    static constexpr int32_t MAX_ROW_WEIGHT = 65535;
+    static constexpr uint16_t DPAD_MASK = 0x000F;
+
+    // Weights grouped for _mm_madd_epi16: for each pair of inputs and half of the outputs, the lanes hold
+    // {Matrix[output][2 * pair], Matrix[output][2 * pair + 1]} for the four outputs of that half
+    alignas(16) int16_t _weights[3][2][LANE_COUNT];
+    alignas(16) int16_t _dpadVectors[16][LANE_COUNT];  // Added to the output for each D-pad state
+    uint16_t _stickDpadButtons[16];                     // D-pad buttons for each combination of stick directions
+    uint16_t _clearedButtons;
+    int16_t _stickToDpadThreshold;
+    uint8_t _stickToDpadAxis;
+    bool _passthrough;
+
+  public:
+    AxisRouter();
+
+    static AxisRouter Compile(const AxisRoutingSettings& settings);
+
+    void Apply(ControllerState* state) const {
+        if (_passthrough)
+            return;
+
+        alignas(16) int16_t axes[LANE_COUNT] = {
+            state->LeftThumbstickX,
+            state->LeftThumbstickY,
+            state->RightThumbstickX,
+            state->RightThumbstickY,
+            static_cast<int16_t>(state->LeftTrigger << 7 | state->LeftTrigger >> 1),
+            static_cast<int16_t>(state->RightTrigger << 7 | state->RightTrigger >> 1),
+            0,
+            0,
+        };
+
+        const uint16_t dpadButtons = GetStickDpadButtons(axes);
+        const int16_t* dpadVector = _dpadVectors[state->ButtonStates & DPAD_MASK];
+#ifdef SHUFFLER_AXIS_ROUTER_SSE2
+        ApplySse2(axes, dpadVector);
+#else
+        ApplyScalar(axes, dpadVector);
+#endif
+
+        state->LeftThumbstickX = axes[0];
+        state->LeftThumbstickY = axes[1];
+        state->RightThumbstickX = axes[2];
+        state->RightThumbstickY = axes[3];
+        state->LeftTrigger = static_cast<uint8_t>(axes[4] < 0 ? 0 : axes[4] >> 7);
+        state->RightTrigger = static_cast<uint8_t>(axes[5] < 0 ? 0 : axes[5] >> 7);
+        state->ButtonStates = static_cast<uint16_t>((state->ButtonStates & ~_clearedButtons) | dpadButtons);
+    }
+
+    // Portable version of the matrix stage, axes are routed in place
+    void ApplyScalar(int16_t* axes, const int16_t* dpadVector) const;
+
+#ifdef SHUFFLER_AXIS_ROUTER_SSE2
+    void ApplySse2(int16_t* axes, const int16_t* dpadVector) const {
+        const __m128i input = _mm_load_si128(reinterpret_cast<const __m128i*>(axes));
+        // Both inputs of a pair repeated in every 32-bit lane
+        const __m128i pair0 = _mm_shuffle_epi32(input, _MM_SHUFFLE(0, 0, 0, 0));
+        const __m128i pair1 = _mm_shuffle_epi32(input, _MM_SHUFFLE(1, 1, 1, 1));
+        const __m128i pair2 = _mm_shuffle_epi32(input, _MM_SHUFFLE(2, 2, 2, 2));
+        const __m128i rounding = _mm_set1_epi32(1 << (SCALE_BITS - 1));
+
+        __m128i low = _mm_add_epi32(rounding, _mm_madd_epi16(pair0, Load(_weights[0][0])));
+        low = _mm_add_epi32(low, _mm_madd_epi16(pair1, Load(_weights[1][0])));
+        low = _mm_add_epi32(low, _mm_madd_epi16(pair2, Load(_weights[2][0])));
+        __m128i high = _mm_add_epi32(rounding, _mm_madd_epi16(pair0, Load(_weights[0][1])));
+        high = _mm_add_epi32(high, _mm_madd_epi16(pair1, Load(_weights[1][1])));
+        high = _mm_add_epi32(high, _mm_madd_epi16(pair2, Load(_weights[2][1])));
+
+        const __m128i output = _mm_packs_epi32(_mm_srai_epi32(low, SCALE_BITS), _mm_srai_epi32(high, SCALE_BITS));
+        _mm_store_si128(reinterpret_cast<__m128i*>(axes), _mm_adds_epi16(output, Load(dpadVector)));
+    }
+#endif
+
+  private:
+    uint16_t GetStickDpadButtons(const int16_t* axes) const {
+        if (_stickToDpadAxis == 0xFF)
+            return 0;
+
+        const int16_t x = axes[_stickToDpadAxis];
+        const int16_t y = axes[_stickToDpadAxis + 1];
+        const int directions = (x > _stickToDpadThreshold) | (x < -_stickToDpadThreshold) << 1 |
+                               (y > _stickToDpadThreshold) << 2 | (y < -_stickToDpadThreshold) << 3;
+        return _stickDpadButtons[directions];
+    }
+
+#ifdef SHUFFLER_AXIS_ROUTER_SSE2
+    static __m128i Load(const int16_t* lanes) {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+    }
+#endif
+};
\ No newline at end of file
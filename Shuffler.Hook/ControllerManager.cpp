@@ -1,123 +1,260 @@
 #include "ControllerManager.h"
 
-#include "Hooks/LoadLibraryHook.h"
-#include "Hooks/XInputHook.h"
-
 Logger ControllerManager::_logger("ControllerManager");
-int ControllerManager::_activeControllerIndex = 0;
-uint8_t ControllerManager::_activePlayerIndex = 0;
-std::vector<ControllerManager::PlayerProfile> ControllerManager::_playerProfiles;
-
-decltype(&XInputGetState) ControllerManager::LoadXInput() {
-    if (XInputHook::GetOriginalXInputGetState())
-        return XInputHook::GetOriginalXInputGetState();
-
-    // If no XInput DLL is loaded, load xinput1_4.dll ourselves
-    if (LoadLibraryHook::HookedLoadLibraryA("xinput1_4.dll")) {
-        _logger.Info("Did not find original XInputGetState in XInputHook, loading xinput1_4.dll ourselves");
-        if (auto original = XInputHook::GetOriginalXInputGetState()) {
-            _logger.Info("Got original XInputGetState from xinput1_4.dll");
-            return original;
-        }
-    }
+VirtualSlotTable ControllerManager::_slots;
+AxisNoiseGate ControllerManager::_noiseGates[VirtualSlotTable::MAX_SLOTS];
+PacketCounter<ControllerState> ControllerManager::_packetCounters[VirtualSlotTable::MAX_SLOTS];
+SeqLock<ControllerManager::StateMemo> ControllerManager::_stateMemos[VirtualSlotTable::MAX_SLOTS];
+std::atomic<int64_t> ControllerManager::_stateFreshness =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(DEFAULT_STATE_FRESHNESS).count();
+AtomicSnapshot<ControllerManager::ProfileSet> ControllerManager::_profileSet;
+XInputSource ControllerManager::_xinputSource;
+PolledInputSource ControllerManager::_polledSource(&_xinputSource, std::chrono::milliseconds(1));
+SharedPadInputSource ControllerManager::_sharedPadSource;
+ReplayInputSource ControllerManager::_replaySource;
+std::atomic<InputSource*> ControllerManager::_inputSource = &_xinputSource;
+std::atomic<ControllerManager::StateListener> ControllerManager::_stateListener = nullptr;
+
+bool ControllerManager::GetState(const int slotIndex, ControllerState* state, const InputApi api,
+                                 uint32_t* packetNumber) {
+    VirtualSlot slot;
+    if (!ReadState(slotIndex, state, packetNumber, &slot))
+        return false;
 
-    return nullptr;
+    InputRecorder::Record(api, slot.PlayerIndex, slot.ControllerIndex, *state);
+    return true;
 }
 
-bool ControllerManager::GetState(ControllerState* state) {
-    auto originalXInputGetState = XInputHook::GetOriginalXInputGetState();
-    if (!originalXInputGetState) {
-        originalXInputGetState = LoadXInput();
-        if (!originalXInputGetState)
-            return false;
-    }
+bool ControllerManager::PollState(const int slotIndex, ControllerState* state, uint32_t* packetNumber) {
+    VirtualSlot slot;
+    return ReadState(slotIndex, state, packetNumber, &slot);
+}
 
-    XINPUT_STATE xinputState;
-    DWORD result = originalXInputGetState(_activeControllerIndex, &xinputState);
+void ControllerManager::SetStateListener(const StateListener listener) {
+    _stateListener.store(listener, std::memory_order_release);
+}
 
-    if (result != ERROR_SUCCESS)
+bool ControllerManager::ReadState(const int slotIndex, ControllerState* state, uint32_t* packetNumber,
+                                  VirtualSlot* boundSlot) {
+    VirtualSlot slot;
+    if (!_slots.TryGet(slotIndex, &slot))
         return false;
+    *boundSlot = slot;
 
-    // Start with clean state for remapped values
-    state->ButtonStates = 0;
-    state->LeftTrigger = 0;
-    state->RightTrigger = 0;
-    state->LeftThumbstickX = xinputState.Gamepad.sThumbLX;
-    state->LeftThumbstickY = xinputState.Gamepad.sThumbLY;
-    state->RightThumbstickX = xinputState.Gamepad.sThumbRX;
-    state->RightThumbstickY = xinputState.Gamepad.sThumbRY;
-
-    if (_activePlayerIndex < _playerProfiles.size()) {
-        const auto& [Index, Mappings] = _playerProfiles[_activePlayerIndex];
-        uint16_t remappedButtons = 0;
-        bool leftTriggerRemapped = false;
-        bool rightTriggerRemapped = false;
-
-        for (const auto& [From, To] : Mappings) {
-            bool sourceIsActive = false;
-
-            if (From.Type == InputType::Button) {
-                sourceIsActive = (xinputState.Gamepad.wButtons & static_cast<uint16_t>(From.Button)) != 0;
-                remappedButtons |= static_cast<uint16_t>(From.Button);
-            } else if (From.Type == InputType::Trigger) {
-                switch (From.Trigger) {
-                case TriggerInput::LeftTrigger:
-                    sourceIsActive = xinputState.Gamepad.bLeftTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD;
-                    leftTriggerRemapped = true;
-                    break;
-                case TriggerInput::RightTrigger:
-                    sourceIsActive = xinputState.Gamepad.bRightTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD;
-                    rightTriggerRemapped = true;
-                    break;
-                }
-            }
-
-            if (sourceIsActive) {
-                if (To.Type == InputType::Button) {
-                    state->ButtonStates |= static_cast<uint16_t>(To.Button);
-                } else if (To.Type == InputType::Trigger) {
-                    switch (To.Trigger) {
-                    case TriggerInput::LeftTrigger:
-                        state->LeftTrigger = 255;
-                        break;
-                    case TriggerInput::RightTrigger:
-                        state->RightTrigger = 255;
-                        break;
-                    }
-                }
-            }
-        }
+    const uint8_t playerIndex = slot.PlayerIndex;
+    InputSource* inputSource = _inputSource.load(std::memory_order_acquire);
+    // Taken before the profiles are read, so a memo never claims a newer version than the profiles it was built from
+    const uint64_t profileVersion = _profileSet.GetVersion();
+    const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+
+    // Every API polls the same memo, so one game frame that asks through several of them reads the source once
+    StateMemo memo;
+    const bool memoValid = _stateMemos[slotIndex].TryLoad(&memo) && memo.Source == inputSource &&
+                           memo.Slot.PlayerIndex == playerIndex && memo.Slot.ControllerIndex == slot.ControllerIndex &&
+                           memo.ProfileVersion == profileVersion;
 
-        state->ButtonStates |= (xinputState.Gamepad.wButtons & ~remappedButtons);
-        if (!leftTriggerRemapped)
-            state->LeftTrigger = xinputState.Gamepad.bLeftTrigger;
-        if (!rightTriggerRemapped)
-            state->RightTrigger = xinputState.Gamepad.bRightTrigger;
+    bool connected;
+    if (memoValid && now - memo.ReadTime < _stateFreshness.load(std::memory_order_relaxed)) {
+        connected = memo.Connected;
+        *state = memo.State;
     } else {
-        state->ButtonStates = xinputState.Gamepad.wButtons;
-        state->LeftTrigger = xinputState.Gamepad.bLeftTrigger;
-        state->RightTrigger = xinputState.Gamepad.bRightTrigger;
+        // The pad feed is already laid out per player. Every slot reads only its own controller, so polling one slot
+        // never costs a read of another
+        const int sourceIndex = inputSource == &_sharedPadSource ? playerIndex : slot.ControllerIndex;
+        ControllerState source = {};
+        connected = inputSource->GetState(sourceIndex, &source);
+
+        // The stream holds a single controller, the one in slot 0
+        if (slotIndex == 0)
+            InputStreamRecorder::Record(connected ? source : ControllerState{}, connected);
+
+        // An unchanged source remaps to the same state, the noise gate holds the same values it let through last time
+        if (!connected)
+            *state = {};
+        else if (memoValid && memo.Connected && memcmp(&memo.SourceState, &source, sizeof(source)) == 0)
+            *state = memo.State;
+        else
+            Remap(slotIndex, playerIndex, source, state);
+
+        // Skipped if another thread is storing this slot's memo right now, its result is as good as ours
+        _stateMemos[slotIndex].TryStore({now, profileVersion, inputSource, slot, connected, source, *state});
+    }
+
+    if (!connected)
+        return false;
+
+    bool changed;
+    const uint32_t packet = _packetCounters[slotIndex].Update(*state, &changed);
+    if (packetNumber)
+        *packetNumber = packet;
+
+    // Pushed from here, where the packet moves, so listeners hear of a change as soon as any api reads it
+    if (changed) {
+        if (const StateListener listener = _stateListener.load(std::memory_order_acquire))
+            listener(slotIndex, *state, packet);
     }
 
     return true;
 }
 
+void ControllerManager::SetStateFreshness(const std::chrono::microseconds window) {
+    _stateFreshness.store(std::chrono::duration_cast<std::chrono::steady_clock::duration>(window).count(),
+                          std::memory_order_relaxed);
+}
+
+void ControllerManager::Remap(const int slotIndex, const uint8_t playerIndex, ControllerState source,
+                              ControllerState* state) {
+    const auto profileSet = _profileSet.Read();
+    if (playerIndex < profileSet->Profiles.size()) {
+        const PlayerProfile& profile = profileSet->Profiles[playerIndex];
+        // Gated on the raw values, before curves can stretch the jitter
+        _noiseGates[slotIndex].Apply(profile.Analog, &source);
+        profile.Response.Apply(&source);
+        profile.Router.Apply(&source);
+        profile.Table.Apply(source, state);
+    } else {
+        *state = source;
+    }
+}
+
+bool ControllerManager::IsSlotConnected(const int slotIndex) {
+    return _slots.IsConnected(slotIndex);
+}
+
+uint32_t ControllerManager::GetConnectedSlotMask() {
+    return _slots.GetConnectedMask();
+}
+
+bool ControllerManager::BindSlot(const int slotIndex, const uint8_t playerIndex, const uint8_t controllerIndex) {
+    if (controllerIndex >= InputSource::MAX_CONTROLLERS)
+        return false;
+
+    return _slots.Bind(slotIndex, {playerIndex, controllerIndex});
+}
+
+bool ControllerManager::UnbindSlot(const int slotIndex) {
+    return _slots.Unbind(slotIndex);
+}
+
 void ControllerManager::SetActivePlayer(uint8_t playerIndex) {
-    _activePlayerIndex = playerIndex;
+    _slots.SetPlayer(0, playerIndex);
 }
 
-void ControllerManager::AddButtonMapping(uint8_t playerIndex, ActionMapping mapping) {
-    while (_playerProfiles.size() <= playerIndex) {
+void ControllerManager::EnableBackgroundPolling(std::chrono::microseconds interval) {
+    _polledSource.SetInterval(interval);
+    _polledSource.Start();
+    _inputSource.store(&_polledSource, std::memory_order_release);
+}
+
+void ControllerManager::DisableBackgroundPolling() {
+    // The polled source stays alive, so readers that still hold it just see its last published state
+    InputSource* expected = &_polledSource;
+    _inputSource.compare_exchange_strong(expected, &_xinputSource, std::memory_order_release);
+    _polledSource.Stop();
+}
+
+bool ControllerManager::EnableSharedPadFeed() {
+    if (!_sharedPadSource.Open())
+        return false;
+
+    _inputSource.store(&_sharedPadSource, std::memory_order_release);
+    return true;
+}
+
+void ControllerManager::DisableSharedPadFeed() {
+    // The feed stays mapped, readers may still hold the source
+    InputSource* expected = &_sharedPadSource;
+    _inputSource.compare_exchange_strong(expected, &_xinputSource, std::memory_order_release);
+}
+
+bool ControllerManager::EnableReplay(const std::wstring& path, const double speed, const bool loop) {
+    if (!_replaySource.Open(path, speed, loop))
+        return false;
+
+    _inputSource.store(&_replaySource, std::memory_order_release);
+    return true;
+}
+
+void ControllerManager::DisableReplay() {
+    InputSource* expected = &_replaySource;
+    _inputSource.compare_exchange_strong(expected, &_xinputSource, std::memory_order_release);
+}
+
+ControllerManager::PlayerProfile& ControllerManager::GetOrAddProfile(ProfileSet& set, uint8_t playerIndex) {
+    while (set.Profiles.size() <= playerIndex) {
         PlayerProfile profile;
-        profile.Index = static_cast<uint8_t>(_playerProfiles.size());
-        _playerProfiles.push_back(profile);
+        profile.Index = static_cast<uint8_t>(set.Profiles.size());
+        set.Profiles.push_back(profile);
     }
 
-    _playerProfiles[playerIndex].Mappings.push_back(mapping);
+    return set.Profiles[playerIndex];
+}
+
+void ControllerManager::AddButtonMapping(uint8_t playerIndex, ActionMapping mapping) {
+    _profileSet.Update([&](ProfileSet& set) {
+        auto& profile = GetOrAddProfile(set, playerIndex);
+        profile.Mappings.push_back(mapping);
+        profile.Table = RemapTable::Compile(profile.Mappings);
+    });
 }
 
 void ControllerManager::ClearButtonMappings(uint8_t playerIndex) {
-    if (playerIndex < _playerProfiles.size()) {
-        _playerProfiles[playerIndex].Mappings.clear();
-    }
+    _profileSet.Update([&](ProfileSet& set) {
+        if (playerIndex < set.Profiles.size()) {
+            set.Profiles[playerIndex].Mappings.clear();
+            set.Profiles[playerIndex].Table = RemapTable();
+        }
+    });
+}
+
+void ControllerManager::ReplaceButtonMappings(const std::vector<std::vector<ActionMapping>>& mappingsPerPlayer) {
+    _profileSet.Update([&](ProfileSet& set) {
+        for (auto& profile : set.Profiles) {
+            profile.Mappings.clear();
+            profile.Table = RemapTable();
+        }
+
+        for (size_t i = 0; i < mappingsPerPlayer.size(); i++) {
+            auto& profile = GetOrAddProfile(set, static_cast<uint8_t>(i));
+            profile.Mappings = mappingsPerPlayer[i];
+            profile.Table = RemapTable::Compile(profile.Mappings);
+        }
+    });
+}
+
+void ControllerManager::ReplaceButtonMappings(const IpcMappingSet& mappingSet) {
+    _profileSet.Update([&](ProfileSet& set) {
+        for (auto& profile : set.Profiles) {
+            profile.Mappings.clear();
+            profile.Table = RemapTable();
+        }
+
+        mappingSet.ForEachPlayer([&](const uint8_t playerIndex, const IpcPlayerMappings& mappings) {
+            auto& profile = GetOrAddProfile(set, playerIndex);
+            profile.Mappings.clear();
+            profile.Mappings.reserve(mappings.GetCount());
+            for (size_t i = 0; i < mappings.GetCount(); i++)
+                profile.Mappings.push_back(mappings[i]);
+            profile.Table = RemapTable::Compile(profile.Mappings);
+        });
+    });
+}
+
+void ControllerManager::SetAnalogSettings(uint8_t playerIndex, const AnalogSettings& settings) {
+    // Compiled outside of the update, building the tables is the slow part
+    const AnalogResponse response = AnalogResponse::Compile(settings);
+    _profileSet.Update([&](ProfileSet& set) {
+        auto& profile = GetOrAddProfile(set, playerIndex);
+        profile.Analog = settings;
+        profile.Response = response;
+    });
+}
+
+void ControllerManager::SetAxisRouting(uint8_t playerIndex, const AxisRoutingSettings& settings) {
+    const AxisRouter router = AxisRouter::Compile(settings);
+    _profileSet.Update([&](ProfileSet& set) {
+        auto& profile = GetOrAddProfile(set, playerIndex);
+        profile.Routing = settings;
+        profile.Router = router;
+    });
 }
\ No newline at end of file
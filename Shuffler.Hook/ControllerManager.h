@@ -1,98 +1,122 @@
 #pragma once
 
+#include "AnalogResponse.h"
+#include "AtomicSnapshot.h"
+#include "AxisNoiseGate.h"
+#include "AxisRouter.h"
+#include "ControllerTypes.h"
+#include "InputRecorder.h"
+#include "InputSource.h"
+#include "XInputSource.h"
+#include "InputStreamRecorder.h"
+#include "IpcProtocol.h"
 #include "Logger.h"
+#include "PacketCounter.h"
+#include "RemapTable.h"
+#include "SeqLock.h"
+#include "VirtualSlotTable.h"
 #include <Windows.h>
 #include <Xinput.h>
+#include <chrono>
 #include <unordered_map>
 
-#define XINPUT_GAMEPAD_TRIGGER_THRESHOLD 30
-
-enum class Button : uint16_t {
-    DPadUp = 0x0001,
-    DPadDown = 0x0002,
-    DPadLeft = 0x0004,
-    DPadRight = 0x0008,
-    Start = 0x0010,
-    Back = 0x0020,
-    LeftThumbstick = 0x0040,
-    RightThumbstick = 0x0080,
-    LeftShoulder = 0x0100,
-    RightShoulder = 0x0200,
-    A = 0x1000,
-    B = 0x2000,
-    X = 0x4000,
-    Y = 0x8000,
-};
-
-enum class TriggerInput : uint8_t { LeftTrigger, RightTrigger };
-
-struct ButtonBits {
-    uint16_t DpadUp : 1;           // 0x0001
-    uint16_t DpadDown : 1;         // 0x0002
-    uint16_t DpadLeft : 1;         // 0x0004
-    uint16_t DpadRight : 1;        // 0x0008
-    uint16_t Start : 1;            // 0x0010
-    uint16_t Back : 1;             // 0x0020
-    uint16_t LeftThumbstick : 1;   // 0x0040
-    uint16_t RightThumbstick : 1;  // 0x0080
-    uint16_t LeftShoulder : 1;     // 0x0100
-    uint16_t RightShoulder : 1;    // 0x0200
-    uint16_t : 2;                  // 2 reserved bits
-    uint16_t A : 1;                // 0x1000
-    uint16_t B : 1;                // 0x2000
-    uint16_t X : 1;                // 0x4000
-    uint16_t Y : 1;                // 0x8000
-};
-
-struct ControllerState {
-    union {
-        uint16_t ButtonStates;  // All button states as a single value
-        ButtonBits Bits;
-    };
-    uint8_t LeftTrigger;
-    uint8_t RightTrigger;
-    int16_t LeftThumbstickX;
-    int16_t LeftThumbstickY;
-    int16_t RightThumbstickX;
-    int16_t RightThumbstickY;
-};
-
-enum class InputType : uint8_t {
-    Button,
-    Trigger,
-};
-
-struct InputAction {
-    InputType Type;
-    union {
-        Button Button;
-        TriggerInput Trigger;
-    };
-};
-
-struct ActionMapping {
-    InputAction From;
-    InputAction To;
-};
-
 class ControllerManager {
+  public:
+    // Told of every new packet of a slot, on the thread whose read produced it, once per packet. Packets read by
+    // different threads at once may arrive out of order
+    using StateListener = void (*)(int slotIndex, const ControllerState& state, uint32_t packetNumber);
+
+  private:
     struct PlayerProfile {
         uint8_t Index;
         std::vector<ActionMapping> Mappings;
+        RemapTable Table;
+        AnalogSettings Analog;
+        AnalogResponse Response;
+        AxisRoutingSettings Routing;
+        AxisRouter Router;
+    };
+
+    struct ProfileSet {
+        std::vector<PlayerProfile> Profiles;
+    };
+
+    // The last read of a slot and what it was remapped to, valid for as long as the slot's binding, the input source
+    // and the profiles stay the same
+    struct StateMemo {
+        int64_t ReadTime;  // steady_clock ticks of the read from the input source
+        uint64_t ProfileVersion;
+        const InputSource* Source;
+        VirtualSlot Slot;
+        bool Connected;
+        ControllerState SourceState;
+        ControllerState State;
     };
 
     static Logger _logger;
-    static int _activeControllerIndex;
-    static uint8_t _activePlayerIndex;
-    static std::vector<PlayerProfile> _playerProfiles;
+    static VirtualSlotTable _slots;
+    static AxisNoiseGate _noiseGates[VirtualSlotTable::MAX_SLOTS];
+    static PacketCounter<ControllerState> _packetCounters[VirtualSlotTable::MAX_SLOTS];
+    static SeqLock<StateMemo> _stateMemos[VirtualSlotTable::MAX_SLOTS];
+    static std::atomic<int64_t> _stateFreshness;
+    static AtomicSnapshot<ProfileSet> _profileSet;
+    static XInputSource _xinputSource;
+    static PolledInputSource _polledSource;
+    static SharedPadInputSource _sharedPadSource;
+    static ReplayInputSource _replaySource;
+    static std::atomic<InputSource*> _inputSource;
+    static std::atomic<StateListener> _stateListener;
 
   public:
-    static bool GetState(ControllerState* state);
+    static constexpr std::chrono::microseconds DEFAULT_STATE_FRESHNESS{500};
+
+    // Reads the controller bound to slotIndex and applies its player's remaps, recording the result under api.
+    // packetNumber receives the slot's packet number, which only changes when the remapped state does, shared by every
+    // api. Returns false if the slot or its controller is not connected
+    static bool GetState(int slotIndex, ControllerState* state, InputApi api, uint32_t* packetNumber = nullptr);
+
+    // Reads slotIndex like GetState without recording it as a read of any api, for hooks that keep reports flowing
+    // while the game is not polling
+    static bool PollState(int slotIndex, ControllerState* state, uint32_t* packetNumber = nullptr);
+
+    // Replaces the state listener, null removes it
+    static void SetStateListener(StateListener listener);
+
+    // Calls to GetState within window of a slot's last read reuse its result instead of reading the input source
+    // again, 0 reads it on every call
+    static void SetStateFreshness(std::chrono::microseconds window);
+
+    static bool IsSlotConnected(int slotIndex);
+    // Bit n is set if slot n is connected
+    static uint32_t GetConnectedSlotMask();
+    static bool BindSlot(int slotIndex, uint8_t playerIndex, uint8_t controllerIndex);
+    static bool UnbindSlot(int slotIndex);
+    // Rebinds slot 0 to playerIndex, the single player switch the controlling process has always used
     static void SetActivePlayer(uint8_t playerIndex);
 
+    static void EnableBackgroundPolling(std::chrono::microseconds interval);
+    static void DisableBackgroundPolling();
+
+    // Reads the active player's slot of the controlling process's pad feed instead of a physical controller
+    static bool EnableSharedPadFeed();
+    static void DisableSharedPadFeed();
+
+    // Feeds an InputStreamRecorder file back in place of the controllers, speed scales the recorded pace
+    static bool EnableReplay(const std::wstring& path, double speed = 1.0, bool loop = false);
+    static void DisableReplay();
+
     static void AddButtonMapping(uint8_t playerIndex, ActionMapping mapping);
     static void ClearButtonMappings(uint8_t playerIndex);
+    static void ReplaceButtonMappings(const std::vector<std::vector<ActionMapping>>& mappingsPerPlayer);
+    // Replaces every player's mappings with the ones in mappingSet, players missing from it end up with none
+    static void ReplaceButtonMappings(const IpcMappingSet& mappingSet);
+
+    static void SetAnalogSettings(uint8_t playerIndex, const AnalogSettings& settings);
+    static void SetAxisRouting(uint8_t playerIndex, const AxisRoutingSettings& settings);
 
   private:
-    static decltype(&XInputGetState) LoadXInput();
+    // GetState without the recording, boundSlot receives the slot's binding
+    static bool ReadState(int slotIndex, ControllerState* state, uint32_t* packetNumber, VirtualSlot* boundSlot);
+    static void Remap(int slotIndex, uint8_t playerIndex, ControllerState source, ControllerState* state);
+    static PlayerProfile& GetOrAddProfile(ProfileSet& set, uint8_t playerIndex);
 };
\ No newline at end of file
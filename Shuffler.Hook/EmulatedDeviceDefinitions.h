@@ -1,120 +1,129 @@
 #pragma once
+#include "HidDeviceProfile.h"
+#include "HidPathMatcher.h"
 #include <Windows.h>
 
 namespace EmulatedDeviceDefinitions
 {
-    // Common device handle used across all hooks
-    static const HANDLE EMULATED_DEVICE_HANDLE = (HANDLE)0x1234;
+    // One emulated device per virtual slot, each with its own raw input device handle. EMULATED_DEVICE_HANDLE is slot
+    // 0's. Files opened on the devices get handles of their own from HidDeviceHook
+    constexpr int DEVICE_COUNT = 4;
+    static const HANDLE EMULATED_DEVICE_HANDLES[DEVICE_COUNT] = {(HANDLE)0x1234, (HANDLE)0x1238, (HANDLE)0x123C,
+                                                                 (HANDLE)0x1240};
+    static const HANDLE EMULATED_DEVICE_HANDLE = EMULATED_DEVICE_HANDLES[0];
     // static const HANDLE EMULATED_DEVICE_HANDLE = (HANDLE) 0x00000000000109BF;
 
+    // Wired Xbox One controller, as its HID descriptor is reported by the native HID parser
+    constexpr HidDeviceProfile XBOX_ONE_WIRED_PROFILE = {
+        .VendorId = 0x045E,  // Microsoft
+        .ProductId = 0x02FF, // Xbox One Controller (Wired)
+        // .ProductId = 0x0b00,
+        // .VersionNumber = 0x0903, // Common version for Xbox One controllers
+        .VersionNumber = 0x0,
+        .UsagePage = 0x01, // Generic Desktop Controls
+        .Usage = 0x05,     // Gamepad
+        .ManufacturerString = L"Microsoft",
+        .ProductString = L"Shuffler Controller",
+        .InstanceIdPrefix = "a&36fff2e",
+        .PhysicalCollectionCount = 3,
+        .Items = {
+            // Left stick
+            {.Type = HidItemType::Value, .Collection = 1, .UsagePage = 0x01,
+             .Usages = {HidDeviceGenerator::USAGE_X, HidDeviceGenerator::USAGE_Y}, .UsageCount = 2,
+             .BitSize = 16, .ReportCount = 2, .LogicalMin = 0, .LogicalMax = -1, .PhysicalMin = 0, .PhysicalMax = -1},
+            // Right stick
+            {.Type = HidItemType::Value, .Collection = 2, .UsagePage = 0x01,
+             .Usages = {HidDeviceGenerator::USAGE_RX, HidDeviceGenerator::USAGE_RY}, .UsageCount = 2,
+             .BitSize = 16, .ReportCount = 2, .LogicalMin = 0, .LogicalMax = -1, .PhysicalMin = 0, .PhysicalMax = -1},
+            // Both triggers share one axis
+            {.Type = HidItemType::Value, .Collection = 3, .UsagePage = 0x01,
+             .Usages = {HidDeviceGenerator::USAGE_Z}, .UsageCount = 1,
+             .BitSize = 16, .ReportCount = 1, .LogicalMin = 0, .LogicalMax = -1, .PhysicalMin = 0, .PhysicalMax = -1},
+            {.Type = HidItemType::Buttons, .Collection = 0, .UsagePage = HidDeviceGenerator::USAGE_PAGE_BUTTON,
+             .Usages = {1, 16}, .UsageCount = 2, .BitSize = 1, .ReportCount = 16},
+            // D-pad, 1-8 clockwise from up in 45 degree steps, 0 when released
+            {.Type = HidItemType::Value, .Collection = 0, .UsagePage = 0x01,
+             .Usages = {HidDeviceGenerator::USAGE_HAT}, .UsageCount = 1, .BitSize = 4, .ReportCount = 1,
+             .HasNullState = true, .LogicalMin = 1, .LogicalMax = 8, .PhysicalMin = 0, .PhysicalMax = 4155,
+             .Units = 0x0E},
+            {.Type = HidItemType::Padding, .BitSize = 20, .ReportCount = 1},
+        },
+        .ItemCount = 6,
+    };
+
+    constexpr const HidDeviceProfile& PROFILE = XBOX_ONE_WIRED_PROFILE;
+
     // Device identifiers
-    constexpr WORD VENDOR_ID = 0x045E;      // Microsoft
-    constexpr WORD PRODUCT_ID = 0x02FF;     // Xbox One Controller (Wired)
-    // constexpr WORD PRODUCT_ID = 0x0b00;
-    // constexpr WORD VERSION_NUMBER = 0x0903; // Common version for Xbox One controllers
-    constexpr WORD VERSION_NUMBER = 0x0;
+    constexpr WORD VENDOR_ID = PROFILE.VendorId;
+    constexpr WORD PRODUCT_ID = PROFILE.ProductId;
+    constexpr WORD VERSION_NUMBER = PROFILE.VersionNumber;
 
     // HID Usage information
-    constexpr WORD USAGE_PAGE = 0x01; // Generic Desktop Controls
-    constexpr WORD USAGE = 0x05;      // Gamepad
+    constexpr WORD USAGE_PAGE = PROFILE.UsagePage;
+    constexpr WORD USAGE = PROFILE.Usage;
 
     // Device strings
-    constexpr const wchar_t *MANUFACTURER_STRING = L"Microsoft";
-    constexpr const wchar_t *PRODUCT_STRING = L"Shuffler Controller";
+    constexpr const wchar_t *MANUFACTURER_STRING = PROFILE.ManufacturerString;
+    constexpr const wchar_t *PRODUCT_STRING = PROFILE.ProductString;
 
     // Device paths for different controllers - using format from real wired Xbox controller
     // Format: \\?\HID#VID_045E&PID_02FF&IG_00#a&XXXXXXXX&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}
     // Where XXXXXXXX is a unique identifier for each controller
-    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_1 = L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e1&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}";
-    // constexpr const wchar_t *DEVICE_PATH_CONTROLLER_1 = L"\\\\?\\HID#VID_045E&PID_0B00&IG_00#b&1805b41d&1&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}";
-    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_2 = L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e2&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}";
-    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_3 = L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e3&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}";
-    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_4 = L"\\\\?\\HID#VID_045E&PID_02FF&IG_00#a&36fff2e4&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}";
+    // L"\\\\?\\HID#VID_045E&PID_0B00&IG_00#b&1805b41d&1&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}";
+    constexpr size_t DEVICE_PATH_LENGTH = HidDeviceGenerator::GetDevicePathLength(PROFILE);
+    constexpr auto DEVICE_PATH_1 = HidDeviceGenerator::GenerateDevicePath<DEVICE_PATH_LENGTH>(PROFILE, 1);
+    constexpr auto DEVICE_PATH_2 = HidDeviceGenerator::GenerateDevicePath<DEVICE_PATH_LENGTH>(PROFILE, 2);
+    constexpr auto DEVICE_PATH_3 = HidDeviceGenerator::GenerateDevicePath<DEVICE_PATH_LENGTH>(PROFILE, 3);
+    constexpr auto DEVICE_PATH_4 = HidDeviceGenerator::GenerateDevicePath<DEVICE_PATH_LENGTH>(PROFILE, 4);
+    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_1 = DEVICE_PATH_1.data();
+    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_2 = DEVICE_PATH_2.data();
+    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_3 = DEVICE_PATH_3.data();
+    constexpr const wchar_t *DEVICE_PATH_CONTROLLER_4 = DEVICE_PATH_4.data();
+
+    // Preprocessed data for the HID descriptor, in the format HidD_GetPreparsedData hands out. One image shared by
+    // every caller, aligned like the heap blocks hid.dll hands out
+    alignas(16) inline constexpr auto PREPROCESSED_DATA =
+        HidDeviceGenerator::GeneratePreparsedData<HidDeviceGenerator::GetPreparsedDataSize(PROFILE)>(PROFILE);
+    constexpr size_t PREPROCESSED_DATA_SIZE = PREPROCESSED_DATA.size();
 
-    // Preprocessed data for Xbox controller HID descriptor
-    static const BYTE PREPROCESSED_DATA[] = {
-    0x48, 0x69, 0x64, 0x50, 0x20, 0x4B, 0x44, 0x52, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x07, 0x00, 0x07, 0x00, 0x10, 0x00, 0x07, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
-    0x07, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0xD8, 0x02, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00,
-    0x10, 0x00, 0x01, 0x00, 0x03, 0x00, 0x10, 0x00, 0x02, 0x00, 0x00, 0x00, 0x05, 0x00, 0x01, 0x00,
-    0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x31, 0x00, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x01, 0x00, 0x01, 0x00, 0x10, 0x00,
-    0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x30, 0x00, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
-    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-    0x10, 0x00, 0x01, 0x00, 0x07, 0x00, 0x10, 0x00, 0x02, 0x00, 0x00, 0x00, 0x09, 0x00, 0x02, 0x00,
-    0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x34, 0x00, 0x34, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x01, 0x00, 0x05, 0x00, 0x10, 0x00,
-    0x02, 0x00, 0x00, 0x00, 0x07, 0x00, 0x02, 0x00, 0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x33, 0x00, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
-    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-    0x10, 0x00, 0x01, 0x00, 0x09, 0x00, 0x10, 0x00, 0x02, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x03, 0x00,
-    0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x01, 0x00, 0x10, 0x00, 0x0B, 0x00, 0x10, 0x00,
-    0x02, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x00, 0x1C, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x01, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x14, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-    0x04, 0x00, 0x01, 0x00, 0x0D, 0x00, 0x04, 0x00, 0x42, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00,
-    0x01, 0x00, 0x05, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39, 0x00, 0x39, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x15, 0x00, 0x15, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3B, 0x10, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x03, 0x00,
-    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    // Input report layout, for encoding reports without going through HidP_*
+    constexpr HidReportLayout REPORT_LAYOUT = HidDeviceGenerator::GenerateLayout(PROFILE);
 
-    constexpr size_t PREPROCESSED_DATA_SIZE = sizeof(PREPROCESSED_DATA);
+    // Matches paths against DEVICE_PATH_CONTROLLER_1..4 in one pass, for the file open hooks
+    constexpr HidPathMatcher<DEVICE_PATH_LENGTH> DEVICE_PATH_MATCHER(
+        DEVICE_PATH_1, HidDeviceGenerator::GetDevicePathNumberOffset(PROFILE), DEVICE_COUNT);
+    static_assert(DEVICE_PATH_MATCHER.Match(DEVICE_PATH_1.data()) == 1 &&
+                  DEVICE_PATH_MATCHER.Match(DEVICE_PATH_4.data()) == 4);
 
     // Helper function to check if a path matches any of our emulated devices
-    inline bool IsEmulatedDevicePath(const wchar_t *path)
+    template <typename Char>
+    bool IsEmulatedDevicePath(const Char *path)
+    {
+        return DEVICE_PATH_MATCHER.Match(path) != 0;
+    }
+
+    // Helper function to get controller index from device path (1-based index), 0 if it is not an emulated device
+    template <typename Char>
+    int GetControllerIndex(const Char *path)
+    {
+        return DEVICE_PATH_MATCHER.Match(path);
+    }
+
+    // Slot of an emulated raw input device handle, -1 for any other handle
+    inline int GetDeviceSlot(HANDLE handle)
     {
-        return wcscmp(path, DEVICE_PATH_CONTROLLER_1) == 0 ||
-               wcscmp(path, DEVICE_PATH_CONTROLLER_2) == 0 ||
-               wcscmp(path, DEVICE_PATH_CONTROLLER_3) == 0 ||
-               wcscmp(path, DEVICE_PATH_CONTROLLER_4) == 0;
+        for (int i = 0; i < DEVICE_COUNT; i++)
+        {
+            if (handle == EMULATED_DEVICE_HANDLES[i])
+                return i;
+        }
+        return -1;
     }
 
-    // Helper function to get controller index from device path (1-based index)
-    inline int GetControllerIndex(const wchar_t *path)
+    inline const wchar_t *GetDevicePath(int slotIndex)
     {
-        if (wcscmp(path, DEVICE_PATH_CONTROLLER_1) == 0)
-            return 1;
-        if (wcscmp(path, DEVICE_PATH_CONTROLLER_2) == 0)
-            return 2;
-        if (wcscmp(path, DEVICE_PATH_CONTROLLER_3) == 0)
-            return 3;
-        if (wcscmp(path, DEVICE_PATH_CONTROLLER_4) == 0)
-            return 4;
-        return 0; // Not an emulated device
+        constexpr const wchar_t *paths[DEVICE_COUNT] = {DEVICE_PATH_CONTROLLER_1, DEVICE_PATH_CONTROLLER_2,
+                                                        DEVICE_PATH_CONTROLLER_3, DEVICE_PATH_CONTROLLER_4};
+        return paths[slotIndex];
     }
 }
\ No newline at end of file
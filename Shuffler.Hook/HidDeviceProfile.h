@@ -0,0 +1,322 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class HidItemType : uint8_t { Value, Buttons, Padding };
+
+// One input main item of the report descriptor, in report order
+struct HidReportItem {
+    HidItemType Type = HidItemType::Padding;
+    uint8_t Collection = 0;  // 0 for the application collection, otherwise the 1-based physical collection
+    uint16_t UsagePage = 0;
+    uint16_t Usages[4] = {};  // For buttons, the first and last usage of the range
+    uint8_t UsageCount = 0;
+    uint8_t BitSize = 0;  // Size of one element
+    uint8_t ReportCount = 0;
+    bool HasNullState = false;
+    int32_t LogicalMin = 0;  // Limits are stored as the descriptor declares them, so 0xFFFF in a 2 byte item is -1
+    int32_t LogicalMax = 0;
+    int32_t PhysicalMin = 0;
+    int32_t PhysicalMax = 0;
+    uint32_t Units = 0;
+};
+
+// Declarative description of an emulated HID gamepad, turned into everything the hooks hand out at compile time
+struct HidDeviceProfile {
+    static constexpr size_t MAX_ITEMS = 8;
+
+    uint16_t VendorId;
+    uint16_t ProductId;
+    uint16_t VersionNumber;
+    uint16_t UsagePage;
+    uint16_t Usage;
+    const wchar_t* ManufacturerString;
+    const wchar_t* ProductString;
+    const char* InstanceIdPrefix;  // Device instance id before the controller number, e.g. "a&36fff2e"
+    uint8_t PhysicalCollectionCount;
+    HidReportItem Items[MAX_ITEMS];
+    uint8_t ItemCount;
+};
+
+// Position of one field inside an input report, in bits from the start of the report (including the report ID byte).
+// Array fields such as buttons cover all their elements.
+struct HidFieldLayout {
+    uint16_t BitOffset;
+    uint16_t BitSize;
+};
+
+struct HidReportLayout {
+    uint16_t ReportLength;
+    HidFieldLayout X;
+    HidFieldLayout Y;
+    HidFieldLayout Z;
+    HidFieldLayout Rx;
+    HidFieldLayout Ry;
+    HidFieldLayout Hat;
+    HidFieldLayout Buttons;  // Button usage 1 is at BitOffset, the rest follow one bit each
+};
+
+/**
+ * Builds the HIDP_PREPARSED_DATA image, the report layout and the device paths for a HidDeviceProfile.
+ *
+ * The image is a 44 byte header, one 104 byte value caps entry per usage, then one 16 byte node per link
+ * collection, laid out the way the native HID parser produces them. Items with several usages get one caps entry
+ * per usage, last usage first, like the native parser lists them.
+ */
+class HidDeviceGenerator {
+    static constexpr size_t HEADER_SIZE = 0x2C;
+    static constexpr size_t CAPS_SIZE = 0x68;
+    static constexpr size_t NODE_SIZE = 0x10;
+
+    // The image captured from the real controller ends with one unused caps entry, kept so images stay identical
+    static constexpr size_t TRAILING_SIZE = CAPS_SIZE;
+
+    static constexpr uint16_t USAGE_PAGE_GENERIC_DESKTOP = 0x01;
+    static constexpr uint32_t VALUE_CAPS_FLAGS = 0x08;
+    static constexpr uint32_t BUTTON_CAPS_FLAGS = 0x1C;
+    static constexpr uint32_t MAIN_ITEM_VARIABLE = 0x02;
+    static constexpr uint32_t MAIN_ITEM_NULL_STATE = 0x40;
+
+    static constexpr char DEVICE_PATH_PREFIX[] = "\\\\?\\HID#VID_";
+    static constexpr char DEVICE_PATH_SUFFIX[] = "&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}";
+
+  public:
+    static constexpr uint16_t USAGE_X = 0x30;
+    static constexpr uint16_t USAGE_Y = 0x31;
+    static constexpr uint16_t USAGE_Z = 0x32;
+    static constexpr uint16_t USAGE_RX = 0x33;
+    static constexpr uint16_t USAGE_RY = 0x34;
+    static constexpr uint16_t USAGE_HAT = 0x39;
+    static constexpr uint16_t USAGE_PAGE_BUTTON = 0x09;
+
+    static constexpr size_t GetPreparsedDataSize(const HidDeviceProfile& profile) {
+        return HEADER_SIZE + GetCapsCount(profile) * CAPS_SIZE + (profile.PhysicalCollectionCount + 1) * NODE_SIZE +
+               TRAILING_SIZE;
+    }
+
+    template <size_t Size>
+    static constexpr std::array<uint8_t, Size> GeneratePreparsedData(const HidDeviceProfile& profile) {
+        std::array<uint8_t, Size> data = {};
+        const uint16_t capsCount = GetCapsCount(profile);
+
+        constexpr char magic[] = "HidP KDR";
+        for (size_t i = 0; i < 8; i++)
+            data[i] = static_cast<uint8_t>(magic[i]);
+
+        WriteWord(data, 0x08, profile.Usage);
+        WriteWord(data, 0x0A, profile.UsagePage);
+        // Input caps start, count, end and report length, then the same for the (empty) output and feature caps
+        WriteWord(data, 0x10, 0);
+        WriteWord(data, 0x12, capsCount);
+        WriteWord(data, 0x14, capsCount);
+        WriteWord(data, 0x16, GetReportLength(profile));
+        for (size_t offset = 0x18; offset < 0x28; offset += 8) {
+            WriteWord(data, offset, capsCount);
+            WriteWord(data, offset + 4, capsCount);
+        }
+        WriteWord(data, 0x28, static_cast<uint16_t>(capsCount * CAPS_SIZE));
+        WriteWord(data, 0x2A, static_cast<uint16_t>(profile.PhysicalCollectionCount + 1));
+
+        size_t cap = HEADER_SIZE;
+        uint16_t dataIndex = 0;
+        uint16_t bitOffset = 8;  // Report ID byte
+        for (size_t i = 0; i < profile.ItemCount; i++) {
+            const HidReportItem& item = profile.Items[i];
+            if (item.Type == HidItemType::Buttons) {
+                const uint16_t usageCount = static_cast<uint16_t>(item.Usages[1] - item.Usages[0] + 1);
+                WriteCaps(data, cap, profile, item, bitOffset, item.ReportCount, item.Usages[0], item.Usages[1],
+                          dataIndex, static_cast<uint16_t>(dataIndex + usageCount - 1));
+                cap += CAPS_SIZE;
+                dataIndex += usageCount;
+            } else if (item.Type == HidItemType::Value) {
+                for (size_t usage = item.UsageCount; usage-- > 0;) {
+                    const uint16_t usageBitOffset = static_cast<uint16_t>(bitOffset + usage * item.BitSize);
+                    WriteCaps(data, cap, profile, item, usageBitOffset, 1, item.Usages[usage], item.Usages[usage],
+                              dataIndex, dataIndex);
+                    cap += CAPS_SIZE;
+                    dataIndex++;
+                }
+            }
+
+            bitOffset += item.BitSize * item.ReportCount;
+        }
+
+        // Application collection, then its physical collections linked as siblings from the last one back
+        const uint8_t physicalCount = profile.PhysicalCollectionCount;
+        WriteNode(data, cap, profile.Usage, profile.UsagePage, physicalCount, 0, physicalCount, 1);
+        for (uint16_t node = 1; node <= physicalCount; node++)
+            WriteNode(data, cap + node * NODE_SIZE, 0, USAGE_PAGE_GENERIC_DESKTOP, 0, node - 1, 0, 0);
+
+        return data;
+    }
+
+    static constexpr HidReportLayout GenerateLayout(const HidDeviceProfile& profile) {
+        HidReportLayout layout = {};
+        layout.ReportLength = GetReportLength(profile);
+        layout.X = FindField(profile, USAGE_PAGE_GENERIC_DESKTOP, USAGE_X);
+        layout.Y = FindField(profile, USAGE_PAGE_GENERIC_DESKTOP, USAGE_Y);
+        layout.Z = FindField(profile, USAGE_PAGE_GENERIC_DESKTOP, USAGE_Z);
+        layout.Rx = FindField(profile, USAGE_PAGE_GENERIC_DESKTOP, USAGE_RX);
+        layout.Ry = FindField(profile, USAGE_PAGE_GENERIC_DESKTOP, USAGE_RY);
+        layout.Hat = FindField(profile, USAGE_PAGE_GENERIC_DESKTOP, USAGE_HAT);
+        layout.Buttons = FindField(profile, USAGE_PAGE_BUTTON, 1);
+        return layout;
+    }
+
+    static constexpr size_t GetDevicePathLength(const HidDeviceProfile& profile) {
+        // Prefix, VID, "&PID_", PID, "&IG_00#", instance prefix, controller number, suffix, null terminator
+        return (sizeof(DEVICE_PATH_PREFIX) - 1) + 4 + 5 + 4 + 7 + StringLength(profile.InstanceIdPrefix) + 1 +
+               (sizeof(DEVICE_PATH_SUFFIX) - 1) + 1;
+    }
+
+    // Index of the controller number in a device path, the paths of all controllers differ only there
+    static constexpr size_t GetDevicePathNumberOffset(const HidDeviceProfile& profile) {
+        return GetDevicePathLength(profile) - (sizeof(DEVICE_PATH_SUFFIX) - 1) - 2;
+    }
+
+    // Device path for a 1-based controller number, in the format real wired Xbox controllers use:
+    // \\?\HID#VID_045E&PID_02FF&IG_00#a&36fff2e1&0&0000#{4d1e55b2-f16f-11cf-88cb-001111000030}
+    template <size_t Length>
+    static constexpr std::array<wchar_t, Length> GenerateDevicePath(const HidDeviceProfile& profile,
+                                                                    int controllerNumber) {
+        std::array<wchar_t, Length> path = {};
+        size_t position = 0;
+        AppendString(path, position, DEVICE_PATH_PREFIX);
+        AppendHex(path, position, profile.VendorId);
+        AppendString(path, position, "&PID_");
+        AppendHex(path, position, profile.ProductId);
+        AppendString(path, position, "&IG_00#");
+        AppendString(path, position, profile.InstanceIdPrefix);
+        path[position++] = static_cast<wchar_t>(L'0' + controllerNumber);
+        AppendString(path, position, DEVICE_PATH_SUFFIX);
+        return path;
+    }
+
+  private:
+    static constexpr uint16_t GetCapsCount(const HidDeviceProfile& profile) {
+        uint16_t count = 0;
+        for (size_t i = 0; i < profile.ItemCount; i++) {
+            if (profile.Items[i].Type == HidItemType::Buttons)
+                count++;
+            else if (profile.Items[i].Type == HidItemType::Value)
+                count += profile.Items[i].UsageCount;
+        }
+        return count;
+    }
+
+    static constexpr uint16_t GetReportLength(const HidDeviceProfile& profile) {
+        uint32_t bits = 8;
+        for (size_t i = 0; i < profile.ItemCount; i++)
+            bits += profile.Items[i].BitSize * profile.Items[i].ReportCount;
+        return static_cast<uint16_t>((bits + 7) / 8);
+    }
+
+    static constexpr HidFieldLayout FindField(const HidDeviceProfile& profile, uint16_t usagePage, uint16_t usage) {
+        uint16_t bitOffset = 8;
+        for (size_t i = 0; i < profile.ItemCount; i++) {
+            const HidReportItem& item = profile.Items[i];
+            if (item.Type == HidItemType::Buttons && item.UsagePage == usagePage && item.Usages[0] == usage)
+                return {.BitOffset = bitOffset, .BitSize = static_cast<uint16_t>(item.BitSize * item.ReportCount)};
+
+            if (item.Type == HidItemType::Value && item.UsagePage == usagePage) {
+                for (size_t j = 0; j < item.UsageCount; j++) {
+                    if (item.Usages[j] == usage)
+                        return {.BitOffset = static_cast<uint16_t>(bitOffset + j * item.BitSize),
+                                .BitSize = item.BitSize};
+                }
+            }
+
+            bitOffset += item.BitSize * item.ReportCount;
+        }
+
+        throw "Usage not found in device profile";  // Only reachable during constant evaluation
+    }
+
+    template <size_t Size>
+    static constexpr void WriteCaps(std::array<uint8_t, Size>& data, size_t cap, const HidDeviceProfile& profile,
+                                    const HidReportItem& item, uint16_t bitOffset, uint16_t reportCount,
+                                    uint16_t usageMin, uint16_t usageMax, uint16_t dataIndexMin,
+                                    uint16_t dataIndexMax) {
+        const bool isButton = item.Type == HidItemType::Buttons;
+        const uint16_t totalBits = static_cast<uint16_t>(item.BitSize * reportCount);
+        const uint16_t startByte = bitOffset / 8;
+        const uint8_t startBit = bitOffset % 8;
+
+        WriteWord(data, cap + 0x00, item.UsagePage);
+        data[cap + 0x02] = 0;  // Report ID
+        data[cap + 0x03] = startBit;
+        WriteWord(data, cap + 0x04, item.BitSize);
+        WriteWord(data, cap + 0x06, reportCount);
+        WriteWord(data, cap + 0x08, startByte);
+        WriteWord(data, cap + 0x0A, totalBits);
+        WriteDword(data, cap + 0x0C, MAIN_ITEM_VARIABLE | (item.HasNullState ? MAIN_ITEM_NULL_STATE : 0));
+        WriteWord(data, cap + 0x10, static_cast<uint16_t>(startByte + (startBit + totalBits + 7) / 8));
+        WriteWord(data, cap + 0x12, item.Collection);
+        WriteWord(data, cap + 0x14, item.Collection ? USAGE_PAGE_GENERIC_DESKTOP : profile.UsagePage);
+        WriteWord(data, cap + 0x16, item.Collection ? 0 : profile.Usage);
+        WriteDword(data, cap + 0x18, isButton ? BUTTON_CAPS_FLAGS : VALUE_CAPS_FLAGS);
+        // 0x1C-0x3B reserved
+        WriteWord(data, cap + 0x3C, usageMin);
+        WriteWord(data, cap + 0x3E, usageMax);
+        // 0x40-0x47 string and designator ranges
+        WriteWord(data, cap + 0x48, dataIndexMin);
+        WriteWord(data, cap + 0x4A, dataIndexMax);
+        WriteWord(data, cap + 0x4C, item.HasNullState ? 1 : 0);
+
+        // Button caps carry no limits or units
+        if (!isButton) {
+            WriteDword(data, cap + 0x50, static_cast<uint32_t>(item.LogicalMin));
+            WriteDword(data, cap + 0x54, static_cast<uint32_t>(item.LogicalMax));
+            WriteDword(data, cap + 0x58, static_cast<uint32_t>(item.PhysicalMin));
+            WriteDword(data, cap + 0x5C, static_cast<uint32_t>(item.PhysicalMax));
+            WriteDword(data, cap + 0x60, item.Units);
+        }
+    }
+
+    template <size_t Size>
+    static constexpr void WriteNode(std::array<uint8_t, Size>& data, size_t node, uint16_t usage, uint16_t usagePage,
+                                    uint16_t childCount, uint16_t nextSibling, uint16_t firstChild,
+                                    uint32_t collectionType) {
+        WriteWord(data, node + 0x00, usage);
+        WriteWord(data, node + 0x02, usagePage);
+        WriteWord(data, node + 0x04, 0);  // Parent
+        WriteWord(data, node + 0x06, childCount);
+        WriteWord(data, node + 0x08, nextSibling);
+        WriteWord(data, node + 0x0A, firstChild);
+        WriteDword(data, node + 0x0C, collectionType);
+    }
+
+    template <size_t Size>
+    static constexpr void WriteWord(std::array<uint8_t, Size>& data, size_t offset, uint16_t value) {
+        data[offset] = static_cast<uint8_t>(value);
+        data[offset + 1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    template <size_t Size>
+    static constexpr void WriteDword(std::array<uint8_t, Size>& data, size_t offset, uint32_t value) {
+        WriteWord(data, offset, static_cast<uint16_t>(value));
+        WriteWord(data, offset + 2, static_cast<uint16_t>(value >> 16));
+    }
+
+    static constexpr size_t StringLength(const char* string) {
+        size_t length = 0;
+        while (string[length])
+            length++;
+        return length;
+    }
+
+    template <size_t Length>
+    static constexpr void AppendString(std::array<wchar_t, Length>& path, size_t& position, const char* string) {
+        for (size_t i = 0; string[i]; i++)
+            path[position++] = static_cast<wchar_t>(string[i]);
+    }
+
+    template <size_t Length>
+    static constexpr void AppendHex(std::array<wchar_t, Length>& path, size_t& position, uint16_t value) {
+        constexpr char digits[] = "0123456789ABCDEF";
+        for (int shift = 12; shift >= 0; shift -= 4)
+            path[position++] = static_cast<wchar_t>(digits[(value >> shift) & 0xF]);
+    }
+};
\ No newline at end of file
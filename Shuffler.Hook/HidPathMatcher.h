@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Recognizes the device paths of the emulated controllers, which only differ in their controller number, and parses
+ * that number out of the path.
+ *
+ * Paths are compared character by character against one pattern and the comparison stops at the first mismatch, so
+ * anything that is not a "\\?\HID#" path is turned away within its first 8 characters. Narrow and wide paths are
+ * matched as they are, without converting them. Letters match regardless of case, like Windows matches device paths.
+ */
+template <size_t Length>
+class HidPathMatcher {
+    char _pattern[Length] = {};
+    size_t _numberOffset;
+    int _count;
+
+  public:
+    // firstPath is the path of controller 1, the other controllers up to count only change the digit at numberOffset
+    constexpr HidPathMatcher(const std::array<wchar_t, Length>& firstPath, const size_t numberOffset, const int count)
+        : _numberOffset(numberOffset), _count(count) {
+        for (size_t i = 0; i < Length; i++)
+            _pattern[i] = static_cast<char>(ToLower(firstPath[i]));
+    }
+
+    // Returns the 1-based controller number, or 0 if path is not the path of an emulated controller
+    template <typename Char>
+    constexpr int Match(const Char* path) const {
+        if (!path)
+            return 0;
+
+        int number = 0;
+        for (size_t i = 0; i < Length; i++) {
+            const auto c = ToLower(path[i]);
+            if (i == _numberOffset) {
+                number = static_cast<int>(c) - '0';
+                if (number < 1 || number > _count)
+                    return 0;
+            } else if (c != static_cast<unsigned char>(_pattern[i])) {
+                return 0;  // Also stops at the end of a path that is shorter than the pattern
+            }
+        }
+
+        return number;
+    }
+
+  private:
+    template <typename Char>
+    static constexpr auto ToLower(const Char c) {
+        using Unsigned = std::make_unsigned_t<Char>;
+        const auto value = static_cast<Unsigned>(c);
+        return value >= 'A' && value <= 'Z' ? static_cast<Unsigned>(value + ('a' - 'A')) : value;
+    }
+};
\ No newline at end of file
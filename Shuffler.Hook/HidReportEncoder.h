@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include "EmulatedDeviceDefinitions.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+/**
+ * Packs a ControllerState into the emulated device's input report with plain shifts and masks, producing the same
+ * bytes HidP_SetUsages/HidP_SetUsageValue would.
+ */
+class HidReportEncoder {
+    static constexpr HidReportLayout LAYOUT = EmulatedDeviceDefinitions::REPORT_LAYOUT;
+
+    static constexpr uint32_t HID_HAT_UP = 1;
+    static constexpr uint32_t HID_HAT_UP_RIGHT = 2;
+    static constexpr uint32_t HID_HAT_RIGHT = 3;
+    static constexpr uint32_t HID_HAT_DOWN_RIGHT = 4;
+    static constexpr uint32_t HID_HAT_DOWN = 5;
+    static constexpr uint32_t HID_HAT_DOWN_LEFT = 6;
+    static constexpr uint32_t HID_HAT_LEFT = 7;
+    static constexpr uint32_t HID_HAT_UP_LEFT = 8;
+
+    static constexpr int32_t TRIGGER_SCALE = 128;
+    static constexpr int32_t AXIS_CENTER = 0xFFFF / 2;
+
+    // Hat value for every combination of the four D-pad bits, resolving conflicting directions the same way the
+    // HidP_SetUsageValue based implementation did
+    static constexpr std::array<uint8_t, 16> HAT_VALUES = [] {
+        std::array<uint8_t, 16> values = {};
+        for (uint16_t dpad = 0; dpad < 16; dpad++) {
+            const bool up = dpad & static_cast<uint16_t>(Button::DPadUp);
+            const bool down = dpad & static_cast<uint16_t>(Button::DPadDown);
+            const bool left = dpad & static_cast<uint16_t>(Button::DPadLeft);
+            const bool right = dpad & static_cast<uint16_t>(Button::DPadRight);
+
+            if (up && right)
+                values[dpad] = HID_HAT_UP_RIGHT;
+            else if (down && right)
+                values[dpad] = HID_HAT_DOWN_RIGHT;
+            else if (down && left)
+                values[dpad] = HID_HAT_DOWN_LEFT;
+            else if (up && left)
+                values[dpad] = HID_HAT_UP_LEFT;
+            else if (up)
+                values[dpad] = HID_HAT_UP;
+            else if (right)
+                values[dpad] = HID_HAT_RIGHT;
+            else if (down)
+                values[dpad] = HID_HAT_DOWN;
+            else if (left)
+                values[dpad] = HID_HAT_LEFT;
+        }
+        return values;
+    }();
+
+  public:
+    static constexpr uint16_t REPORT_LENGTH = LAYOUT.ReportLength;
+
+    static void Encode(const ControllerState& state, uint8_t* report) {
+        memset(report, 0, REPORT_LENGTH);
+
+        WriteField(report, LAYOUT.X, RemapAxis(state.LeftThumbstickX));
+        WriteField(report, LAYOUT.Y, RemapAxis(-state.LeftThumbstickY));
+        WriteField(report, LAYOUT.Rx, RemapAxis(state.RightThumbstickX));
+        WriteField(report, LAYOUT.Ry, RemapAxis(-state.RightThumbstickY));
+        WriteField(report, LAYOUT.Z,
+                   std::clamp(AXIS_CENTER + (state.LeftTrigger - state.RightTrigger) * TRIGGER_SCALE, 0, 0xFFFF));
+        WriteField(report, LAYOUT.Hat, HAT_VALUES[state.ButtonStates & 0xF]);
+        WriteField(report, LAYOUT.Buttons, GetHidButtons(state.ButtonStates));
+    }
+
+  private:
+    static constexpr uint32_t RemapAxis(int32_t value) {
+        return static_cast<uint32_t>(std::clamp(value + AXIS_CENTER, 0, 0xFFFF));
+    }
+
+    // HID buttons 1-10 are A, B, X, Y, LB, RB, Back, Start, LS, RS
+    static constexpr uint32_t GetHidButtons(uint16_t buttons) {
+        return ((buttons >> 12) & 0xF) | (((buttons >> 8) & 0x3) << 4) | (((buttons >> 5) & 0x1) << 6) |
+               (((buttons >> 4) & 0x1) << 7) | (((buttons >> 6) & 0x3) << 8);
+    }
+
+    static void WriteField(uint8_t* report, const HidFieldLayout field, uint32_t value) {
+        value &= (1u << field.BitSize) - 1;
+
+        const uint32_t shift = field.BitOffset & 7;
+        const uint32_t byteCount = (shift + field.BitSize + 7) / 8;
+        uint8_t* bytes = report + (field.BitOffset >> 3);
+        const uint32_t shifted = value << shift;
+        for (uint32_t i = 0; i < byteCount; i++)
+            bytes[i] |= static_cast<uint8_t>(shifted >> (i * 8));
+    }
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "HookStats.h"
+
+#ifdef SHUFFLER_HOOK_STATS
+
+#include <format>
+
+Logger HookStats::_logger("HookStats");
+HookStats::Shard HookStats::_shards[SHARD_COUNT][static_cast<size_t>(HookId::Count)];
+std::atomic<uint32_t> HookStats::_nextShard = 0;
+HANDLE HookStats::_mapping = nullptr;
+HookStatsPage* HookStats::_page = nullptr;
+std::atomic<bool> HookStats::_stopRequested = false;
+std::thread HookStats::_publishThread;
+
+bool HookStats::Init() {
+    const std::wstring name = std::format(L"Local\\ShufflerHookStats_{}", GetCurrentProcessId());
+    _mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(HookStatsPage),
+                                  name.c_str());
+    if (!_mapping) {
+        _logger.ErrorFormat("Failed to create stats mapping: {}", GetLastError());
+        return false;
+    }
+
+    _page = static_cast<HookStatsPage*>(MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, sizeof(HookStatsPage)));
+    if (!_page) {
+        _logger.ErrorFormat("Failed to map stats page: {}", GetLastError());
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    _page->Magic = HookStatsPage::MAGIC;
+    _page->Version = HookStatsPage::VERSION;
+    _page->HookCount = static_cast<uint16_t>(HookId::Count);
+    _page->BucketCount = HookLatencyBuckets::BUCKET_COUNT;
+    _page->SubBucketBits = HookLatencyBuckets::SUB_BUCKET_BITS;
+    _page->ProcessId = GetCurrentProcessId();
+    _page->TimestampFrequency = frequency.QuadPart;
+
+    _stopRequested = false;
+    _publishThread = std::thread(&HookStats::PublishThread);
+    return true;
+}
+
+void HookStats::Shutdown() {
+    _stopRequested = true;
+    if (_publishThread.joinable())
+        _publishThread.join();
+
+    if (_page) {
+        UnmapViewOfFile(_page);
+        _page = nullptr;
+    }
+
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+}
+
+void HookStats::Aggregate(HookStatsPage* page) {
+    const uint32_t sequence = page->Sequence.load(std::memory_order_relaxed);
+    page->Sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t hook = 0; hook < static_cast<size_t>(HookId::Count); hook++) {
+        HookStatsEntry& entry = page->Hooks[hook];
+        entry = {};
+
+        for (const auto& shards : _shards) {
+            const Shard& shard = shards[hook];
+            entry.Calls += shard.Calls.load(std::memory_order_relaxed);
+            entry.TotalTicks += shard.TotalTicks.load(std::memory_order_relaxed);
+            for (uint32_t bucket = 0; bucket < HookLatencyBuckets::BUCKET_COUNT; bucket++)
+                entry.Buckets[bucket] += shard.Buckets[bucket].load(std::memory_order_relaxed);
+        }
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    page->UpdatedTimestamp = now.QuadPart;
+    page->Sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void HookStats::PublishThread() {
+    while (!_stopRequested) {
+        Aggregate(_page);
+        std::this_thread::sleep_for(PUBLISH_INTERVAL);
+    }
+
+    Aggregate(_page);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Logger.h"
+#include <Windows.h>
+#include <atomic>
+#include <bit>
+#include <thread>
+
+// Hooked entry points with their own counters. The A/W and per-version variants of a function share one entry.
+enum class HookId : uint8_t {
+    XInputGetState,
+    XInputGetCapabilities,
+    RegisterRawInputDevices,
+    GetRawInputData,
+    GetRawInputDeviceList,
+    GetRawInputDeviceInfo,
+    GetRegisteredRawInputDevices,
+    CreateFile,
+    CloseHandle,
+    HidDGetString,
+    HidDGetPreparsedData,
+    HidDGetAttributes,
+    GetProcAddress,
+    LoadLibrary,
+    HidDFreePreparsedData,
+    GetRawInputBuffer,
+    ReadFile,
+    GetOverlappedResult,
+    CancelIo,
+    Count
+};
+
+/**
+ * Log-linear latency buckets: values below 2^SUB_BUCKET_BITS get a bucket each, every power of two above that is split
+ * into 2^SUB_BUCKET_BITS equal buckets, so every bucket is within 12.5% of the values it holds.
+ */
+struct HookLatencyBuckets {
+    static constexpr uint32_t SUB_BUCKET_BITS = 3;
+    static constexpr uint32_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr uint32_t BUCKET_COUNT = (32 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    static constexpr uint32_t GetBucket(const uint64_t ticks) {
+        if (ticks < SUB_BUCKET_COUNT)
+            return static_cast<uint32_t>(ticks);
+        if (ticks >> 32)
+            return BUCKET_COUNT - 1;
+
+        const uint32_t exponent = std::bit_width(ticks) - 1;
+        const uint32_t subBucket =
+            static_cast<uint32_t>(ticks >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+    }
+
+    // Smallest value that lands in bucket
+    static constexpr uint64_t GetBucketStart(const uint32_t bucket) {
+        if (bucket < SUB_BUCKET_COUNT)
+            return bucket;
+
+        const uint32_t exponent = bucket / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+        return (static_cast<uint64_t>(SUB_BUCKET_COUNT + bucket % SUB_BUCKET_COUNT)) << (exponent - SUB_BUCKET_BITS);
+    }
+};
+
+struct HookStatsEntry {
+    uint64_t Calls;
+    uint64_t TotalTicks;
+    uint64_t Buckets[HookLatencyBuckets::BUCKET_COUNT];
+};
+
+/**
+ * Layout of the shared memory page the stats are published in, named "Local\ShufflerHookStats_<pid>".
+ *
+ * Readers copy the page and retry if Sequence was odd or changed while they were copying.
+ */
+struct HookStatsPage {
+    static constexpr uint32_t MAGIC = 0x54534853;  // "SHST"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t HookCount;
+    uint16_t BucketCount;
+    uint16_t SubBucketBits;
+    uint32_t ProcessId;
+    int64_t TimestampFrequency;  // QueryPerformanceCounter ticks per second, latencies are in ticks
+    std::atomic<uint32_t> Sequence;
+    uint32_t Reserved;
+    int64_t UpdatedTimestamp;
+    HookStatsEntry Hooks[static_cast<size_t>(HookId::Count)];
+};
+
+#ifdef SHUFFLER_HOOK_STATS
+
+/**
+ * Call counts and latency histograms for the hooked entry points.
+ *
+ * Hooks record into one of a fixed set of cache line aligned shards picked per thread, so threads do not contend on
+ * the same counters. A background thread periodically sums the shards into the shared HookStatsPage.
+ */
+class HookStats {
+    static constexpr uint32_t SHARD_COUNT = 16;
+    static constexpr auto PUBLISH_INTERVAL = std::chrono::milliseconds(250);
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> Calls;
+        std::atomic<uint64_t> TotalTicks;
+        std::atomic<uint32_t> Buckets[HookLatencyBuckets::BUCKET_COUNT];
+    };
+
+    static Logger _logger;
+    static Shard _shards[SHARD_COUNT][static_cast<size_t>(HookId::Count)];
+    static std::atomic<uint32_t> _nextShard;
+    static HANDLE _mapping;
+    static HookStatsPage* _page;
+    static std::atomic<bool> _stopRequested;
+    static std::thread _publishThread;
+
+  public:
+    class ScopedTimer {
+        HookId _hook;
+        LARGE_INTEGER _start;
+
+      public:
+        explicit ScopedTimer(const HookId hook) : _hook(hook) {
+            QueryPerformanceCounter(&_start);
+        }
+
+        ~ScopedTimer() {
+            LARGE_INTEGER end;
+            QueryPerformanceCounter(&end);
+            HookStats::Record(_hook, static_cast<uint64_t>(end.QuadPart - _start.QuadPart));
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+
+    static bool Init();
+    static void Shutdown();
+
+    static void Record(HookId hook, uint64_t ticks) {
+        static thread_local const uint32_t shardIndex =
+            _nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+
+        Shard& shard = _shards[shardIndex][static_cast<size_t>(hook)];
+        shard.Calls.fetch_add(1, std::memory_order_relaxed);
+        shard.TotalTicks.fetch_add(ticks, std::memory_order_relaxed);
+        shard.Buckets[HookLatencyBuckets::GetBucket(ticks)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Sums every shard into page
+    static void Aggregate(HookStatsPage* page);
+
+  private:
+    static void PublishThread();
+};
+
+#define HOOK_STATS_SCOPE(hook) const HookStats::ScopedTimer hookStatsTimer(hook)
+
+#else
+
+class HookStats {
+  public:
+    static bool Init() {
+        return true;
+    }
+
+    static void Shutdown() {}
+};
+
+#define HOOK_STATS_SCOPE(hook) ((void)0)
+
+#endif
\ No newline at end of file
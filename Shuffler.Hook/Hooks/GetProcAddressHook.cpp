@@ -1,4 +1,6 @@
 #include "GetProcAddressHook.h"
+#include "../HookStats.h"
+#include "../ProcNameTable.h"
 #include "HookHelper.h"
 #include "XInputHook.h"
 
@@ -7,6 +9,35 @@ HookHelper GetProcAddressHook::_hookHelper;
 bool GetProcAddressHook::Enabled = false;
 decltype(&GetProcAddress) GetProcAddressHook::_originalGetProcAddress = nullptr;
 
+namespace {
+
+// Exports that resolve to a hook, the named ones first in the order of EXPORT_NAMES, then the ordinals in order
+enum class HookedExport : uint8_t { GetState, GetCapabilities, GetStateOrdinal, GetCapabilitiesOrdinal, Count };
+
+constexpr const char* EXPORT_NAMES[] = {"XInputGetState", "XInputGetCapabilities"};
+constexpr ProcNameTable<std::size(EXPORT_NAMES)> EXPORT_NAME_TABLE(EXPORT_NAMES);
+constexpr WORD FIRST_ORDINAL = 100;
+constexpr WORD ORDINAL_COUNT = 2;
+
+constexpr int VERSION_COUNT = static_cast<int>(XInputVersion::XInput910) + 1;
+
+// Hook thunk for every export and XInput version, indexed by HookedExport and XInputVersion. XInput 9.1.0 has no
+// ordinal exports
+const FARPROC Thunks[static_cast<int>(HookedExport::Count)][VERSION_COUNT] = {
+    {nullptr, Utils::FunctionToFarProc(XInputHook::HookedXInputGetState14),
+     Utils::FunctionToFarProc(XInputHook::HookedXInputGetState13),
+     Utils::FunctionToFarProc(XInputHook::HookedXInputGetState910)},
+    {nullptr, Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities14),
+     Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities13),
+     Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities910)},
+    {nullptr, Utils::FunctionToFarProc(XInputHook::HookedXInputGetState14Ordinal),
+     Utils::FunctionToFarProc(XInputHook::HookedXInputGetState13Ordinal), nullptr},
+    {nullptr, Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities14Ordinal),
+     Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities13Ordinal), nullptr},
+};
+
+}  // namespace
+
 bool GetProcAddressHook::Install() {
     _logger.Info("Installing GetProcAddress hook...");
     bool success = _hookHelper.Hook("kernel32.dll", "GetProcAddress", &_originalGetProcAddress, HookedGetProcAddress);
@@ -25,82 +56,30 @@ bool GetProcAddressHook::Uninstall() {
 }
 
 FARPROC WINAPI GetProcAddressHook::HookedGetProcAddress(HMODULE hModule, LPCSTR lpProcName) {
-    if (lpProcName == nullptr)
-        return _originalGetProcAddress(hModule, lpProcName);
+    HOOK_STATS_SCOPE(HookId::GetProcAddress);
 
-    if (!XInputHook::IsModuleHooked(hModule)) {
+    // One probe of the hooked module cache turns away every module that is not a hooked XInput DLL
+    const XInputVersion version = XInputHook::GetHookedVersion(hModule);
+    if (version == XInputVersion::None || lpProcName == nullptr)
         return _originalGetProcAddress(hModule, lpProcName);
-    } 
-
-    XInputVersion version = XInputHook::GetXInputVersion(hModule);
-    if (version == XInputVersion::None)
-        return _originalGetProcAddress(hModule, lpProcName);
-
-    FARPROC result = nullptr;
-
-    _logger.InfoFormat("GetProcAddress called for {} in {}", (void*)hModule, Utils::GetDllName(hModule));
 
     // Check if lpProcName is a string (not an ordinal)
+    int exportIndex = -1;
     if (HIWORD(lpProcName) != 0) {
-        if (strcmp(lpProcName, "XInputGetState") == 0) {
-            switch (version) {
-            case XInputVersion::XInput13:
-                _logger.Info("Returning XInputGetState for XInput 1.3");
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetState13);
-                break;
-            case XInputVersion::XInput14:
-                _logger.Info("Returning XInputGetState for XInput 1.4");
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetState14);
-                break;
-            case XInputVersion::XInput910:
-                _logger.Info("Returning XInputGetState for XInput 9.1.0");
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetState910);
-                break;
-            default:;
-            }
-        } else if (strcmp(lpProcName, "XInputGetCapabilities") == 0) {
-            switch (version) {
-            case XInputVersion::XInput13:
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities13);
-                break;
-            case XInputVersion::XInput14:
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities14);
-                break;
-            case XInputVersion::XInput910:
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities910);
-                break;
-            default:;
-            }
-        }
+        exportIndex = EXPORT_NAME_TABLE.Find(lpProcName);
     } else {
         const WORD ordinal = LOWORD(reinterpret_cast<DWORD_PTR>(lpProcName));
-        if (ordinal == 100) {
-            switch (version) {
-            case XInputVersion::XInput13:
-                _logger.Info("Returning XInputGetState ordinal for XInput 1.3");
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetState13Ordinal);
-                break;
-            case XInputVersion::XInput14:
-                _logger.Info("Returning XInputGetState ordinal for XInput 1.4");
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetState14Ordinal);
-                break;
-            default:;
-            }
-        } else if (ordinal == 101) {
-            switch (version) {
-            case XInputVersion::XInput13:
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities13Ordinal);
-                break;
-            case XInputVersion::XInput14:
-                result = Utils::FunctionToFarProc(XInputHook::HookedXInputGetCapabilities14Ordinal);
-                break;
-            default:;
-            }
-        }
+        if (ordinal >= FIRST_ORDINAL && ordinal < FIRST_ORDINAL + ORDINAL_COUNT)
+            exportIndex = static_cast<int>(HookedExport::GetStateOrdinal) + (ordinal - FIRST_ORDINAL);
     }
 
+    const FARPROC result = exportIndex >= 0 ? Thunks[exportIndex][static_cast<int>(version)] : nullptr;
     if (!result)
-        result = _originalGetProcAddress(hModule, lpProcName);
+        return _originalGetProcAddress(hModule, lpProcName);
+
+    if (_logger.IsEnabled(LogLevel::Debug))
+        _logger.DebugFormat("Returning hooked export {} for {} in {}", exportIndex, (void*)hModule,
+                            Utils::GetDllName(hModule));
 
     return result;
 }
\ No newline at end of file
@@ -1,11 +1,24 @@
 #include "HidDeviceHook.h"
 
+#include "../ControllerManager.h"
 #include "../EmulatedDeviceDefinitions.h"
+#include "../HookStats.h"
 #include "../Logger.h"
 #include "RawInputHook.h"
+#include <atomic>
+#include <chrono>
 
 Logger HidDeviceHook::_logger = Logger("HidDeviceHook");
 HookHelper HidDeviceHook::_hookHelper;
+VirtualHandleTable<HidDeviceHook::EmulatedFile> HidDeviceHook::_files;
+SharedBlock HidDeviceHook::_preparsedData(EmulatedDeviceDefinitions::PREPROCESSED_DATA.data(),
+                                          EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE);
+HidDeviceHook::ReportStream HidDeviceHook::_streams[FILE_CAPACITY];
+std::mutex HidDeviceHook::_pumpMutex;
+std::condition_variable HidDeviceHook::_pumpWake;
+std::thread HidDeviceHook::_pumpThread;
+std::atomic<size_t> HidDeviceHook::_openStreams = 0;
+bool HidDeviceHook::_pumpStopRequested = false;
 bool HidDeviceHook::Enabled = false;
 
 namespace {
@@ -13,12 +26,35 @@ namespace {
 decltype(&CreateFileW) OriginalCreateFileW = nullptr;
 decltype(&CreateFileA) OriginalCreateFileA = nullptr;
 decltype(&CloseHandle) OriginalCloseHandle = nullptr;
+decltype(&ReadFile) OriginalReadFile = nullptr;
+decltype(&GetOverlappedResult) OriginalGetOverlappedResult = nullptr;
+decltype(&CancelIo) OriginalCancelIo = nullptr;
+decltype(&CancelIoEx) OriginalCancelIoEx = nullptr;
 decltype(&HidD_GetManufacturerString) OriginalHidDGetManufacturerString = nullptr;
 decltype(&HidD_GetProductString) OriginalHidDGetProductString = nullptr;
 decltype(&HidD_GetSerialNumberString) OriginalHidDGetSerialNumberString = nullptr;
 decltype(&HidD_GetPreparsedData) OriginalHidDGetPreparsedData = nullptr;
+decltype(&HidD_FreePreparsedData) OriginalHidDFreePreparsedData = nullptr;
 decltype(&HidD_GetAttributes) OriginalHidDGetAttributes = nullptr;
 
+// Same pace as the background XInput polling. Only a game that reads nothing but ReadFile relies on it, any other read
+// of the device queues its changes right away
+constexpr auto REPORT_PUMP_INTERVAL = std::chrono::milliseconds(1);
+
+// Completion statuses an OVERLAPPED carries in Internal
+constexpr ULONG_PTR READ_SUCCESS = 0x00000000;    // STATUS_SUCCESS
+constexpr ULONG_PTR READ_PENDING = 0x00000103;    // STATUS_PENDING
+constexpr ULONG_PTR READ_CANCELLED = 0xC0000120;  // STATUS_CANCELLED
+
+// An OVERLAPPED's event with the low bit, which only keeps the completion off an I/O completion port, cleared
+HANDLE GetCompletionEvent(const OVERLAPPED* overlapped) {
+    return reinterpret_cast<HANDLE>(reinterpret_cast<uintptr_t>(overlapped->hEvent) & ~static_cast<uintptr_t>(1));
+}
+
+uint64_t GetSession(const HANDLE handle) {
+    return reinterpret_cast<uintptr_t>(handle);
+}
+
 }  // namespace
 
 bool HidDeviceHook::Install() {
@@ -28,6 +64,11 @@ bool HidDeviceHook::Install() {
     success &= _hookHelper.Hook("kernel32.dll", "CreateFileW", &OriginalCreateFileW, HookedCreateFileW);
     success &= _hookHelper.Hook("kernel32.dll", "CreateFileA", &OriginalCreateFileA, HookedCreateFileA);
     success &= _hookHelper.Hook("kernel32.dll", "CloseHandle", &OriginalCloseHandle, HookedCloseHandle);
+    success &= _hookHelper.Hook("kernel32.dll", "ReadFile", &OriginalReadFile, HookedReadFile);
+    success &= _hookHelper.Hook("kernel32.dll", "GetOverlappedResult", &OriginalGetOverlappedResult,
+                                HookedGetOverlappedResult);
+    success &= _hookHelper.Hook("kernel32.dll", "CancelIo", &OriginalCancelIo, HookedCancelIo);
+    success &= _hookHelper.Hook("kernel32.dll", "CancelIoEx", &OriginalCancelIoEx, HookedCancelIoEx);
     success &= _hookHelper.Hook("hid.dll", "HidD_GetManufacturerString", &OriginalHidDGetManufacturerString,
                                 HookedHidDGetManufacturerString);
     success &=
@@ -36,8 +77,13 @@ bool HidDeviceHook::Install() {
                                 HookedHidDGetSerialNumberString);
     success &=
         _hookHelper.Hook("hid.dll", "HidD_GetPreparsedData", &OriginalHidDGetPreparsedData, HookedHidDGetPreparsedData);
+    success &= _hookHelper.Hook("hid.dll", "HidD_FreePreparsedData", &OriginalHidDFreePreparsedData,
+                                HookedHidDFreePreparsedData);
     success &= _hookHelper.Hook("hid.dll", "HidD_GetAttributes", &OriginalHidDGetAttributes, HookedHidDGetAttributes);
 
+    // Reports are pushed where the slot's packet number moves, whichever api read it
+    ControllerManager::SetStateListener(&HidDeviceHook::OnStateChanged);
+
     if (success) {
         _logger.Info("HID device hooks installed successfully");
     } else {
@@ -48,22 +94,185 @@ bool HidDeviceHook::Install() {
 }
 
 bool HidDeviceHook::Uninstall() {
+    ControllerManager::SetStateListener(nullptr);
+    StopPump();
     return _hookHelper.Uninstall();
 }
 
+HANDLE HidDeviceHook::OpenEmulatedFile(const int slotIndex, const DWORD flagsAndAttributes) {
+    const HANDLE handle = _files.Open({slotIndex, (flagsAndAttributes & FILE_FLAG_OVERLAPPED) != 0});
+    if (!handle) {
+        _logger.Error("Too many open handles on emulated devices");
+        SetLastError(ERROR_TOO_MANY_OPEN_FILES);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    OpenStream(handle);
+    return handle;
+}
+
+int HidDeviceHook::GetDeviceIndex(const HANDLE handle) {
+    EmulatedFile file;
+    return _files.TryGet(handle, &file) ? file.DeviceIndex : -1;
+}
+
+void HidDeviceHook::OpenStream(const HANDLE handle) {
+    const int deviceIndex = GetDeviceIndex(handle);
+    ReportStream& stream = _streams[_files.GetIndex(handle)];
+    stream.Queue.Open(GetSession(handle));
+    stream.DeviceIndex.store(deviceIndex, std::memory_order_relaxed);
+    stream.Handle.store(handle, std::memory_order_release);
+
+    {
+        std::lock_guard lock(_pumpMutex);
+        _openStreams.fetch_add(1, std::memory_order_relaxed);
+        if (!_pumpThread.joinable()) {
+            _logger.InfoFormat("Starting HID report pump every {}ms", REPORT_PUMP_INTERVAL.count());
+            _pumpStopRequested = false;
+            _pumpThread = std::thread(&HidDeviceHook::PumpThread);
+        }
+    }
+    _pumpWake.notify_one();
+
+    // A newly opened handle gets the current state right away. Should the state change meanwhile, the queue keeps
+    // whichever packet is newer last
+    ControllerState state;
+    uint32_t packetNumber;
+    if (ControllerManager::PollState(deviceIndex, &state, &packetNumber)) {
+        uint8_t report[HidReportEncoder::REPORT_LENGTH];
+        HidReportEncoder::Encode(state, report);
+        PushReport(stream, handle, report, packetNumber);
+    }
+}
+
+void HidDeviceHook::CloseStream(const int streamIndex, const HANDLE handle) {
+    // Two threads closing the same handle at once both get here, only the first one closes the stream
+    ReportStream& stream = _streams[streamIndex];
+    HANDLE open = handle;
+    if (!stream.Handle.compare_exchange_strong(open, nullptr, std::memory_order_acq_rel))
+        return;
+
+    // Pending reads fail as cancelled and blocking ReadFile calls return, like they do when a real handle is closed
+    StreamQueue::PendingRead cancelled[StreamQueue::MAX_PENDING_READS];
+    CancelReads(cancelled, stream.Queue.Close(GetSession(handle), cancelled));
+
+    std::lock_guard lock(_pumpMutex);
+    _openStreams.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void HidDeviceHook::StopPump() {
+    {
+        std::lock_guard lock(_pumpMutex);
+        _pumpStopRequested = true;
+    }
+    _pumpWake.notify_one();
+
+    if (_pumpThread.joinable()) {
+        _pumpThread.join();
+        _logger.Info("HID report pump stopped");
+    }
+}
+
+void HidDeviceHook::PumpThread() {
+    auto nextPump = std::chrono::steady_clock::now();
+
+    std::unique_lock lock(_pumpMutex);
+    while (!_pumpStopRequested) {
+        // Sleeps without a timeout while no handle is open, games that only enumerate devices cost nothing
+        if (_openStreams.load(std::memory_order_relaxed) == 0) {
+            _pumpWake.wait(lock);
+            nextPump = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        lock.unlock();
+        PollDevices();
+
+        nextPump += REPORT_PUMP_INTERVAL;
+        const auto now = std::chrono::steady_clock::now();
+        if (nextPump < now)
+            nextPump = now;  // Fell behind, don't try to catch up with a burst of pumps
+
+        std::this_thread::sleep_until(nextPump);
+        lock.lock();
+    }
+}
+
+void HidDeviceHook::PollDevices() {
+    uint32_t polledMask = 0;
+    for (ReportStream& stream : _streams) {
+        const HANDLE handle = stream.Handle.load(std::memory_order_acquire);
+        const int deviceIndex = stream.DeviceIndex.load(std::memory_order_relaxed);
+        if (!handle || deviceIndex < 0 || polledMask & 1u << deviceIndex)
+            continue;
+        polledMask |= 1u << deviceIndex;
+
+        // Not recorded, these are not the game's reads and a pump that outpaces the memo would flood the recorder
+        ControllerState state;
+        ControllerManager::PollState(deviceIndex, &state);
+    }
+}
+
+void HidDeviceHook::OnStateChanged(const int slotIndex, const ControllerState& state, const uint32_t packetNumber) {
+    // Games that never open the device pay one load per change
+    if (_openStreams.load(std::memory_order_relaxed) == 0)
+        return;
+
+    uint8_t report[HidReportEncoder::REPORT_LENGTH];
+    bool encoded = false;
+    for (ReportStream& stream : _streams) {
+        const HANDLE handle = stream.Handle.load(std::memory_order_acquire);
+        if (!handle || stream.DeviceIndex.load(std::memory_order_relaxed) != slotIndex)
+            continue;
+
+        if (!encoded) {
+            HidReportEncoder::Encode(state, report);
+            encoded = true;
+        }
+        PushReport(stream, handle, report, packetNumber);
+    }
+}
+
+void HidDeviceHook::PushReport(ReportStream& stream, const HANDLE handle, const uint8_t* report,
+                               const uint32_t packetNumber) {
+    // The queue ignores the report if the handle was closed in the meantime, its session is over
+    StreamQueue::PendingRead completed;
+    if (stream.Queue.Push(GetSession(handle), packetNumber, report, &completed))
+        CompleteRead(static_cast<OVERLAPPED*>(completed.Context), HidReportEncoder::REPORT_LENGTH, READ_SUCCESS);
+}
+
+void HidDeviceHook::CompleteRead(OVERLAPPED* overlapped, const DWORD bytesRead, const ULONG_PTR status) {
+    // The caller may free the OVERLAPPED as soon as it sees the status, so nothing is read from it after that
+    const HANDLE event = GetCompletionEvent(overlapped);
+    ULONG_PTR* internal = &overlapped->Internal;
+
+    overlapped->InternalHigh = bytesRead;
+    std::atomic_ref(*internal).store(status, std::memory_order_release);
+
+    WakeByAddressAll(internal);
+    if (event)
+        SetEvent(event);
+}
+
+void HidDeviceHook::CancelReads(const StreamQueue::PendingRead* reads, const size_t count) {
+    for (size_t i = 0; i < count; i++)
+        CompleteRead(static_cast<OVERLAPPED*>(reads[i].Context), 0, READ_CANCELLED);
+}
+
 HANDLE WINAPI HidDeviceHook::HookedCreateFileW(LPCWSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode,
                                                LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition,
                                                DWORD dwFlagsAndAttributes, HANDLE hTemplateFile) {
+    HOOK_STATS_SCOPE(HookId::CreateFile);
     if (!Enabled) {
         return OriginalCreateFileW(lpFileName, dwDesiredAccess, dwShareMode, lpSecurityAttributes,
                                    dwCreationDisposition, dwFlagsAndAttributes, hTemplateFile);
     }
 
-    // Check if this is one of our emulated device paths
-    if (EmulatedDeviceDefinitions::IsEmulatedDevicePath(lpFileName)) {
-        int controllerIndex = EmulatedDeviceDefinitions::GetControllerIndex(lpFileName);
+    // Check if this is one of our emulated device paths, other paths are turned away within their first few characters
+    const int controllerIndex = EmulatedDeviceDefinitions::GetControllerIndex(lpFileName);
+    if (controllerIndex != 0 && ControllerManager::IsSlotConnected(controllerIndex - 1)) {
         _logger.InfoFormat("CreateFileW called for emulated device (controller {})", controllerIndex);
-        return EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE;
+        return OpenEmulatedFile(controllerIndex - 1, dwFlagsAndAttributes);
     }
 
     return OriginalCreateFileW(lpFileName, dwDesiredAccess, dwShareMode, lpSecurityAttributes, dwCreationDisposition,
@@ -73,23 +282,18 @@ HANDLE WINAPI HidDeviceHook::HookedCreateFileW(LPCWSTR lpFileName, DWORD dwDesir
 HANDLE WINAPI HidDeviceHook::HookedCreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode,
                                                LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition,
                                                DWORD dwFlagsAndAttributes, HANDLE hTemplateFile) {
+    HOOK_STATS_SCOPE(HookId::CreateFile);
     if (!Enabled) {
         return OriginalCreateFileA(lpFileName, dwDesiredAccess, dwShareMode, lpSecurityAttributes,
                                    dwCreationDisposition, dwFlagsAndAttributes, hTemplateFile);
     }
 
-    // Convert ANSI path to wide string for comparison
-    wchar_t wideFileName[MAX_PATH];
-    if (MultiByteToWideChar(CP_ACP, 0, lpFileName, -1, wideFileName, MAX_PATH) == 0) {
-        return OriginalCreateFileA(lpFileName, dwDesiredAccess, dwShareMode, lpSecurityAttributes,
-                                   dwCreationDisposition, dwFlagsAndAttributes, hTemplateFile);
-    }
-
-    // Check if this is one of our emulated device paths
-    if (EmulatedDeviceDefinitions::IsEmulatedDevicePath(wideFileName)) {
-        int controllerIndex = EmulatedDeviceDefinitions::GetControllerIndex(wideFileName);
+    // Device paths are plain ASCII, which reads the same in every ANSI code page, so the path is matched without
+    // converting it
+    const int controllerIndex = EmulatedDeviceDefinitions::GetControllerIndex(lpFileName);
+    if (controllerIndex != 0 && ControllerManager::IsSlotConnected(controllerIndex - 1)) {
         _logger.InfoFormat("CreateFileA called for emulated device (controller {})", controllerIndex);
-        return EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE;
+        return OpenEmulatedFile(controllerIndex - 1, dwFlagsAndAttributes);
     }
 
     return OriginalCreateFileA(lpFileName, dwDesiredAccess, dwShareMode, lpSecurityAttributes, dwCreationDisposition,
@@ -97,23 +301,183 @@ HANDLE WINAPI HidDeviceHook::HookedCreateFileA(LPCSTR lpFileName, DWORD dwDesire
 }
 
 BOOL WINAPI HidDeviceHook::HookedCloseHandle(HANDLE hObject) {
-    if (!Enabled || hObject != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::CloseHandle);
+    // No kernel handle falls in the table's range, so every other handle is passed on after one range check. Handles
+    // of the table are closed even while disabled, they may have been opened before
+    if (!VirtualHandleTable<EmulatedFile>::IsInRange(hObject)) {
         return OriginalCloseHandle(hObject);
     }
 
-    _logger.Info("CloseHandle called for emulated device");
+    _logger.Debug("CloseHandle called for emulated device");
+
+    // The stream closes first, while the handle still owns its entry and no new handle can be given the same stream
+    if (const int streamIndex = _files.GetIndex(hObject); streamIndex >= 0)
+        CloseStream(streamIndex, hObject);
+
+    if (!_files.Close(hObject)) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL WINAPI HidDeviceHook::HookedReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead,
+                                          LPDWORD lpNumberOfBytesRead, LPOVERLAPPED lpOverlapped) {
+    HOOK_STATS_SCOPE(HookId::ReadFile);
+    // Read even while disabled, the handle may have been opened before
+    if (!VirtualHandleTable<EmulatedFile>::IsInRange(hFile)) {
+        return OriginalReadFile(hFile, lpBuffer, nNumberOfBytesToRead, lpNumberOfBytesRead, lpOverlapped);
+    }
+
+    EmulatedFile file;
+    const int streamIndex = _files.GetIndex(hFile);
+    if (streamIndex < 0 || !_files.TryGet(hFile, &file)) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    if (lpNumberOfBytesRead)
+        *lpNumberOfBytesRead = 0;
+
+    // Like the HID class driver, every read returns one whole report
+    if (!lpBuffer || nNumberOfBytesToRead < HidReportEncoder::REPORT_LENGTH) {
+        SetLastError(ERROR_INVALID_USER_BUFFER);
+        return FALSE;
+    }
+
+    StreamQueue& queue = _streams[streamIndex].Queue;
+    auto* buffer = static_cast<uint8_t*>(lpBuffer);
+
+    // A handle opened without FILE_FLAG_OVERLAPPED reads synchronously even when given an OVERLAPPED
+    if (!file.Overlapped) {
+        if (queue.WaitRead(GetSession(hFile), buffer) == StreamQueue::ReadResult::Closed) {
+            SetLastError(ERROR_OPERATION_ABORTED);
+            return FALSE;
+        }
+
+        if (lpNumberOfBytesRead)
+            *lpNumberOfBytesRead = HidReportEncoder::REPORT_LENGTH;
+        if (lpOverlapped)
+            CompleteRead(lpOverlapped, HidReportEncoder::REPORT_LENGTH, READ_SUCCESS);
+        return TRUE;
+    }
+
+    if (!lpOverlapped) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    // Marked pending before the read is queued, a push may complete it as soon as it is
+    lpOverlapped->InternalHigh = 0;
+    std::atomic_ref(lpOverlapped->Internal).store(READ_PENDING, std::memory_order_relaxed);
+    if (const HANDLE event = GetCompletionEvent(lpOverlapped))
+        ResetEvent(event);
+
+    switch (queue.Read(GetSession(hFile), buffer, lpOverlapped)) {
+    case StreamQueue::ReadResult::Completed:
+        CompleteRead(lpOverlapped, HidReportEncoder::REPORT_LENGTH, READ_SUCCESS);
+        if (lpNumberOfBytesRead)
+            *lpNumberOfBytesRead = HidReportEncoder::REPORT_LENGTH;
+        return TRUE;
+    case StreamQueue::ReadResult::Pending:
+        SetLastError(ERROR_IO_PENDING);
+        return FALSE;
+    case StreamQueue::ReadResult::TooManyPending:
+        _logger.Warning("Too many overlapped reads pending on emulated device");
+        SetLastError(ERROR_NOT_ENOUGH_QUOTA);
+        return FALSE;
+    default:
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+}
+
+BOOL WINAPI HidDeviceHook::HookedGetOverlappedResult(HANDLE hFile, LPOVERLAPPED lpOverlapped,
+                                                     LPDWORD lpNumberOfBytesTransferred, BOOL bWait) {
+    HOOK_STATS_SCOPE(HookId::GetOverlappedResult);
+    // Reads of a closed handle were completed as cancelled when it closed, so they are still answered here
+    if (!VirtualHandleTable<EmulatedFile>::IsInRange(hFile)) {
+        return OriginalGetOverlappedResult(hFile, lpOverlapped, lpNumberOfBytesTransferred, bWait);
+    }
+
+    std::atomic_ref internal(lpOverlapped->Internal);
+    ULONG_PTR status = internal.load(std::memory_order_acquire);
+    if (status == READ_PENDING) {
+        if (!bWait) {
+            SetLastError(ERROR_IO_INCOMPLETE);
+            return FALSE;
+        }
+
+        // Blocks until a push or a cancel completes the read, a read without an event is waited on by address
+        const HANDLE event = GetCompletionEvent(lpOverlapped);
+        while ((status = internal.load(std::memory_order_acquire)) == READ_PENDING) {
+            if (event)
+                WaitForSingleObject(event, INFINITE);
+            else
+                WaitOnAddress(&lpOverlapped->Internal, &status, sizeof(status), INFINITE);
+        }
+    }
+
+    *lpNumberOfBytesTransferred = static_cast<DWORD>(lpOverlapped->InternalHigh);
+    if (status != READ_SUCCESS) {
+        SetLastError(ERROR_OPERATION_ABORTED);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL WINAPI HidDeviceHook::HookedCancelIo(HANDLE hFile) {
+    HOOK_STATS_SCOPE(HookId::CancelIo);
+    if (!VirtualHandleTable<EmulatedFile>::IsInRange(hFile)) {
+        return OriginalCancelIo(hFile);
+    }
+
+    const int streamIndex = _files.GetIndex(hFile);
+    if (streamIndex < 0) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    // Reads are not tracked per thread, so this cancels the handle's reads from every thread, like CancelIoEx
+    StreamQueue::PendingRead cancelled[StreamQueue::MAX_PENDING_READS];
+    CancelReads(cancelled, _streams[streamIndex].Queue.Cancel(GetSession(hFile), nullptr, cancelled));
+    return TRUE;
+}
+
+BOOL WINAPI HidDeviceHook::HookedCancelIoEx(HANDLE hFile, LPOVERLAPPED lpOverlapped) {
+    HOOK_STATS_SCOPE(HookId::CancelIo);
+    if (!VirtualHandleTable<EmulatedFile>::IsInRange(hFile)) {
+        return OriginalCancelIoEx(hFile, lpOverlapped);
+    }
+
+    const int streamIndex = _files.GetIndex(hFile);
+    if (streamIndex < 0) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    StreamQueue::PendingRead cancelled[StreamQueue::MAX_PENDING_READS];
+    const size_t count = _streams[streamIndex].Queue.Cancel(GetSession(hFile), lpOverlapped, cancelled);
+    CancelReads(cancelled, count);
+
+    if (count == 0) {
+        SetLastError(ERROR_NOT_FOUND);
+        return FALSE;
+    }
 
-    // Always return success for our emulated handle
     return TRUE;
 }
 
 BOOLEAN WINAPI HidDeviceHook::HookedHidDGetManufacturerString(HANDLE hidDeviceObject, PVOID buffer,
                                                               ULONG bufferLength) {
-    if (!Enabled || hidDeviceObject != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::HidDGetString);
+    if (!Enabled || GetDeviceIndex(hidDeviceObject) < 0) {
         return OriginalHidDGetManufacturerString(hidDeviceObject, buffer, bufferLength);
     }
 
-    _logger.Info("HidD_GetManufacturerString called for emulated device");
+    _logger.Debug("HidD_GetManufacturerString called for emulated device");
 
     if (bufferLength < sizeof(wchar_t) * (wcslen(EmulatedDeviceDefinitions::MANUFACTURER_STRING) + 1)) {
         return FALSE;
@@ -125,11 +489,12 @@ BOOLEAN WINAPI HidDeviceHook::HookedHidDGetManufacturerString(HANDLE hidDeviceOb
 }
 
 BOOLEAN WINAPI HidDeviceHook::HookedHidDGetProductString(HANDLE hidDeviceObject, PVOID buffer, ULONG bufferLength) {
-    if (!Enabled || hidDeviceObject != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::HidDGetString);
+    if (!Enabled || GetDeviceIndex(hidDeviceObject) < 0) {
         return OriginalHidDGetProductString(hidDeviceObject, buffer, bufferLength);
     }
 
-    _logger.Info("HidD_GetProductString called for emulated device");
+    _logger.Debug("HidD_GetProductString called for emulated device");
 
     if (bufferLength < sizeof(wchar_t) * (wcslen(EmulatedDeviceDefinitions::PRODUCT_STRING) + 1)) {
         return FALSE;
@@ -141,15 +506,18 @@ BOOLEAN WINAPI HidDeviceHook::HookedHidDGetProductString(HANDLE hidDeviceObject,
 
 BOOLEAN WINAPI HidDeviceHook::HookedHidDGetSerialNumberString(HANDLE hidDeviceObject, PVOID buffer,
                                                               ULONG bufferLength) {
-    if (!Enabled || hidDeviceObject != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::HidDGetString);
+    const int deviceIndex = GetDeviceIndex(hidDeviceObject);
+    if (!Enabled || deviceIndex < 0) {
         return OriginalHidDGetSerialNumberString(hidDeviceObject, buffer, bufferLength);
     }
 
-    _logger.Info("HidD_GetSerialNumberString called for emulated device");
+    _logger.Debug("HidD_GetSerialNumberString called for emulated device");
 
-    // Return a simple serial number
+    // Return a simple serial number, the device's controller number
     if (bufferLength >= 2 * sizeof(wchar_t)) {
-        wcscpy_s(static_cast<wchar_t*>(buffer), bufferLength / sizeof(wchar_t), L"1");
+        const wchar_t serial[] = {static_cast<wchar_t>(L'1' + deviceIndex), L'\0'};
+        wcscpy_s(static_cast<wchar_t*>(buffer), bufferLength / sizeof(wchar_t), serial);
         return TRUE;
     }
 
@@ -157,30 +525,46 @@ BOOLEAN WINAPI HidDeviceHook::HookedHidDGetSerialNumberString(HANDLE hidDeviceOb
 }
 
 BOOLEAN WINAPI HidDeviceHook::HookedHidDGetPreparsedData(HANDLE hidDeviceObject, PHIDP_PREPARSED_DATA* preparsedData) {
-    if (!Enabled || hidDeviceObject != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::HidDGetPreparsedData);
+    if (!Enabled || GetDeviceIndex(hidDeviceObject) < 0) {
         return OriginalHidDGetPreparsedData(hidDeviceObject, preparsedData);
     }
 
-    _logger.Info("HidD_GetPreparsedData called for emulated device");
+    _logger.Debug("HidD_GetPreparsedData called for emulated device");
+
+    if (!preparsedData) {
+        return FALSE;
+    }
+
+    // Every caller gets the same read-only image, HidD_FreePreparsedData gives the reference back
+    *preparsedData = static_cast<PHIDP_PREPARSED_DATA>(const_cast<void*>(_preparsedData.Acquire()));
+    return TRUE;
+}
+
+BOOLEAN WINAPI HidDeviceHook::HookedHidDFreePreparsedData(PHIDP_PREPARSED_DATA preparsedData) {
+    HOOK_STATS_SCOPE(HookId::HidDFreePreparsedData);
+    // Checked even while disabled, the image may have been handed out before
+    if (!_preparsedData.Owns(preparsedData)) {
+        return OriginalHidDFreePreparsedData(preparsedData);
+    }
+
+    _logger.Debug("HidD_FreePreparsedData called for emulated device");
 
-    // Allocate memory for the preparsed data
-    *preparsedData = static_cast<PHIDP_PREPARSED_DATA>(malloc(EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE));
-    if (!*preparsedData) {
+    if (!_preparsedData.Release(preparsedData)) {
+        _logger.Warning("HidD_FreePreparsedData called more often than HidD_GetPreparsedData for emulated device");
         return FALSE;
     }
 
-    // Copy our preprocessed data
-    memcpy(*preparsedData, EmulatedDeviceDefinitions::PREPROCESSED_DATA,
-           EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE);
     return TRUE;
 }
 
 BOOLEAN WINAPI HidDeviceHook::HookedHidDGetAttributes(HANDLE hidDeviceObject, PHIDD_ATTRIBUTES attributes) {
-    if (!Enabled || hidDeviceObject != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::HidDGetAttributes);
+    if (!Enabled || GetDeviceIndex(hidDeviceObject) < 0) {
         return OriginalHidDGetAttributes(hidDeviceObject, attributes);
     }
 
-    _logger.Info("HidD_GetAttributes called for emulated device");
+    _logger.Debug("HidD_GetAttributes called for emulated device");
 
     if (!attributes) {
         return FALSE;
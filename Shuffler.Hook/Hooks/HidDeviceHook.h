@@ -1,13 +1,69 @@
 #pragma once
 
+#include "../HidReportEncoder.h"
 #include "../Logger.h"
+#include "../ReportQueue.h"
+#include "../SharedBlock.h"
+#include "../VirtualHandleTable.h"
 #include "HookHelper.h"
 #include <Windows.h>
+#include <condition_variable>
 #include <hidsdi.h>
+#include <mutex>
+#include <thread>
 
 class HidDeviceHook {
+    // State of one file handle opened on an emulated device
+    struct EmulatedFile {
+        int DeviceIndex;
+        bool Overlapped;  // Opened with FILE_FLAG_OVERLAPPED
+    };
+
+    // Auto-reset event that blocking readers of a report stream wait on
+    class EventSignal {
+        HANDLE _event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
+      public:
+        ~EventSignal() {
+            CloseHandle(_event);
+        }
+
+        void Notify() {
+            SetEvent(_event);
+        }
+
+        void Wait() {
+            WaitForSingleObject(_event, INFINITE);
+        }
+    };
+
+    // Same as the HID class driver's default number of input buffers
+    static constexpr size_t STREAM_REPORT_CAPACITY = 32;
+    static constexpr size_t FILE_CAPACITY = VirtualHandleTable<EmulatedFile>::CAPACITY;
+
+    using StreamQueue = ReportQueue<HidReportEncoder::REPORT_LENGTH, STREAM_REPORT_CAPACITY, EventSignal>;
+
+    // Input reports of an open file handle, waiting for ReadFile. The session is the handle itself and every report's
+    // sequence is the packet number of its state
+    struct ReportStream {
+        StreamQueue Queue;
+        std::atomic<HANDLE> Handle{nullptr};  // Null while no handle is open on this stream
+        std::atomic<int> DeviceIndex{-1};
+    };
+
     static Logger _logger;
     static HookHelper _hookHelper;
+    static VirtualHandleTable<EmulatedFile> _files;
+    static SharedBlock _preparsedData;
+    static ReportStream _streams[FILE_CAPACITY];  // By the handle's index in _files
+
+    // Pump thread that polls the devices of open streams for games that only read them with ReadFile, running while any
+    // stream is open. _openStreams only changes under _pumpMutex but is read without it
+    static std::mutex _pumpMutex;
+    static std::condition_variable _pumpWake;
+    static std::thread _pumpThread;
+    static std::atomic<size_t> _openStreams;
+    static bool _pumpStopRequested;
 
   public:
     static bool Enabled;
@@ -15,6 +71,28 @@ class HidDeviceHook {
     static bool Uninstall();
 
   private:
+    // Opens a file handle on the emulated device of slotIndex, for the CreateFile hooks
+    static HANDLE OpenEmulatedFile(int slotIndex, DWORD flagsAndAttributes);
+
+    // Device index of an open emulated file handle, -1 for any other handle
+    static int GetDeviceIndex(HANDLE handle);
+
+    static void OpenStream(HANDLE handle);
+    static void CloseStream(int streamIndex, HANDLE handle);
+    static void StopPump();
+    static void PumpThread();
+
+    // Polls every device with an open stream, their changes reach the streams through OnStateChanged
+    static void PollDevices();
+
+    // ControllerManager's state listener, queues the new state's report on every open stream of the slot's device
+    static void OnStateChanged(int slotIndex, const ControllerState& state, uint32_t packetNumber);
+    static void PushReport(ReportStream& stream, HANDLE handle, const uint8_t* report, uint32_t packetNumber);
+
+    // Finishes an overlapped read the way the I/O manager does: status and byte count, then the wakeups
+    static void CompleteRead(OVERLAPPED* overlapped, DWORD bytesRead, ULONG_PTR status);
+    static void CancelReads(const StreamQueue::PendingRead* reads, size_t count);
+
     static HANDLE WINAPI HookedCreateFileW(LPCWSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode,
                                            LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition,
                                            DWORD dwFlagsAndAttributes, HANDLE hTemplateFile);
@@ -25,6 +103,16 @@ class HidDeviceHook {
 
     static BOOL WINAPI HookedCloseHandle(HANDLE hObject);
 
+    static BOOL WINAPI HookedReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead,
+                                      LPDWORD lpNumberOfBytesRead, LPOVERLAPPED lpOverlapped);
+
+    static BOOL WINAPI HookedGetOverlappedResult(HANDLE hFile, LPOVERLAPPED lpOverlapped,
+                                                 LPDWORD lpNumberOfBytesTransferred, BOOL bWait);
+
+    static BOOL WINAPI HookedCancelIo(HANDLE hFile);
+
+    static BOOL WINAPI HookedCancelIoEx(HANDLE hFile, LPOVERLAPPED lpOverlapped);
+
     static BOOLEAN WINAPI HookedHidDGetManufacturerString(HANDLE hidDeviceObject, PVOID buffer, ULONG bufferLength);
 
     static BOOLEAN WINAPI HookedHidDGetProductString(HANDLE hidDeviceObject, PVOID buffer, ULONG bufferLength);
@@ -33,5 +121,7 @@ class HidDeviceHook {
 
     static BOOLEAN WINAPI HookedHidDGetPreparsedData(HANDLE hidDeviceObject, PHIDP_PREPARSED_DATA* preparsedData);
 
+    static BOOLEAN WINAPI HookedHidDFreePreparsedData(PHIDP_PREPARSED_DATA preparsedData);
+
     static BOOLEAN WINAPI HookedHidDGetAttributes(HANDLE hidDeviceObject, PHIDD_ATTRIBUTES attributes);
 };
\ No newline at end of file
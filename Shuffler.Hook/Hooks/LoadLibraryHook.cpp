@@ -1,4 +1,5 @@
 #include "LoadLibraryHook.h"
+#include "../HookStats.h"
 #include "../Utils.h"
 #include "XInputHook.h"
 
@@ -40,6 +41,7 @@ bool LoadLibraryHook::Uninstall() {
 }
 
 HMODULE WINAPI LoadLibraryHook::HookedLoadLibraryA(LPCSTR lpLibFileName) {
+    HOOK_STATS_SCOPE(HookId::LoadLibrary);
     if (!Enabled) {
         return OriginalLoadLibraryA(lpLibFileName);
     }
@@ -58,6 +60,7 @@ HMODULE WINAPI LoadLibraryHook::HookedLoadLibraryA(LPCSTR lpLibFileName) {
 }
 
 HMODULE WINAPI LoadLibraryHook::HookedLoadLibraryW(LPCWSTR lpLibFileName) {
+    HOOK_STATS_SCOPE(HookId::LoadLibrary);
     if (!Enabled) {
         return OriginalLoadLibraryW(lpLibFileName);
     }
@@ -76,6 +79,7 @@ HMODULE WINAPI LoadLibraryHook::HookedLoadLibraryW(LPCWSTR lpLibFileName) {
 }
 
 HMODULE WINAPI LoadLibraryHook::HookedLoadLibraryExA(LPCSTR lpLibFileName, HANDLE hFile, DWORD dwFlags) {
+    HOOK_STATS_SCOPE(HookId::LoadLibrary);
     if (!Enabled) {
         return OriginalLoadLibraryExA(lpLibFileName, hFile, dwFlags);
     }
@@ -94,6 +98,7 @@ HMODULE WINAPI LoadLibraryHook::HookedLoadLibraryExA(LPCSTR lpLibFileName, HANDL
 }
 
 HMODULE WINAPI LoadLibraryHook::HookedLoadLibraryExW(LPCWSTR lpLibFileName, HANDLE hFile, DWORD dwFlags) {
+    HOOK_STATS_SCOPE(HookId::LoadLibrary);
     if (!Enabled) {
         return OriginalLoadLibraryExW(lpLibFileName, hFile, dwFlags);
     }
@@ -1,34 +1,43 @@
 #include "RawInputHook.h"
 #include "../ControllerManager.h"
 #include "../EmulatedDeviceDefinitions.h"
+#include "../HidReportEncoder.h"
+#include "../HookStats.h"
 #include "../Logger.h"
 #include "HidDeviceHook.h"
 #include <Xinput.h>
 #include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <format>
 
 Logger RawInputHook::_logger = Logger("RawInputHook");
 HookHelper RawInputHook::_hookHelper;
+ReportChangeFilter<VirtualSlotTable::MAX_SLOTS> RawInputHook::_bufferedReports;
 bool RawInputHook::Enabled = false;
 
 namespace {
 decltype(&RegisterRawInputDevices) OriginalRegisterRawInputDevices = nullptr;
 decltype(&GetRawInputData) OriginalGetRawInputData = nullptr;
+decltype(&GetRawInputBuffer) OriginalGetRawInputBuffer = nullptr;
 decltype(&GetRawInputDeviceList) OriginalGetRawInputDeviceList = nullptr;
 decltype(&GetRawInputDeviceInfoA) OriginalGetRawInputDeviceInfoA = nullptr;
 decltype(&GetRawInputDeviceInfoW) OriginalGetRawInputDeviceInfoW = nullptr;
 decltype(&GetRegisteredRawInputDevices) OriginalGetRegisteredRawInputDevices = nullptr;
 
-PHIDP_PREPARSED_DATA GetPreparsedData() {
-    return reinterpret_cast<PHIDP_PREPARSED_DATA>(const_cast<BYTE*>(EmulatedDeviceDefinitions::PREPROCESSED_DATA));
-}
-
-NTSTATUS SetHidValue(USAGE usage, ULONG value, PCHAR rawData, DWORD rawDataSize) {
-    return HidP_SetUsageValue(HidP_Input, 0x01, 0, usage, value, GetPreparsedData(), rawData, rawDataSize);
-}
-
-ULONG RemapAxis(LONG value, bool invert = false) {
-    return static_cast<ULONG>(std::clamp((invert ? -value : value) + (MAXWORD / 2), 0L, static_cast<LONG>(MAXWORD)));
+// Records in a GetRawInputBuffer batch start where NEXTRAWINPUTBLOCK looks for them, at pointer-size alignment
+constexpr size_t RAW_INPUT_ALIGNMENT = sizeof(ULONG_PTR);
+constexpr UINT HID_RECORD_SIZE =
+    static_cast<UINT>(sizeof(RAWINPUTHEADER) + offsetof(RAWHID, bRawData) + HidReportEncoder::REPORT_LENGTH);
+
+void WriteHidRecord(RAWINPUT* record, const int slotIndex, const ControllerState& state) {
+    record->header.dwType = RIM_TYPEHID;
+    record->header.dwSize = HID_RECORD_SIZE;
+    record->header.hDevice = EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLES[slotIndex];
+    record->header.wParam = RIM_INPUT;
+    record->data.hid.dwSizeHid = HidReportEncoder::REPORT_LENGTH;
+    record->data.hid.dwCount = 1;
+    HidReportEncoder::Encode(state, record->data.hid.bRawData);
 }
 }  // namespace
 
@@ -39,6 +48,8 @@ bool RawInputHook::Install() {
     success &= _hookHelper.Hook("user32.dll", "RegisterRawInputDevices", &OriginalRegisterRawInputDevices,
                                 HookedRegisterRawInputDevices);
     success &= _hookHelper.Hook("user32.dll", "GetRawInputData", &OriginalGetRawInputData, HookedGetRawInputData);
+    success &=
+        _hookHelper.Hook("user32.dll", "GetRawInputBuffer", &OriginalGetRawInputBuffer, HookedGetRawInputBuffer);
     success &= _hookHelper.Hook("user32.dll", "GetRawInputDeviceList", &OriginalGetRawInputDeviceList,
                                 HookedGetRawInputDeviceList);
     success &= _hookHelper.Hook("user32.dll", "GetRawInputDeviceInfoA", &OriginalGetRawInputDeviceInfoA,
@@ -63,6 +74,7 @@ bool RawInputHook::Uninstall() {
 
 BOOL WINAPI RawInputHook::HookedRegisterRawInputDevices(PCRAWINPUTDEVICE pRawInputDevices, UINT uiNumDevices,
                                                         UINT cbSize) {
+    HOOK_STATS_SCOPE(HookId::RegisterRawInputDevices);
     if (!Enabled) {
         return OriginalRegisterRawInputDevices(pRawInputDevices, uiNumDevices, cbSize);
     }
@@ -82,29 +94,39 @@ BOOL WINAPI RawInputHook::HookedRegisterRawInputDevices(PCRAWINPUTDEVICE pRawInp
 
 UINT WINAPI RawInputHook::HookedGetRawInputDeviceList(PRAWINPUTDEVICELIST pRawInputDeviceList, PUINT puiNumDevices,
                                                       UINT cbSize) {
+    HOOK_STATS_SCOPE(HookId::GetRawInputDeviceList);
     if (!Enabled) {
         return OriginalGetRawInputDeviceList(pRawInputDeviceList, puiNumDevices, cbSize);
     }
 
-    _logger.InfoFormat("GetRawInputDeviceList called - size: {}, devices: {}", cbSize,
-                       puiNumDevices ? *puiNumDevices : 0);
+    _logger.DebugFormat("GetRawInputDeviceList called - size: {}, devices: {}", cbSize,
+                        puiNumDevices ? *puiNumDevices : 0);
 
-    // Always report one device
+    // Report one device per connected slot
+    const uint32_t connectedSlots = ControllerManager::GetConnectedSlotMask();
+    const UINT deviceCount = static_cast<UINT>(std::popcount(connectedSlots));
     if (!pRawInputDeviceList) {
-        *puiNumDevices = 1;
-        _logger.Info("Reporting 1 device");
+        *puiNumDevices = deviceCount;
+        _logger.DebugFormat("Reporting {} devices", deviceCount);
         return 0;
     }
 
-    if (*puiNumDevices < 1) {
-        *puiNumDevices = 1;
+    if (*puiNumDevices < deviceCount) {
+        *puiNumDevices = deviceCount;
         return ERROR_INSUFFICIENT_BUFFER;
     }
 
-    _logger.Info("Returning emulated device");
-    pRawInputDeviceList[0].hDevice = EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE;
-    pRawInputDeviceList[0].dwType = RIM_TYPEHID;
-    return 1;
+    _logger.Debug("Returning emulated devices");
+    UINT count = 0;
+    for (int slot = 0; slot < EmulatedDeviceDefinitions::DEVICE_COUNT; slot++) {
+        if (!(connectedSlots & (1u << slot)))
+            continue;
+
+        pRawInputDeviceList[count].hDevice = EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLES[slot];
+        pRawInputDeviceList[count].dwType = RIM_TYPEHID;
+        count++;
+    }
+    return count;
 }
 
 UINT RawInputHook::HandleGetRawInputDeviceInfo(UINT uiCommand, LPVOID pData, PUINT pcbSize) {
@@ -120,7 +142,8 @@ UINT RawInputHook::HandleGetRawInputDeviceInfo(UINT uiCommand, LPVOID pData, PUI
             return -1;
         }
 
-        memcpy(pData, EmulatedDeviceDefinitions::PREPROCESSED_DATA, EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE);
+        memcpy(pData, EmulatedDeviceDefinitions::PREPROCESSED_DATA.data(),
+               EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE);
         return EmulatedDeviceDefinitions::PREPROCESSED_DATA_SIZE;
     }
 
@@ -144,7 +167,7 @@ UINT RawInputHook::HandleGetRawInputDeviceInfo(UINT uiCommand, LPVOID pData, PUI
         info->hid.usUsagePage = EmulatedDeviceDefinitions::USAGE_PAGE;
         info->hid.usUsage = EmulatedDeviceDefinitions::USAGE;
 
-        _logger.InfoFormat(
+        _logger.DebugFormat(
             "Emulated device info - VID: 0x{0:X}, PID: 0x{1:X}, Ver: 0x{2:X}, Page: 0x{3:X}, Usage: 0x{4:X}",
             info->hid.dwVendorId, info->hid.dwProductId, info->hid.dwVersionNumber, info->hid.usUsagePage,
             info->hid.usUsage);
@@ -158,13 +181,15 @@ UINT RawInputHook::HandleGetRawInputDeviceInfo(UINT uiCommand, LPVOID pData, PUI
 }
 
 UINT WINAPI RawInputHook::HookedGetRawInputDeviceInfoA(HANDLE hDevice, UINT uiCommand, LPVOID pData, PUINT pcbSize) {
-    if (!Enabled || hDevice != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::GetRawInputDeviceInfo);
+    const int slot = EmulatedDeviceDefinitions::GetDeviceSlot(hDevice);
+    if (!Enabled || slot < 0) {
         return OriginalGetRawInputDeviceInfoA(hDevice, uiCommand, pData, pcbSize);
     }
 
     if (uiCommand == RIDI_DEVICENAME) {
-        const int requiredSize = WideCharToMultiByte(CP_ACP, 0, EmulatedDeviceDefinitions::DEVICE_PATH_CONTROLLER_1, -1,
-                                                     nullptr, 0, nullptr, nullptr);
+        const wchar_t* devicePath = EmulatedDeviceDefinitions::GetDevicePath(slot);
+        const int requiredSize = WideCharToMultiByte(CP_ACP, 0, devicePath, -1, nullptr, 0, nullptr, nullptr);
         if (!pcbSize || requiredSize == 0)
             return ERROR_INVALID_PARAMETER;
 
@@ -176,8 +201,7 @@ UINT WINAPI RawInputHook::HookedGetRawInputDeviceInfoA(HANDLE hDevice, UINT uiCo
         if (*pcbSize < static_cast<UINT>(requiredSize))
             return ERROR_INSUFFICIENT_BUFFER;
 
-        if (!WideCharToMultiByte(CP_ACP, 0, EmulatedDeviceDefinitions::DEVICE_PATH_CONTROLLER_1, -1,
-                                 static_cast<char*>(pData), *pcbSize, nullptr, nullptr)) {
+        if (!WideCharToMultiByte(CP_ACP, 0, devicePath, -1, static_cast<char*>(pData), *pcbSize, nullptr, nullptr)) {
             return ERROR_INVALID_PARAMETER;
         }
 
@@ -188,12 +212,15 @@ UINT WINAPI RawInputHook::HookedGetRawInputDeviceInfoA(HANDLE hDevice, UINT uiCo
 }
 
 UINT WINAPI RawInputHook::HookedGetRawInputDeviceInfoW(HANDLE hDevice, UINT uiCommand, LPVOID pData, PUINT pcbSize) {
-    if (!Enabled || hDevice != EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE) {
+    HOOK_STATS_SCOPE(HookId::GetRawInputDeviceInfo);
+    const int slot = EmulatedDeviceDefinitions::GetDeviceSlot(hDevice);
+    if (!Enabled || slot < 0) {
         return OriginalGetRawInputDeviceInfoW(hDevice, uiCommand, pData, pcbSize);
     }
 
     if (uiCommand == RIDI_DEVICENAME) {
-        const size_t nameSize = (wcslen(EmulatedDeviceDefinitions::DEVICE_PATH_CONTROLLER_1) + 1) * sizeof(wchar_t);
+        const wchar_t* devicePath = EmulatedDeviceDefinitions::GetDevicePath(slot);
+        const size_t nameSize = (wcslen(devicePath) + 1) * sizeof(wchar_t);
         if (!pcbSize)
             return ERROR_INVALID_PARAMETER;
 
@@ -205,8 +232,7 @@ UINT WINAPI RawInputHook::HookedGetRawInputDeviceInfoW(HANDLE hDevice, UINT uiCo
         if (*pcbSize < nameSize)
             return ERROR_INSUFFICIENT_BUFFER;
 
-        wcscpy_s(static_cast<wchar_t*>(pData), *pcbSize / sizeof(wchar_t),
-                 EmulatedDeviceDefinitions::DEVICE_PATH_CONTROLLER_1);
+        wcscpy_s(static_cast<wchar_t*>(pData), *pcbSize / sizeof(wchar_t), devicePath);
         return static_cast<UINT>(nameSize);
     }
 
@@ -215,6 +241,7 @@ UINT WINAPI RawInputHook::HookedGetRawInputDeviceInfoW(HANDLE hDevice, UINT uiCo
 
 UINT WINAPI RawInputHook::HookedGetRegisteredRawInputDevices(PRAWINPUTDEVICE pRawInputDevices, PUINT puiNumDevices,
                                                              UINT cbSize) {
+    HOOK_STATS_SCOPE(HookId::GetRegisteredRawInputDevices);
     if (!Enabled) {
         return OriginalGetRegisteredRawInputDevices(pRawInputDevices, puiNumDevices, cbSize);
     }
@@ -246,6 +273,7 @@ UINT WINAPI RawInputHook::HookedGetRegisteredRawInputDevices(PRAWINPUTDEVICE pRa
 
 UINT WINAPI RawInputHook::HookedGetRawInputData(HRAWINPUT hRawInput, UINT uiCommand, LPVOID pData, PUINT pcbSize,
                                                 UINT cbSizeHeader) {
+    HOOK_STATS_SCOPE(HookId::GetRawInputData);
     if (!Enabled)
         return OriginalGetRawInputData(hRawInput, uiCommand, pData, pcbSize, cbSizeHeader);
 
@@ -269,83 +297,15 @@ UINT WINAPI RawInputHook::HookedGetRawInputData(HRAWINPUT hRawInput, UINT uiComm
         raw->header.dwSize = sizeof(RAWINPUTHEADER);
         raw->header.hDevice = EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE;
         raw->header.wParam = 0;
-        raw->data.hid.dwSizeHid = 16;
+        raw->data.hid.dwSizeHid = HidReportEncoder::REPORT_LENGTH;
         raw->data.hid.dwCount = 1;
 
-        const PCHAR rawData = reinterpret_cast<PCHAR>(raw->data.hid.bRawData);
-        const DWORD rawSize = raw->data.hid.dwSizeHid;
-
+        // WM_INPUT is only raised for the game's real devices, so there is no message that names another slot
         ControllerState state;
-        if (!ControllerManager::GetState(&state))
-            return static_cast<UINT>(-1);
-
-        USAGE buttonUsages[16];
-        ULONG numButtons = 0;
-
-        if (state.Bits.A)
-            buttonUsages[numButtons++] = HID_BUTTON_A;
-        if (state.Bits.B)
-            buttonUsages[numButtons++] = HID_BUTTON_B;
-        if (state.Bits.X)
-            buttonUsages[numButtons++] = HID_BUTTON_X;
-        if (state.Bits.Y)
-            buttonUsages[numButtons++] = HID_BUTTON_Y;
-        if (state.Bits.LeftShoulder)
-            buttonUsages[numButtons++] = HID_BUTTON_LEFT_SHOULDER;
-        if (state.Bits.RightShoulder)
-            buttonUsages[numButtons++] = HID_BUTTON_RIGHT_SHOULDER;
-        if (state.Bits.Back)
-            buttonUsages[numButtons++] = HID_BUTTON_BACK;
-        if (state.Bits.Start)
-            buttonUsages[numButtons++] = HID_BUTTON_START;
-        if (state.Bits.LeftThumbstick)
-            buttonUsages[numButtons++] = HID_BUTTON_LEFT_THUMB;
-        if (state.Bits.RightThumbstick)
-            buttonUsages[numButtons++] = HID_BUTTON_RIGHT_THUMB;
-
-        if (numButtons > 0) {
-            if (FAILED(HidP_SetUsages(HidP_Input, HID_USAGE_BUTTON, 0, buttonUsages, &numButtons, GetPreparsedData(),
-                                      reinterpret_cast<PCHAR>(raw->data.hid.bRawData), raw->data.hid.dwSizeHid))) {
-                return static_cast<UINT>(-1);
-            }
-        }
-
-        ULONG hatValue = 0;
-        if (state.Bits.DpadUp && state.Bits.DpadRight)
-            hatValue = HID_HAT_UP_RIGHT;
-        else if (state.Bits.DpadDown && state.Bits.DpadRight)
-            hatValue = HID_HAT_DOWN_RIGHT;
-        else if (state.Bits.DpadDown && state.Bits.DpadLeft)
-            hatValue = HID_HAT_DOWN_LEFT;
-        else if (state.Bits.DpadUp && state.Bits.DpadLeft)
-            hatValue = HID_HAT_UP_LEFT;
-        else if (state.Bits.DpadUp)
-            hatValue = HID_HAT_UP;
-        else if (state.Bits.DpadRight)
-            hatValue = HID_HAT_RIGHT;
-        else if (state.Bits.DpadDown)
-            hatValue = HID_HAT_DOWN;
-        else if (state.Bits.DpadLeft)
-            hatValue = HID_HAT_LEFT;
-
-        if (hatValue != 0) {
-            if (FAILED(SetHidValue(HID_USAGE_HAT, hatValue, rawData, rawSize))) {
-                return static_cast<UINT>(-1);
-            }
-        }
-
-        if (FAILED(SetHidValue(HID_USAGE_X, RemapAxis(state.LeftThumbstickX), rawData, rawSize)) ||
-            FAILED(SetHidValue(HID_USAGE_Y, RemapAxis(state.LeftThumbstickY, true), rawData, rawSize)) ||
-            FAILED(SetHidValue(HID_USAGE_RX, RemapAxis(state.RightThumbstickX), rawData, rawSize)) ||
-            FAILED(SetHidValue(HID_USAGE_RY, RemapAxis(state.RightThumbstickY, true), rawData, rawSize))) {
+        if (!ControllerManager::GetState(0, &state, InputApi::RawInput))
             return static_cast<UINT>(-1);
-        }
 
-        LONG combinedTriggers = MAXWORD / 2 + -state.RightTrigger * TRIGGER_SCALE + state.LeftTrigger * TRIGGER_SCALE;
-        if (FAILED(SetHidValue(HID_USAGE_Z, std::clamp(combinedTriggers, 0L, static_cast<LONG>(MAXWORD)), rawData,
-                               rawSize))) {
-            return static_cast<UINT>(-1);
-        }
+        HidReportEncoder::Encode(state, raw->data.hid.bRawData);
 
         *pcbSize = requiredSize;
         return requiredSize;
@@ -366,7 +326,7 @@ UINT WINAPI RawInputHook::HookedGetRawInputData(HRAWINPUT hRawInput, UINT uiComm
         header->hDevice = EmulatedDeviceDefinitions::EMULATED_DEVICE_HANDLE;
         header->wParam = 0;
         *pcbSize = sizeof(RAWINPUTHEADER);
-        _logger.Info("RID_HEADER - Returned header data");
+        _logger.Debug("RID_HEADER - Returned header data");
         return ERROR_SUCCESS;
     }
 
@@ -374,4 +334,48 @@ UINT WINAPI RawInputHook::HookedGetRawInputData(HRAWINPUT hRawInput, UINT uiComm
         _logger.InfoFormat("Unknown command: {}", uiCommand);
         return ERROR_INVALID_PARAMETER;
     }
+}
+
+UINT WINAPI RawInputHook::HookedGetRawInputBuffer(PRAWINPUT pData, PUINT pcbSize, UINT cbSizeHeader) {
+    HOOK_STATS_SCOPE(HookId::GetRawInputBuffer);
+    if (!Enabled || !pcbSize || cbSizeHeader != sizeof(RAWINPUTHEADER))
+        return OriginalGetRawInputBuffer(pData, pcbSize, cbSizeHeader);
+
+    const uint32_t connectedSlots = ControllerManager::GetConnectedSlotMask();
+
+    // A size query asks for the size of the next record, ours are all the same size
+    if (!pData) {
+        const UINT result = OriginalGetRawInputBuffer(nullptr, pcbSize, cbSizeHeader);
+        if (result == 0 && connectedSlots != 0)
+            *pcbSize = std::max(*pcbSize, HID_RECORD_SIZE);
+        return result;
+    }
+
+    // A report is queued only for slots whose state changed since the last batch, so polling faster than the
+    // controller changes costs no records
+    RecordBatchWriter batch(pData, *pcbSize, RAW_INPUT_ALIGNMENT);
+    for (uint32_t slots = connectedSlots; slots != 0 && batch.CanFit(HID_RECORD_SIZE); slots &= slots - 1) {
+        const int slot = std::countr_zero(slots);
+        ControllerState state;
+        uint32_t packetNumber;
+        if (!ControllerManager::GetState(slot, &state, InputApi::RawInput, &packetNumber) ||
+            !_bufferedReports.Claim(slot, packetNumber))
+            continue;
+
+        WriteHidRecord(static_cast<RAWINPUT*>(batch.Append(HID_RECORD_SIZE)), slot, state);
+    }
+
+    if (batch.GetCount() == 0)
+        return OriginalGetRawInputBuffer(pData, pcbSize, cbSizeHeader);
+
+    // The rest of the buffer goes to the game's real devices. If not even one of their records fits, they wait for
+    // the next call instead of failing this one
+    const size_t offset = std::min(batch.GetNextOffset(), batch.GetCapacity());
+    UINT remainingSize = static_cast<UINT>(batch.GetCapacity() - offset);
+    const UINT realCount = OriginalGetRawInputBuffer(
+        reinterpret_cast<PRAWINPUT>(reinterpret_cast<BYTE*>(pData) + offset), &remainingSize, cbSizeHeader);
+    if (realCount == static_cast<UINT>(-1))
+        return batch.GetCount();
+
+    return batch.GetCount() + realCount;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "XInputHook.h"
 #include "../ControllerManager.h"
+#include "../HookStats.h"
 #include "../Logger.h"
 #include "../Utils.h"
 #include "HookHelper.h"
@@ -12,7 +13,7 @@ Logger XInputHook::_logger = Logger("XInputHook");
 HookHelper XInputHook::_hookHelper;
 bool XInputHook::Enabled = false;
 decltype(&XInputGetState) XInputHook::_originalXInputGetState = nullptr;
-std::unordered_set<HMODULE> XInputHook::_hookedModules;
+ModuleCache<XInputVersion> XInputHook::_hookedModules;
 
 bool XInputHook::Install() {
     _logger.Info("Installing XInput hooks...");
@@ -37,7 +38,8 @@ bool XInputHook::Install(HMODULE module) {
     }
 
     if (HookModule(version)) {
-        _hookedModules.insert(module);
+        if (!_hookedModules.Add(module, version))
+            _logger.Error("Hooked module cache is full");
         return true;
     }
 
@@ -60,7 +62,8 @@ bool XInputHook::HookExisting() {
         if (module && !IsModuleHooked(module)) {
             _logger.InfoFormat("Found {} - attempting to hook...", dllName);
             if (HookModule(version)) {
-                _hookedModules.insert(module);
+                if (!_hookedModules.Add(module, version))
+                    _logger.Error("Hooked module cache is full");
                 anySuccess = true;
                 _logger.InfoFormat("Successfully hooked {}", dllName);
 
@@ -110,21 +113,28 @@ decltype(&XInputGetState) XInputHook::GetOriginalXInputGetState() {
 }
 
 bool XInputHook::Uninstall() {
-    _hookedModules.clear();
+    _hookedModules.Clear();
     return _hookHelper.Uninstall();
 }
 
 DWORD WINAPI XInputHook::HookedXInputGetState(DWORD dwUserIndex, XINPUT_STATE* pState) WIN_NOEXCEPT {
-    if (!Enabled || dwUserIndex != 0) 
+    HOOK_STATS_SCOPE(HookId::XInputGetState);
+    // Games poll every user index, slots with nothing bound are not worth logging
+    if (!Enabled || dwUserIndex >= VirtualSlotTable::MAX_SLOTS ||
+        !ControllerManager::IsSlotConnected(static_cast<int>(dwUserIndex)))
         return ERROR_DEVICE_NOT_CONNECTED;
 
     // Convert XInput state to our ControllerState
     ControllerState controllerState;
-    if (!ControllerManager::GetState(&controllerState)) {
+    uint32_t packetNumber;
+    if (!ControllerManager::GetState(static_cast<int>(dwUserIndex), &controllerState, InputApi::XInput,
+                                     &packetNumber)) {
         _logger.Error("Failed to get controller state");
         return ERROR_DEVICE_NOT_CONNECTED;
     }
 
+    // Only moves on when the state changes, games compare it to skip frames without new input
+    pState->dwPacketNumber = packetNumber;
     pState->Gamepad.wButtons = controllerState.ButtonStates;
     pState->Gamepad.bLeftTrigger = controllerState.LeftTrigger;
     pState->Gamepad.bRightTrigger = controllerState.RightTrigger;
@@ -138,7 +148,9 @@ DWORD WINAPI XInputHook::HookedXInputGetState(DWORD dwUserIndex, XINPUT_STATE* p
 
 DWORD WINAPI XInputHook::HookedXInputGetCapabilities(DWORD dwUserIndex, DWORD dwFlags,
                                                      XINPUT_CAPABILITIES* pCapabilities) WIN_NOEXCEPT {
-    if (!Enabled || !pCapabilities || dwUserIndex != 0) {
+    HOOK_STATS_SCOPE(HookId::XInputGetCapabilities);
+    if (!Enabled || !pCapabilities || dwUserIndex >= VirtualSlotTable::MAX_SLOTS ||
+        !ControllerManager::IsSlotConnected(static_cast<int>(dwUserIndex))) {
         return ERROR_DEVICE_NOT_CONNECTED;
     }
 
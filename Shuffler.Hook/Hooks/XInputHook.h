@@ -1,12 +1,12 @@
 #pragma once
 
 #include "../Logger.h"
+#include "../ModuleCache.h"
 #include "../Utils.h"
 #include "HookHelper.h"
 #include <Windows.h>
 #include <Xinput.h>
 #include <string>
-#include <unordered_set>
 
 enum class XInputVersion : uint8_t { None, XInput14, XInput13, XInput910 };
 
@@ -14,7 +14,7 @@ class XInputHook {
     static Logger _logger;
     static HookHelper _hookHelper;
     static decltype(&XInputGetState) _originalXInputGetState;
-    static std::unordered_set<HMODULE> _hookedModules;
+    static ModuleCache<XInputVersion> _hookedModules;
 
     struct VersionHooks {
         decltype(&XInputGetState) GetState;
@@ -61,7 +61,12 @@ class XInputHook {
     }
 
     static bool IsModuleHooked(HMODULE module) {
-        return _hookedModules.contains(module);
+        return GetHookedVersion(module) != XInputVersion::None;
+    }
+
+    // Version the module was hooked as, looked up without touching the module. None if it was not hooked
+    static XInputVersion GetHookedVersion(HMODULE module) {
+        return _hookedModules.Find(module, XInputVersion::None);
     }
 
     static DWORD WINAPI HookedXInputGetState(DWORD dwUserIndex, XINPUT_STATE* pState) WIN_NOEXCEPT;
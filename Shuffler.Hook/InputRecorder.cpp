@@ -0,0 +1,96 @@
+#include "InputRecorder.h"
+#include "Utils.h"
+
+Logger InputRecorder::_logger("InputRecorder");
+HANDLE InputRecorder::_file = INVALID_HANDLE_VALUE;
+HANDLE InputRecorder::_mapping = nullptr;
+std::atomic<InputRecordHeader*> InputRecorder::_header = nullptr;
+
+bool InputRecorder::Init(const std::wstring& path, uint32_t capacity) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        _logger.ErrorFormat("Recorder capacity must be a power of two, got {}", capacity);
+        return false;
+    }
+
+    const uint64_t size = sizeof(InputRecordHeader) + static_cast<uint64_t>(capacity) * sizeof(InputRecord);
+
+    _file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        _logger.ErrorFormat("Failed to create recording file: {}", GetLastError());
+        return false;
+    }
+
+    _mapping = CreateFileMappingW(_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                  static_cast<DWORD>(size), nullptr);
+    if (!_mapping) {
+        _logger.ErrorFormat("Failed to create recording file mapping: {}", GetLastError());
+        Shutdown();
+        return false;
+    }
+
+    auto* header = static_cast<InputRecordHeader*>(MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, size));
+    if (!header) {
+        _logger.ErrorFormat("Failed to map recording file: {}", GetLastError());
+        Shutdown();
+        return false;
+    }
+
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+
+    // The new file is zero-filled, so every record starts out with a sequence that never matches
+    header->Magic = InputRecordHeader::MAGIC;
+    header->Version = InputRecordHeader::VERSION;
+    header->RecordSize = sizeof(InputRecord);
+    header->Capacity = capacity;
+    header->ProcessId = GetCurrentProcessId();
+    header->TimestampFrequency = frequency.QuadPart;
+    header->StartTimestamp = now.QuadPart;
+    header->NextIndex.store(0, std::memory_order_relaxed);
+
+    _header.store(header, std::memory_order_release);
+    _logger.InfoFormat("Recording input to {} ({} records)", Utils::WideToMultibyte(path.c_str()), capacity);
+    return true;
+}
+
+void InputRecorder::Shutdown() {
+    if (InputRecordHeader* header = _header.exchange(nullptr)) {
+        FlushViewOfFile(header, 0);
+        UnmapViewOfFile(header);
+    }
+
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+
+    if (_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+    }
+}
+
+void InputRecorder::Record(const InputApi api, const uint8_t playerIndex, const uint8_t controllerIndex,
+                           const ControllerState& state) {
+    InputRecordHeader* header = _header.load(std::memory_order_acquire);
+    if (!header)
+        return;
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    const uint64_t index = header->NextIndex.fetch_add(1, std::memory_order_relaxed);
+    InputRecord& record = reinterpret_cast<InputRecord*>(header + 1)[index & (header->Capacity - 1)];
+    std::atomic_ref sequence(record.Sequence);
+    sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.Timestamp = now.QuadPart;
+    record.Api = api;
+    record.PlayerIndex = playerIndex;
+    record.ControllerIndex = controllerIndex;
+    record.State = state;
+    sequence.store(static_cast<uint32_t>(index + 1), std::memory_order_release);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include "Logger.h"
+#include <Windows.h>
+#include <atomic>
+#include <string>
+
+// The hooked API a recorded state was handed out through
+enum class InputApi : uint8_t { XInput = 1, RawInput = 2, Hid = 3 };
+
+// Start of the recording file, followed by Capacity InputRecords
+struct InputRecordHeader {
+    static constexpr uint32_t MAGIC = 0x52464853;  // "SHFR"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t RecordSize;
+    uint32_t Capacity;  // Power of two
+    uint32_t ProcessId;
+    int64_t TimestampFrequency;  // QueryPerformanceCounter ticks per second
+    int64_t StartTimestamp;
+    uint8_t Reserved[32];
+    alignas(64) std::atomic<uint64_t> NextIndex;  // Total number of records ever claimed
+    uint8_t Reserved2[56];
+};
+
+struct InputRecord {
+    int64_t Timestamp;  // QueryPerformanceCounter ticks
+    // Low 32 bits of the record's index + 1. Cleared before the rest is written and set last, so a reader that finds
+    // the same sequence before and after reading the record knows nothing overwrote it meanwhile
+    uint32_t Sequence;
+    InputApi Api;
+    uint8_t PlayerIndex;
+    uint8_t ControllerIndex;
+    uint8_t Reserved;
+    ControllerState State;
+    uint32_t Reserved2;
+};
+
+static_assert(sizeof(InputRecordHeader) == 128);
+static_assert(sizeof(InputRecord) == 32);
+
+/**
+ * Flight recorder for every state the hooks hand out, kept in a memory-mapped ring file.
+ *
+ * Recording claims a slot with one atomic increment and writes it straight into the mapped view, so it neither
+ * allocates nor makes a syscall, and the records reach the file even if the game crashes.
+ */
+class InputRecorder {
+    static Logger _logger;
+    static HANDLE _file;
+    static HANDLE _mapping;
+    static std::atomic<InputRecordHeader*> _header;
+
+  public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 1 << 16;
+
+    static bool Init(const std::wstring& path, uint32_t capacity = DEFAULT_CAPACITY);
+    static void Shutdown();
+
+    static void Record(InputApi api, uint8_t playerIndex, uint8_t controllerIndex, const ControllerState& state);
+};
\ No newline at end of file
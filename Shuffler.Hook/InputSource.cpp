@@ -0,0 +1,205 @@
+#include "InputSource.h"
+
+PolledInputSource::PolledInputSource(InputSource* source, std::chrono::microseconds interval)
+    : _source(source), _intervalMicroseconds(interval.count()), _requestedControllers(0), _stopRequested(false) {}
+
+PolledInputSource::~PolledInputSource() {
+    Stop();
+}
+
+bool PolledInputSource::Start() {
+    if (_pollThread.joinable())
+        return true;
+
+    _logger.InfoFormat("Starting background polling every {}us", _intervalMicroseconds.load());
+    _stopRequested = false;
+    _pollThread = std::thread(&PolledInputSource::PollThread, this);
+    return true;
+}
+
+void PolledInputSource::Stop() {
+    _stopRequested = true;
+
+    if (_pollThread.joinable()) {
+        _pollThread.join();
+        _logger.Info("Background polling stopped");
+    }
+}
+
+void PolledInputSource::SetInterval(std::chrono::microseconds interval) {
+    _intervalMicroseconds.store(interval.count(), std::memory_order_relaxed);
+}
+
+bool PolledInputSource::GetState(int controllerIndex, ControllerState* state) {
+    if (controllerIndex < 0 || controllerIndex >= MAX_CONTROLLERS)
+        return false;
+
+    // Only controllers that someone asks for get polled, since reading a disconnected slot is slow
+    const uint32_t controllerBit = 1u << controllerIndex;
+    if (!(_requestedControllers.load(std::memory_order_relaxed) & controllerBit))
+        _requestedControllers.fetch_or(controllerBit, std::memory_order_relaxed);
+
+    PolledState polled;
+    if (_states[controllerIndex].Load(&polled) == 0)
+        return _source->GetState(controllerIndex, state);  // Not polled yet, read it this once
+
+    *state = polled.State;
+    return polled.Connected;
+}
+
+void PolledInputSource::PollThread() {
+    auto nextPoll = std::chrono::steady_clock::now();
+
+    while (!_stopRequested) {
+        const uint32_t requested = _requestedControllers.load(std::memory_order_relaxed);
+        for (int i = 0; i < MAX_CONTROLLERS; i++) {
+            if (requested & (1u << i))
+                Poll(i);
+        }
+
+        nextPoll += std::chrono::microseconds(_intervalMicroseconds.load(std::memory_order_relaxed));
+        const auto now = std::chrono::steady_clock::now();
+        if (nextPoll < now)
+            nextPoll = now;  // Fell behind, don't try to catch up with a burst of polls
+
+        std::this_thread::sleep_until(nextPoll);
+    }
+}
+
+void PolledInputSource::Poll(int controllerIndex) {
+    PolledState polled = {};
+    polled.Connected = _source->GetState(controllerIndex, &polled.State);
+    _states[controllerIndex].Store(polled);
+}
+
+SharedPadInputSource::~SharedPadInputSource() {
+    Close();
+}
+
+bool SharedPadInputSource::Open() {
+    if (_table)
+        return true;
+
+    _mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, L"Local\\ShufflerPadFeed");
+    if (!_mapping) {
+        _logger.ErrorFormat("Failed to open pad feed: {}", GetLastError());
+        return false;
+    }
+
+    _table = static_cast<const SharedPadTable*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, sizeof(SharedPadTable)));
+    if (!_table || _table->Magic != SharedPadTable::MAGIC || _table->Version != SharedPadTable::VERSION) {
+        _logger.Error("Pad feed is not mapped or has an unsupported version");
+        Close();
+        return false;
+    }
+
+    _logger.InfoFormat("Opened pad feed with {} slots", _table->SlotCount);
+    return true;
+}
+
+void SharedPadInputSource::Close() {
+    if (_table) {
+        UnmapViewOfFile(_table);
+        _table = nullptr;
+    }
+
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+}
+
+bool SharedPadInputSource::GetState(int playerIndex, ControllerState* state) {
+    if (!_table || playerIndex < 0 || playerIndex >= _table->SlotCount ||
+        playerIndex >= static_cast<int>(SharedPadTable::MAX_PLAYERS))
+        return false;
+
+    // The writer lives in another process and may have died halfway through a write, so never wait on it indefinitely
+    SharedPadState padState;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        if (_table->Slots[playerIndex].State.TryLoad(&padState)) {
+            *state = padState.State;
+            return padState.Connected != 0;
+        }
+    }
+
+    return false;
+}
+
+bool ReplayInputSource::Open(const std::wstring& path, const double speed, const bool loop) {
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        _logger.ErrorFormat("Failed to open input stream: {}", GetLastError());
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart > MAXDWORD) {
+        _logger.Error("Input stream is too large to replay");
+        CloseHandle(file);
+        return false;
+    }
+
+    std::vector<uint8_t> data(static_cast<size_t>(size.QuadPart));
+    DWORD read;
+    const bool success = ReadFile(file, data.data(), static_cast<DWORD>(data.size()), &read, nullptr) &&
+                         read == data.size();
+    CloseHandle(file);
+    if (!success) {
+        _logger.ErrorFormat("Failed to read input stream: {}", GetLastError());
+        return false;
+    }
+
+    std::lock_guard lock(_mutex);
+    _data = std::move(data);
+    if (!_reader.Open(_data)) {
+        _logger.Error("Not an input stream or an unsupported version");
+        _data.clear();
+        return false;
+    }
+
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+
+    _loop = loop;
+    _tickScale = speed * static_cast<double>(_reader.GetHeader().TimestampFrequency) / frequency.QuadPart;
+    Restart(now.QuadPart);
+
+    _logger.InfoFormat("Replaying {} blocks at {}x speed", _reader.GetBlockCount(), speed);
+    return true;
+}
+
+bool ReplayInputSource::GetState(int /*controllerIndex*/, ControllerState* state) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    std::lock_guard lock(_mutex);
+    if (_data.empty())
+        return false;
+
+    // Only once the previous read handed out the last state, so a loop does not skip it
+    if (!_hasNext && _loop)
+        Restart(now.QuadPart);
+
+    const int64_t target = _reader.GetFirstTimestamp() +
+                           static_cast<int64_t>(static_cast<double>(now.QuadPart - _replayStart) * _tickScale);
+    while (_hasNext && _next.Timestamp <= target) {
+        _current = _next;
+        _hasNext = _reader.Next(&_next);
+    }
+
+    *state = _current.State;
+    return _current.Connected;
+}
+
+void ReplayInputSource::Restart(const int64_t now) {
+    _replayStart = now;
+    _reader.Seek(_reader.GetFirstTimestamp());
+    _current = {};
+    if (_reader.Next(&_current))
+        _hasNext = _reader.Next(&_next);
+    else
+        _hasNext = false;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include "InputStream.h"
+#include "Logger.h"
+#include "SeqLock.h"
+#include "SharedPadTable.h"
+#include <Windows.h>
+#include <Xinput.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// A backend that reads the raw state of a physical controller
+class InputSource {
+  public:
+    static constexpr int MAX_CONTROLLERS = XUSER_MAX_COUNT;
+
+    virtual ~InputSource() = default;
+    virtual bool GetState(int controllerIndex, ControllerState* state) = 0;
+};
+
+// Polls another source on a background thread and hands out the latest state it published
+class PolledInputSource : public InputSource {
+    struct PolledState {
+        ControllerState State;
+        bool Connected;
+    };
+
+    Logger _logger = Logger("PolledInputSource");
+    InputSource* _source;
+    std::atomic<int64_t> _intervalMicroseconds;
+    std::atomic<uint32_t> _requestedControllers;
+    std::atomic<bool> _stopRequested;
+    std::thread _pollThread;
+    SeqLock<PolledState> _states[MAX_CONTROLLERS];
+
+  public:
+    PolledInputSource(InputSource* source, std::chrono::microseconds interval);
+    ~PolledInputSource() override;
+
+    bool Start();
+    void Stop();
+    void SetInterval(std::chrono::microseconds interval);
+
+    bool GetState(int controllerIndex, ControllerState* state) override;
+
+  private:
+    void PollThread();
+    void Poll(int controllerIndex);
+};
+
+/**
+ * Reads player slots from the SharedPadTable the controlling process publishes, so hooked games do not each poll the
+ * physical controllers. The controllerIndex passed to GetState is a player index.
+ */
+class SharedPadInputSource : public InputSource {
+    static constexpr int MAX_READ_ATTEMPTS = 64;
+
+    Logger _logger = Logger("SharedPadInputSource");
+    HANDLE _mapping = nullptr;
+    const SharedPadTable* _table = nullptr;
+
+  public:
+    ~SharedPadInputSource() override;
+
+    // Opens the table, returns false if the controlling process has not created it
+    bool Open();
+    void Close();
+
+    bool GetState(int playerIndex, ControllerState* state) override;
+};
+
+/**
+ * Plays an InputStreamRecorder file back in place of a physical controller, at the recorded pace scaled by speed. The
+ * same recorded controller is returned for every controller index.
+ */
+class ReplayInputSource : public InputSource {
+    Logger _logger = Logger("ReplayInputSource");
+    std::mutex _mutex;
+    std::vector<uint8_t> _data;
+    InputStreamReader _reader;
+    bool _loop = false;
+    double _tickScale = 0;      // Recorded ticks per QueryPerformanceCounter tick of playback
+    int64_t _replayStart = 0;   // QueryPerformanceCounter ticks
+    InputStreamSample _current = {};
+    InputStreamSample _next = {};
+    bool _hasNext = false;
+
+  public:
+    bool Open(const std::wstring& path, double speed, bool loop);
+
+    bool GetState(int controllerIndex, ControllerState* state) override;
+
+  private:
+    void Restart(int64_t now);
+};
\ No newline at end of file
@@ -0,0 +1,314 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+/**
+ * Compact controller input stream: only changes are stored, each as the XOR of the fields that changed against the
+ * previous state, varint encoded. Every KeyframeInterval changes a new block starts with a full keyframe, so readers
+ * can seek to any point by skipping whole blocks.
+ *
+ * File layout: InputStreamHeader, then blocks of an InputStreamBlockHeader followed by Size bytes of records. A record
+ * is a varint tick delta to the previous record, a flags byte (bit n set if field n changed, bit 7 if connected),
+ * then one varint per changed field. The fields are the six 16-bit words of a ControllerState.
+ */
+struct InputStreamHeader {
+    static constexpr uint32_t MAGIC = 0x53494853;  // "SHIS"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t KeyframeInterval;
+    int64_t TimestampFrequency;  // Ticks per second
+    int64_t StartTimestamp;
+};
+
+struct InputStreamBlockHeader {
+    uint32_t Size;   // Bytes of records following the header
+    uint32_t Count;  // Records following the keyframe
+    int64_t Timestamp;
+    uint8_t Connected;
+    uint8_t Reserved[3];
+    ControllerState Keyframe;
+};
+
+static_assert(sizeof(InputStreamHeader) == 24);
+static_assert(sizeof(InputStreamBlockHeader) == 32);
+
+struct InputStreamSample {
+    int64_t Timestamp;
+    ControllerState State;
+    bool Connected;
+};
+
+namespace InputStreamCodec {
+constexpr int FIELD_COUNT = sizeof(ControllerState) / sizeof(uint16_t);
+constexpr uint8_t CONNECTED_FLAG = 0x80;
+constexpr size_t MAX_RECORD_SIZE = 10 + 1 + FIELD_COUNT * 3;
+
+static_assert(sizeof(ControllerState) == FIELD_COUNT * sizeof(uint16_t));
+
+inline void ToFields(const ControllerState& state, uint16_t* fields) {
+    memcpy(fields, &state, sizeof(state));
+}
+
+inline void FromFields(const uint16_t* fields, ControllerState* state) {
+    memcpy(state, fields, sizeof(*state));
+}
+
+inline uint8_t* WriteVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// Returns nullptr if the varint runs past end or is longer than 64 bits
+inline const uint8_t* ReadVarint(const uint8_t* in, const uint8_t* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && in < end; shift += 7) {
+        const uint8_t byte = *in++;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return in;
+        }
+    }
+    return nullptr;
+}
+}  // namespace InputStreamCodec
+
+/**
+ * Encodes changes into one block at a time. The block buffer is reserved up front, so encoding does not allocate.
+ */
+class InputStreamEncoder {
+    uint16_t _keyframeInterval;
+    std::vector<uint8_t> _block;
+    size_t _blockSize = 0;
+    uint32_t _count = 0;
+    bool _hasLast = false;
+    int64_t _lastTimestamp = 0;
+    uint16_t _lastFields[InputStreamCodec::FIELD_COUNT] = {};
+    bool _lastConnected = false;
+
+  public:
+    explicit InputStreamEncoder(const uint16_t keyframeInterval)
+        : _keyframeInterval(keyframeInterval),
+          _block(sizeof(InputStreamBlockHeader) + keyframeInterval * InputStreamCodec::MAX_RECORD_SIZE) {}
+
+    // Returns false if the state is the same as the last one, in which case nothing is encoded
+    bool Add(const int64_t timestamp, const ControllerState& state, const bool connected) {
+        uint16_t fields[InputStreamCodec::FIELD_COUNT];
+        InputStreamCodec::ToFields(state, fields);
+
+        uint8_t flags = connected ? InputStreamCodec::CONNECTED_FLAG : 0;
+        for (int i = 0; i < InputStreamCodec::FIELD_COUNT; i++) {
+            if (fields[i] != _lastFields[i])
+                flags |= 1 << i;
+        }
+
+        if (_hasLast && (flags & ~InputStreamCodec::CONNECTED_FLAG) == 0 && connected == _lastConnected)
+            return false;
+
+        // Timestamps from different threads can arrive slightly out of order, they are clamped to stay monotonic
+        const int64_t delta = _hasLast ? std::max<int64_t>(timestamp - _lastTimestamp, 0) : 0;
+
+        if (_blockSize == 0) {
+            InputStreamBlockHeader header = {};
+            header.Timestamp = _hasLast ? _lastTimestamp + delta : timestamp;
+            header.Connected = connected;
+            header.Keyframe = state;
+            memcpy(_block.data(), &header, sizeof(header));
+            _blockSize = sizeof(header);
+            _count = 0;
+            Remember(header.Timestamp, fields, connected);
+            return true;
+        }
+
+        uint8_t* out = _block.data() + _blockSize;
+        out = InputStreamCodec::WriteVarint(out, static_cast<uint64_t>(delta));
+        *out++ = flags;
+        for (int i = 0; i < InputStreamCodec::FIELD_COUNT; i++) {
+            if (flags & (1 << i))
+                out = InputStreamCodec::WriteVarint(out, fields[i] ^ _lastFields[i]);
+        }
+
+        _blockSize = out - _block.data();
+        _count++;
+        Remember(_lastTimestamp + delta, fields, connected);
+        return true;
+    }
+
+    bool IsBlockEmpty() const {
+        return _blockSize == 0;
+    }
+
+    bool IsBlockFull() const {
+        return _count >= _keyframeInterval;
+    }
+
+    // Completes the current block and returns its bytes, the next Add starts a new block with a keyframe
+    std::span<const uint8_t> FinishBlock() {
+        if (_blockSize == 0)
+            return {};
+
+        const uint32_t size = static_cast<uint32_t>(_blockSize - sizeof(InputStreamBlockHeader));
+        memcpy(_block.data() + offsetof(InputStreamBlockHeader, Size), &size, sizeof(size));
+        memcpy(_block.data() + offsetof(InputStreamBlockHeader, Count), &_count, sizeof(_count));
+
+        const std::span<const uint8_t> block(_block.data(), _blockSize);
+        _blockSize = 0;
+        return block;
+    }
+
+  private:
+    void Remember(const int64_t timestamp, const uint16_t* fields, const bool connected) {
+        _lastTimestamp = timestamp;
+        memcpy(_lastFields, fields, sizeof(_lastFields));
+        _lastConnected = connected;
+        _hasLast = true;
+    }
+};
+
+/**
+ * Decodes an input stream held in memory. A block that is cut off ends the stream, a record that does not decode
+ * cleanly skips the rest of its block.
+ */
+class InputStreamReader {
+    struct BlockEntry {
+        int64_t Timestamp;
+        size_t Offset;
+    };
+
+    std::span<const uint8_t> _data;
+    InputStreamHeader _header = {};
+    std::vector<BlockEntry> _blocks;
+    size_t _block = 0;
+    const uint8_t* _cursor = nullptr;
+    const uint8_t* _blockEnd = nullptr;
+    uint32_t _remaining = 0;
+    bool _keyframePending = false;
+    InputStreamSample _sample = {};
+
+  public:
+    // Returns false if data does not start with a supported stream header
+    bool Open(const std::span<const uint8_t> data) {
+        if (data.size() < sizeof(InputStreamHeader))
+            return false;
+
+        memcpy(&_header, data.data(), sizeof(_header));
+        if (_header.Magic != InputStreamHeader::MAGIC || _header.Version != InputStreamHeader::VERSION)
+            return false;
+
+        _data = data;
+        _blocks.clear();
+        for (size_t offset = sizeof(InputStreamHeader); data.size() - offset >= sizeof(InputStreamBlockHeader);) {
+            InputStreamBlockHeader block;
+            memcpy(&block, data.data() + offset, sizeof(block));
+            if (block.Size > data.size() - offset - sizeof(block))
+                break;
+
+            _blocks.push_back({block.Timestamp, offset});
+            offset += sizeof(block) + block.Size;
+        }
+
+        EnterBlock(0);
+        return true;
+    }
+
+    const InputStreamHeader& GetHeader() const {
+        return _header;
+    }
+
+    size_t GetBlockCount() const {
+        return _blocks.size();
+    }
+
+    int64_t GetFirstTimestamp() const {
+        return _blocks.empty() ? _header.StartTimestamp : _blocks.front().Timestamp;
+    }
+
+    // Positions the reader so the next sample is the keyframe of the last block starting at or before timestamp
+    void Seek(const int64_t timestamp) {
+        const auto it = std::upper_bound(_blocks.begin(), _blocks.end(), timestamp,
+                                         [](const int64_t value, const BlockEntry& block) {
+                                             return value < block.Timestamp;
+                                         });
+        EnterBlock(it == _blocks.begin() ? 0 : static_cast<size_t>(it - _blocks.begin() - 1));
+    }
+
+    // Returns false at the end of the stream
+    bool Next(InputStreamSample* sample) {
+        while (true) {
+            if (_keyframePending) {
+                _keyframePending = false;
+                *sample = _sample;
+                return true;
+            }
+
+            if (_remaining > 0) {
+                if (DecodeRecord()) {
+                    *sample = _sample;
+                    return true;
+                }
+                _remaining = 0;  // Corrupt block, skip the rest of it
+            }
+
+            if (_block + 1 >= _blocks.size())
+                return false;
+            EnterBlock(_block + 1);
+        }
+    }
+
+  private:
+    void EnterBlock(const size_t index) {
+        _block = index;
+        _remaining = 0;
+        _keyframePending = false;
+        if (index >= _blocks.size())
+            return;
+
+        InputStreamBlockHeader block;
+        memcpy(&block, _data.data() + _blocks[index].Offset, sizeof(block));
+        _cursor = _data.data() + _blocks[index].Offset + sizeof(block);
+        _blockEnd = _cursor + block.Size;
+        _remaining = block.Count;
+        _keyframePending = true;
+        _sample = {block.Timestamp, block.Keyframe, block.Connected != 0};
+    }
+
+    bool DecodeRecord() {
+        uint64_t delta;
+        const uint8_t* in = InputStreamCodec::ReadVarint(_cursor, _blockEnd, &delta);
+        if (!in || in >= _blockEnd)
+            return false;
+
+        const uint8_t flags = *in++;
+        uint16_t fields[InputStreamCodec::FIELD_COUNT];
+        InputStreamCodec::ToFields(_sample.State, fields);
+        for (int i = 0; i < InputStreamCodec::FIELD_COUNT; i++) {
+            if (!(flags & (1 << i)))
+                continue;
+
+            uint64_t change;
+            in = InputStreamCodec::ReadVarint(in, _blockEnd, &change);
+            if (!in)
+                return false;
+            fields[i] ^= static_cast<uint16_t>(change);
+        }
+
+        _cursor = in;
+        _remaining--;
+        _sample.Timestamp += static_cast<int64_t>(delta);
+        _sample.Connected = (flags & InputStreamCodec::CONNECTED_FLAG) != 0;
+        InputStreamCodec::FromFields(fields, &_sample.State);
+        return true;
+    }
+};
\ No newline at end of file
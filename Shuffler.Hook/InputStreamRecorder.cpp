@@ -0,0 +1,155 @@
+#include "InputStreamRecorder.h"
+#include "Utils.h"
+
+Logger InputStreamRecorder::_logger("InputStreamRecorder");
+std::atomic<bool> InputStreamRecorder::_recording = false;
+std::mutex InputStreamRecorder::_startStopMutex;
+std::mutex InputStreamRecorder::_mutex;
+HANDLE InputStreamRecorder::_file = INVALID_HANDLE_VALUE;
+std::unique_ptr<InputStreamEncoder> InputStreamRecorder::_encoder;
+std::vector<std::vector<uint8_t>> InputStreamRecorder::_pendingBlocks;
+std::vector<std::vector<uint8_t>> InputStreamRecorder::_freeBlocks;
+bool InputStreamRecorder::_stopRequested = false;
+uint64_t InputStreamRecorder::_droppedBlocks = 0;
+std::atomic<uint32_t> InputStreamRecorder::_wakeSequence = 0;
+std::thread InputStreamRecorder::_writerThread;
+
+bool InputStreamRecorder::Start(const std::wstring& path) {
+    std::lock_guard startStopLock(_startStopMutex);
+    if (_writerThread.joinable())
+        return true;
+
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        _logger.ErrorFormat("Failed to create input stream file: {}", GetLastError());
+        return false;
+    }
+
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+
+    const InputStreamHeader header = {
+        .Magic = InputStreamHeader::MAGIC,
+        .Version = InputStreamHeader::VERSION,
+        .KeyframeInterval = KEYFRAME_INTERVAL,
+        .TimestampFrequency = frequency.QuadPart,
+        .StartTimestamp = now.QuadPart,
+    };
+
+    DWORD written;
+    if (!WriteFile(file, &header, sizeof(header), &written, nullptr)) {
+        _logger.ErrorFormat("Failed to write input stream header: {}", GetLastError());
+        CloseHandle(file);
+        return false;
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+        _file = file;
+        _encoder = std::make_unique<InputStreamEncoder>(KEYFRAME_INTERVAL);
+        _stopRequested = false;
+        _droppedBlocks = 0;
+    }
+
+    _writerThread = std::thread(&InputStreamRecorder::WriterThread);
+    _recording.store(true, std::memory_order_relaxed);
+    _logger.InfoFormat("Recording input stream to {}", Utils::WideToMultibyte(path.c_str()));
+    return true;
+}
+
+void InputStreamRecorder::Stop() {
+    std::lock_guard startStopLock(_startStopMutex);
+    _recording.store(false, std::memory_order_relaxed);
+    if (!_writerThread.joinable())
+        return;
+
+    // The block in progress is queued too, the writer drains everything before it exits
+    {
+        std::lock_guard lock(_mutex);
+        QueueBlockLocked();
+        _encoder.reset();
+        _stopRequested = true;
+    }
+    WakeWriter();
+    _writerThread.join();
+
+    std::lock_guard lock(_mutex);
+    CloseHandle(_file);
+    _file = INVALID_HANDLE_VALUE;
+    _freeBlocks.clear();
+    if (_droppedBlocks)
+        _logger.WarningFormat("Dropped {} input stream blocks, the file could not keep up", _droppedBlocks);
+}
+
+void InputStreamRecorder::Append(const ControllerState& state, const bool connected) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    std::lock_guard lock(_mutex);
+    if (!_encoder)
+        return;
+
+    if (_encoder->Add(now.QuadPart, state, connected) && _encoder->IsBlockFull())
+        QueueBlockLocked();
+}
+
+void InputStreamRecorder::QueueBlockLocked() {
+    if (!_encoder)
+        return;
+
+    const auto block = _encoder->FinishBlock();
+    if (block.empty())
+        return;
+
+    if (_pendingBlocks.size() >= MAX_PENDING_BLOCKS) {
+        _droppedBlocks++;
+        return;
+    }
+
+    std::vector<uint8_t> buffer;
+    if (!_freeBlocks.empty()) {
+        buffer = std::move(_freeBlocks.back());
+        _freeBlocks.pop_back();
+    }
+    buffer.assign(block.begin(), block.end());
+    _pendingBlocks.push_back(std::move(buffer));
+    WakeWriter();
+}
+
+void InputStreamRecorder::WakeWriter() {
+    _wakeSequence.fetch_add(1, std::memory_order_release);
+    _wakeSequence.notify_one();
+}
+
+void InputStreamRecorder::WriterThread() {
+    std::vector<std::vector<uint8_t>> blocks;
+
+    while (true) {
+        // Read before looking at the queue, so a block queued after the look changes it and the wait returns
+        const uint32_t sequence = _wakeSequence.load(std::memory_order_acquire);
+        {
+            std::lock_guard lock(_mutex);
+            if (_pendingBlocks.empty() && _stopRequested)
+                return;
+            blocks.swap(_pendingBlocks);
+        }
+
+        if (blocks.empty()) {
+            _wakeSequence.wait(sequence, std::memory_order_acquire);
+            continue;
+        }
+
+        for (const auto& block : blocks) {
+            DWORD written;
+            if (!WriteFile(_file, block.data(), static_cast<DWORD>(block.size()), &written, nullptr))
+                _logger.ErrorFormat("Failed to write input stream block: {}", GetLastError());
+        }
+
+        std::lock_guard lock(_mutex);
+        for (auto& block : blocks)
+            _freeBlocks.push_back(std::move(block));
+        blocks.clear();
+    }
+}
\ No newline at end of file
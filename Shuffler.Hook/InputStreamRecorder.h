@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include "InputStream.h"
+#include "Logger.h"
+#include <Windows.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Records the raw source states ControllerManager reads, before any remapping, as a delta-encoded InputStream file, so
+ * a session can be replayed through the remap engine later with ReplayInputSource.
+ *
+ * Only changes are encoded, and blocks are handed to a writer thread as they fill up, so callers never wait for the
+ * file. Should the writer fall more than MAX_PENDING_BLOCKS behind, whole blocks are dropped; every block starts with
+ * a keyframe, so the stream still decodes with a gap.
+ */
+class InputStreamRecorder {
+    static constexpr uint16_t KEYFRAME_INTERVAL = 256;
+    static constexpr size_t MAX_PENDING_BLOCKS = 64;
+
+    static Logger _logger;
+    static std::atomic<bool> _recording;
+    static std::mutex _startStopMutex;  // Serializes Start and Stop, which run outside _mutex while the writer works
+    static std::mutex _mutex;           // Guards everything below
+    static HANDLE _file;
+    static std::unique_ptr<InputStreamEncoder> _encoder;
+    static std::vector<std::vector<uint8_t>> _pendingBlocks;  // Full blocks the writer thread has not written yet
+    static std::vector<std::vector<uint8_t>> _freeBlocks;     // Written blocks, kept to reuse their buffers
+    static bool _stopRequested;
+    static uint64_t _droppedBlocks;
+    static std::atomic<uint32_t> _wakeSequence;  // Bumped whenever the writer has something to do
+    static std::thread _writerThread;
+
+  public:
+    static bool Start(const std::wstring& path);
+    static void Stop();
+
+    static void Record(const ControllerState& state, bool connected) {
+        if (_recording.load(std::memory_order_relaxed))
+            Append(state, connected);
+    }
+
+  private:
+    static void Append(const ControllerState& state, bool connected);
+    static void QueueBlockLocked();
+    static void WakeWriter();
+    static void WriterThread();
+};
\ No newline at end of file
@@ -1,12 +1,17 @@
 #include "IpcHandler.h"
 #include "Logger.h"
 
-IpcHandler::IpcHandler(EnableCallback onEnable, DisableCallback onDisable, SetControllerCallback onSetController)
-    : _onEnable(std::move(onEnable)),
-      _onDisable(std::move(onDisable)),
-      _onSetController(std::move(onSetController)),
-      _shutdownRequested(false),
-      _pipeHandle(INVALID_HANDLE_VALUE) {}
+IpcHandler::IpcHandler(EnableCallback onEnable, DisableCallback onDisable, SetControllerCallback onSetController,
+                       SetMappingsCallback onSetMappings, SetInputSourceCallback onSetInputSource,
+                       SetAnalogSettingsCallback onSetAnalogSettings, SetAxisRoutingCallback onSetAxisRouting,
+                       SetVirtualSlotCallback onSetVirtualSlot, SetReplaySourceCallback onSetReplaySource,
+                       SetInputRecordingCallback onSetInputRecording,
+                       SetStateFreshnessCallback onSetStateFreshness)
+    : _onEnable(std::move(onEnable)), _onDisable(std::move(onDisable)), _onSetController(std::move(onSetController)),
+      _onSetMappings(std::move(onSetMappings)), _onSetInputSource(std::move(onSetInputSource)),
+      _onSetAnalogSettings(std::move(onSetAnalogSettings)), _onSetAxisRouting(std::move(onSetAxisRouting)),
+      _onSetVirtualSlot(std::move(onSetVirtualSlot)), _onSetReplaySource(std::move(onSetReplaySource)),
+      _onSetInputRecording(std::move(onSetInputRecording)), _onSetStateFreshness(std::move(onSetStateFreshness)) {}
 
 IpcHandler::~IpcHandler() {
     Stop();
@@ -14,65 +19,54 @@ IpcHandler::~IpcHandler() {
 
 bool IpcHandler::Start() {
     _logger.Info("Starting IPC handler...");
-    _shutdownRequested = false;
-    _pipeThread = std::thread(&IpcHandler::PipeServerThread, this);
-    return true;
+
+    // The shared memory ring is the fast path, the pipe stays for clients that cannot map it
+    _transports.push_back(std::make_unique<SharedMemoryIpcTransport>());
+    _transports.push_back(std::make_unique<PipeIpcTransport>());
+
+    bool started = false;
+    for (const auto& transport : _transports)
+        started |= transport->Start([this](const std::span<const IpcMessage> messages) { HandleMessages(messages); });
+
+    return started;
 }
 
 void IpcHandler::Stop() {
     _logger.Info("Stopping IPC handler...");
-    _shutdownRequested = true;
-
-    if (_pipeHandle != INVALID_HANDLE_VALUE) {
-        CloseHandle(_pipeHandle);
-        _pipeHandle = INVALID_HANDLE_VALUE;
-    }
 
-    if (_pipeThread.joinable()) {
-        _pipeThread.join();
-    }
+    for (const auto& transport : _transports)
+        transport->Stop();
+    _transports.clear();
 }
 
-void IpcHandler::PipeServerThread() {
-    auto pipeName = std::format(R"(\\.\pipe\ShufflerHook-{})", GetCurrentProcessId());
-    _logger.InfoFormat("IPC server thread started. Pipe name: {}", pipeName);
-
-    while (!_shutdownRequested) {
-        _pipeHandle = CreateNamedPipeA(pipeName.c_str(), PIPE_ACCESS_DUPLEX,
-                                       PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT, 1, sizeof(IpcMessage),
-                                       sizeof(IpcMessage), 0, nullptr);
+void IpcHandler::HandleMessages(const std::span<const IpcMessage> messages) {
+    // The callbacks are not safe to run concurrently, and commands that replace each other have to be applied in the
+    // order they arrived
+    std::lock_guard lock(_dispatchMutex);
+
+    // Only the last controller switch and mapping set in a batch matter, the ones before would be undone right away
+    size_t lastSetController = messages.size();
+    size_t lastSetMappings = messages.size();
+    for (size_t i = 0; i < messages.size(); i++) {
+        if (messages[i].Type == IpcMessageType::SetActiveController)
+            lastSetController = i;
+        else if (messages[i].Type == IpcMessageType::SetMappings)
+            lastSetMappings = i;
+    }
 
-        if (_pipeHandle == INVALID_HANDLE_VALUE) {
-            _logger.Info("Failed to create named pipe");
-            return;
+    for (size_t i = 0; i < messages.size(); i++) {
+        if (messages[i].Type == IpcMessageType::SetActiveController && i != lastSetController) {
+            _logger.DebugFormat("IPC: Skipping superseded switch to controller {}", messages[i].GetControllerId());
+            continue;
         }
 
-        _logger.Info("Waiting for client connection...");
-        if (ConnectNamedPipe(_pipeHandle, nullptr)) {
-            _logger.Info("Client connected");
-
-            while (!_shutdownRequested) {
-                IpcMessage msg;
-                DWORD bytesRead;
-
-                if (ReadFile(_pipeHandle, &msg, sizeof(msg), &bytesRead, nullptr)) {
-                    if (bytesRead == sizeof(msg))
-                        HandleMessage(msg);
-                } else {
-                    _logger.Info("Client disconnected or error");
-                    break;
-                }
-            }
+        if (messages[i].Type == IpcMessageType::SetMappings && i != lastSetMappings) {
+            _logger.Debug("IPC: Skipping superseded mapping set");
+            continue;
         }
 
-        CloseHandle(_pipeHandle);
-        _pipeHandle = INVALID_HANDLE_VALUE;
-
-        if (_shutdownRequested)
-            break;
+        HandleMessage(messages[i]);
     }
-
-    _logger.Info("IPC server thread stopped");
 }
 
 void IpcHandler::HandleMessage(const IpcMessage& msg) {
@@ -90,9 +84,82 @@ void IpcHandler::HandleMessage(const IpcMessage& msg) {
         break;
 
     case IpcMessageType::SetActiveController:
-        _logger.InfoFormat("IPC: Set active controller to {}", msg.ControllerId);
+        _logger.InfoFormat("IPC: Set active controller to {}", msg.GetControllerId());
         if (_onSetController)
-            _onSetController(msg.ControllerId);
+            _onSetController(msg.GetControllerId());
+        break;
+
+    case IpcMessageType::SetMappings:
+        _logger.InfoFormat("IPC: Set mappings for {} players", msg.GetMappingSet().GetPlayerCount());
+        if (_onSetMappings)
+            _onSetMappings(msg.GetMappingSet());
+        break;
+
+    case IpcMessageType::SetInputSource: {
+        const IpcSetInputSource source = msg.GetInputSource();
+        if (source.Source == IpcInputSource::Replay) {
+            std::wstring path;
+            const IpcReplaySource replay = msg.GetReplaySource(&path);
+            _logger.InfoFormat("IPC: Set input source to replay at {}x{}", replay.Speed, replay.Loop ? ", looped" : "");
+            if (_onSetReplaySource)
+                _onSetReplaySource(replay, path);
+            break;
+        }
+
+        if (source.Source == IpcInputSource::Polled)
+            _logger.InfoFormat("IPC: Set input source to polled every {}us", source.PollIntervalMicroseconds);
+        else
+            _logger.InfoFormat("IPC: Set input source to {}", static_cast<int>(source.Source));
+        if (_onSetInputSource)
+            _onSetInputSource(source);
         break;
     }
+
+    case IpcMessageType::SetAnalogSettings: {
+        uint8_t playerIndex;
+        const AnalogSettings settings = msg.GetAnalogSettings(&playerIndex);
+        _logger.InfoFormat("IPC: Set analog settings for player {}", playerIndex);
+        if (_onSetAnalogSettings)
+            _onSetAnalogSettings(playerIndex, settings);
+        break;
+    }
+
+    case IpcMessageType::SetAxisRouting: {
+        uint8_t playerIndex;
+        const AxisRoutingSettings settings = msg.GetAxisRouting(&playerIndex);
+        _logger.InfoFormat("IPC: Set axis routing for player {}", playerIndex);
+        if (_onSetAxisRouting)
+            _onSetAxisRouting(playerIndex, settings);
+        break;
+    }
+
+    case IpcMessageType::SetVirtualSlot: {
+        const IpcSetVirtualSlot slot = msg.GetVirtualSlot();
+        if (slot.Connected)
+            _logger.InfoFormat("IPC: Bind slot {} to player {} on controller {}", slot.SlotIndex, slot.PlayerIndex,
+                               slot.ControllerIndex);
+        else
+            _logger.InfoFormat("IPC: Unplug slot {}", slot.SlotIndex);
+        if (_onSetVirtualSlot)
+            _onSetVirtualSlot(slot);
+        break;
+    }
+
+    case IpcMessageType::SetInputRecording: {
+        std::wstring path;
+        const IpcSetInputRecording recording = msg.GetInputRecording(&path);
+        _logger.Info(recording.Recording ? "IPC: Start input recording" : "IPC: Stop input recording");
+        if (_onSetInputRecording)
+            _onSetInputRecording(recording.Recording != 0, path);
+        break;
+    }
+
+    case IpcMessageType::SetStateFreshness: {
+        const uint32_t microseconds = msg.GetStateFreshness();
+        _logger.InfoFormat("IPC: Set state freshness to {}us", microseconds);
+        if (_onSetStateFreshness)
+            _onSetStateFreshness(std::chrono::microseconds(microseconds));
+        break;
+    }
+    }
 }
\ No newline at end of file
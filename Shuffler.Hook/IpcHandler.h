@@ -1,41 +1,55 @@
 #pragma once
 
+#include "IpcTransport.h"
 #include "Logger.h"
-#include <Windows.h>
+#include <chrono>
 #include <functional>
-#include <thread>
-
-enum class IpcMessageType : uint32_t { Enable = 1, Disable = 2, SetActiveController = 3 };
-
-#pragma pack(push, 1)
-struct IpcMessage {
-    IpcMessageType Type;
-    int ControllerId;
-};
-#pragma pack(pop)
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 class IpcHandler {
     using EnableCallback = std::function<void()>;
     using DisableCallback = std::function<void()>;
     using SetControllerCallback = std::function<void(int)>;
+    using SetMappingsCallback = std::function<void(const IpcMappingSet&)>;
+    using SetInputSourceCallback = std::function<void(const IpcSetInputSource&)>;
+    using SetAnalogSettingsCallback = std::function<void(uint8_t, const AnalogSettings&)>;
+    using SetAxisRoutingCallback = std::function<void(uint8_t, const AxisRoutingSettings&)>;
+    using SetVirtualSlotCallback = std::function<void(const IpcSetVirtualSlot&)>;
+    using SetReplaySourceCallback = std::function<void(const IpcReplaySource&, const std::wstring&)>;
+    using SetInputRecordingCallback = std::function<void(bool, const std::wstring&)>;
+    using SetStateFreshnessCallback = std::function<void(std::chrono::microseconds)>;
 
     Logger _logger = Logger("IpcHandler");
 
     EnableCallback _onEnable;
     DisableCallback _onDisable;
     SetControllerCallback _onSetController;
-    bool _shutdownRequested;
-    HANDLE _pipeHandle;
-    std::thread _pipeThread;
+    SetMappingsCallback _onSetMappings;
+    SetInputSourceCallback _onSetInputSource;
+    SetAnalogSettingsCallback _onSetAnalogSettings;
+    SetAxisRoutingCallback _onSetAxisRouting;
+    SetVirtualSlotCallback _onSetVirtualSlot;
+    SetReplaySourceCallback _onSetReplaySource;
+    SetInputRecordingCallback _onSetInputRecording;
+    SetStateFreshnessCallback _onSetStateFreshness;
+    std::vector<std::unique_ptr<IpcTransport>> _transports;
+    std::mutex _dispatchMutex;  // Every transport has its own thread, callbacks run one batch at a time
 
   public:
-    IpcHandler(EnableCallback onEnable, DisableCallback onDisable, SetControllerCallback onSetController);
+    IpcHandler(EnableCallback onEnable, DisableCallback onDisable, SetControllerCallback onSetController,
+               SetMappingsCallback onSetMappings, SetInputSourceCallback onSetInputSource,
+               SetAnalogSettingsCallback onSetAnalogSettings, SetAxisRoutingCallback onSetAxisRouting,
+               SetVirtualSlotCallback onSetVirtualSlot, SetReplaySourceCallback onSetReplaySource,
+               SetInputRecordingCallback onSetInputRecording, SetStateFreshnessCallback onSetStateFreshness);
     ~IpcHandler();
 
     bool Start();
     void Stop();
 
   private:
-    void PipeServerThread();
+    void HandleMessages(std::span<const IpcMessage> messages);
     void HandleMessage(const IpcMessage& msg);
 };
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "IpcProtocol.h"
+
+#include <bit>
+#include <cmath>
+
+namespace {
+bool IsValidAction(const InputType type, const uint16_t value) {
+    switch (type) {
+    case InputType::Button:
+        // Exactly one of the bits XInput defines
+        return std::has_single_bit(value) && (value & 0x0C00) == 0;
+    case InputType::Trigger:
+        return value <= static_cast<uint16_t>(TriggerInput::RightTrigger);
+    }
+
+    return false;
+}
+
+bool IsValidCurve(const float curve) {
+    return std::isfinite(curve) && curve > 0 && curve <= 16;
+}
+
+// length UTF-16 code units making up the rest of the payload, none of them NUL
+bool IsValidPath(const std::span<const uint8_t> path, const uint16_t length) {
+    if (length == 0 || path.size() != length * sizeof(uint16_t))
+        return false;
+
+    for (size_t i = 0; i < path.size(); i += sizeof(uint16_t)) {
+        if (path[i] == 0 && path[i + 1] == 0)
+            return false;
+    }
+
+    return true;
+}
+
+bool IsValidReplaySource(const std::span<const uint8_t> payload) {
+    IpcReplaySource replay;
+    if (payload.size() < sizeof(replay))
+        return false;
+    memcpy(&replay, payload.data(), sizeof(replay));
+
+    return std::isfinite(replay.Speed) && replay.Speed > 0 && replay.Speed <= IpcReplaySource::MAX_SPEED &&
+           IsValidPath(payload.subspan(sizeof(replay)), replay.PathLength);
+}
+
+bool IsValidAxisRouting(const IpcSetAxisRouting& routing) {
+    if (routing.DpadToStick > StickSelection::Right || routing.StickToDpad > StickSelection::Right)
+        return false;
+
+    for (const auto& row : routing.Matrix) {
+        for (const float weight : row) {
+            if (!std::isfinite(weight))
+                return false;
+        }
+    }
+
+    return true;
+}
+}  // namespace
+
+bool IpcMappingSet::Validate(const std::span<const uint8_t> payload) {
+    if (payload.size() < sizeof(IpcMappingSetHeader))
+        return false;
+
+    size_t offset = sizeof(IpcMappingSetHeader);
+    for (uint8_t player = 0; player < payload[0]; player++) {
+        IpcPlayerMappingsHeader header;
+        if (payload.size() - offset < sizeof(header))
+            return false;
+        memcpy(&header, payload.data() + offset, sizeof(header));
+        offset += sizeof(header);
+
+        if ((payload.size() - offset) / sizeof(IpcMappingEntry) < header.MappingCount)
+            return false;
+
+        for (uint16_t i = 0; i < header.MappingCount; i++) {
+            IpcMappingEntry entry;
+            memcpy(&entry, payload.data() + offset, sizeof(entry));
+            offset += sizeof(entry);
+
+            if (!IsValidAction(entry.FromType, entry.From) || !IsValidAction(entry.ToType, entry.To))
+                return false;
+        }
+    }
+
+    return offset == payload.size();
+}
+
+bool IpcMessage::TryParse(const std::span<const uint8_t> frame, IpcMessage* message) {
+    IpcFrameHeader header;
+    if (frame.size() < sizeof(header))
+        return false;
+    memcpy(&header, frame.data(), sizeof(header));
+
+    if (header.Magic != IpcFrameHeader::MAGIC || header.Version != IpcFrameHeader::VERSION ||
+        header.PayloadSize != frame.size() - sizeof(header))
+        return false;
+
+    const auto payload = frame.subspan(sizeof(header));
+    switch (header.Type) {
+    case IpcMessageType::Enable:
+    case IpcMessageType::Disable:
+        break;
+    case IpcMessageType::SetActiveController:
+        if (payload.size() != sizeof(IpcSetActiveController))
+            return false;
+        break;
+    case IpcMessageType::SetInputSource: {
+        IpcSetInputSource setInputSource;
+        if (payload.size() < sizeof(setInputSource))
+            return false;
+        memcpy(&setInputSource, payload.data(), sizeof(setInputSource));
+        if (setInputSource.Source == IpcInputSource::Replay) {
+            if (!IsValidReplaySource(payload.subspan(sizeof(setInputSource))))
+                return false;
+        } else if (payload.size() != sizeof(setInputSource) || setInputSource.Source > IpcInputSource::Replay ||
+                   (setInputSource.Source == IpcInputSource::Polled && setInputSource.PollIntervalMicroseconds == 0)) {
+            return false;
+        }
+        break;
+    }
+    case IpcMessageType::SetInputRecording: {
+        IpcSetInputRecording recording;
+        if (payload.size() < sizeof(recording))
+            return false;
+        memcpy(&recording, payload.data(), sizeof(recording));
+        if (recording.Recording > 1)
+            return false;
+        if (recording.Recording ? !IsValidPath(payload.subspan(sizeof(recording)), recording.PathLength)
+                                : payload.size() != sizeof(recording) || recording.PathLength != 0)
+            return false;
+        break;
+    }
+    case IpcMessageType::SetAnalogSettings: {
+        IpcSetAnalogSettings settings;
+        if (payload.size() != sizeof(settings))
+            return false;
+        memcpy(&settings, payload.data(), sizeof(settings));
+        if (!IsValidCurve(settings.LeftStick.Curve) || !IsValidCurve(settings.RightStick.Curve) ||
+            !IsValidCurve(settings.LeftTrigger.Curve) || !IsValidCurve(settings.RightTrigger.Curve))
+            return false;
+        break;
+    }
+    case IpcMessageType::SetAxisRouting: {
+        IpcSetAxisRouting routing;
+        if (payload.size() != sizeof(routing))
+            return false;
+        memcpy(&routing, payload.data(), sizeof(routing));
+        if (!IsValidAxisRouting(routing))
+            return false;
+        break;
+    }
+    case IpcMessageType::SetVirtualSlot: {
+        IpcSetVirtualSlot slot;
+        if (payload.size() != sizeof(slot))
+            return false;
+        memcpy(&slot, payload.data(), sizeof(slot));
+        if (slot.SlotIndex >= VirtualSlotTable::MAX_SLOTS)
+            return false;
+        break;
+    }
+    case IpcMessageType::SetStateFreshness: {
+        IpcSetStateFreshness freshness;
+        if (payload.size() != sizeof(freshness))
+            return false;
+        memcpy(&freshness, payload.data(), sizeof(freshness));
+        if (freshness.Microseconds > IpcSetStateFreshness::MAX_MICROSECONDS)
+            return false;
+        break;
+    }
+    case IpcMessageType::SetMappings:
+        if (!IpcMappingSet::Validate(payload))
+            return false;
+        break;
+    default:
+        return false;
+    }
+
+    message->Type = header.Type;
+    message->Payload = payload;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "AnalogResponse.h"
+#include "AxisRouter.h"
+#include "ControllerTypes.h"
+#include "VirtualSlotTable.h"
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+
+/**
+ * Wire format shared with ShufflerHookIpcProtocol.cs in Shuffler.Core. All values are little endian.
+ *
+ * Every message is one frame: an IpcFrameHeader followed by PayloadSize bytes of payload. The transports deliver
+ * whole frames, so a frame never has to be reassembled.
+ */
+enum class IpcMessageType : uint16_t {
+    Enable = 1,
+    Disable = 2,
+    SetActiveController = 3,
+    SetMappings = 4,
+    SetInputSource = 5,
+    SetAnalogSettings = 6,
+    SetAxisRouting = 7,
+    SetVirtualSlot = 8,
+    SetInputRecording = 9,
+    SetStateFreshness = 10,
+};
+
+enum class IpcInputSource : uint8_t { XInput = 0, SharedPadFeed = 1, Polled = 2, Replay = 3 };
+
+#pragma pack(push, 1)
+struct IpcFrameHeader {
+    static constexpr uint32_t MAGIC = 0x50494853;  // "SHIP"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t MAX_FRAME_SIZE = 16 * 1024;
+
+    uint32_t Magic;
+    uint16_t Version;
+    IpcMessageType Type;
+    uint32_t PayloadSize;
+    uint32_t Reserved;
+};
+
+// SetActiveController payload
+struct IpcSetActiveController {
+    int32_t ControllerId;
+};
+
+// SetInputSource payload, PollIntervalMicroseconds is how often Polled reads the controllers and unused otherwise
+struct IpcSetInputSource {
+    IpcInputSource Source;
+    uint8_t Reserved;
+    uint16_t PollIntervalMicroseconds;
+};
+
+// Follows IpcSetInputSource when Source is Replay, followed in turn by PathLength UTF-16 code units of the path of the
+// InputStreamRecorder file to play
+struct IpcReplaySource {
+    static constexpr float MAX_SPEED = 1000;
+
+    float Speed;  // Scales the recorded pace
+    uint8_t Loop;
+    uint8_t Reserved;
+    uint16_t PathLength;
+};
+
+// SetInputRecording payload, followed by PathLength UTF-16 code units of the path to record to. Recording 0 stops the
+// recording and has no path
+struct IpcSetInputRecording {
+    uint8_t Recording;
+    uint8_t Reserved;
+    uint16_t PathLength;
+};
+
+// SetAnalogSettings payload, the fields mirror AnalogSettings
+struct IpcStickResponse {
+    uint16_t Deadzone;
+    uint16_t AntiDeadzone;
+    uint16_t OuterDeadzone;
+    uint16_t NoiseGate;
+    float Curve;
+};
+
+struct IpcTriggerResponse {
+    uint8_t Deadzone;
+    uint8_t AntiDeadzone;
+    uint8_t NoiseGate;
+    uint8_t Reserved;
+    float Curve;
+};
+
+struct IpcSetAnalogSettings {
+    uint8_t PlayerIndex;
+    uint8_t Reserved[3];
+    IpcStickResponse LeftStick;
+    IpcStickResponse RightStick;
+    IpcTriggerResponse LeftTrigger;
+    IpcTriggerResponse RightTrigger;
+};
+
+// SetAxisRouting payload, the fields mirror AxisRoutingSettings
+struct IpcSetAxisRouting {
+    uint8_t PlayerIndex;
+    StickSelection DpadToStick;
+    StickSelection StickToDpad;
+    uint8_t Reserved;
+    uint16_t StickToDpadThreshold;
+    uint16_t Reserved2;
+    float Matrix[AxisRoutingSettings::AXIS_COUNT][AxisRoutingSettings::AXIS_COUNT];
+};
+
+// SetVirtualSlot payload, Connected 0 unplugs the slot and ignores the other fields
+struct IpcSetVirtualSlot {
+    uint8_t SlotIndex;
+    uint8_t Connected;
+    uint8_t PlayerIndex;
+    uint8_t ControllerIndex;
+};
+
+// SetStateFreshness payload, how long GetState reuses a slot's last read, 0 reads the input source on every call
+struct IpcSetStateFreshness {
+    static constexpr uint32_t MAX_MICROSECONDS = 100'000;
+
+    uint32_t Microseconds;
+};
+
+// SetMappings payload: an IpcMappingSetHeader, then for each player an IpcPlayerMappingsHeader and its entries
+struct IpcMappingSetHeader {
+    uint8_t PlayerCount;
+    uint8_t Reserved[3];
+};
+
+struct IpcPlayerMappingsHeader {
+    uint8_t PlayerIndex;
+    uint8_t Reserved;
+    uint16_t MappingCount;
+};
+
+struct IpcMappingEntry {
+    InputType FromType;
+    uint8_t Reserved;
+    uint16_t From;  // A single Button bit or a TriggerInput, depending on FromType
+    InputType ToType;
+    uint8_t Reserved2;
+    uint16_t To;
+};
+#pragma pack(pop)
+
+/**
+ * One player's mappings, read straight out of the frame they arrived in.
+ */
+class IpcPlayerMappings {
+    const uint8_t* _entries;
+    uint16_t _count;
+
+  public:
+    IpcPlayerMappings(const uint8_t* entries, const uint16_t count) : _entries(entries), _count(count) {}
+
+    size_t GetCount() const {
+        return _count;
+    }
+
+    ActionMapping operator[](const size_t index) const {
+        IpcMappingEntry entry;
+        memcpy(&entry, _entries + index * sizeof(IpcMappingEntry), sizeof(entry));
+        return {.From = ToAction(entry.FromType, entry.From), .To = ToAction(entry.ToType, entry.To)};
+    }
+
+  private:
+    static InputAction ToAction(const InputType type, const uint16_t value) {
+        InputAction action{};
+        action.Type = type;
+        if (type == InputType::Button)
+            action.Button = static_cast<Button>(value);
+        else
+            action.Trigger = static_cast<TriggerInput>(value);
+        return action;
+    }
+};
+
+/**
+ * A SetMappings payload that has been validated by IpcMessage::TryParse, so walking it cannot fail halfway.
+ */
+class IpcMappingSet {
+    std::span<const uint8_t> _payload;
+
+  public:
+    explicit IpcMappingSet(const std::span<const uint8_t> payload) : _payload(payload) {}
+
+    static bool Validate(std::span<const uint8_t> payload);
+
+    uint8_t GetPlayerCount() const {
+        return _payload[0];
+    }
+
+    // Calls handler(playerIndex, IpcPlayerMappings) for every player in the set, in order
+    template <typename F>
+    void ForEachPlayer(F&& handler) const {
+        size_t offset = sizeof(IpcMappingSetHeader);
+        for (uint8_t player = 0; player < GetPlayerCount(); player++) {
+            IpcPlayerMappingsHeader header;
+            memcpy(&header, _payload.data() + offset, sizeof(header));
+            offset += sizeof(header);
+
+            handler(header.PlayerIndex, IpcPlayerMappings(_payload.data() + offset, header.MappingCount));
+            offset += header.MappingCount * sizeof(IpcMappingEntry);
+        }
+    }
+};
+
+/**
+ * A received frame. The payload points into the transport's buffer and is only valid until the handler returns.
+ */
+struct IpcMessage {
+    IpcMessageType Type;
+    std::span<const uint8_t> Payload;
+
+    // Checks the header and the payload of the type it declares, returns false if frame is malformed or from an
+    // unsupported protocol version
+    static bool TryParse(std::span<const uint8_t> frame, IpcMessage* message);
+
+    int GetControllerId() const {
+        IpcSetActiveController payload;
+        memcpy(&payload, Payload.data(), sizeof(payload));
+        return payload.ControllerId;
+    }
+
+    IpcSetInputSource GetInputSource() const {
+        IpcSetInputSource payload;
+        memcpy(&payload, Payload.data(), sizeof(payload));
+        return payload;
+    }
+
+    // Only for a SetInputSource whose Source is Replay
+    IpcReplaySource GetReplaySource(std::wstring* path) const {
+        IpcReplaySource payload;
+        memcpy(&payload, Payload.data() + sizeof(IpcSetInputSource), sizeof(payload));
+        *path = ReadPath(Payload.subspan(sizeof(IpcSetInputSource) + sizeof(payload)));
+        return payload;
+    }
+
+    IpcSetInputRecording GetInputRecording(std::wstring* path) const {
+        IpcSetInputRecording payload;
+        memcpy(&payload, Payload.data(), sizeof(payload));
+        *path = ReadPath(Payload.subspan(sizeof(payload)));
+        return payload;
+    }
+
+    AnalogSettings GetAnalogSettings(uint8_t* playerIndex) const {
+        IpcSetAnalogSettings payload;
+        memcpy(&payload, Payload.data(), sizeof(payload));
+        *playerIndex = payload.PlayerIndex;
+
+        const auto toStick = [](const IpcStickResponse& stick) {
+            return StickResponse{stick.Deadzone, stick.AntiDeadzone, stick.OuterDeadzone, stick.Curve, stick.NoiseGate};
+        };
+        const auto toTrigger = [](const IpcTriggerResponse& trigger) {
+            return TriggerResponse{trigger.Deadzone, trigger.AntiDeadzone, trigger.Curve, trigger.NoiseGate};
+        };
+        return {toStick(payload.LeftStick), toStick(payload.RightStick), toTrigger(payload.LeftTrigger),
+                toTrigger(payload.RightTrigger)};
+    }
+
+    AxisRoutingSettings GetAxisRouting(uint8_t* playerIndex) const {
+        IpcSetAxisRouting payload;
+        memcpy(&payload, Payload.data(), sizeof(payload));
+        *playerIndex = payload.PlayerIndex;
+
+        AxisRoutingSettings settings;
+        memcpy(settings.Matrix, payload.Matrix, sizeof(settings.Matrix));
+        settings.DpadToStick = payload.DpadToStick;
+        settings.StickToDpad = payload.StickToDpad;
+        settings.StickToDpadThreshold = payload.StickToDpadThreshold;
+        return settings;
+    }
+
+    IpcSetVirtualSlot GetVirtualSlot() const {
+        IpcSetVirtualSlot payload;
+        memcpy(&payload, Payload.data(), sizeof(payload));
+        return payload;
+    }
+
+    uint32_t GetStateFreshness() const {
+        IpcSetStateFreshness payload;
+        memcpy(&payload, Payload.data(), sizeof(payload));
+        return payload.Microseconds;
+    }
+
+    IpcMappingSet GetMappingSet() const {
+        return IpcMappingSet(Payload);
+    }
+
+  private:
+    static std::wstring ReadPath(const std::span<const uint8_t> units) {
+        std::wstring path(units.size() / sizeof(uint16_t), L'\0');
+        for (size_t i = 0; i < path.size(); i++) {
+            uint16_t unit;
+            memcpy(&unit, units.data() + i * sizeof(unit), sizeof(unit));
+            path[i] = static_cast<wchar_t>(unit);
+        }
+        return path;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Start of the shared memory mapping, followed by Capacity bytes of records
+struct IpcRingHeader {
+    static constexpr uint32_t MAGIC = 0x52434853;  // "SHCR"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t Reserved;
+    uint32_t Capacity;  // Power of two
+    uint32_t Reserved2;
+    alignas(64) std::atomic<uint64_t> Tail;  // Bytes written, only advanced by the producer
+    alignas(64) std::atomic<uint64_t> Head;  // Bytes consumed, only advanced by the consumer
+};
+
+/**
+ * Single-producer, single-consumer ring of variable-length records in shared memory.
+ *
+ * Every record is an 8 byte {Length, Reserved} prefix followed by the payload, padded to 8 bytes. Records never wrap;
+ * when one does not fit before the end of the ring, the producer writes a prefix with WRAP_MARKER as its length and
+ * starts over at offset 0. The C# producer in Shuffler.Core mirrors this layout.
+ */
+class IpcRing {
+    static constexpr uint32_t RECORD_ALIGNMENT = 8;
+    static constexpr uint32_t PREFIX_SIZE = 8;
+    static constexpr uint32_t WRAP_MARKER = 0xFFFFFFFF;
+
+    IpcRingHeader* _header = nullptr;
+    uint8_t* _data = nullptr;
+    uint32_t _capacity = 0;  // Kept out of the shared header so that the other process cannot change it
+
+  public:
+    static constexpr size_t GetMappingSize(const uint32_t capacity) {
+        return sizeof(IpcRingHeader) + capacity;
+    }
+
+    IpcRing() = default;
+
+    static IpcRing Create(void* memory, const uint32_t capacity) {
+        auto* header = static_cast<IpcRingHeader*>(memory);
+        header->Magic = IpcRingHeader::MAGIC;
+        header->Version = IpcRingHeader::VERSION;
+        header->Capacity = capacity;
+        header->Tail.store(0, std::memory_order_relaxed);
+        header->Head.store(0, std::memory_order_relaxed);
+        return IpcRing(header, capacity);
+    }
+
+    bool IsValid() const {
+        return _header != nullptr;
+    }
+
+    // Producer side, returns false if there is not enough free space
+    bool TryWrite(const std::span<const uint8_t> payload) {
+        const uint32_t capacity = _capacity;
+        const uint32_t recordSize = GetRecordSize(static_cast<uint32_t>(payload.size()));
+        if (recordSize > capacity)
+            return false;
+
+        uint64_t tail = _header->Tail.load(std::memory_order_relaxed);
+        const uint64_t head = _header->Head.load(std::memory_order_acquire);
+        uint32_t offset = static_cast<uint32_t>(tail & (capacity - 1));
+        const uint32_t padding = offset + recordSize > capacity ? capacity - offset : 0;
+
+        if (tail + padding + recordSize - head > capacity)
+            return false;
+
+        if (padding) {
+            WritePrefix(offset, WRAP_MARKER);
+            tail += padding;
+            offset = 0;
+        }
+
+        WritePrefix(offset, static_cast<uint32_t>(payload.size()));
+        memcpy(_data + offset + PREFIX_SIZE, payload.data(), payload.size());
+        _header->Tail.store(tail + recordSize, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, calls handler with every record written so far and returns how many there were
+    template <typename F>
+    size_t ReadAll(F&& handler) {
+        size_t count = 0;
+        Release(Peek([&](const std::span<const uint8_t> record) {
+            handler(record);
+            count++;
+        }));
+        return count;
+    }
+
+    /**
+     * Consumer side, calls handler with every record written so far without handing their space back to the producer,
+     * so the records stay valid until the returned position is passed to Release.
+     */
+    template <typename F>
+    uint64_t Peek(F&& handler) const {
+        const uint32_t capacity = _capacity;
+        const uint64_t tail = _header->Tail.load(std::memory_order_acquire);
+        uint64_t head = _header->Head.load(std::memory_order_relaxed);
+
+        // A tail more than a ring ahead, or behind the head, means the producer is broken, drop everything it wrote
+        if (tail - head > capacity)
+            return tail;
+
+        while (head < tail) {
+            const uint32_t offset = static_cast<uint32_t>(head & (capacity - 1));
+            uint32_t length;
+            memcpy(&length, _data + offset, sizeof(length));
+
+            if (length == WRAP_MARKER) {
+                head += capacity - offset;
+                continue;
+            }
+
+            // A length that could not have been written, or that runs past the tail, means the producer is broken
+            if (length > capacity - offset - PREFIX_SIZE || head + GetRecordSize(length) > tail)
+                return tail;
+
+            handler(std::span<const uint8_t>(_data + offset + PREFIX_SIZE, length));
+            head += GetRecordSize(length);
+        }
+
+        // Only a wrap marker the producer did not follow with a record skips past the tail
+        return std::min(head, tail);
+    }
+
+    void Release(const uint64_t head) {
+        _header->Head.store(head, std::memory_order_release);
+    }
+
+  private:
+    IpcRing(IpcRingHeader* header, const uint32_t capacity)
+        : _header(header), _data(reinterpret_cast<uint8_t*>(header + 1)), _capacity(capacity) {}
+
+    static constexpr uint32_t GetRecordSize(const uint32_t payloadSize) {
+        return (PREFIX_SIZE + payloadSize + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+    }
+
+    void WritePrefix(const uint32_t offset, const uint32_t length) {
+        const uint32_t prefix[2] = {length, 0};
+        memcpy(_data + offset, prefix, sizeof(prefix));
+    }
+};
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "IpcTransport.h"
+#include <format>
+#include <memory>
+#include <sddl.h>
+
+namespace {
+/**
+ * Security attributes with an explicit DACL that only lets the current user and SYSTEM open the object, rather than
+ * whatever default DACL the game's token carries. Null if the current user could not be looked up.
+ */
+class CurrentUserSecurity {
+    PSECURITY_DESCRIPTOR _descriptor = nullptr;
+    SECURITY_ATTRIBUTES _attributes = {};
+
+  public:
+    CurrentUserSecurity() {
+        HANDLE token;
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token))
+            return;
+
+        DWORD size = 0;
+        GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+        const auto user = std::make_unique<uint8_t[]>(size);
+        LPWSTR sid = nullptr;
+        if (GetTokenInformation(token, TokenUser, user.get(), size, &size) &&
+            ConvertSidToStringSidW(reinterpret_cast<TOKEN_USER*>(user.get())->User.Sid, &sid)) {
+            const std::wstring sddl = std::format(L"D:P(A;;GA;;;SY)(A;;GA;;;{})", sid);
+            ConvertStringSecurityDescriptorToSecurityDescriptorW(sddl.c_str(), SDDL_REVISION_1, &_descriptor,
+                                                                 nullptr);
+            LocalFree(sid);
+        }
+        CloseHandle(token);
+
+        _attributes.nLength = sizeof(_attributes);
+        _attributes.lpSecurityDescriptor = _descriptor;
+        _attributes.bInheritHandle = FALSE;
+    }
+
+    ~CurrentUserSecurity() {
+        LocalFree(_descriptor);
+    }
+
+    CurrentUserSecurity(const CurrentUserSecurity&) = delete;
+    CurrentUserSecurity& operator=(const CurrentUserSecurity&) = delete;
+
+    SECURITY_ATTRIBUTES* Get() {
+        return _descriptor ? &_attributes : nullptr;
+    }
+};
+}
+
+PipeIpcTransport::~PipeIpcTransport() {
+    Stop();
+}
+
+bool PipeIpcTransport::Start(MessageCallback onMessages) {
+    _onMessages = std::move(onMessages);
+    _shutdownRequested = false;
+    _pipeThread = std::thread(&PipeIpcTransport::PipeServerThread, this);
+    return true;
+}
+
+void PipeIpcTransport::Stop() {
+    _shutdownRequested = true;
+
+    if (_pipeHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(_pipeHandle);
+        _pipeHandle = INVALID_HANDLE_VALUE;
+    }
+
+    if (_pipeThread.joinable()) {
+        _pipeThread.join();
+    }
+}
+
+void PipeIpcTransport::PipeServerThread() {
+    auto pipeName = std::format(R"(\\.\pipe\ShufflerHook-{})", GetCurrentProcessId());
+    _logger.InfoFormat("IPC server thread started. Pipe name: {}", pipeName);
+
+    while (!_shutdownRequested) {
+        _pipeHandle = CreateNamedPipeA(pipeName.c_str(), PIPE_ACCESS_DUPLEX,
+                                       PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT, 1,
+                                       IpcFrameHeader::MAX_FRAME_SIZE, IpcFrameHeader::MAX_FRAME_SIZE, 0, nullptr);
+
+        if (_pipeHandle == INVALID_HANDLE_VALUE) {
+            _logger.Info("Failed to create named pipe");
+            return;
+        }
+
+        _logger.Info("Waiting for client connection...");
+        if (ConnectNamedPipe(_pipeHandle, nullptr)) {
+            _logger.Info("Client connected");
+
+            while (!_shutdownRequested) {
+                DWORD bytesRead;
+
+                if (ReadFile(_pipeHandle, _frame, sizeof(_frame), &bytesRead, nullptr)) {
+                    IpcMessage msg;
+                    if (IpcMessage::TryParse(std::span(_frame, bytesRead), &msg))
+                        _onMessages(std::span(&msg, 1));
+                    else
+                        _logger.ErrorFormat("Ignoring malformed frame of {} bytes", bytesRead);
+                } else if (GetLastError() == ERROR_MORE_DATA) {
+                    // Read out the rest of the oversized message so the next read starts at a frame boundary
+                    while (!ReadFile(_pipeHandle, _frame, sizeof(_frame), &bytesRead, nullptr) &&
+                           GetLastError() == ERROR_MORE_DATA) {}
+                    _logger.Error("Ignoring frame larger than the maximum frame size");
+                } else {
+                    _logger.Info("Client disconnected or error");
+                    break;
+                }
+            }
+        }
+
+        CloseHandle(_pipeHandle);
+        _pipeHandle = INVALID_HANDLE_VALUE;
+
+        if (_shutdownRequested)
+            break;
+    }
+
+    _logger.Info("IPC server thread stopped");
+}
+
+SharedMemoryIpcTransport::~SharedMemoryIpcTransport() {
+    Stop();
+}
+
+bool SharedMemoryIpcTransport::Start(MessageCallback onMessages) {
+    _onMessages = std::move(onMessages);
+
+    const DWORD processId = GetCurrentProcessId();
+    const std::wstring mappingName = std::format(L"Local\\ShufflerHookCommands-{}", processId);
+    const std::wstring eventName = std::format(L"Local\\ShufflerHookCommandsEvent-{}", processId);
+    constexpr size_t mappingSize = IpcRing::GetMappingSize(RING_CAPACITY);
+
+    CurrentUserSecurity security;
+    if (!security.Get()) {
+        _logger.ErrorFormat("Failed to build command ring security descriptor: {}", GetLastError());
+        return false;
+    }
+
+    _mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, security.Get(), PAGE_READWRITE, 0,
+                                  static_cast<DWORD>(mappingSize), mappingName.c_str());
+    if (!_mapping) {
+        _logger.ErrorFormat("Failed to create command ring mapping: {}", GetLastError());
+        return false;
+    }
+
+    // Someone else created it first, with their own DACL and possibly a different size
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        _logger.Error("Command ring mapping already exists, not using it");
+        Close();
+        return false;
+    }
+
+    _view = MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, mappingSize);
+    _dataEvent = CreateEventW(security.Get(), FALSE, FALSE, eventName.c_str());
+    _stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!_view || !_dataEvent || !_stopEvent) {
+        _logger.ErrorFormat("Failed to set up command ring: {}", GetLastError());
+        Close();
+        return false;
+    }
+
+    _ring = IpcRing::Create(_view, RING_CAPACITY);
+    _readThread = std::thread(&SharedMemoryIpcTransport::ReadThread, this);
+    _logger.Info("Command ring ready");
+    return true;
+}
+
+void SharedMemoryIpcTransport::Stop() {
+    if (_stopEvent)
+        SetEvent(_stopEvent);
+
+    if (_readThread.joinable())
+        _readThread.join();
+
+    Close();
+}
+
+void SharedMemoryIpcTransport::ReadThread() {
+    const HANDLE events[] = {_dataEvent, _stopEvent};
+
+    while (WaitForMultipleObjects(2, events, FALSE, INFINITE) == WAIT_OBJECT_0) {
+        // The producer can still write to the ring, so records are copied out before they are checked. Whatever it
+        // writes afterwards cannot change a frame that has already been validated
+        _frames.clear();
+        _frameSizes.clear();
+        _ring.Release(_ring.Peek([&](const std::span<const uint8_t> record) {
+            if (record.size() > IpcFrameHeader::MAX_FRAME_SIZE) {
+                _logger.ErrorFormat("Ignoring frame of {} bytes, larger than the maximum frame size", record.size());
+                return;
+            }
+
+            _frames.insert(_frames.end(), record.begin(), record.end());
+            _frameSizes.push_back(static_cast<uint32_t>(record.size()));
+        }));
+
+        _batch.clear();
+        size_t offset = 0;
+        for (const uint32_t size : _frameSizes) {
+            IpcMessage msg;
+            if (IpcMessage::TryParse(std::span(_frames).subspan(offset, size), &msg))
+                _batch.push_back(msg);
+            else
+                _logger.ErrorFormat("Ignoring malformed frame of {} bytes", size);
+            offset += size;
+        }
+
+        if (!_batch.empty())
+            _onMessages(_batch);
+    }
+}
+
+void SharedMemoryIpcTransport::Close() {
+    _ring = IpcRing();
+
+    if (_view) {
+        UnmapViewOfFile(_view);
+        _view = nullptr;
+    }
+
+    for (HANDLE* handle : {&_mapping, &_dataEvent, &_stopEvent}) {
+        if (*handle) {
+            CloseHandle(*handle);
+            *handle = nullptr;
+        }
+    }
+}
\ No newline at end of file
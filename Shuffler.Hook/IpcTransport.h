@@ -0,0 +1,74 @@
+#pragma once
+
+#include "IpcProtocol.h"
+#include "IpcRing.h"
+#include "Logger.h"
+#include <Windows.h>
+#include <functional>
+#include <span>
+#include <thread>
+#include <vector>
+
+/**
+ * Receives frames from the controlling process and hands them over as parsed IpcMessages in batches, in the order they
+ * were sent. Malformed frames are logged and dropped. The messages point into the transport's buffers, so they are
+ * only valid during the callback.
+ */
+class IpcTransport {
+  public:
+    using MessageCallback = std::function<void(std::span<const IpcMessage>)>;
+
+    virtual ~IpcTransport() = default;
+    virtual bool Start(MessageCallback onMessages) = 0;
+    virtual void Stop() = 0;
+};
+
+// One client at a time over the "\\.\pipe\ShufflerHook-<pid>" message pipe, one blocking read per frame
+class PipeIpcTransport : public IpcTransport {
+    Logger _logger = Logger("PipeIpcTransport");
+    MessageCallback _onMessages;
+    bool _shutdownRequested = false;
+    HANDLE _pipeHandle = INVALID_HANDLE_VALUE;
+    std::thread _pipeThread;
+    uint8_t _frame[IpcFrameHeader::MAX_FRAME_SIZE];
+
+  public:
+    ~PipeIpcTransport() override;
+
+    bool Start(MessageCallback onMessages) override;
+    void Stop() override;
+
+  private:
+    void PipeServerThread();
+};
+
+/**
+ * IpcRing in the "Local\ShufflerHookCommands-<pid>" mapping, with the producer signalling
+ * "Local\ShufflerHookCommandsEvent-<pid>" after every write. Everything queued since the last wake up is delivered
+ * as one batch.
+ */
+class SharedMemoryIpcTransport : public IpcTransport {
+    static constexpr uint32_t RING_CAPACITY = 64 * 1024;
+
+    Logger _logger = Logger("SharedMemoryIpcTransport");
+    MessageCallback _onMessages;
+    HANDLE _mapping = nullptr;
+    HANDLE _dataEvent = nullptr;
+    HANDLE _stopEvent = nullptr;
+    void* _view = nullptr;
+    IpcRing _ring;
+    std::thread _readThread;
+    std::vector<uint8_t> _frames;  // The batch's records, copied out of the ring before they are parsed
+    std::vector<uint32_t> _frameSizes;
+    std::vector<IpcMessage> _batch;
+
+  public:
+    ~SharedMemoryIpcTransport() override;
+
+    bool Start(MessageCallback onMessages) override;
+    void Stop() override;
+
+  private:
+    void ReadThread();
+    void Close();
+};
\ No newline at end of file
@@ -1,8 +1,54 @@
 #include "Logger.h"
 #include <Windows.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 std::ofstream Logger::_file;
 std::string Logger::_appName;
+MpscQueue<LogEntry, Logger::QUEUE_CAPACITY> Logger::_queue;
+std::thread Logger::_writerThread;
+std::atomic<bool> Logger::_running = false;
+std::atomic<bool> Logger::_writerWaiting = false;
+std::atomic<uint32_t> Logger::_wakeSequence = 0;
+std::atomic<uint64_t> Logger::_droppedEntries = 0;
+
+namespace {
+// Only touched by the writer thread. The "[time] [app] [PID:n] " prefix only changes once a second, so it is
+// rebuilt when the second changes instead of for every line.
+time_t CachedSecond = -1;
+std::string CachedPrefix;
+
+const char* GetLevelString(const LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug:
+        return "DEBUG";
+    case LogLevel::Info:
+        return "INFO";
+    case LogLevel::Warning:
+        return "WARN";
+    case LogLevel::Error:
+        return "ERROR";
+    }
+    return "";
+}
+
+const std::string& GetPrefix(const std::chrono::system_clock::time_point timestamp, const std::string& appName) {
+    const auto timeT = std::chrono::system_clock::to_time_t(timestamp);
+    if (timeT == CachedSecond)
+        return CachedPrefix;
+
+    tm localTime;
+    localtime_s(&localTime, &timeT);
+    char timeStr[32];
+    std::strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &localTime);
+
+    CachedSecond = timeT;
+    CachedPrefix = std::format("[{}] [{}] [PID:{}] ", timeStr, appName, GetCurrentProcessId());
+    return CachedPrefix;
+}
+}  // namespace
 
 void Logger::Init(const std::string& logPath) {
     _file.open(logPath, std::ios::app);
@@ -14,59 +60,120 @@ void Logger::Init(const std::string& logPath) {
     } else {
         _appName = "Unknown";
     }
-}
 
-Logger::Logger(std::string name) : _name(std::move(name)) {}
+    if (!_file.is_open() || _running.exchange(true))
+        return;
+
+    _writerThread = std::thread(&Logger::WriterThread);
+}
 
-void Logger::Log(const LogEntry& entry) {
-    if (!_file.is_open())
+void Logger::Shutdown() {
+    if (!_running.exchange(false))
         return;
 
-    // Get current time
-    const auto now = std::chrono::system_clock::now();
-    const auto timeT = std::chrono::system_clock::to_time_t(now);
-    tm localTime;
-    localtime_s(&localTime, &timeT);
+    WakeWriter();
+    if (_writerThread.joinable())
+        _writerThread.join();
+    _file.close();
+}
 
-    // Convert LogLevel to string
-    std::string levelStr;
-    switch (entry.Level) {
-    case LogLevel::Debug:
-        levelStr = "DEBUG";
-        break;
-    case LogLevel::Info:
-        levelStr = "INFO";
-        break;
-    case LogLevel::Warning:
-        levelStr = "WARN";
-        break;
-    case LogLevel::Error:
-        levelStr = "ERROR";
-        break;
-    }
+uint64_t Logger::GetDroppedCount() {
+    return _droppedEntries.load(std::memory_order_relaxed);
+}
 
-    char timeStr[32];
-    std::strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &localTime);
+Logger::Logger(const std::string& name) : _source(InternSource(name)) {}
+
+void Logger::SetLevel(const std::string& name, const LogLevel level) {
+    InternSource(name)->Level.store(level, std::memory_order_relaxed);
+}
+
+LogSource* Logger::InternSource(const std::string& name) {
+    // Function-local so loggers constructed during static initialization of other files can use it
+    static std::mutex mutex;
+    static std::unordered_map<std::string, LogSource> sources;
+
+    std::lock_guard lock(mutex);
+    auto [it, inserted] = sources.try_emplace(name);
+    if (inserted) {
+        it->second.Name = it->first.c_str();
+        it->second.Level.store(MIN_LEVEL, std::memory_order_relaxed);
+    }
+    return &it->second;
+}
 
-    const auto logMessage = std::format("[{}] [{}] [PID:{}] [{}] [{}] {}\n", timeStr, _appName, GetCurrentProcessId(),
-                                        levelStr, entry.Source, entry.Message);
+void Logger::Log(const LogLevel level, const std::string_view message) {
+    Enqueue(level, [&](LogEntry& entry) {
+        entry.Length = static_cast<uint16_t>(std::min(message.size(), LogEntry::MESSAGE_CAPACITY));
+        memcpy(entry.Message, message.data(), entry.Length);
+    });
+}
 
-    _file << logMessage;
-    _file.flush();
+void Logger::OnEnqueued() {
+    // Pairs with the fence in WaitForEntries, so either the writer sees this entry or this sees the writer waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_writerWaiting.load(std::memory_order_relaxed))
+        WakeWriter();
 }
 
-void Logger::Debug(const std::string& message) {
-    Log(LogEntry(message, LogLevel::Debug, _name));
+void Logger::WriterThread() {
+    std::string batch;
+    batch.reserve(MAX_BATCH_SIZE + 512);
+    uint64_t reportedDrops = 0;
+
+    while (true) {
+        const bool running = _running.load(std::memory_order_acquire);
+
+        LogEntry entry;
+        while (batch.size() < MAX_BATCH_SIZE && _queue.TryPop(&entry))
+            AppendEntry(batch, entry);
+
+        if (const uint64_t dropped = _droppedEntries.load(std::memory_order_relaxed); dropped != reportedDrops) {
+            batch += GetPrefix(std::chrono::system_clock::now(), _appName);
+            std::format_to(std::back_inserter(batch), "[WARN] [Logger] Dropped {} log entries, queue was full\n",
+                           dropped - reportedDrops);
+            reportedDrops = dropped;
+        }
+
+        if (!batch.empty()) {
+            _file.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            _file.flush();
+            batch.clear();
+            continue;
+        }
+
+        if (!running)
+            break;
+
+        WaitForEntries();
+    }
 }
 
-void Logger::Info(const std::string& message) {
-    Log(LogEntry(message, LogLevel::Info, _name));
+void Logger::WakeWriter() {
+    _wakeSequence.fetch_add(1, std::memory_order_release);
+    _wakeSequence.notify_one();
 }
 
-void Logger::Warning(const std::string& message) {
-    Log(LogEntry(message, LogLevel::Warning, _name));
+void Logger::WaitForEntries() {
+    const uint32_t sequence = _wakeSequence.load(std::memory_order_acquire);
+    _writerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (_queue.IsEmpty() && _running.load(std::memory_order_relaxed))
+        _wakeSequence.wait(sequence, std::memory_order_acquire);
+
+    _writerWaiting.store(false, std::memory_order_relaxed);
 }
 
-void Logger::Error(const std::string& message) {
-    Log(LogEntry(message, LogLevel::Error, _name));
+void Logger::AppendEntry(std::string& batch, const LogEntry& entry) {
+    batch += GetPrefix(entry.Timestamp, _appName);
+    batch += '[';
+    batch += GetLevelString(entry.Level);
+    batch += "] [";
+    batch += entry.Source;
+    batch += "] ";
+    if (entry.Formatter)
+        entry.Formatter(batch, entry.Format, entry.Message);
+    else
+        batch.append(entry.Message, entry.Length);
+    batch += '\n';
 }
\ No newline at end of file
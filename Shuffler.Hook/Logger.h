@@ -1,56 +1,256 @@
 #pragma once
+#include "MpscQueue.h"
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <format>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
 
-enum class LogLevel { Debug, Info, Warning, Error };
+enum class LogLevel : uint8_t { Debug, Info, Warning, Error };
 
+// Lowest level compiled into the build, logging calls below it compile away entirely
+#ifndef SHUFFLER_LOG_MIN_LEVEL
+#define SHUFFLER_LOG_MIN_LEVEL 1  // LogLevel::Info
+#endif
+
+using LogFormatter = void (*)(std::string& output, std::string_view format, const char* arguments);
+
+// Fixed-size queue record. Message holds either the finished text, or the arguments Formatter turns into the text on
+// the writer thread. Messages longer than MESSAGE_CAPACITY are truncated.
 struct LogEntry {
-    std::string Message;
-    LogLevel Level;
+    static constexpr size_t MESSAGE_CAPACITY = 192;
+
     std::chrono::system_clock::time_point Timestamp;
-    std::string Source;
+    const char* Source;
+    LogFormatter Formatter;
+    std::string_view Format;
+    LogLevel Level;
+    uint16_t Length;
+    char Message[MESSAGE_CAPACITY];
+};
+
+// One per distinct logger name, never freed so entries still in the queue can point at it
+struct LogSource {
+    const char* Name;
+    std::atomic<LogLevel> Level;
+};
+
+/**
+ * Packs format arguments into a LogEntry as raw bytes, so the caller only pays for copies and std::format runs on the
+ * writer thread. Strings are copied with a length prefix, other arguments must be trivially copyable.
+ */
+class LogArguments {
+    template <typename T>
+    static constexpr bool IS_STRING = std::is_convertible_v<const T&, std::string_view>;
+
+    template <typename T>
+    using Stored = std::conditional_t<IS_STRING<T>, std::string_view, T>;
+
+  public:
+    template <typename T>
+    static constexpr bool IS_DEFERRABLE = IS_STRING<T> || std::is_trivially_copyable_v<T>;
+
+    template <typename... Args>
+    static size_t GetSize(const Args&... args) {
+        return (GetSizeOne(args) + ... + 0);
+    }
+
+    // Buffer must hold GetSize(args...) bytes, returns the number of bytes written
+    template <typename... Args>
+    static uint16_t Write(char* buffer, const Args&... args) {
+        char* cursor = buffer;
+        (WriteOne(cursor, args), ...);
+        return static_cast<uint16_t>(cursor - buffer);
+    }
+
+    template <typename... Args>
+    static void Format(std::string& output, const std::string_view format, const char* arguments) {
+        const char* cursor = arguments;
+        // Braced initialization reads the arguments left to right
+        std::tuple<Stored<Args>...> values{ReadOne<Args>(cursor)...};
+        std::apply(
+            [&](const auto&... value) {
+                std::vformat_to(std::back_inserter(output), format, std::make_format_args(value...));
+            },
+            values);
+    }
+
+  private:
+    template <typename T>
+    static size_t GetSizeOne(const T& value) {
+        if constexpr (IS_STRING<T>)
+            return sizeof(uint16_t) + std::string_view(value).size();
+        else
+            return sizeof(T);
+    }
+
+    template <typename T>
+    static void WriteOne(char*& cursor, const T& value) {
+        if constexpr (IS_STRING<T>) {
+            const std::string_view string = value;
+            const auto size = static_cast<uint16_t>(string.size());
+            memcpy(cursor, &size, sizeof(size));
+            memcpy(cursor + sizeof(size), string.data(), size);
+            cursor += sizeof(size) + size;
+        } else {
+            memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+        }
+    }
 
-    LogEntry(std::string msg, LogLevel lvl, std::string src)
-        : Message(std::move(msg)), Level(lvl), Timestamp(std::chrono::system_clock::now()), Source(std::move(src)) {}
+    template <typename T>
+    static Stored<T> ReadOne(const char*& cursor) {
+        if constexpr (IS_STRING<T>) {
+            uint16_t size;
+            memcpy(&size, cursor, sizeof(size));
+            const std::string_view string(cursor + sizeof(size), size);
+            cursor += sizeof(size) + size;
+            return string;
+        } else {
+            T value;
+            memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+    }
 };
 
+/**
+ * Callers only copy their message into a lock-free queue; a background writer thread adds the timestamp and process
+ * prefix, and writes the lines to the log file in batches.
+ *
+ * When the queue is full entries are dropped rather than blocking the game thread, and the writer reports how many
+ * were lost.
+ *
+ * Levels are filtered twice before anything is copied: against SHUFFLER_LOG_MIN_LEVEL at compile time, and against
+ * the level set for the logger's name at runtime.
+ */
 class Logger {
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+    static constexpr size_t MAX_BATCH_SIZE = 64 * 1024;
+    static constexpr auto MIN_LEVEL = static_cast<LogLevel>(SHUFFLER_LOG_MIN_LEVEL);
+
     static std::ofstream _file;
-    std::string _name;
     static std::string _appName;
+    static MpscQueue<LogEntry, QUEUE_CAPACITY> _queue;
+    static std::thread _writerThread;
+    static std::atomic<bool> _running;
+    static std::atomic<bool> _writerWaiting;
+    static std::atomic<uint32_t> _wakeSequence;
+    static std::atomic<uint64_t> _droppedEntries;
+
+    LogSource* _source;
 
   public:
     // static Logger Create(const std::string &name);
-    explicit Logger(std::string name);
+    explicit Logger(const std::string& name);
     static void Init(const std::string& logPath);
+    // Writes everything still queued and stops the writer thread
+    static void Shutdown();
 
-    void Debug(const std::string& message);
-    void Info(const std::string& message);
-    void Warning(const std::string& message);
-    void Error(const std::string& message);
+    static uint64_t GetDroppedCount();
+    // Sets the runtime level of every logger with this name, including ones created later
+    static void SetLevel(const std::string& name, LogLevel level);
+
+    bool IsEnabled(const LogLevel level) const {
+        return level >= MIN_LEVEL && level >= _source->Level.load(std::memory_order_relaxed);
+    }
+
+    void Debug(const std::string_view message) {
+        LogMessage<LogLevel::Debug>(message);
+    }
+
+    void Info(const std::string_view message) {
+        LogMessage<LogLevel::Info>(message);
+    }
+
+    void Warning(const std::string_view message) {
+        LogMessage<LogLevel::Warning>(message);
+    }
+
+    void Error(const std::string_view message) {
+        LogMessage<LogLevel::Error>(message);
+    }
 
     template <typename... Args>
     void DebugFormat(std::format_string<Args...> format, Args&&... args) {
-        Debug(std::format(format, std::forward<Args>(args)...));
+        LogFormat<LogLevel::Debug, std::remove_cvref_t<Args>...>(format.get(), args...);
     }
 
     template <typename... Args>
     void InfoFormat(std::format_string<Args...> format, Args&&... args) {
-        Info(std::format(format, std::forward<Args>(args)...));
+        LogFormat<LogLevel::Info, std::remove_cvref_t<Args>...>(format.get(), args...);
     }
 
     template <typename... Args>
     void WarningFormat(std::format_string<Args...> format, Args&&... args) {
-        Warning(std::format(format, std::forward<Args>(args)...));
+        LogFormat<LogLevel::Warning, std::remove_cvref_t<Args>...>(format.get(), args...);
     }
 
     template <typename... Args>
     void ErrorFormat(std::format_string<Args...> format, Args&&... args) {
-        Error(std::format(format, std::forward<Args>(args)...));
+        LogFormat<LogLevel::Error, std::remove_cvref_t<Args>...>(format.get(), args...);
     }
 
   private:
-    void Log(const LogEntry& entry);
+    template <LogLevel Level>
+    void LogMessage(const std::string_view message) {
+        if constexpr (Level >= MIN_LEVEL) {
+            if (IsEnabled(Level))
+                Log(Level, message);
+        }
+    }
+
+    template <LogLevel Level, typename... Args>
+    void LogFormat(const std::string_view format, const Args&... args) {
+        if constexpr (Level >= MIN_LEVEL) {
+            if (!IsEnabled(Level))
+                return;
+
+            if constexpr ((LogArguments::IS_DEFERRABLE<Args> && ...)) {
+                if (LogArguments::GetSize(args...) <= LogEntry::MESSAGE_CAPACITY) {
+                    Enqueue(Level, [&](LogEntry& entry) {
+                        entry.Formatter = &LogArguments::Format<Args...>;
+                        entry.Format = format;
+                        entry.Length = LogArguments::Write(entry.Message, args...);
+                    });
+                    return;
+                }
+            }
+
+            Log(Level, std::vformat(format, std::make_format_args(args...)));
+        }
+    }
+
+    void Log(LogLevel level, std::string_view message);
+
+    template <typename F>
+    void Enqueue(const LogLevel level, F&& fill) {
+        if (!_running.load(std::memory_order_relaxed))
+            return;
+
+        const bool queued = _queue.TryPush([&](LogEntry& entry) {
+            entry.Timestamp = std::chrono::system_clock::now();
+            entry.Source = _source->Name;
+            entry.Level = level;
+            entry.Formatter = nullptr;
+            fill(entry);
+        });
+
+        if (queued)
+            OnEnqueued();
+        else
+            _droppedEntries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static LogSource* InternSource(const std::string& name);
+    static void OnEnqueued();
+    static void WriterThread();
+    static void WakeWriter();
+    static void WaitForEntries();
+    static void AppendEntry(std::string& batch, const LogEntry& entry);
 };
\ No newline at end of file
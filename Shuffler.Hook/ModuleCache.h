@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+/**
+ * Fixed-size, open-addressed map from module handles to a small value, for lookups on hot hook paths.
+ *
+ * Module handles are the base addresses of their images, which are 64 KB aligned, so the bits above that make a good
+ * hash on their own. Lookups take no lock and a module that was never added usually lands on an empty entry at the
+ * first probe. Adds are rare and serialized by a mutex; entries are never removed one by one, only all at once.
+ */
+template <typename T, size_t Capacity = 16>
+class ModuleCache {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    static constexpr int MODULE_ALIGNMENT_BITS = 16;
+
+    struct Entry {
+        std::atomic<uintptr_t> Module;
+        std::atomic<T> Value;
+    };
+
+    Entry _entries[Capacity] = {};
+    std::mutex _writeMutex;
+
+  public:
+    ModuleCache() = default;
+    ModuleCache(const ModuleCache&) = delete;
+    ModuleCache& operator=(const ModuleCache&) = delete;
+
+    // Returns fallback if module was never added
+    T Find(const void* module, const T fallback = T()) const {
+        const auto key = reinterpret_cast<uintptr_t>(module);
+        if (key == 0)
+            return fallback;
+
+        for (size_t i = 0, index = GetIndex(key); i < Capacity; i++, index = (index + 1) & (Capacity - 1)) {
+            const uintptr_t entry = _entries[index].Module.load(std::memory_order_acquire);
+            if (entry == key)
+                return _entries[index].Value.load(std::memory_order_relaxed);
+            if (entry == 0)
+                break;
+        }
+
+        return fallback;
+    }
+
+    // Adds module or updates its value, returns false if the cache is full
+    bool Add(const void* module, const T value) {
+        const auto key = reinterpret_cast<uintptr_t>(module);
+        if (key == 0)
+            return false;
+
+        std::lock_guard lock(_writeMutex);
+        for (size_t i = 0, index = GetIndex(key); i < Capacity; i++, index = (index + 1) & (Capacity - 1)) {
+            const uintptr_t entry = _entries[index].Module.load(std::memory_order_relaxed);
+            if (entry == key) {
+                _entries[index].Value.store(value, std::memory_order_relaxed);
+                return true;
+            }
+
+            if (entry == 0) {
+                // The value is published before the module, so a reader that finds the module also sees its value
+                _entries[index].Value.store(value, std::memory_order_relaxed);
+                _entries[index].Module.store(key, std::memory_order_release);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Clear() {
+        std::lock_guard lock(_writeMutex);
+        for (auto& entry : _entries)
+            entry.Module.store(0, std::memory_order_release);
+    }
+
+  private:
+    static size_t GetIndex(const uintptr_t key) {
+        return (key >> MODULE_ALIGNMENT_BITS ^ key >> (MODULE_ALIGNMENT_BITS + 8)) & (Capacity - 1);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Bounded multi-producer, single-consumer queue that never blocks the producers.
+ *
+ * Every slot carries a sequence number telling whether it is free for the producer at a given position or ready for
+ * the consumer, so a push is one CAS on the tail plus a store into the slot, and a full queue is reported instead of
+ * waited on.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    struct alignas(64) Slot {
+        std::atomic<size_t> Sequence;
+        T Value;
+    };
+
+    alignas(64) std::atomic<size_t> _tail{0};
+    alignas(64) size_t _head = 0;
+    Slot _slots[Capacity];
+
+  public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; i++)
+            _slots[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Claims a slot and lets fill write the value in place, returns false without calling fill if the queue is full
+    template <typename F>
+    bool TryPush(F&& fill) {
+        size_t position = _tail.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &_slots[position & (Capacity - 1)];
+            const size_t sequence = slot->Sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<ptrdiff_t>(sequence - position);
+
+            if (difference == 0) {
+                if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(slot->Value);
+        slot->Sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // TryPop and IsEmpty are only called from the consumer thread
+    bool TryPop(T* value) {
+        Slot& slot = _slots[_head & (Capacity - 1)];
+        if (slot.Sequence.load(std::memory_order_acquire) != _head + 1)
+            return false;
+
+        *value = slot.Value;
+        slot.Sequence.store(_head + Capacity, std::memory_order_release);
+        _head++;
+        return true;
+    }
+
+    bool IsEmpty() const {
+        return _slots[_head & (Capacity - 1)].Sequence.load(std::memory_order_acquire) != _head + 1;
+    }
+};
\ No newline at end of file
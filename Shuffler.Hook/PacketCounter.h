@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/**
+ * Numbers the distinct states of one controller, the way XInput numbers its packets: the number only moves on when a
+ * state differs from the one before it, so callers can skip their input handling while it stays the same.
+ *
+ * The last state is kept behind a sequence number like in SeqLock, and the sequence number is also the packet number.
+ * Any number of threads can update it; a caller that sees a change takes the sequence with a compare-and-swap, and a
+ * caller that loses that race compares against the state that won. Either way a packet number stands for exactly one
+ * state.
+ */
+template <typename T>
+class PacketCounter {
+    // States are compared byte by byte, so T must not have padding
+    static_assert(std::is_trivially_copyable_v<T>);
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> _sequence{0};  // Twice the packet number, odd while a new state is being stored
+    std::atomic<uint64_t> _words[WORD_COUNT]{};
+
+  public:
+    // Returns the packet number of state, a new one if it differs from the state of the previous packet. Packet 0 is
+    // the all-zero state. changed is set for the one caller that started the packet, so that caller alone can tell
+    // others about it
+    uint32_t Update(const T& state, bool* changed = nullptr) {
+        if (changed)
+            *changed = false;
+
+        uint64_t words[WORD_COUNT] = {};
+        memcpy(words, &state, sizeof(T));
+
+        while (true) {
+            uint32_t sequence = _sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            bool unchanged = true;
+            for (size_t i = 0; i < WORD_COUNT; i++)
+                unchanged &= _words[i].load(std::memory_order_relaxed) == words[i];
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) != sequence)
+                continue;
+            if (unchanged)
+                return sequence / 2;
+
+            if (!_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_relaxed))
+                continue;
+
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORD_COUNT; i++)
+                _words[i].store(words[i], std::memory_order_relaxed);
+
+            _sequence.store(sequence + 2, std::memory_order_release);
+            if (changed)
+                *changed = true;
+            return sequence / 2 + 1;
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Perfect hash from a fixed set of export names to their index in that set, built at compile time.
+ *
+ * The constructor searches for a seed under which every name lands in its own bucket, so a lookup is one hash of the
+ * name and at most one strcmp. The hash only looks at the length, the first eight characters and the last one, so
+ * every name in the set has to differ from the others in one of those; construction fails to compile if no seed is
+ * found.
+ */
+template <size_t N>
+class ProcNameTable {
+    static constexpr size_t BUCKET_COUNT = std::bit_ceil(N * 2);
+    static constexpr int BUCKET_BITS = std::countr_zero(BUCKET_COUNT);
+    static constexpr uint32_t MAX_SEED = 1 << 12;
+    static constexpr size_t PREFIX_LENGTH = 8;
+
+    const char* _names[BUCKET_COUNT] = {};
+    uint8_t _indices[BUCKET_COUNT] = {};
+    uint32_t _seed = 0;
+
+  public:
+    consteval explicit ProcNameTable(const char* const (&names)[N]) {
+        static_assert(N > 0 && N < 256);
+
+        for (uint32_t seed = 0; seed < MAX_SEED; seed++) {
+            if (TryBuild(names, seed))
+                return;
+        }
+
+        throw "No perfect hash seed found for these names";
+    }
+
+    // Returns the index of name in the set, or -1 if it is not in it
+    int Find(const char* name) const {
+        const size_t bucket = Hash(name, _seed) >> (32 - BUCKET_BITS);
+        if (_names[bucket] && strcmp(_names[bucket], name) == 0)
+            return _indices[bucket];
+        return -1;
+    }
+
+  private:
+    // Mixes only the length, the first PREFIX_LENGTH characters and the last one, which tells export names apart far
+    // more cheaply than hashing all of them. strcmp confirms the match
+    static constexpr uint32_t Hash(const char* name, const uint32_t seed) {
+        uint64_t prefix = 0;
+        size_t length = 0;
+        if (std::is_constant_evaluated()) {
+            for (; length < PREFIX_LENGTH && name[length]; length++)
+                prefix |= static_cast<uint64_t>(static_cast<uint8_t>(name[length])) << length * 8;
+            while (name[length])
+                length++;
+        } else {
+            length = strlen(name);
+            memcpy(&prefix, name, length < PREFIX_LENGTH ? length : PREFIX_LENGTH);
+        }
+
+        // Multiplicative hash with a multiplier picked by the seed, the top bits depend on every bit of the key. The
+        // length and last character are spread over the whole key first: names of one API tend to share their prefix,
+        // and keys that only differ in their top bits would leave the multiply just those bits to work with
+        const uint64_t last = length ? static_cast<uint8_t>(name[length - 1]) : 0;
+        const uint64_t key = prefix ^ (static_cast<uint64_t>(length) << 8 | last) * 0xC2B2AE3D27D4EB4Full;
+        return static_cast<uint32_t>(key * ((seed + 1) * 0x9E3779B97F4A7C15ull | 1) >> 32);
+    }
+
+    constexpr bool TryBuild(const char* const (&names)[N], const uint32_t seed) {
+        for (auto& name : _names)
+            name = nullptr;
+
+        for (size_t i = 0; i < N; i++) {
+            const size_t bucket = Hash(names[i], seed) >> (32 - BUCKET_BITS);
+            if (_names[bucket])
+                return false;
+
+            _names[bucket] = names[i];
+            _indices[bucket] = static_cast<uint8_t>(i);
+        }
+
+        _seed = seed;
+        return true;
+    }
+};
\ No newline at end of file
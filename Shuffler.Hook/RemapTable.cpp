@@ -0,0 +1,47 @@
+#include "RemapTable.h"
+
+#include <bit>
+
+RemapTable::RemapTable()
+    : _buttonRoutes{}, _triggerRoutes{}, _passthroughButtons(0xFFFF), _passthroughTriggers{0xFF, 0xFF} {}
+
+RemapTable RemapTable::Compile(const std::vector<ActionMapping>& mappings) {
+    RemapTable table;
+
+    for (const auto& [From, To] : mappings) {
+        const uint32_t outputs = GetOutputMask(To);
+
+        if (From.Type == InputType::Button) {
+            // Anything but a single button has no group to route from, and 0 would index past the last one
+            const auto button = static_cast<uint16_t>(From.Button);
+            if (!std::has_single_bit(button))
+                continue;
+
+            table._passthroughButtons &= ~button;
+
+            // Every value of the button's 4-bit group that has the button pressed produces the outputs
+            const int group = std::countr_zero(button) / 4;
+            const uint16_t groupBit = button >> (group * 4);
+            for (uint16_t value = 0; value < 16; value++) {
+                if (value & groupBit)
+                    table._buttonRoutes[group][value] |= outputs;
+            }
+        } else if (From.Type == InputType::Trigger) {
+            const int trigger = From.Trigger == TriggerInput::LeftTrigger ? 0 : 1;
+            table._triggerRoutes[trigger] |= outputs;
+            table._passthroughTriggers[trigger] = 0;
+        }
+    }
+
+    return table;
+}
+
+uint32_t RemapTable::GetOutputMask(const InputAction& action) {
+    if (action.Type == InputType::Button)
+        return static_cast<uint16_t>(action.Button);
+
+    if (action.Type == InputType::Trigger)
+        return action.Trigger == TriggerInput::LeftTrigger ? LEFT_TRIGGER_OUTPUT : RIGHT_TRIGGER_OUTPUT;
+
+    return 0;
+}
\ No newline at end of file
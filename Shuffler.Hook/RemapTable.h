@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include <vector>
+
+/**
+ * A player's ActionMappings flattened into lookup tables, so applying them costs the same handful of lookups no
+ * matter how many mappings the player has.
+ *
+ * Every route is a 32-bit output mask: the low 16 bits are buttons to press, and the two bits above them press the
+ * left/right trigger fully.
+ */
+class RemapTable {
+    static constexpr uint32_t LEFT_TRIGGER_OUTPUT = 1u << 16;
+    static constexpr uint32_t RIGHT_TRIGGER_OUTPUT = 1u << 17;
+
+    uint32_t _buttonRoutes[4][16];    // Outputs for each value of each 4-bit group of source buttons
+    uint32_t _triggerRoutes[2];       // Outputs for each source trigger past the threshold
+    uint16_t _passthroughButtons;     // Source buttons that are not remapped
+    uint8_t _passthroughTriggers[2];  // 0xFF if the trigger value is passed through, 0 if it is remapped
+
+  public:
+    RemapTable();
+
+    // Mappings from a button are skipped unless From is a single button bit
+    static RemapTable Compile(const std::vector<ActionMapping>& mappings);
+
+    void Apply(const ControllerState& source, ControllerState* state) const {
+        const uint16_t buttons = source.ButtonStates;
+        uint32_t outputs = _buttonRoutes[0][buttons & 0xF] | _buttonRoutes[1][(buttons >> 4) & 0xF] |
+                           _buttonRoutes[2][(buttons >> 8) & 0xF] | _buttonRoutes[3][buttons >> 12];
+        outputs |= _triggerRoutes[0] & (0u - (source.LeftTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD));
+        outputs |= _triggerRoutes[1] & (0u - (source.RightTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD));
+
+        state->ButtonStates = static_cast<uint16_t>((outputs & 0xFFFF) | (buttons & _passthroughButtons));
+        state->LeftTrigger = static_cast<uint8_t>((source.LeftTrigger & _passthroughTriggers[0]) |
+                                                  (0u - ((outputs >> 16) & 1)));
+        state->RightTrigger = static_cast<uint8_t>((source.RightTrigger & _passthroughTriggers[1]) |
+                                                   (0u - ((outputs >> 17) & 1)));
+        state->LeftThumbstickX = source.LeftThumbstickX;
+        state->LeftThumbstickY = source.LeftThumbstickY;
+        state->RightThumbstickX = source.RightThumbstickX;
+        state->RightThumbstickY = source.RightThumbstickY;
+    }
+
+  private:
+    static uint32_t GetOutputMask(const InputAction& action);
+};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Lays records of any size out back to back in a caller's buffer, each starting at an aligned offset, the way
+ * GetRawInputBuffer hands out RAWINPUT records. The buffer itself is expected to be aligned, so aligned offsets are
+ * aligned addresses.
+ */
+class RecordBatchWriter {
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _alignment;
+    size_t _end = 0;
+    uint32_t _count = 0;
+
+  public:
+    // alignment must be a power of two. A null buffer fits nothing
+    RecordBatchWriter(void* buffer, const size_t capacity, const size_t alignment)
+        : _buffer(static_cast<uint8_t*>(buffer)), _capacity(buffer ? capacity : 0), _alignment(alignment) {}
+
+    static constexpr size_t Align(const size_t offset, const size_t alignment) {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    bool CanFit(const size_t size) const {
+        return GetNextOffset() + size <= _capacity;
+    }
+
+    // Returns the space for a record of size bytes, nullptr if it does not fit
+    void* Append(const size_t size) {
+        if (!CanFit(size))
+            return nullptr;
+
+        const size_t offset = GetNextOffset();
+        _end = offset + size;
+        _count++;
+        return _buffer + offset;
+    }
+
+    // Where the next record would start, the rest of the buffer can be handed on from here
+    size_t GetNextOffset() const {
+        return Align(_end, _alignment);
+    }
+
+    size_t GetCapacity() const {
+        return _capacity;
+    }
+
+    uint32_t GetCount() const {
+        return _count;
+    }
+};
+
+/**
+ * Remembers the last packet number handed out for each of a fixed set of sources, so a report is queued once per
+ * state change no matter how often or from how many threads the sources are polled.
+ */
+template <size_t SourceCount>
+class ReportChangeFilter {
+    static constexpr uint64_t HANDED_OUT = 1ull << 32;
+
+    std::atomic<uint64_t> _handedOut[SourceCount] = {};  // HANDED_OUT | packet number, 0 before the first report
+
+  public:
+    // True if packetNumber is newer than the last one handed out for source. It then counts as handed out for every
+    // caller, so check that the report fits before claiming it. Packet numbers only move forward, a caller that read
+    // one before another caller handed out a newer one gets false instead of handing out the older state again
+    bool Claim(const size_t source, const uint32_t packetNumber) {
+        uint64_t handedOut = _handedOut[source].load(std::memory_order_relaxed);
+        while (true) {
+            if (handedOut && static_cast<int32_t>(packetNumber - static_cast<uint32_t>(handedOut)) <= 0)
+                return false;
+            if (_handedOut[source].compare_exchange_weak(handedOut, HANDED_OUT | packetNumber,
+                                                         std::memory_order_relaxed))
+                return true;
+        }
+    }
+};
\ No newline at end of file
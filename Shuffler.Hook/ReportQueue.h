@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+/**
+ * Input reports of one open handle on an emulated HID device, read the way ReadFile reads them from a real one.
+ *
+ * Reports nobody has read yet wait in a ring of Capacity; once it is full the oldest is dropped, like in a HID device's
+ * input buffer. An overlapped read that finds no report leaves a pending read behind, which the next report fills
+ * directly and hands back to be completed. A blocking read waits on Signal, which is only notified when a report
+ * arrives or the queue closes, so readers never spin. Signal needs Notify() and Wait() with the semantics of an
+ * auto-reset event: a Notify with nobody waiting wakes the next Wait.
+ *
+ * The queue is opened for one session at a time, identified by a caller-chosen value such as the handle. Reads from a
+ * session that has been closed fail, so a queue can be reused for the next handle.
+ *
+ * Every report carries a sequence number, such as the packet number of the state it encodes. Producers on several
+ * threads can push out of order; a report that is not newer than the last one pushed is dropped, so the newest report
+ * is always the last one read.
+ */
+template <size_t ReportSize, size_t Capacity, typename Signal>
+class ReportQueue {
+  public:
+    static constexpr size_t MAX_PENDING_READS = 8;
+
+    enum class ReadResult {
+        Completed,
+        Pending,  // No report yet. Read registered the pending read, TryRead did not
+        Closed,
+        TooManyPending,
+    };
+
+    struct PendingRead {
+        uint8_t* Buffer;
+        void* Context;
+    };
+
+  private:
+    mutable std::mutex _mutex;
+    Signal _signal;
+    uint64_t _session = 0;
+    bool _open = false;
+    bool _pushed = false;  // Whether _lastSequence holds a report of this session
+    uint32_t _lastSequence = 0;
+    uint8_t _reports[Capacity][ReportSize] = {};
+    size_t _head = 0;
+    size_t _count = 0;
+    PendingRead _pendingReads[MAX_PENDING_READS] = {};
+    size_t _pendingHead = 0;
+    size_t _pendingCount = 0;
+
+  public:
+    // Starts a new session with no reports queued
+    void Open(const uint64_t session) {
+        std::lock_guard lock(_mutex);
+        _session = session;
+        _open = true;
+        _pushed = false;
+        _head = _count = 0;
+        _pendingHead = _pendingCount = 0;
+    }
+
+    // Ends session and wakes its blocking readers. Its pending reads are moved to cancelled, which must have room for
+    // MAX_PENDING_READS, to be completed as cancelled. Returns their count
+    size_t Close(const uint64_t session, PendingRead* cancelled) {
+        size_t count = 0;
+        {
+            std::lock_guard lock(_mutex);
+            if (!IsOpenLocked(session))
+                return 0;
+
+            _open = false;
+            while (_pendingCount != 0)
+                cancelled[count++] = PopPendingLocked();
+        }
+
+        _signal.Notify();
+        return count;
+    }
+
+    // Queues report, or fills the oldest pending read with it. Returns true if it did the latter, with the read in
+    // completed. Ignored once session is closed, so a producer that raced a close cannot feed the next session, and
+    // ignored unless sequence is newer than the last report's, which it may have wrapped past
+    bool Push(const uint64_t session, const uint32_t sequence, const uint8_t* report, PendingRead* completed) {
+        {
+            std::lock_guard lock(_mutex);
+            if (!IsOpenLocked(session))
+                return false;
+            if (_pushed && static_cast<int32_t>(sequence - _lastSequence) <= 0)
+                return false;
+
+            _pushed = true;
+            _lastSequence = sequence;
+
+            if (_pendingCount != 0) {
+                *completed = PopPendingLocked();
+                memcpy(completed->Buffer, report, ReportSize);
+                return true;
+            }
+
+            if (_count == Capacity) {
+                _head = (_head + 1) % Capacity;
+                _count--;
+            }
+
+            memcpy(_reports[(_head + _count) % Capacity], report, ReportSize);
+            _count++;
+        }
+
+        _signal.Notify();
+        return false;
+    }
+
+    // Takes the oldest report if there is one, without waiting
+    ReadResult TryRead(const uint64_t session, uint8_t* buffer) {
+        std::lock_guard lock(_mutex);
+        if (!IsOpenLocked(session))
+            return ReadResult::Closed;
+        return PopReportLocked(buffer) ? ReadResult::Completed : ReadResult::Pending;
+    }
+
+    // Takes the oldest report, or leaves a pending read for buffer that a later Push fills
+    ReadResult Read(const uint64_t session, uint8_t* buffer, void* context) {
+        std::lock_guard lock(_mutex);
+        if (!IsOpenLocked(session))
+            return ReadResult::Closed;
+        if (PopReportLocked(buffer))
+            return ReadResult::Completed;
+        if (_pendingCount == MAX_PENDING_READS)
+            return ReadResult::TooManyPending;
+
+        _pendingReads[(_pendingHead + _pendingCount) % MAX_PENDING_READS] = {buffer, context};
+        _pendingCount++;
+        return ReadResult::Pending;
+    }
+
+    // Waits for a report or for the session to close. Returns Completed or Closed
+    ReadResult WaitRead(const uint64_t session, uint8_t* buffer) {
+        while (true) {
+            {
+                std::lock_guard lock(_mutex);
+                if (!IsOpenLocked(session)) {
+                    // A single Notify woke only one of the readers of the closed session, pass it on to the next
+                    _signal.Notify();
+                    return ReadResult::Closed;
+                }
+
+                if (PopReportLocked(buffer)) {
+                    if (_count != 0)
+                        _signal.Notify();  // Reports arrived faster than readers woke up, wake the next one
+                    return ReadResult::Completed;
+                }
+            }
+
+            _signal.Wait();
+        }
+    }
+
+    // Moves the pending read of context, or every pending read if context is null, to cancelled, which must have room
+    // for MAX_PENDING_READS. Returns their count
+    size_t Cancel(const uint64_t session, const void* context, PendingRead* cancelled) {
+        std::lock_guard lock(_mutex);
+        if (!IsOpenLocked(session))
+            return 0;
+
+        size_t count = 0;
+        size_t kept = 0;
+        for (size_t i = 0; i < _pendingCount; i++) {
+            const PendingRead read = _pendingReads[(_pendingHead + i) % MAX_PENDING_READS];
+            if (!context || read.Context == context)
+                cancelled[count++] = read;
+            else
+                _pendingReads[(_pendingHead + kept++) % MAX_PENDING_READS] = read;
+        }
+
+        _pendingCount = kept;
+        return count;
+    }
+
+  private:
+    bool IsOpenLocked(const uint64_t session) const {
+        return _open && _session == session;
+    }
+
+    bool PopReportLocked(uint8_t* buffer) {
+        if (_count == 0)
+            return false;
+
+        memcpy(buffer, _reports[_head], ReportSize);
+        _head = (_head + 1) % Capacity;
+        _count--;
+        return true;
+    }
+
+    PendingRead PopPendingLocked() {
+        const PendingRead read = _pendingReads[_pendingHead];
+        _pendingHead = (_pendingHead + 1) % MAX_PENDING_READS;
+        _pendingCount--;
+        return read;
+    }
+};
\ No newline at end of file
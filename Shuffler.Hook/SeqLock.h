@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/**
+ * Single-writer, multi-reader sequence lock for small trivially copyable values.
+ *
+ * The value is stored as relaxed atomic words, so readers racing with the writer see torn data only in their local
+ * copy and retry instead of invoking undefined behavior.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> _sequence{0};
+    std::atomic<uint64_t> _words[WORD_COUNT]{};
+
+  public:
+    void Store(const T& value) {
+        uint64_t words[WORD_COUNT] = {};
+        memcpy(words, &value, sizeof(T));
+
+        const uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            _words[i].store(words[i], std::memory_order_relaxed);
+
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * Store for values that any thread may write, like a cache. Gives up and returns false if another TryStore is in
+     * progress instead of waiting for it. Not to be mixed with Store, which assumes a single writer
+     */
+    bool TryStore(const T& value) {
+        uint64_t words[WORD_COUNT] = {};
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) || !_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed))
+            return false;
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            _words[i].store(words[i], std::memory_order_relaxed);
+
+        _sequence.store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Single read attempt for when the writer may be in another process and could die halfway through a Store. Returns
+     * false if a write was in progress, a value that was never stored reads as all zeroes.
+     */
+    bool TryLoad(T* value) const {
+        uint64_t words[WORD_COUNT];
+
+        const uint32_t before = _sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            return false;
+
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            words[i] = _words[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) != before)
+            return false;
+
+        memcpy(value, words, sizeof(T));
+        return true;
+    }
+
+    // Returns the sequence number of the value that was read, 0 if nothing has been stored yet
+    uint32_t Load(T* value) const {
+        uint64_t words[WORD_COUNT];
+
+        while (true) {
+            const uint32_t before = _sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (size_t i = 0; i < WORD_COUNT; i++)
+                words[i] = _words[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == before) {
+                memcpy(value, words, sizeof(T));
+                return before;
+            }
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Immutable block of memory that is handed out to callers who each give it back once, like the preparsed data of a HID
+ * device.
+ *
+ * Every caller gets the same block, so memory use stays the same however often it is asked for. The block itself is
+ * never freed; the reference count tracks how many callers still hold it, so that a pointer of some other block, or a
+ * release without a matching acquire, is turned away instead of being counted.
+ */
+class SharedBlock {
+    const void* _data;
+    size_t _size;
+    std::atomic<uint32_t> _references{0};
+
+  public:
+    constexpr SharedBlock(const void* data, const size_t size) : _data(data), _size(size) {}
+
+    SharedBlock(const SharedBlock&) = delete;
+    SharedBlock& operator=(const SharedBlock&) = delete;
+
+    const void* Acquire() {
+        _references.fetch_add(1, std::memory_order_relaxed);
+        return _data;
+    }
+
+    // Returns false if data is not this block or every reference has already been released
+    bool Release(const void* data) {
+        if (data != _data)
+            return false;
+
+        uint32_t references = _references.load(std::memory_order_relaxed);
+        do {
+            if (references == 0)
+                return false;
+        } while (!_references.compare_exchange_weak(references, references - 1, std::memory_order_relaxed));
+
+        return true;
+    }
+
+    bool Owns(const void* data) const {
+        return data == _data;
+    }
+
+    size_t GetSize() const {
+        return _size;
+    }
+
+    uint32_t GetReferenceCount() const {
+        return _references.load(std::memory_order_relaxed);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ControllerTypes.h"
+#include "SeqLock.h"
+#include <cstddef>
+#include <cstdint>
+
+struct SharedPadState {
+    ControllerState State;
+    uint8_t Connected;
+    uint8_t Reserved[3];
+};
+
+/**
+ * Layout of the "Local\ShufflerPadFeed" mapping that the controlling process publishes every player's controller
+ * state in, mirrored by ShufflerPadFeed.cs in Shuffler.Core.
+ *
+ * Each slot is a SeqLock written only by the controlling process: a 32-bit sequence at offset 0 that is odd while a
+ * write is in progress, and the SharedPadState at offset 8. Slots are indexed by player, not by physical controller.
+ */
+struct SharedPadTable {
+    static constexpr uint32_t MAGIC = 0x44504853;  // "SHPD"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t MAX_PLAYERS = 16;
+
+    struct alignas(64) Slot {
+        SeqLock<SharedPadState> State;
+    };
+
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t SlotCount;
+    Slot Slots[MAX_PLAYERS];
+};
+
+static_assert(sizeof(SeqLock<SharedPadState>) == 24);
+static_assert(offsetof(SharedPadTable, Slots) == 64 && sizeof(SharedPadTable::Slot) == 64);
\ No newline at end of file
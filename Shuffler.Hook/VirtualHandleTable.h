@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Hands out handles for virtual devices from a reserved address range, each with a small piece of per-handle state.
+ *
+ * A handle is BASE | generation << 8 | index << 2. Kernel handles stay far below BASE (a process holds at most 2^24
+ * handles, numbered in steps of 4), so telling a virtual handle from any other is a range and mask check. Every entry
+ * carries a generation that moves on when its handle is closed, so a stale or twice-closed handle is rejected even
+ * after its entry has been reused.
+ *
+ * Free entries form a lock-free stack whose head is tagged against ABA, so any number of threads can open, look up and
+ * close handles without locking.
+ */
+template <typename T, size_t Capacity = 64>
+class VirtualHandleTable {
+    static_assert(std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free,
+                  "Per-handle state has to fit in a lock-free atomic");
+
+    static constexpr int INDEX_SHIFT = 2;
+    static constexpr int INDEX_BITS = 6;
+    static constexpr int GENERATION_SHIFT = INDEX_SHIFT + INDEX_BITS;
+    static constexpr uint32_t GENERATION_MASK = 0xFFFF;
+    static constexpr uintptr_t RANGE_MASK = 0x00FFFFFF;
+    static constexpr uint32_t NO_ENTRY = 0xFFFFFFFF;
+
+    static_assert(Capacity > 0 && Capacity <= 1 << INDEX_BITS);
+
+    struct alignas(64) Entry {
+        std::atomic<uint32_t> State{0};  // Generation << 1, plus 1 while a handle is open
+        std::atomic<uint32_t> NextFree{NO_ENTRY};
+        std::atomic<T> Value{};
+    };
+
+    Entry _entries[Capacity];
+    alignas(64) std::atomic<uint64_t> _freeHead;  // Tag << 32 | index of the first free entry
+
+  public:
+    static constexpr uintptr_t BASE = 0x5A000000;
+    static constexpr size_t CAPACITY = Capacity;
+
+    VirtualHandleTable() {
+        for (uint32_t i = 0; i + 1 < Capacity; i++)
+            _entries[i].NextFree.store(i + 1, std::memory_order_relaxed);
+        _freeHead.store(0, std::memory_order_relaxed);
+    }
+
+    VirtualHandleTable(const VirtualHandleTable&) = delete;
+    VirtualHandleTable& operator=(const VirtualHandleTable&) = delete;
+
+    // True for every handle the table could have issued, open or not
+    static constexpr bool IsInRange(const void* handle) {
+        const auto value = reinterpret_cast<uintptr_t>(handle);
+        return (value & ~RANGE_MASK) == BASE && (value & ((1 << INDEX_SHIFT) - 1)) == 0 &&
+               (value >> INDEX_SHIFT & ((1 << INDEX_BITS) - 1)) < Capacity;
+    }
+
+    // Returns nullptr if every entry is in use
+    void* Open(const T value) {
+        uint64_t head = _freeHead.load(std::memory_order_acquire);
+        uint32_t index;
+        while (true) {
+            index = static_cast<uint32_t>(head);
+            if (index == NO_ENTRY)
+                return nullptr;
+
+            const uint64_t next = _entries[index].NextFree.load(std::memory_order_relaxed);
+            if (_freeHead.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | next, std::memory_order_acquire,
+                                                std::memory_order_acquire))
+                break;
+        }
+
+        Entry& entry = _entries[index];
+        const uint32_t generation = entry.State.load(std::memory_order_relaxed) >> 1;
+        entry.Value.store(value, std::memory_order_relaxed);
+        entry.State.store(generation << 1 | 1, std::memory_order_release);
+        return Encode(index, generation);
+    }
+
+    // Returns false if handle is not an open handle of this table
+    bool TryGet(const void* handle, T* value) const {
+        if (!IsInRange(handle))
+            return false;
+
+        const auto [index, generation] = Decode(handle);
+        const Entry& entry = _entries[index];
+        const uint32_t open = generation << 1 | 1;
+        if (entry.State.load(std::memory_order_acquire) != open)
+            return false;
+
+        *value = entry.Value.load(std::memory_order_acquire);
+        // The handle may have been closed and its entry reopened while the value was read
+        return entry.State.load(std::memory_order_acquire) == open;
+    }
+
+    // Entry index of an open handle, in [0, Capacity), for keeping more per-handle state alongside the table. -1 if
+    // handle is not open
+    int GetIndex(const void* handle) const {
+        if (!IsInRange(handle))
+            return -1;
+
+        const auto [index, generation] = Decode(handle);
+        return _entries[index].State.load(std::memory_order_acquire) == (generation << 1 | 1) ? static_cast<int>(index)
+                                                                                               : -1;
+    }
+
+    // Returns false if handle is not open, in which case nothing changes
+    bool Close(const void* handle) {
+        if (!IsInRange(handle))
+            return false;
+
+        const auto [index, generation] = Decode(handle);
+        Entry& entry = _entries[index];
+        uint32_t open = generation << 1 | 1;
+        if (!entry.State.compare_exchange_strong(open, ((generation + 1) & GENERATION_MASK) << 1,
+                                                 std::memory_order_acq_rel))
+            return false;
+
+        uint64_t head = _freeHead.load(std::memory_order_relaxed);
+        do {
+            entry.NextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        } while (!_freeHead.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | index, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+        return true;
+    }
+
+  private:
+    struct DecodedHandle {
+        uint32_t Index;
+        uint32_t Generation;
+    };
+
+    static void* Encode(const uint32_t index, const uint32_t generation) {
+        return reinterpret_cast<void*>(BASE | static_cast<uintptr_t>(generation) << GENERATION_SHIFT |
+                                       static_cast<uintptr_t>(index) << INDEX_SHIFT);
+    }
+
+    static DecodedHandle Decode(const void* handle) {
+        const auto value = reinterpret_cast<uintptr_t>(handle);
+        return {static_cast<uint32_t>(value >> INDEX_SHIFT & ((1 << INDEX_BITS) - 1)),
+                static_cast<uint32_t>(value >> GENERATION_SHIFT & GENERATION_MASK)};
+    }
+};
\ No newline at end of file
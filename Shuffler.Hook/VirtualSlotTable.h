@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// What a virtual slot is bound to: the player whose profile is applied and the physical controller it reads
+struct VirtualSlot {
+    uint8_t PlayerIndex;
+    uint8_t ControllerIndex;
+};
+
+/**
+ * The virtual controllers a game sees, as XInput user indices and as emulated HID devices. Every slot is bound
+ * independently and packed into one atomic word, so the hooks read a binding without locking and never see half of
+ * an update. Only slot 0 is connected by default, bound to player 0 on controller 0.
+ *
+ * Kept free of Windows headers so it can be built and tested on its own.
+ */
+class VirtualSlotTable {
+  public:
+    static constexpr int MAX_SLOTS = 4;
+
+  private:
+    static constexpr uint32_t CONNECTED_BIT = 1u << 16;
+
+    std::atomic<uint32_t> _slots[MAX_SLOTS] = {CONNECTED_BIT, 0, 0, 0};
+
+  public:
+    // Returns false if slotIndex is out of range or nothing is plugged into it
+    bool TryGet(const int slotIndex, VirtualSlot* slot) const {
+        if (slotIndex < 0 || slotIndex >= MAX_SLOTS)
+            return false;
+
+        const uint32_t packed = _slots[slotIndex].load(std::memory_order_acquire);
+        if (!(packed & CONNECTED_BIT))
+            return false;
+
+        slot->PlayerIndex = static_cast<uint8_t>(packed);
+        slot->ControllerIndex = static_cast<uint8_t>(packed >> 8);
+        return true;
+    }
+
+    bool IsConnected(const int slotIndex) const {
+        return slotIndex >= 0 && slotIndex < MAX_SLOTS &&
+               (_slots[slotIndex].load(std::memory_order_relaxed) & CONNECTED_BIT);
+    }
+
+    // Bit n is set if slot n is connected
+    uint32_t GetConnectedMask() const {
+        uint32_t mask = 0;
+        for (int i = 0; i < MAX_SLOTS; i++) {
+            if (_slots[i].load(std::memory_order_relaxed) & CONNECTED_BIT)
+                mask |= 1u << i;
+        }
+        return mask;
+    }
+
+    // Connects the slot if it was not, returns false if slotIndex is out of range
+    bool Bind(const int slotIndex, const VirtualSlot slot) {
+        if (slotIndex < 0 || slotIndex >= MAX_SLOTS)
+            return false;
+
+        _slots[slotIndex].store(CONNECTED_BIT | slot.ControllerIndex << 8 | slot.PlayerIndex, std::memory_order_release);
+        return true;
+    }
+
+    // Rebinds a slot to another player and leaves its controller and connection as they are
+    bool SetPlayer(const int slotIndex, const uint8_t playerIndex) {
+        if (slotIndex < 0 || slotIndex >= MAX_SLOTS)
+            return false;
+
+        uint32_t packed = _slots[slotIndex].load(std::memory_order_relaxed);
+        while (!_slots[slotIndex].compare_exchange_weak(packed, (packed & ~0xFFu) | playerIndex,
+                                                        std::memory_order_release, std::memory_order_relaxed)) {}
+        return true;
+    }
+
+    bool Unbind(const int slotIndex) {
+        if (slotIndex < 0 || slotIndex >= MAX_SLOTS)
+            return false;
+
+        _slots[slotIndex].store(0, std::memory_order_release);
+        return true;
+    }
+};
\ No newline at end of file
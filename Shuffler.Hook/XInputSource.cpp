@@ -0,0 +1,42 @@
+#include "XInputSource.h"
+
+#include "Hooks/LoadLibraryHook.h"
+#include "Hooks/XInputHook.h"
+
+decltype(&XInputGetState) XInputSource::LoadXInput() {
+    if (XInputHook::GetOriginalXInputGetState())
+        return XInputHook::GetOriginalXInputGetState();
+
+    // If no XInput DLL is loaded, load xinput1_4.dll ourselves
+    if (LoadLibraryHook::HookedLoadLibraryA("xinput1_4.dll")) {
+        _logger.Info("Did not find original XInputGetState in XInputHook, loading xinput1_4.dll ourselves");
+        if (auto original = XInputHook::GetOriginalXInputGetState()) {
+            _logger.Info("Got original XInputGetState from xinput1_4.dll");
+            return original;
+        }
+    }
+
+    return nullptr;
+}
+
+bool XInputSource::GetState(int controllerIndex, ControllerState* state) {
+    auto originalXInputGetState = XInputHook::GetOriginalXInputGetState();
+    if (!originalXInputGetState) {
+        originalXInputGetState = LoadXInput();
+        if (!originalXInputGetState)
+            return false;
+    }
+
+    XINPUT_STATE xinputState;
+    if (originalXInputGetState(controllerIndex, &xinputState) != ERROR_SUCCESS)
+        return false;
+
+    state->ButtonStates = xinputState.Gamepad.wButtons;
+    state->LeftTrigger = xinputState.Gamepad.bLeftTrigger;
+    state->RightTrigger = xinputState.Gamepad.bRightTrigger;
+    state->LeftThumbstickX = xinputState.Gamepad.sThumbLX;
+    state->LeftThumbstickY = xinputState.Gamepad.sThumbLY;
+    state->RightThumbstickX = xinputState.Gamepad.sThumbRX;
+    state->RightThumbstickY = xinputState.Gamepad.sThumbRY;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "InputSource.h"
+#include "Logger.h"
+#include <Windows.h>
+#include <Xinput.h>
+
+// Reads physical controllers synchronously through the original XInputGetState
+class XInputSource : public InputSource {
+    Logger _logger = Logger("XInputSource");
+
+  public:
+    bool GetState(int controllerIndex, ControllerState* state) override;
+
+  private:
+    decltype(&XInputGetState) LoadXInput();
+};
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include "Hooks/LoadLibraryHook.h"
 #include "Hooks/RawInputHook.h"
 #include "Hooks/XInputHook.h"
+#include "HookStats.h"
+#include "InputRecorder.h"
+#include "InputStreamRecorder.h"
 #include "IpcHandler.h"
 #include "Logger.h"
 #include "Utils.h"
@@ -33,6 +36,69 @@ void OnSetController(int controllerId) {
     MainLogger.InfoFormat("Setting active controller to {}", controllerId);
     ControllerManager::SetActivePlayer(static_cast<uint8_t>(controllerId));
 }
+
+void OnSetMappings(const IpcMappingSet& mappingSet) {
+    ControllerManager::ReplaceButtonMappings(mappingSet);
+}
+
+void OnSetAnalogSettings(uint8_t playerIndex, const AnalogSettings& settings) {
+    ControllerManager::SetAnalogSettings(playerIndex, settings);
+}
+
+void OnSetAxisRouting(uint8_t playerIndex, const AxisRoutingSettings& settings) {
+    ControllerManager::SetAxisRouting(playerIndex, settings);
+}
+
+void OnSetVirtualSlot(const IpcSetVirtualSlot& slot) {
+    if (!slot.Connected)
+        ControllerManager::UnbindSlot(slot.SlotIndex);
+    else if (!ControllerManager::BindSlot(slot.SlotIndex, slot.PlayerIndex, slot.ControllerIndex))
+        MainLogger.ErrorFormat("Failed to bind slot {} to controller {}", slot.SlotIndex, slot.ControllerIndex);
+}
+
+void OnSetInputSource(const IpcSetInputSource& source) {
+    switch (source.Source) {
+    case IpcInputSource::XInput:
+        ControllerManager::DisableSharedPadFeed();
+        ControllerManager::DisableBackgroundPolling();
+        ControllerManager::DisableReplay();
+        break;
+    case IpcInputSource::SharedPadFeed:
+        ControllerManager::DisableBackgroundPolling();
+        ControllerManager::DisableReplay();
+        if (!ControllerManager::EnableSharedPadFeed())
+            MainLogger.Error("Failed to switch to the shared pad feed, staying on XInput");
+        break;
+    case IpcInputSource::Polled:
+        ControllerManager::DisableSharedPadFeed();
+        ControllerManager::DisableReplay();
+        ControllerManager::EnableBackgroundPolling(std::chrono::microseconds(source.PollIntervalMicroseconds));
+        break;
+    case IpcInputSource::Replay:
+        // Carries a path, so it arrives through OnSetReplaySource instead
+        break;
+    }
+}
+
+void OnSetReplaySource(const IpcReplaySource& replay, const std::wstring& path) {
+    ControllerManager::DisableSharedPadFeed();
+    ControllerManager::DisableBackgroundPolling();
+    if (!ControllerManager::EnableReplay(path, replay.Speed, replay.Loop != 0)) {
+        ControllerManager::DisableReplay();
+        MainLogger.Error("Failed to start replay, staying on XInput");
+    }
+}
+
+void OnSetInputRecording(const bool recording, const std::wstring& path) {
+    if (!recording)
+        InputStreamRecorder::Stop();
+    else if (!InputStreamRecorder::Start(path))
+        MainLogger.Error("Failed to start input recording");
+}
+
+void OnSetStateFreshness(const std::chrono::microseconds window) {
+    ControllerManager::SetStateFreshness(window);
+}
 }  // namespace
 
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall, LPVOID lpReserved) {
@@ -41,6 +107,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall, LPVOID lpReserved)
         DisableThreadLibraryCalls(hModule);
 
         Logger::Init(R"(C:\Users\Myla\Documents\Dev\shuffler_hook.log)");
+        InputRecorder::Init(
+            std::format(LR"(C:\Users\Myla\Documents\Dev\shuffler_input_{}.rec)", GetCurrentProcessId()));
+        HookStats::Init();
 
         XInputHook::Enabled = true;
         RawInputHook::Enabled = true;
@@ -57,7 +126,10 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall, LPVOID lpReserved)
 
         XInputHook::HookExisting();
 
-        MainIpcHandler = std::make_unique<IpcHandler>(OnEnable, OnDisable, OnSetController);
+        MainIpcHandler = std::make_unique<IpcHandler>(OnEnable, OnDisable, OnSetController, OnSetMappings,
+                                                       OnSetInputSource, OnSetAnalogSettings, OnSetAxisRouting,
+                                                       OnSetVirtualSlot, OnSetReplaySource, OnSetInputRecording,
+                                                       OnSetStateFreshness);
         if (!MainIpcHandler->Start()) {
             MainLogger.Error("Failed to start IPC handler");
             return FALSE;
@@ -96,11 +168,18 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall, LPVOID lpReserved)
             MainIpcHandler.reset();
         }
 
+        ControllerManager::DisableBackgroundPolling();
+
         // Uninstall hooks in reverse order
         LoadLibraryHook::Uninstall();
         XInputHook::Uninstall();
         RawInputHook::Uninstall();
         HidDeviceHook::Uninstall();
+
+        HookStats::Shutdown();
+        InputStreamRecorder::Stop();
+        InputRecorder::Shutdown();
+        Logger::Shutdown();
         break;
     default:;
     }